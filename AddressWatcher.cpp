@@ -0,0 +1,172 @@
+#include "AddressWatcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif // _WIN32
+
+namespace
+{
+const size_t kReceiveBufferSize = 16 * 1024;
+// 未能订阅时查询当前地址的间隔
+const int kPollIntervalMs = 100;
+
+long long monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+
+AddressWatcher::AddressWatcher() : fd_(-1), eventCount_(0), buffer_(kReceiveBufferSize)
+{
+}
+
+AddressWatcher::~AddressWatcher()
+{
+    close();
+}
+
+bool AddressWatcher::open()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        return true;
+    }
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd_ < 0)
+    {
+        return false;
+    }
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_IPV4_IFADDR;
+    if (bind(fd_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0)
+    {
+        close();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void AddressWatcher::close()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif // _WIN32
+}
+
+bool AddressWatcher::findAddress(int ifindex, InterfaceAddress &address)
+{
+    std::vector<InterfaceAddress> addresses;
+    if (!query_.getAddresses(addresses))
+    {
+        return false;
+    }
+    for (const auto &entry : addresses)
+    {
+        if (entry.ifindex == ifindex)
+        {
+            address = entry;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool AddressWatcher::waitForAddress(int ifindex, int timeoutMs, InterfaceAddress &address)
+{
+#ifndef _WIN32
+    // 已订阅时, 查询之后写入的地址一定会以事件到达
+    if (findAddress(ifindex, address))
+    {
+        return true;
+    }
+
+    long long deadline = monotonicMs() + timeoutMs;
+    while (true)
+    {
+        long long remaining = deadline - monotonicMs();
+        if (remaining <= 0)
+        {
+            return false;
+        }
+        if (fd_ < 0)
+        {
+            usleep(static_cast<useconds_t>(std::min<long long>(remaining, kPollIntervalMs)) * 1000);
+            if (findAddress(ifindex, address))
+            {
+                return true;
+            }
+            continue;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = fd_;
+        pfd.events = POLLIN;
+        int ready = poll(&pfd, 1, static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return false;
+        }
+
+        ssize_t received = recv(fd_, buffer_.data(), buffer_.size(), MSG_DONTWAIT);
+        if (received < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            if (errno == ENOBUFS)
+            {
+                // 事件溢出, 丢失的部分以重新查询补齐
+                if (findAddress(ifindex, address))
+                {
+                    return true;
+                }
+                continue;
+            }
+            // 订阅失效, 退化为定时查询
+            close();
+            continue;
+        }
+
+        std::vector<InterfaceAddress> addresses;
+        RtNetlink::decodeAddresses(buffer_.data(), static_cast<size_t>(received), addresses);
+        eventCount_ += static_cast<int>(addresses.size());
+        for (const auto &entry : addresses)
+        {
+            if (entry.ifindex == ifindex)
+            {
+                address = entry;
+                return true;
+            }
+        }
+    }
+#else
+    (void)ifindex;
+    (void)timeoutMs;
+    (void)address;
+    return false;
+#endif // _WIN32
+}
@@ -0,0 +1,61 @@
+#ifndef ADDRESS_WATCHER_H
+#define ADDRESS_WATCHER_H
+
+#include <vector>
+#include <cstdint>
+#include "RtNetlink.h"
+
+/*
+ * IPv4地址变化订阅(rtnetlink RTMGRP_IPV4_IFADDR组播)
+ * 在触发地址分配(如启动udhcpc)之前打开, 之后到达的RTM_NEWADDR不会丢失;
+ * 等待时先查询当前地址, 再阻塞在事件上, 地址写入后立即返回, 不再固定等待
+ */
+class AddressWatcher
+{
+public:
+    AddressWatcher();
+    ~AddressWatcher();
+
+    /**
+     * 打开订阅套接字(已打开时直接返回true)
+     * @return 成功返回true，失败返回false
+     */
+    bool open();
+
+    /**
+     * 关闭订阅套接字
+     */
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * 等待接口获得IPv4地址, 未能订阅时退化为每100毫秒查询一次
+     * @param ifindex 接口索引
+     * @param timeoutMs 超时时间(毫秒)
+     * @param address 获得的地址
+     * @return 超时前获得地址返回true
+     */
+    bool waitForAddress(int ifindex, int timeoutMs, InterfaceAddress &address);
+
+    /**
+     * 已收到的RTM_NEWADDR事件数量(不限接口)
+     */
+    int getEventCount() const { return eventCount_; }
+
+private:
+    int fd_;
+    int eventCount_;
+    RtNetlink query_;             // 查询当前地址(独立套接字, dump响应不会与事件交错)
+    std::vector<uint8_t> buffer_; // 复用的接收缓冲区
+
+    /*
+     * 查询接口当前的IPv4地址
+     */
+    bool findAddress(int ifindex, InterfaceAddress &address);
+
+    AddressWatcher(const AddressWatcher &);
+    AddressWatcher &operator=(const AddressWatcher &);
+};
+
+#endif // ADDRESS_WATCHER_H
@@ -1,4 +1,5 @@
 #include "BlueInterface.h"
+#include "TextView.h"
 
 /*
 TODO:
@@ -15,7 +16,7 @@ TODO:
     获取已连接设备
     修改设备名称
 */
-BlueInterface::BlueInterface() : bluetoothEnabled_(false), isScanning_(false)
+BlueInterface::BlueInterface() : bluetoothEnabled_(false), isScanning_(false), metricStore_(nullptr)
 {
     loadDeviceConfig();
 }
@@ -35,9 +36,9 @@ bool BlueInterface::validateBluetoothState()
 #endif
     return true;
 }
-bool BlueInterface::validateDeviceAddress(const std::string &deviceAddress)
+bool BlueInterface::validateDeviceAddress(const MacAddress &deviceAddress)
 {
-    if (deviceAddress.empty())
+    if (deviceAddress.isZero())
     {
         std::cout << "Invalid device MAC address." << std::endl;
         return false;
@@ -62,11 +63,12 @@ void BlueInterface::loadDeviceConfig()
     while (std::getline(configFile, line))
     {
         size_t pos = line.find('|');
-        if (pos != std::string::npos)
+        MacAddress address;
+        if (pos != std::string::npos && MacAddress::parse(line.data(), pos, address))
         {
-            std::string address = line.substr(0, pos);
-            bool autoConnect = line.substr(pos + 1) == "1";
-            autoConnectDevices_[address] = autoConnect;
+            BluetoothDeviceRecord &record = devices_.upsert(address);
+            record.set(kDeviceSaved, true);
+            record.set(kDeviceAutoConnect, line.substr(pos + 1) == "1");
         }
     }
     configFile.close();
@@ -85,9 +87,13 @@ void BlueInterface::saveDeviceConfig()
         return;
     }
 
-    for (const auto &device : autoConnectDevices_)
+    for (const auto &record : devices_.records())
     {
-        configFile << device.first << "|" << (device.second ? "1" : "0") << std::endl;
+        if (record.has(kDeviceSaved))
+        {
+            configFile << record.address.toString(true) << "|"
+                       << (record.has(kDeviceAutoConnect) ? "1" : "0") << std::endl;
+        }
     }
     configFile.close();
 #else
@@ -95,47 +101,74 @@ void BlueInterface::saveDeviceConfig()
 #endif // _WIN32
 }
 
-std::string BlueInterface::executeCommand(const std::string &command)
+BluetoothDevice BlueInterface::toDevice(const BluetoothDeviceRecord &record)
 {
-#ifndef _WIN32
-    FILE *pipe = popen(command.c_str(), "r");
-    if (!pipe)
-    {
-        return "";
-    }
+    BluetoothDevice device;
+    device.address = record.address;
+    device.name = record.name.empty() ? "unknown" : record.name;
+    device.isPaired = record.has(kDevicePaired);
+    device.isConnected = record.has(kDeviceConnected);
+    device.autoConnect = record.has(kDeviceAutoConnect);
+    return device;
+}
 
-    char buffer[128];
-    std::string result = "";
-    while (!feof(pipe))
+std::vector<BluetoothDevice> BlueInterface::snapshotDevices(uint8_t flag, uint8_t excludeFlag) const
+{
+    std::vector<BluetoothDevice> devices;
+    for (const auto &record : devices_.records())
     {
-        if (fgets(buffer, 128, pipe) != NULL)
+        if (record.has(flag) && (excludeFlag == 0 || !record.has(excludeFlag)))
         {
-            result += buffer;
+            devices.push_back(toDevice(record));
         }
     }
-    pclose(pipe);
-    return result;
+    return devices;
+}
+
+BluetoothDeviceRecord *BlueInterface::lookupDevice(const MacAddress &deviceAddress, bool create)
+{
+    if (deviceAddress.isZero())
+    {
+        return nullptr;
+    }
+    return create ? &devices_.upsert(deviceAddress) : devices_.find(deviceAddress);
+}
+
+std::string BlueInterface::executeCommand(const std::vector<std::string> &argv, int timeoutMs)
+{
+#ifndef _WIN32
+    return runner_.capture(argv, timeoutMs);
 #else
     return "";
 #endif // _WIN32
 }
 
-bool BlueInterface::executeCommandWithResult(const std::string &command)
+bool BlueInterface::executeCommandWithResult(const std::vector<std::string> &argv, int timeoutMs, const std::string &input)
 {
 #ifndef _WIN32
-    int result = system(command.c_str());
-    return (result == 0);
+    ProcessResult result;
+    return runner_.run(argv, result, timeoutMs, input) && result.exitStatus == 0;
 #else
     return true;
 #endif // _WIN32
 }
 
+std::string BlueInterface::runBluetoothctl(const std::string &command, const std::vector<std::string> &markers, int timeoutMs)
+{
+#ifndef _WIN32
+    std::string output;
+    bluetoothctl_.execute(command, output, markers, timeoutMs);
+    return output;
+#else
+    return "";
+#endif // _WIN32
+}
+
 bool BlueInterface::enableBluetooth()
 {
 #ifndef _WIN32
     // 1. 启动bluetoothd服务
-    std::string startDaemonCommand = "bluetoothd -n &";
-    if (!executeCommandWithResult(startDaemonCommand))
+    if (!runner_.spawnDetached({"bluetoothd", "-n"}))
     {
         std::cout << "Failed to start bluetoothd daemon." << std::endl;
         return false;
@@ -144,16 +177,15 @@ bool BlueInterface::enableBluetooth()
     sleep(2); // 等待2s,确保bluetoothd服务启动完成
 
     // 2. 启用蓝牙接口
-    std::string upCommand = "hciconfig hci0 up";
-    if (!executeCommandWithResult(upCommand))
+    if (!executeCommandWithResult({"hciconfig", "hci0", "up"}))
     {
         std::cout << "Failed to enable Bluetooth." << std::endl;
         return false;
     }
 
     // 3. 开启蓝牙电源
-    std::string powerOnCommand = "timeout 5 bluetoothctl -- power on";
-    if (executeCommandWithResult(powerOnCommand))
+    std::string powerOnOutput = runBluetoothctl("power on", {"Changing power on succeeded", "Failed to set power on", "not available"}, 5000);
+    if (powerOnOutput.find("succeeded") != std::string::npos)
     {
         bluetoothEnabled_ = true;
         std::cout << "Bluetooth enabled." << std::endl;
@@ -161,9 +193,8 @@ bool BlueInterface::enableBluetooth()
     }
     else
     {
-        // 如果timeout失败，则直接发送power on命令
-        std::string alternativeCommand = "printf 'power on\nquit' | bluetoothctl";
-        if (executeCommandWithResult(alternativeCommand))
+        // 如果会话命令失败，则通过一次性bluetoothctl进程发送power on命令
+        if (executeCommandWithResult({"bluetoothctl"}, -1, "power on\nquit"))
         {
             bluetoothEnabled_ = true;
             std::cout << "Bluetooth enabled." << std::endl;
@@ -188,20 +219,17 @@ bool BlueInterface::disableBluetooth()
     }
 
     // 关闭蓝牙电源
-    std::string powerOffCommand = "timeout 5 bluetoothctl -- power off";
-    if (!executeCommandWithResult(powerOffCommand))
+    std::string powerOffOutput = runBluetoothctl("power off", {"Changing power off succeeded", "Failed to set power off", "not available"}, 5000);
+    if (powerOffOutput.find("succeeded") == std::string::npos)
     {
-        std::string alternativeCommand = "printf 'power off\nquit' | bluetoothctl";
-        executeCommandWithResult(alternativeCommand);
+        executeCommandWithResult({"bluetoothctl"}, -1, "power off\nquit");
     }
 
     // 关闭蓝牙接口
-    std::string downCommand = "hciconfig hci0 down";
-    executeCommandWithResult(downCommand);
+    executeCommandWithResult({"hciconfig", "hci0", "down"});
 
     // 停止Bluetoothd服务
-    std::string stopDaemonCommand = "killall bluetoothd";
-    executeCommandWithResult(stopDaemonCommand);
+    executeCommandWithResult({"killall", "bluetoothd"});
     sleep(2); // 等待2s,确保bluetoothd服务停止完成
     bluetoothEnabled_ = false;
     std::cout << "Bluetooth disabled." << std::endl;
@@ -216,15 +244,11 @@ bool BlueInterface::isBluetoothEnabled()
 {
 #ifndef _WIN32
     // 检测bluetoothd服务是否运行
-    std::string daemonCommand = "ps aux | grep -q '[b]luetoothd' && echo 'running' || echo 'stopped'";
-    std::string daemonStatus = executeCommand(daemonCommand);
-
-    if (daemonStatus.find("running") != std::string::npos)
+    if (probe_.isProcessRunning("bluetoothd"))
     {
         // 检测蓝牙接口状态
-        std::string hciCommand = "hciconfig hci0 | grep -q 'UP RUNNING' && echo 'enabled' || echo 'disabled'";
-        std::string hciResult = executeCommand(hciCommand);
-        bluetoothEnabled_ = (hciResult.find("enabled") != std::string::npos);
+        std::string hciResult = executeCommand({"hciconfig", "hci0"});
+        bluetoothEnabled_ = (hciResult.find("UP RUNNING") != std::string::npos);
     }
     else
     {
@@ -252,10 +276,11 @@ bool BlueInterface::startScanning(int duration)
     }
 
     clearScanResults();
+    // 已配对设备只查询一次, 用于过滤扫描结果
+    refreshPairedDevices();
 
     // 关闭配对请求的验证，解决后台终端需要输入yes确认的问题
-    std::string agentOffCommand = "bluetoothctl -- agent off";
-    std::string agentOffOutput = executeCommand(agentOffCommand);
+    std::string agentOffOutput = runBluetoothctl("agent off", {"Agent unregistered", "No agent is registered"});
     if (agentOffOutput.find("Agent unregistered") != std::string::npos)
     {
         std::cout << "Agent unregistered successfully." << std::endl;
@@ -266,8 +291,7 @@ bool BlueInterface::startScanning(int duration)
     }
 
     // 使能设备可配对
-    std::string pairableOnCommand = "bluetoothctl -- pairable on";
-    std::string pairableOnOutput = executeCommand(pairableOnCommand);
+    std::string pairableOnOutput = runBluetoothctl("pairable on", {"Changing pairable on succeeded", "Failed to set pairable on", "not available"});
     if (pairableOnOutput.find("Changing pairable on succeeded") != std::string::npos)
     {
         std::cout << "Pairable mode enabled successfully." << std::endl;
@@ -279,8 +303,7 @@ bool BlueInterface::startScanning(int duration)
     }
 
     // 使能设备可发现
-    std::string discoverableOnCommand = "bluetoothctl -- discoverable on";
-    std::string discoverableOnOutput = executeCommand(discoverableOnCommand);
+    std::string discoverableOnOutput = runBluetoothctl("discoverable on", {"Changing discoverable on succeeded", "Failed to set discoverable on", "not available"});
     if (discoverableOnOutput.find("Changing discoverable on succeeded") != std::string::npos)
     {
         std::cout << "Discoverable mode enabled successfully." << std::endl;
@@ -291,10 +314,11 @@ bool BlueInterface::startScanning(int duration)
         return false;
     }
 
-    std::string scanCommand = "timeout " + std::to_string(duration) + " bluetoothctl -- scan on 2>/dev/null";
     std::cout << "Start scanning for Bluetooth devices. Duration: " << duration << " seconds." << std::endl;
 
-    std::string scanOutput = executeCommand(scanCommand);
+    std::string scanOutput = runBluetoothctl("scan on", {"Discovery started", "Failed to start discovery"});
+    scanOutput += bluetoothctl_.collect(duration * 1000);
+    runBluetoothctl("scan off", {"Discovery stopped", "Failed to stop discovery"});
 
     // 解析扫描过程中发现的设备
     if (!parseScanResults(scanOutput))
@@ -304,15 +328,13 @@ bool BlueInterface::startScanning(int duration)
     }
 
     // 扫描完成后获取设备列表
-    std::string devicesCommand = "bluetoothctl -- devices";
-    std::string devicesOutput = executeCommand(devicesCommand);
+    std::string devicesOutput = runBluetoothctl("devices");
     parseScanResults(devicesOutput);
 
     isScanning_ = false;
 
-    // 获取已配对设备数量用于统计
-    auto pairedDevices = getPairedDevices();
-    std::cout << "Scan completed, found " << scanResults_.size() << " unpaired devices. (" << pairedDevices.size() << " paired devices filtered out)" << std::endl;
+    std::cout << "Scan completed, found " << devices_.count(kDeviceDiscovered) << " unpaired devices. ("
+              << devices_.count(kDevicePaired) << " paired devices filtered out)" << std::endl;
     return true;
 #else
     isScanning_ = true;
@@ -329,8 +351,8 @@ bool BlueInterface::stopScanning()
         return false;
     }
 
-    std::string stopCommand = "bluetoothctl -- scan off";
-    if (!executeCommandWithResult(stopCommand))
+    std::string stopOutput = runBluetoothctl("scan off", {"Discovery stopped", "Failed to stop discovery"});
+    if (stopOutput.find("Discovery stopped") == std::string::npos)
     {
         std::cout << "Failed to stop scanning." << std::endl;
         return false;
@@ -339,8 +361,7 @@ bool BlueInterface::stopScanning()
     sleep(1);
 
     // 获取最终的设备列表
-    std::string devicesCommand = "bluetoothctl -- devices";
-    std::string devicesOutput = executeCommand(devicesCommand);
+    std::string devicesOutput = runBluetoothctl("devices");
     if (!parseScanResults(devicesOutput))
     {
         std::cout << "Failed to parse scan results." << std::endl;
@@ -349,9 +370,8 @@ bool BlueInterface::stopScanning()
 
     isScanning_ = false;
 
-    // 获取已配对设备数量用于统计
-    auto pairedDevices = getPairedDevices();
-    std::cout << "Scan stopped, found " << scanResults_.size() << " unpaired devices. (" << pairedDevices.size() << " paired devices filtered out)" << std::endl;
+    std::cout << "Scan stopped, found " << devices_.count(kDeviceDiscovered) << " unpaired devices. ("
+              << devices_.count(kDevicePaired) << " paired devices filtered out)" << std::endl;
     return true;
 #else
     isScanning_ = false;
@@ -365,20 +385,8 @@ bool BlueInterface::parseScanResults(const std::string &scanOutput)
     std::istringstream iss(scanOutput);
     std::string line;
 
-    // 获取已配对设备列表，用于过滤
-    auto pairedDevices = getPairedDevices();
-    std::set<std::string> pairedDeviceAddresses;
-    for (const auto &pairedDevice : pairedDevices)
-    {
-        pairedDeviceAddresses.insert(pairedDevice.address);
-    }
-
     while (std::getline(iss, line))
     {
-        if (!line.empty() && line.back() == '\n')
-        {
-            line.pop_back();
-        }
         if (!line.empty() && line.back() == '\r')
         {
             line.pop_back();
@@ -394,53 +402,33 @@ bool BlueInterface::parseScanResults(const std::string &scanOutput)
         // 检查是否是[NEW] Device格式
         if (line.find("[NEW] Device") != std::string::npos)
         {
-            size_t devicePos = line.find("Device");
-            if (devicePos != std::string::npos)
-            {
-                std::string deviceLine = line.substr(devicePos);
-                validDevice = parseDeviceLine(deviceLine, device);
-            }
+            validDevice = parseDeviceLine(line.substr(line.find("Device")), device);
         }
         // 检查是否是Device格式
         else if (line.find("Device") == 0)
         {
             validDevice = parseDeviceLine(line, device);
         }
-
-        if (validDevice)
+        if (!validDevice)
         {
-            // 检查设备是否已配对，如果已配对则跳过
-            if (pairedDeviceAddresses.find(device.address) != pairedDeviceAddresses.end())
-            {
-                std::cout << "Skipping paired device: " << device.name << " (" << device.address << ")" << std::endl;
-                continue; // 跳过已配对的设备
-            }
-
-            // 检查是否已经存在相同MAC地址的设备
-            bool exists = false;
-            for (auto &existingDevice : scanResults_)
-            {
-                if (existingDevice.address == device.address)
-                {
-                    exists = true;
-                    // 更新设备信息
-                    if (!device.name.empty() && device.name != "unknown")
-                    {
-                        existingDevice.name = device.name;
-                    }
-                    break;
-                }
-            }
-
-            if (!exists)
-            {
-                // 设置默认值
-                device.isPaired = false;
-                device.isConnected = false;
-                device.autoConnect = false;
+            continue;
+        }
 
-                scanResults_.push_back(device);
-            }
+        BluetoothDeviceRecord *record = lookupDevice(device.address, true);
+        if (!record)
+        {
+            continue;
+        }
+        // 已配对设备不计入扫描结果(配对状态在扫描开始时已刷新)
+        if (record->has(kDevicePaired))
+        {
+            std::cout << "Skipping paired device: " << device.name << " (" << device.address.toString(true) << ")" << std::endl;
+            continue;
+        }
+        record->set(kDeviceDiscovered, true);
+        if (!device.name.empty() && (device.name != "unknown" || record->name.empty()))
+        {
+            record->name = device.name;
         }
     }
 
@@ -462,11 +450,8 @@ bool BlueInterface::parseDeviceLine(const std::string &line, BluetoothDevice &de
     if (lineStream >> token)
     {
         // 验证MAC地址格式
-        if (token.length() == 17 &&
-            token[2] == ':' && token[5] == ':' && token[8] == ':' &&
-            token[11] == ':' && token[14] == ':')
+        if (MacAddress::parse(token, device.address))
         {
-            device.address = token;
 
             // 获取设备名称
             std::string name;
@@ -491,12 +476,12 @@ bool BlueInterface::parseDeviceLine(const std::string &line, BluetoothDevice &de
 
 std::vector<BluetoothDevice> BlueInterface::getScanResults()
 {
-    return scanResults_;
+    return snapshotDevices(kDeviceDiscovered, kDevicePaired);
 }
 
 void BlueInterface::clearScanResults()
 {
-    scanResults_.clear();
+    devices_.clearFlag(kDeviceDiscovered);
 }
 
 bool BlueInterface::pairDevice(const BluetoothDevice &device)
@@ -507,22 +492,18 @@ bool BlueInterface::pairDevice(const BluetoothDevice &device)
         return false;
     }
 
-    std::string pairCommand = "timeout 10 bluetoothctl -- pair " + device.address;
-    std::string pairOutput = executeCommand(pairCommand);
+    std::string pairOutput = runBluetoothctl("pair " + device.address.toString(true), {"Pairing successful", "Failed to pair", "not available"}, 10000);
 
     if (pairOutput.find("Pairing successful") != std::string::npos)
     {
-        std::cout << "Pairing successful for device " << device.address << "." << std::endl;
+        std::cout << "Pairing successful for device " << device.address.toString(true) << "." << std::endl;
         // 更新设备配对状态
-        for (auto &dev : scanResults_)
+        BluetoothDeviceRecord *record = lookupDevice(device.address, true);
+        if (record)
         {
-            if (dev.address == device.address)
-            {
-                dev.isPaired = true;
-                break;
-            }
+            record->set(kDevicePaired, true);
         }
-        std::cout << "Device " << device.address << " is now paired." << std::endl;
+        std::cout << "Device " << device.address.toString(true) << " is now paired." << std::endl;
         return true;
     }
     else
@@ -543,41 +524,37 @@ bool BlueInterface::unpairDevice(const BluetoothDevice &device)
         return false;
     }
 
-    std::cout << "Unpairing device " << device.address << "..." << std::endl;
+    std::cout << "Unpairing device " << device.address.toString(true) << "..." << std::endl;
 
-    std::string unpairCommand = "bluetoothctl -- remove " + device.address;
-    if (executeCommandWithResult(unpairCommand))
+    std::string removeOutput = runBluetoothctl("remove " + device.address.toString(true), {"Device has been removed", "Failed to remove", "not available"});
+    if (removeOutput.find("Device has been removed") != std::string::npos)
     {
-        // 更新设备配对状态
-        for (auto &dev : scanResults_)
-        {
-            if (dev.address == device.address)
-            {
-                dev.isPaired = false;
-                dev.isConnected = false;
-                dev.autoConnect = false;
-                break;
-            }
-        }
-
         // 断开设备连接
-        std::string disconnectCommand = "bluetoothctl -- disconnect " + device.address;
-        executeCommand(disconnectCommand);
+        runBluetoothctl("disconnect " + device.address.toString(true), {"Successful disconnected", "Failed to disconnect", "not available"});
 
         // 失能信任状态
-        std::string trustCommand = "bluetoothctl -- untrust " + device.address;
-        executeCommand(trustCommand);
+        runBluetoothctl("untrust " + device.address.toString(true), {"untrust succeeded", "Failed to set trusted", "not available"});
 
-        // 从自动连接配置文件中移除该设备
-        auto it = autoConnectDevices_.find(device.address);
-        if (it != autoConnectDevices_.end())
+        // 更新设备状态, 并从自动连接配置文件中移除该设备
+        BluetoothDeviceRecord *record = lookupDevice(device.address, false);
+        if (record)
         {
-            autoConnectDevices_.erase(it);
-            saveDeviceConfig();
-            std::cout << "Device " << device.address << " has been removed from auto-connect configuration." << std::endl;
+            bool wasSaved = record->has(kDeviceSaved);
+            MacAddress address = record->address;
+            record->set(kDevicePaired | kDeviceTrusted | kDeviceConnected | kDeviceSaved | kDeviceAutoConnect, false);
+            record->set(kDeviceConnectionKnown, true);
+            if (!record->has(kDeviceDiscovered))
+            {
+                devices_.remove(address);
+            }
+            if (wasSaved)
+            {
+                saveDeviceConfig();
+                std::cout << "Device " << device.address.toString(true) << " has been removed from auto-connect configuration." << std::endl;
+            }
         }
 
-        std::cout << "Device " << device.address << " is now unpaired." << std::endl;
+        std::cout << "Device " << device.address.toString(true) << " is now unpaired." << std::endl;
         return true;
     }
     return false;
@@ -588,153 +565,98 @@ bool BlueInterface::unpairDevice(const BluetoothDevice &device)
 
 std::vector<BluetoothDevice> BlueInterface::getPairedDevices()
 {
-    std::vector<BluetoothDevice> pairedDevices;
 #ifndef _WIN32
-    std::string pairedCommand = "bluetoothctl -- paired-devices";
-    std::string pairedOutput = executeCommand(pairedCommand);
+    refreshPairedDevices();
+    return snapshotDevices(kDevicePaired);
+#else
+    return std::vector<BluetoothDevice>();
+#endif // _WIN32
+}
+
+void BlueInterface::refreshPairedDevices()
+{
+#ifndef _WIN32
+    std::string pairedOutput = runBluetoothctl("paired-devices");
 
+    std::vector<MacAddress> addresses;
+    std::vector<std::string> names;
     std::istringstream iss(pairedOutput);
     std::string line;
     while (std::getline(iss, line))
     {
-        if (line.find("Device") == 0)
+        if (!line.empty() && line.back() == '\r')
         {
-            std::istringstream lineStream(line);
-            std::string token;
-            BluetoothDevice device;
-
-            // 跳过 "Device"
-            lineStream >> token;
-
-            // 获取MAC地址
-            if (lineStream >> token)
-            {
-                device.address = token;
-            }
-
-            // 获取设备名称
-            std::string name;
-            std::getline(lineStream, name);
-            size_t start = name.find_first_not_of(" \t");
-            size_t end = name.find_last_not_of(" \t");
-            if (start != std::string::npos && end != std::string::npos)
-            {
-                device.name = name.substr(start, end - start + 1);
-            }
-            else
-            {
-                device.name = "unknown";
-            }
-
-            device.isPaired = true;
-            device.isConnected = false;
-            device.autoConnect = false;
-            pairedDevices.push_back(device);
+            line.pop_back();
+        }
+        BluetoothDevice device;
+        if (line.find("Device") == 0 && parseDeviceLine(line, device))
+        {
+            addresses.push_back(device.address);
+            names.push_back(device.name);
         }
     }
+    devices_.updatePaired(addresses, names);
 #endif // _WIN32
-    return pairedDevices;
 }
 
 bool BlueInterface::connectToDevice(const BluetoothDevice &device)
 {
 #ifndef _WIN32
+    TraceSpan total("connectToDevice", "total");
+    TraceSpan phase("connectToDevice", "validate");
     if (!validateBluetoothState() || !validateDevice(device))
     {
         return false;
     }
 
-    std::cout << "Connecting to device " << device.address << "..." << std::endl;
+    std::cout << "Connecting to device " << device.address.toString(true) << "..." << std::endl;
 
-    // 检查设备是否已配对
-    bool isPaired = false;
-    for (const auto &dev : scanResults_)
+    // 检查设备是否已配对, 设备表中没有配对信息时刷新一次已配对设备列表
+    phase.next("pairedCheck");
+    BluetoothDeviceRecord *record = lookupDevice(device.address, false);
+    if (!record || !record->has(kDevicePaired))
     {
-        if (dev.address == device.address && dev.isPaired)
-        {
-            isPaired = true;
-            break;
-        }
+        refreshPairedDevices();
+        record = lookupDevice(device.address, false);
     }
+    bool isPaired = record && record->has(kDevicePaired);
 
-    // 如果扫描结果中没有配对信息，检查已配对设备列表
     if (!isPaired)
     {
-        auto pairedDevices = getPairedDevices();
-        for (const auto &pairedDevice : pairedDevices)
-        {
-            if (pairedDevice.address == device.address)
-            {
-                isPaired = true;
-                // 更新扫描结果
-                bool foundInScanResults = false;
-                for (auto &scannedDevice : scanResults_)
-                {
-                    if (scannedDevice.address == device.address)
-                    {
-                        scannedDevice.isPaired = true;
-                        scannedDevice.name = device.name;
-                        foundInScanResults = true;
-                        break;
-                    }
-                }
-                if (!foundInScanResults)
-                {
-                    BluetoothDevice newDevice = device;
-                    newDevice.isPaired = true;
-                    newDevice.isConnected = false;
-                    newDevice.autoConnect = false;
-                    scanResults_.push_back(newDevice);
-                }
-                break;
-            }
-        }
-    }
-
-    if (!isPaired)
-    {
-        std::cout << "Device " << device.address << " is not paired. Please pair first." << std::endl;
+        std::cout << "Device " << device.address.toString(true) << " is not paired. Please pair first." << std::endl;
         return false;
     }
 
     // 使能受信任状态(自动重连功能)
-    std::string trustCommand = "bluetoothctl -- trust " + device.address;
-    std::string trustOutput = executeCommand(trustCommand);
+    phase.next("trust");
+    std::string trustOutput = runBluetoothctl("trust " + device.address.toString(true), {"trust succeeded", "Failed to set trusted", "not available"});
     if (trustOutput.find("Changing") != std::string::npos || trustOutput.find("succeeded") != std::string::npos)
     {
-        std::cout << "Device " << device.address << " is now trusted." << std::endl;
+        std::cout << "Device " << device.address.toString(true) << " is now trusted." << std::endl;
+        record->set(kDeviceTrusted, true);
     }
     else
     {
         std::cout << "Warning: Failed to set trust status. The connection continues..." << std::endl;
     }
 
-    std::string connectCommand = "timeout 10 bluetoothctl -- connect " + device.address;
-    std::string connectOutput = executeCommand(connectCommand);
+    phase.next("connect");
+    std::string connectOutput = runBluetoothctl("connect " + device.address.toString(true), {"Connection successful", "Failed to connect", "not available"}, 10000);
 
     if (connectOutput.find("Connection successful") != std::string::npos)
     {
-        // 更新设备连接状态
-        for (auto &dev : scanResults_)
-        {
-            if (dev.address == device.address)
-            {
-                dev.isConnected = true;
-                dev.autoConnect = true;
-                break;
-            }
-        }
-
-        // 保存自动连接设置
-        autoConnectDevices_[device.address] = true;
+        // 更新设备连接状态并保存自动连接设置
+        record->set(kDeviceConnected | kDeviceConnectionKnown | kDeviceSaved | kDeviceAutoConnect, true);
+        phase.next("saveConfig");
         saveDeviceConfig();
+        phase.next("settle");
         sleep(1); // 等待1秒确保连接完成
-        std::cout << "Connection successful to device " << device.address << std::endl;
+        std::cout << "Connection successful to device " << device.address.toString(true) << std::endl;
         return true;
     }
     else
     {
-        std::cout << "Failed to connect to device " << device.address << std::endl;
+        std::cout << "Failed to connect to device " << device.address.toString(true) << std::endl;
         return false;
     }
 #else
@@ -750,19 +672,16 @@ bool BlueInterface::disconnectDevice(const BluetoothDevice &device)
         return false;
     }
 
-    std::cout << "Disconnecting device " << device.address << "..." << std::endl;
-    std::string disconnectCommand = "bluetoothctl -- disconnect " + device.address;
-    std::string disconnectOutput = executeCommand(disconnectCommand);
+    std::cout << "Disconnecting device " << device.address.toString(true) << "..." << std::endl;
+    std::string disconnectOutput = runBluetoothctl("disconnect " + device.address.toString(true), {"Successful disconnected", "Failed to disconnect", "not available"});
     if (disconnectOutput.find("Successful disconnected") != std::string::npos)
     {
         // 更新设备连接状态
-        for (auto &dev : scanResults_)
+        BluetoothDeviceRecord *record = lookupDevice(device.address, false);
+        if (record)
         {
-            if (dev.address == device.address)
-            {
-                dev.isConnected = false;
-                break;
-            }
+            record->set(kDeviceConnected, false);
+            record->set(kDeviceConnectionKnown, true);
         }
         return true;
     }
@@ -774,51 +693,88 @@ bool BlueInterface::disconnectDevice(const BluetoothDevice &device)
 
 std::vector<BluetoothDevice> BlueInterface::getConnectedDevices()
 {
-    std::vector<BluetoothDevice> connectedDevices;
 #ifndef _WIN32
-    for (const auto &device : scanResults_)
-    {
-        if (device.isConnected)
-        {
-            connectedDevices.push_back(device);
-        }
-    }
+    return snapshotDevices(kDeviceConnected);
+#else
+    return std::vector<BluetoothDevice>();
 #endif
-    return connectedDevices;
 }
 
-bool BlueInterface::isDeviceConnected(const std::string &deviceAddress)
+bool BlueInterface::isDeviceConnected(const MacAddress &deviceAddress)
 {
 #ifndef _WIN32
-    for (const auto &dev : scanResults_)
+    BluetoothDeviceRecord *record = lookupDevice(deviceAddress, false);
+    if (record && record->has(kDeviceConnectionKnown))
     {
-        if (dev.address == deviceAddress)
-        {
-            return dev.isConnected;
-        }
+        return record->has(kDeviceConnected);
     }
 
-    std::string connectedCommand = "bluetoothctl -- info " + deviceAddress + " | grep 'Connected: yes'";
-    std::string connectedOutput = executeCommand(connectedCommand);
-
-    return !connectedOutput.empty();
+    std::string connectedOutput = runBluetoothctl("info " + deviceAddress.toString(true));
+    bool connected = connectedOutput.find("Connected: yes") != std::string::npos;
+    record = lookupDevice(deviceAddress, false);
+    if (record)
+    {
+        record->set(kDeviceConnected, connected);
+        record->set(kDeviceConnectionKnown, true);
+    }
+    return connected;
 #endif
     return false;
 }
 
-bool BlueInterface::setAutoConnect(const std::string &deviceAddress, bool autoConnect)
+int BlueInterface::getDeviceSignalStrength(const MacAddress &deviceAddress)
+{
+#ifndef _WIN32
+    // 旧版本输出 "RSSI: -62", 新版本输出 "RSSI: 0xffffffc2 (-62)"
+    std::string info = runBluetoothctl("info " + deviceAddress.toString(true));
+    size_t position = info.find("RSSI:");
+    if (position == std::string::npos)
+    {
+        return 0;
+    }
+    size_t end = info.find('\n', position);
+    std::string value = info.substr(position + 5, end == std::string::npos ? std::string::npos : end - position - 5);
+    size_t open = value.find('(');
+    if (open != std::string::npos)
+    {
+        value = value.substr(open + 1, value.find(')', open) - open - 1);
+    }
+    int rssi = 0;
+    if (!TextView(value).trim().toInt(rssi))
+    {
+        return 0;
+    }
+    if (metricStore_)
+    {
+        metricStore_->append(MetricStore::seriesName("bt", deviceAddress, "rssi"), MetricStore::nowMs(), rssi);
+    }
+    return rssi;
+#else
+    (void)deviceAddress;
+    return 0;
+#endif // _WIN32
+}
+
+bool BlueInterface::setAutoConnect(const MacAddress &deviceAddress, bool autoConnect)
 {
 #ifndef _WIN32
-    autoConnectDevices_[deviceAddress] = autoConnect;
+    BluetoothDeviceRecord *record = lookupDevice(deviceAddress, true);
+    if (!record)
+    {
+        std::cout << "Invalid device MAC address." << std::endl;
+        return false;
+    }
+    record->set(kDeviceSaved, true);
+    record->set(kDeviceAutoConnect, autoConnect);
     saveDeviceConfig();
 
     if (autoConnect)
     {
-        std::string trustCommand = "bluetoothctl -- trust " + deviceAddress;
-        std::string trustOutput = executeCommand(trustCommand);
+        std::string trustOutput = runBluetoothctl("trust " + deviceAddress.toString(true), {"trust succeeded", "Failed to set trusted", "not available"});
         if (trustOutput.find("Changing") != std::string::npos || trustOutput.find("succeeded") != std::string::npos)
         {
-            std::cout << "Device " << deviceAddress << " is now trusted." << std::endl;
+            std::cout << "Device " << deviceAddress.toString(true) << " is now trusted." << std::endl;
+            record->set(kDeviceTrusted, true);
         }
     }
     return true;
@@ -846,54 +802,25 @@ bool BlueInterface::autoConnectToPairedDevices()
 
     std::cout << "Found " << pairedDevices.size() << " paired devices." << std::endl;
 
-    // 更新扫描结果中的配对状态
-    for (const auto &pairedDevice : pairedDevices)
-    {
-        bool foundInScanResults = false;
-        for (auto &scannedDevice : scanResults_)
-        {
-            if (scannedDevice.address == pairedDevice.address)
-            {
-                scannedDevice.isPaired = true;
-                scannedDevice.name = pairedDevice.name;
-                foundInScanResults = true;
-                break;
-            }
-        }
-
-        // 如果配对设备不在扫描结果中，添加到扫描结果
-        if (!foundInScanResults)
-        {
-            BluetoothDevice newDevice = pairedDevice;
-            newDevice.isPaired = true;
-            newDevice.isConnected = false;
-            newDevice.autoConnect = false;
-            scanResults_.push_back(newDevice);
-        }
-    }
-
     bool connected = false;
     int attemptCount = 0;
     int successCount = 0;
 
+    // 配对状态已合并到设备表, 快照中的autoConnect即为配置文件中的设置
     for (const auto &device : pairedDevices)
     {
-        auto it = autoConnectDevices_.find(device.address);
-        if (it != autoConnectDevices_.end() && it->second)
+        if (device.autoConnect)
         {
             attemptCount++;
             if (!isDeviceConnected(device.address))
             {
-                std::cout << "Try to connect the device automatically: " << device.name << "(" << device.address << ")" << std::endl;
+                std::cout << "Try to connect the device automatically: " << device.name << "(" << device.address.toString(true) << ")" << std::endl;
 
                 if (connectToDevice(device))
                 {
                     std::cout << "Auto Connect Success" << std::endl;
                     connected = true;
                     successCount++;
-
-                    // 更新自动连接状态
-                    autoConnectDevices_[device.address] = true;
                 }
                 else
                 {
@@ -902,7 +829,7 @@ bool BlueInterface::autoConnectToPairedDevices()
             }
             else
             {
-                std::cout << "Device " << device.name << "(" << device.address << ") is already connected." << std::endl;
+                std::cout << "Device " << device.name << "(" << device.address.toString(true) << ") is already connected." << std::endl;
                 connected = true;
                 successCount++;
             }
@@ -928,26 +855,20 @@ bool BlueInterface::autoConnectToPairedDevices()
 #endif // _WIN32
 }
 
-bool BlueInterface::setDeviceName(const std::string &deviceAddress, const std::string &deviceName)
+bool BlueInterface::setDeviceName(const MacAddress &deviceAddress, const std::string &deviceName)
 {
 #ifndef _WIN32
-    std::string setNameCommand = "bluetoothctl -- set-alias \"" + deviceName + "\"";
-    return executeCommandWithResult(setNameCommand);
+    std::string aliasOutput = runBluetoothctl("set-alias \"" + deviceName + "\"", {"succeeded", "Failed", "Missing"});
+    return aliasOutput.find("succeeded") != std::string::npos;
 #else
     return true;
 #endif
 }
 
-std::string BlueInterface::getDeviceName(const std::string &deviceAddress)
+std::string BlueInterface::getDeviceName(const MacAddress &deviceAddress)
 {
-    for (const auto &dev : scanResults_)
-    {
-        if (dev.address == deviceAddress)
-        {
-            return dev.name;
-        }
-    }
-    return "unknown";
+    BluetoothDeviceRecord *record = lookupDevice(deviceAddress, false);
+    return (record && !record->name.empty()) ? record->name : "unknown";
 }
 
 bool BlueInterface::setAdapterName(const std::string &adapterName)
@@ -961,8 +882,7 @@ bool BlueInterface::setAdapterName(const std::string &adapterName)
 
     std::cout << "Setting adapter name to " << adapterName << " ..." << std::endl;
 
-    std::string setNameCommand = "timeout 5 bluetoothctl -- system-alias \"" + adapterName + "\"";
-    std::string result = executeCommand(setNameCommand);
+    std::string result = runBluetoothctl("system-alias \"" + adapterName + "\"", {"succeeded", "Alias set to", "Failed"}, 5000);
 
     if ((result.find("Changing") != std::string::npos &&
          result.find("succeeded") != std::string::npos) ||
@@ -994,8 +914,7 @@ bool BlueInterface::resetAdapterName()
 #ifndef _WIN32
     std::cout << "Resetting Bluetooth adapter name to default..." << std::endl;
 
-    std::string resetCommand = "timeout 5 bluetoothctl -- reset-alias";
-    std::string result = executeCommand(resetCommand);
+    std::string result = runBluetoothctl("reset-alias", {"succeeded", "Alias removed", "Failed"}, 5000);
 
     if (result.find("Alias removed") != std::string::npos ||
         result.find("Changing") != std::string::npos ||
@@ -1021,15 +940,17 @@ bool BlueInterface::resetAdapterName()
 std::string BlueInterface::getAdapterName()
 {
 #ifndef _WIN32
-    std::string showCommand = "timeout 3 bluetoothctl -- show 2>/dev/null | grep 'Alias:' | sed 's/^[[:space:]]*Alias:[[:space:]]*//'";
-    std::string aliasOutput = executeCommand(showCommand);
+    std::string showOutput = runBluetoothctl("show");
+    std::string aliasOutput;
+    size_t aliasPos = showOutput.find("Alias:");
+    if (aliasPos != std::string::npos)
+    {
+        size_t lineEnd = showOutput.find('\n', aliasPos);
+        aliasOutput = showOutput.substr(aliasPos + 6, lineEnd == std::string::npos ? std::string::npos : lineEnd - aliasPos - 6);
+    }
 
     if (!aliasOutput.empty())
     {
-        if (aliasOutput.back() == '\n')
-        {
-            aliasOutput.pop_back();
-        }
 
         size_t start = aliasOutput.find_first_not_of(" \t\r\n");
         size_t end = aliasOutput.find_last_not_of(" \t\r\n");
@@ -1048,57 +969,39 @@ std::string BlueInterface::getAdapterName()
 #endif
 }
 
-bool BlueInterface::getAutoConnectStatus(const std::string &deviceAddress)
+bool BlueInterface::getAutoConnectStatus(const MacAddress &deviceAddress)
 {
-    auto it = autoConnectDevices_.find(deviceAddress);
-    return it != autoConnectDevices_.end() && it->second;
+    BluetoothDeviceRecord *record = lookupDevice(deviceAddress, false);
+    return record && record->has(kDeviceSaved | kDeviceAutoConnect);
 }
 
 std::vector<BluetoothDevice> BlueInterface::getSavedDevices()
 {
     std::vector<BluetoothDevice> savedDevices;
 #ifndef _WIN32
-    // 从自动连接配置中获取已保存的设备
-    for (const auto &pair : autoConnectDevices_)
+    // 有已保存设备不在扫描结果中时才刷新已配对设备列表, 且只刷新一次
+    for (const auto &record : devices_.records())
     {
-        BluetoothDevice device;
-        device.address = pair.first;
-        device.autoConnect = pair.second;
-
-        // 检查设备是否仍然存在（已配对或可扫描到）
-        bool deviceExists = false;
-
-        // 检查扫描结果
-        for (const auto &scannedDevice : scanResults_)
+        if (record.has(kDeviceSaved) && !record.has(kDeviceDiscovered))
         {
-            if (scannedDevice.address == device.address)
-            {
-                device.name = scannedDevice.name;
-                deviceExists = true;
-                break;
-            }
+            refreshPairedDevices();
+            break;
         }
+    }
 
-        // 如果扫描结果中没有，检查已配对设备
-        if (!deviceExists)
+    // 检查设备是否仍然存在（已配对或可扫描到）, 已不存在的设备从配置中移除
+    std::vector<MacAddress> removed;
+    for (auto &record : devices_.records())
+    {
+        if (!record.has(kDeviceSaved))
         {
-            auto pairedDevices = getPairedDevices();
-            for (const auto &pairedDevice : pairedDevices)
-            {
-                if (pairedDevice.address == device.address)
-                {
-                    device.name = pairedDevice.name;
-                    deviceExists = true;
-                    break;
-                }
-            }
+            continue;
         }
-
-        // 如果设备仍然存在，添加到返回列表
-        if (deviceExists)
+        if (record.has(kDeviceDiscovered) || record.has(kDevicePaired))
         {
+            BluetoothDevice device = toDevice(record);
             // 如果仍然没有名称，使用默认名称
-            if (device.name.empty())
+            if (record.name.empty())
             {
                 device.name = "Unknown Device";
             }
@@ -1106,11 +1009,17 @@ std::vector<BluetoothDevice> BlueInterface::getSavedDevices()
         }
         else
         {
-            // 设备已不存在，从配置中移除
-            autoConnectDevices_.erase(pair.first);
-            saveDeviceConfig();
+            removed.push_back(record.address);
         }
     }
+    for (const MacAddress &address : removed)
+    {
+        devices_.remove(address);
+    }
+    if (!removed.empty())
+    {
+        saveDeviceConfig();
+    }
 #endif // _WIN32
     return savedDevices;
-}
\ No newline at end of file
+}
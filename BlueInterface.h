@@ -12,6 +12,12 @@
 #include <thread>
 #include <chrono>
 #include <set>
+#include "ProcessRunner.h"
+#include "BluetoothctlSession.h"
+#include "SysProbe.h"
+#include "BluetoothDeviceRegistry.h"
+#include "PhaseTracer.h"
+#include "MetricStore.h"
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -22,7 +28,7 @@
 struct BluetoothDevice
 {
     std::string name;    // 蓝牙设备名称
-    std::string address; // 蓝牙设备地址
+    MacAddress address;  // 蓝牙设备地址
     bool isPaired;       // 是否已配对
     bool isConnected;    // 是否已连接
     bool autoConnect;    // 是否自动连接
@@ -121,7 +127,21 @@ public:
      * @param deviceAddress 蓝牙设备地址
      * @return 已连接返回true，未连接返回false
      */
-    bool isDeviceConnected(const std::string &deviceAddress);
+    bool isDeviceConnected(const MacAddress &deviceAddress);
+
+    /**
+     * 读取蓝牙设备最近一次的信号强度(bluetoothctl info中的RSSI, 扫描到或已连接时才有),
+     * 设置了指标历史存储时记录到"bt/<mac>/rssi"
+     * @param deviceAddress 蓝牙设备地址
+     * @return 信号强度(dBm), 未知时返回0
+     */
+    int getDeviceSignalStrength(const MacAddress &deviceAddress);
+
+    /**
+     * 设置指标历史存储
+     * @param store 存储, 为nullptr时不再记录; 生命周期须长于BlueInterface
+     */
+    void setMetricStore(MetricStore *store) { metricStore_ = store; }
 
     /**
      * 设置蓝牙设备自动连接
@@ -129,7 +149,7 @@ public:
      * @param autoConnect 是否自动连接
      * @return 成功返回true，失败返回false
      */
-    bool setAutoConnect(const std::string &deviceAddress, bool autoConnect);
+    bool setAutoConnect(const MacAddress &deviceAddress, bool autoConnect);
 
     /**
      * 自动连接已配对的蓝牙设备
@@ -143,14 +163,14 @@ public:
      * @param deviceName 蓝牙设备名称
      * @return 成功返回true，失败返回false
      */
-    bool setDeviceName(const std::string &deviceAddress, const std::string &deviceName);
+    bool setDeviceName(const MacAddress &deviceAddress, const std::string &deviceName);
 
     /**
      * 获取蓝牙设备名称
      * @param deviceAddress 蓝牙设备地址
      * @return 蓝牙设备名称
      */
-    std::string getDeviceName(const std::string &deviceAddress);
+    std::string getDeviceName(const MacAddress &deviceAddress);
 
     /**
      * 设置蓝牙适配器本身的名称（本机蓝牙名称）
@@ -176,7 +196,7 @@ public:
      * @param deviceAddress 蓝牙设备地址
      * @return 是否自动连接
      */
-    bool getAutoConnectStatus(const std::string &deviceAddress);
+    bool getAutoConnectStatus(const MacAddress &deviceAddress);
 
     /**
      * 获取已保存的蓝牙设备列表
@@ -187,20 +207,48 @@ public:
 private:
     bool bluetoothEnabled_;                          // 蓝牙状态
     bool isScanning_;                                // 是否正在扫描
-    std::vector<BluetoothDevice> scanResults_;       // 扫描结果
+    BluetoothDeviceRegistry devices_;                // 设备表(扫描/配对/连接/自动连接状态)
     std::string adapterName_;                        // 蓝牙适配器名称
-    std::map<std::string, bool> autoConnectDevices_; // 自动连接设备映射表
+    ProcessRunner runner_;                           // 命令执行器(不经过shell)
+    BluetoothctlSession bluetoothctl_;               // 常驻bluetoothctl会话
+    SysProbe probe_;                                 // 进程状态探测(读取/proc)
+    MetricStore *metricStore_;                       // 指标历史, 未设置时为nullptr
 
     bool validateBluetoothState();
-    bool validateDeviceAddress(const std::string &deviceAddress);
+    bool validateDeviceAddress(const MacAddress &deviceAddress);
     bool validateDevice(const BluetoothDevice &device);
 
-    std::string executeCommand(const std::string &command);
-    bool executeCommandWithResult(const std::string &command);
+    std::string executeCommand(const std::vector<std::string> &argv, int timeoutMs = -1);
+    bool executeCommandWithResult(const std::vector<std::string> &argv, int timeoutMs = -1, const std::string &input = "");
+    /*
+     * 通过常驻bluetoothctl会话执行命令
+     * @param command bluetoothctl命令
+     * @param markers 完成标记, 为空时以提示符判断命令结束
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 命令输出
+     */
+    std::string runBluetoothctl(const std::string &command,
+                                const std::vector<std::string> &markers = std::vector<std::string>(), int timeoutMs = 3000);
     bool parseScanResults(const std::string &scanOutput);
     bool parseDeviceLine(const std::string &line, BluetoothDevice &device);
     void saveDeviceConfig();
     void loadDeviceConfig();
+    /*
+     * 通过bluetoothctl查询已配对设备并合并到设备表
+     */
+    void refreshPairedDevices();
+    /*
+     * 按地址查找设备记录
+     * @param deviceAddress 设备地址
+     * @param create 不存在时是否新建
+     * @return 设备记录, 地址无效(或不存在且不新建)时返回nullptr
+     */
+    BluetoothDeviceRecord *lookupDevice(const MacAddress &deviceAddress, bool create);
+    /*
+     * 生成带有flag且不带excludeFlag的设备列表
+     */
+    std::vector<BluetoothDevice> snapshotDevices(uint8_t flag, uint8_t excludeFlag = 0) const;
+    static BluetoothDevice toDevice(const BluetoothDeviceRecord &record);
 };
 
 #endif // BLUE_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "BluetoothDeviceRegistry.h"
+
+BluetoothDeviceRegistry::BluetoothDeviceRegistry()
+{
+}
+
+BluetoothDeviceRecord *BluetoothDeviceRegistry::find(const MacAddress &address)
+{
+    auto it = index_.find(address);
+    return it == index_.end() ? nullptr : &records_[it->second];
+}
+
+const BluetoothDeviceRecord *BluetoothDeviceRegistry::find(const MacAddress &address) const
+{
+    auto it = index_.find(address);
+    return it == index_.end() ? nullptr : &records_[it->second];
+}
+
+BluetoothDeviceRecord &BluetoothDeviceRegistry::upsert(const MacAddress &address)
+{
+    auto result = index_.insert(std::make_pair(address, records_.size()));
+    if (result.second)
+    {
+        records_.push_back(BluetoothDeviceRecord());
+        records_.back().address = address;
+    }
+    return records_[result.first->second];
+}
+
+bool BluetoothDeviceRegistry::remove(const MacAddress &address)
+{
+    auto it = index_.find(address);
+    if (it == index_.end())
+    {
+        return false;
+    }
+    size_t position = it->second;
+    index_.erase(it);
+    // 末尾记录移到被删除的位置, 保持数组连续
+    if (position != records_.size() - 1)
+    {
+        records_[position] = std::move(records_.back());
+        index_[records_[position].address] = position;
+    }
+    records_.pop_back();
+    return true;
+}
+
+void BluetoothDeviceRegistry::clearFlag(uint8_t flag)
+{
+    size_t position = 0;
+    while (position < records_.size())
+    {
+        records_[position].set(flag, false);
+        // 连接状态已确认本身不足以保留设备
+        if ((records_[position].flags & ~kDeviceConnectionKnown) == 0)
+        {
+            remove(records_[position].address);
+            continue;
+        }
+        position++;
+    }
+}
+
+void BluetoothDeviceRegistry::updatePaired(const std::vector<MacAddress> &addresses, const std::vector<std::string> &names)
+{
+    for (auto &record : records_)
+    {
+        record.set(kDevicePaired, false);
+    }
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        BluetoothDeviceRecord &record = upsert(addresses[i]);
+        record.set(kDevicePaired, true);
+        if (i < names.size() && !names[i].empty() && names[i] != "unknown")
+        {
+            record.name = names[i];
+        }
+    }
+}
+
+size_t BluetoothDeviceRegistry::count(uint8_t flag) const
+{
+    size_t result = 0;
+    for (const auto &record : records_)
+    {
+        if (record.has(flag))
+        {
+            result++;
+        }
+    }
+    return result;
+}
+
+void BluetoothDeviceRegistry::clear()
+{
+    records_.clear();
+    index_.clear();
+}
@@ -0,0 +1,104 @@
+#ifndef BLUETOOTH_DEVICE_REGISTRY_H
+#define BLUETOOTH_DEVICE_REGISTRY_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <utility>
+#include "MacAddress.h"
+
+// 设备状态标志
+enum BluetoothDeviceFlag
+{
+    kDeviceDiscovered = 0x01,      // 本次扫描中发现
+    kDevicePaired = 0x02,          // 已配对
+    kDeviceTrusted = 0x04,         // 已信任
+    kDeviceConnected = 0x08,       // 已连接
+    kDeviceConnectionKnown = 0x10, // 连接状态已确认(否则需要向bluetoothctl查询)
+    kDeviceSaved = 0x20,           // 保存在自动连接配置文件中
+    kDeviceAutoConnect = 0x40      // 自动连接
+};
+
+struct BluetoothDeviceRecord
+{
+    MacAddress address;
+    std::string name;
+    uint8_t flags; // BluetoothDeviceFlag组合
+
+    BluetoothDeviceRecord() : flags(0) {}
+
+    bool has(uint8_t flag) const { return (flags & flag) == flag; }
+    void set(uint8_t flag, bool enabled)
+    {
+        flags = enabled ? static_cast<uint8_t>(flags | flag) : static_cast<uint8_t>(flags & ~flag);
+    }
+};
+
+/*
+ * 蓝牙设备表
+ * 以48位地址为键合并扫描、配对、信任、连接和自动连接状态, 每个设备一条记录.
+ * 记录连续存放, 哈希索引保存下标, 查找为O(1), 遍历直接访问记录数组
+ */
+class BluetoothDeviceRegistry
+{
+public:
+    BluetoothDeviceRegistry();
+
+    /**
+     * 按地址查找设备
+     * @param address 设备地址
+     * @return 设备记录, 不存在返回nullptr(记录表修改后指针失效)
+     */
+    BluetoothDeviceRecord *find(const MacAddress &address);
+    const BluetoothDeviceRecord *find(const MacAddress &address) const;
+
+    /**
+     * 查找设备, 不存在时新建
+     * @param address 设备地址
+     * @return 设备记录(记录表修改后引用失效)
+     */
+    BluetoothDeviceRecord &upsert(const MacAddress &address);
+
+    /**
+     * 删除设备
+     * @param address 设备地址
+     * @return 设备存在返回true
+     */
+    bool remove(const MacAddress &address);
+
+    /**
+     * 清除所有设备的指定标志, 并删除不再带有任何标志的设备
+     * @param flag BluetoothDeviceFlag组合
+     */
+    void clearFlag(uint8_t flag);
+
+    /**
+     * 用最新的已配对列表更新配对状态: 列表中的设备标记为已配对并更新名称, 其余设备清除配对标志
+     * @param addresses 已配对设备地址
+     * @param names 对应的设备名称
+     */
+    void updatePaired(const std::vector<MacAddress> &addresses, const std::vector<std::string> &names);
+
+    /**
+     * 统计带有指定标志的设备数量
+     * @param flag BluetoothDeviceFlag组合
+     * @return 设备数量
+     */
+    size_t count(uint8_t flag) const;
+
+    /**
+     * 全部设备记录(按加入顺序, 删除时末尾记录会移到被删除的位置)
+     * @return 记录数组
+     */
+    const std::vector<BluetoothDeviceRecord> &records() const { return records_; }
+
+    size_t size() const { return records_.size(); }
+    void clear();
+
+private:
+    std::vector<BluetoothDeviceRecord> records_;
+    std::unordered_map<MacAddress, size_t> index_; // 地址 -> records_下标
+};
+
+#endif // BLUETOOTH_DEVICE_REGISTRY_H
@@ -0,0 +1,424 @@
+#include "BluetoothctlSession.h"
+#include "ProcessRunner.h"
+
+#include <chrono>
+#include <cerrno>
+#include <iostream>
+#ifndef _WIN32
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif // _WIN32
+
+#ifndef _WIN32
+namespace
+{
+const int kStartupWaitMs = 2000; // 启动后等待首个提示符的最长时间
+const int kQuietMs = 150;        // 无完成标记时, 提示符出现后的静默判定时间
+const int kReadSliceMs = 50;     // 单次等待输出的时间片
+
+long long monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+} // namespace
+#endif // _WIN32
+
+BluetoothctlSession::BluetoothctlSession(const std::vector<std::string> &argv)
+    : argv_(argv), pid_(-1), stdinFd_(-1), stdoutFd_(-1), restartCount_(0), started_(false), buffer_(16 * 1024)
+{
+}
+
+BluetoothctlSession::~BluetoothctlSession()
+{
+    stop();
+}
+
+bool BluetoothctlSession::start()
+{
+#ifndef _WIN32
+    if (isRunning())
+    {
+        return true;
+    }
+
+    if (!ProcessRunner::spawnPiped(argv_, pid_, stdinFd_, stdoutFd_))
+    {
+        std::cout << "Failed to start bluetoothctl session." << std::endl;
+        return false;
+    }
+    if (started_)
+    {
+        restartCount_++;
+        std::cout << "bluetoothctl session restarted (" << restartCount_ << ")." << std::endl;
+    }
+    started_ = true;
+    pending_.clear();
+
+    // 等待首个提示符, 确保bluetoothctl已连接到bluetoothd
+    long long deadline = monotonicMs() + kStartupWaitMs;
+    while (monotonicMs() < deadline)
+    {
+        if (!readAvailable(kReadSliceMs))
+        {
+            return false;
+        }
+        if (endsWithPrompt(stripControlSequences(pending_)))
+        {
+            break;
+        }
+    }
+    pending_.clear();
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void BluetoothctlSession::stop()
+{
+#ifndef _WIN32
+    if (pid_ > 0)
+    {
+        writeLine("quit");
+        close(stdinFd_);
+        stdinFd_ = -1;
+        ProcessRunner::terminate(pid_, 500);
+        pid_ = -1;
+    }
+    if (stdinFd_ >= 0)
+    {
+        close(stdinFd_);
+        stdinFd_ = -1;
+    }
+    if (stdoutFd_ >= 0)
+    {
+        close(stdoutFd_);
+        stdoutFd_ = -1;
+    }
+    pending_.clear();
+#endif // _WIN32
+}
+
+bool BluetoothctlSession::isRunning()
+{
+#ifndef _WIN32
+    if (pid_ <= 0)
+    {
+        return false;
+    }
+    int status = 0;
+    if (stdoutFd_ >= 0 && waitpid(pid_, &status, WNOHANG) == 0)
+    {
+        return true;
+    }
+    // 进程已退出或输出管道已关闭, 回收进程并清理残留的管道
+    if (stdinFd_ >= 0)
+    {
+        close(stdinFd_);
+        stdinFd_ = -1;
+    }
+    ProcessRunner::terminate(pid_, 200);
+    pid_ = -1;
+    stop();
+    return false;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool BluetoothctlSession::restart()
+{
+#ifndef _WIN32
+    if (pid_ > 0)
+    {
+        kill(pid_, SIGKILL);
+        ProcessRunner::terminate(pid_, 0);
+        pid_ = -1;
+    }
+    stop();
+    return start();
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool BluetoothctlSession::execute(const std::string &command, std::string &output,
+                                  const std::vector<std::string> &markers, int timeoutMs)
+{
+#ifndef _WIN32
+    output.clear();
+
+    // 会话崩溃时自动重启并重发一次命令
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        if (!start())
+        {
+            return false;
+        }
+
+        // 丢弃上一条命令之后残留的异步输出
+        if (!readAvailable(0))
+        {
+            continue;
+        }
+        pending_.clear();
+
+        if (!writeLine(command))
+        {
+            restart();
+            continue;
+        }
+
+        long long deadline = monotonicMs() + timeoutMs;
+        long long lastDataAt = monotonicMs();
+        bool alive = true;
+        while (monotonicMs() < deadline)
+        {
+            size_t before = pending_.size();
+            alive = readAvailable(kReadSliceMs);
+            long long now = monotonicMs();
+            if (pending_.size() != before)
+            {
+                lastDataAt = now;
+            }
+
+            std::string text = stripControlSequences(pending_);
+            if (!markers.empty())
+            {
+                for (const auto &marker : markers)
+                {
+                    if (text.find(marker) != std::string::npos)
+                    {
+                        output = removePrompts(text);
+                        pending_.clear();
+                        return true;
+                    }
+                }
+            }
+            else if (now - lastDataAt >= kQuietMs && endsWithPrompt(text))
+            {
+                output = removePrompts(text);
+                pending_.clear();
+                return true;
+            }
+
+            if (!alive)
+            {
+                break;
+            }
+        }
+
+        output = removePrompts(stripControlSequences(pending_));
+        pending_.clear();
+        if (alive)
+        {
+            // 正常超时, 不重试
+            return false;
+        }
+        std::cout << "bluetoothctl session exited while running '" << command << "'." << std::endl;
+    }
+    return false;
+#else
+    output.clear();
+    return false;
+#endif // _WIN32
+}
+
+std::string BluetoothctlSession::collect(int durationMs)
+{
+#ifndef _WIN32
+    if (!start())
+    {
+        return "";
+    }
+
+    long long deadline = monotonicMs() + durationMs;
+    while (monotonicMs() < deadline)
+    {
+        long long remaining = deadline - monotonicMs();
+        if (!readAvailable(static_cast<int>(remaining < kReadSliceMs ? remaining : kReadSliceMs)))
+        {
+            break;
+        }
+    }
+    std::string text = removePrompts(stripControlSequences(pending_));
+    pending_.clear();
+    return text;
+#else
+    return "";
+#endif // _WIN32
+}
+
+bool BluetoothctlSession::writeLine(const std::string &line)
+{
+#ifndef _WIN32
+    if (stdinFd_ < 0)
+    {
+        return false;
+    }
+
+    // 屏蔽SIGPIPE, 进程已退出时write返回EPIPE而不是终止本进程
+    sigset_t pipeMask;
+    sigset_t oldMask;
+    sigemptyset(&pipeMask);
+    sigaddset(&pipeMask, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &pipeMask, &oldMask);
+
+    std::string data = line + "\n";
+    size_t offset = 0;
+    bool ok = true;
+    while (offset < data.size())
+    {
+        ssize_t n = write(stdinFd_, data.data() + offset, data.size() - offset);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            ok = false;
+            break;
+        }
+        offset += static_cast<size_t>(n);
+    }
+
+    struct timespec zero = {0, 0};
+    while (sigtimedwait(&pipeMask, nullptr, &zero) > 0)
+    {
+    }
+    pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    return ok;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool BluetoothctlSession::readAvailable(int waitMs)
+{
+#ifndef _WIN32
+    if (stdoutFd_ < 0)
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        struct pollfd pfd;
+        pfd.fd = stdoutFd_;
+        pfd.events = POLLIN;
+        int ready = poll(&pfd, 1, waitMs);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        if (ready == 0)
+        {
+            return true;
+        }
+
+        ssize_t n = read(stdoutFd_, buffer_.data(), buffer_.size());
+        if (n > 0)
+        {
+            pending_.append(buffer_.data(), static_cast<size_t>(n));
+            // 继续读取已到达的数据, 但不再等待
+            waitMs = 0;
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        // EOF: bluetoothctl已退出
+        close(stdoutFd_);
+        stdoutFd_ = -1;
+        return false;
+    }
+#else
+    return false;
+#endif // _WIN32
+}
+
+std::string BluetoothctlSession::stripControlSequences(const std::string &text)
+{
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        char c = text[i];
+        if (c == '\x1b')
+        {
+            // CSI序列: ESC [ 参数 结束字节(0x40-0x7E)
+            if (i + 1 < text.size() && text[i + 1] == '[')
+            {
+                i += 2;
+                while (i < text.size() && (text[i] < 0x40 || text[i] > 0x7E))
+                {
+                    i++;
+                }
+            }
+            else
+            {
+                i++;
+            }
+            continue;
+        }
+        if (c == '\r' || c == '\x01' || c == '\x02')
+        {
+            continue;
+        }
+        result += c;
+    }
+    return result;
+}
+
+std::string BluetoothctlSession::removePrompts(const std::string &text)
+{
+    // 去除行首的提示符, 使输出与 "bluetoothctl -- <cmd>" 一致(如 "Device XX:XX:... 名称")
+    std::string result;
+    result.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t end = text.find('\n', pos);
+        size_t lineEnd = (end == std::string::npos) ? text.size() : end;
+        size_t start = pos;
+        while (start < lineEnd && text[start] == '[')
+        {
+            // 只有第一个 ']' 紧跟 "# " 时才是提示符, 避免误删 "[NEW] Device ..." 等事件行
+            size_t promptEnd = text.find(']', start);
+            if (promptEnd == std::string::npos || promptEnd + 2 >= lineEnd ||
+                text.compare(promptEnd, 3, "]# ") != 0)
+            {
+                break;
+            }
+            start = promptEnd + 3;
+        }
+        if (start < lineEnd)
+        {
+            result.append(text, start, lineEnd - start);
+            result += '\n';
+        }
+        pos = lineEnd + 1;
+    }
+    return result;
+}
+
+bool BluetoothctlSession::endsWithPrompt(const std::string &text)
+{
+    // 提示符形如 "[bluetooth]# " 或 "[设备名]# "
+    size_t end = text.find_last_not_of(" \t\n");
+    if (end == std::string::npos || text[end] != '#' || end == 0 || text[end - 1] != ']')
+    {
+        return false;
+    }
+    size_t lineStart = text.rfind('\n', end);
+    lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+    return text[lineStart] == '[';
+}
@@ -0,0 +1,97 @@
+#ifndef BLUETOOTHCTL_SESSION_H
+#define BLUETOOTHCTL_SESSION_H
+
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif // _WIN32
+
+/*
+ * 常驻bluetoothctl会话
+ * 启动一个长期运行的bluetoothctl进程, 命令写入其标准输入,
+ * 通过完成标记或提示符从标准输出中分离每条命令的响应.
+ * 进程异常退出时在下一条命令前自动重启.
+ */
+class BluetoothctlSession
+{
+public:
+    /**
+     * @param argv 启动会话的程序及参数, 测试时可替换为脚本化的假bluetoothctl
+     */
+    explicit BluetoothctlSession(const std::vector<std::string> &argv = std::vector<std::string>(1, "bluetoothctl"));
+    ~BluetoothctlSession();
+
+    /**
+     * 启动会话(已运行时直接返回true)
+     * @return 成功返回true，失败返回false
+     */
+    bool start();
+
+    /**
+     * 结束会话
+     */
+    void stop();
+
+    /**
+     * 判断会话进程是否仍在运行
+     * @return 运行中返回true
+     */
+    bool isRunning();
+
+    /**
+     * 执行一条命令并等待其完成
+     * 指定了完成标记时, 输出中出现任一标记即完成;
+     * 否则在提示符出现且输出静默一段时间后完成
+     * @param command bluetoothctl命令(不含换行)
+     * @param output 命令执行期间的输出(已去除终端控制字符)
+     * @param markers 完成标记列表
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 匹配到完成标记或提示符返回true, 超时或会话不可用返回false
+     */
+    bool execute(const std::string &command, std::string &output,
+                 const std::vector<std::string> &markers = std::vector<std::string>(), int timeoutMs = 3000);
+
+    /**
+     * 收集会话在一段时间内的全部输出(用于扫描期间的异步事件)
+     * @param durationMs 收集时长(毫秒)
+     * @return 收集到的输出
+     */
+    std::string collect(int durationMs);
+
+    /**
+     * 获取会话自动重启的次数
+     * @return 重启次数
+     */
+    int getRestartCount() const { return restartCount_; }
+
+private:
+    std::vector<std::string> argv_;
+    pid_t pid_;
+    int stdinFd_;
+    int stdoutFd_;
+    int restartCount_;
+    bool started_;             // 是否曾成功启动, 用于区分首次启动和重启
+    std::string pending_;      // 已读取但尚未归属到任何命令的输出
+    std::vector<char> buffer_; // 复用的读缓冲区
+
+    bool restart();
+    bool writeLine(const std::string &line);
+    /*
+     * 读取当前可用的输出并追加到pending_
+     * @param waitMs 最长等待时间(毫秒)
+     * @return 读取到数据或超时返回true, 会话已退出返回false
+     */
+    bool readAvailable(int waitMs);
+    static std::string stripControlSequences(const std::string &text);
+    static std::string removePrompts(const std::string &text);
+    static bool endsWithPrompt(const std::string &text);
+
+    BluetoothctlSession(const BluetoothctlSession &);
+    BluetoothctlSession &operator=(const BluetoothctlSession &);
+};
+
+#endif // BLUETOOTHCTL_SESSION_H
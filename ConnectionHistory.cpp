@@ -0,0 +1,348 @@
+#include "ConnectionHistory.h"
+#include "TextView.h"
+
+#include <algorithm>
+
+namespace
+{
+// 弱信号时成功率按比例降低: 低于kWeakRssi每20dB减半, 不低于kMinRssiScale
+const int kWeakRssi = -75;
+const double kMinRssiScale = 0.25;
+// 退避时间内成功率的折扣
+const double kBackoffSuccessScale = 0.2;
+// 失败耗时的平滑系数(新样本权重)
+const double kFailureCostWeight = 0.3;
+// format()的字段数(不含ssid)
+const size_t kFieldCount = 10;
+
+int backoffSeconds(int consecutiveFailures)
+{
+    int seconds = ConnectionHistory::kBackoffBaseSeconds;
+    for (int i = 1; i < consecutiveFailures && seconds < ConnectionHistory::kBackoffMaxSeconds; i++)
+    {
+        seconds *= 2;
+    }
+    return std::min(seconds, ConnectionHistory::kBackoffMaxSeconds);
+}
+
+bool recordInBackoff(const ConnectionRecord &record, time_t now)
+{
+    return record.consecutiveFailures > 0 && now - record.lastFailureAt < backoffSeconds(record.consecutiveFailures);
+}
+
+/*
+ * 合并后的统计量
+ */
+struct HistoryStats
+{
+    int attempts;
+    int successes;
+    std::vector<int> connectTimesMs;
+    long failureCostTotal;
+    int failureCostCount;
+
+    HistoryStats() : attempts(0), successes(0), failureCostTotal(0), failureCostCount(0) {}
+
+    void add(const ConnectionRecord &record)
+    {
+        attempts += record.attempts;
+        successes += record.successes;
+        connectTimesMs.insert(connectTimesMs.end(), record.connectTimesMs.begin(), record.connectTimesMs.end());
+        if (record.failureCostMs > 0)
+        {
+            failureCostTotal += record.failureCostMs;
+            failureCostCount++;
+        }
+    }
+};
+
+int median(std::vector<int> values)
+{
+    if (values.empty())
+    {
+        return -1;
+    }
+    size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    if (values.size() % 2 == 1)
+    {
+        return values[middle];
+    }
+    int upper = values[middle];
+    return (*std::max_element(values.begin(), values.begin() + middle) + upper) / 2;
+}
+
+/*
+ * 逗号分隔的整数
+ */
+void parseIntList(TextView text, std::vector<int> &values, size_t maxCount)
+{
+    while (!text.empty() && values.size() < maxCount)
+    {
+        TextView item;
+        TextView rest;
+        if (!text.split(',', item, rest))
+        {
+            item = text.trim();
+            rest = TextView();
+        }
+        int value = 0;
+        if (item.toInt(value))
+        {
+            values.push_back(value);
+        }
+        text = rest;
+    }
+}
+} // namespace
+
+const size_t ConnectionRecord::kFailureKinds;
+const size_t ConnectionHistory::kMaxSamples;
+const size_t ConnectionHistory::kMaxRecords;
+
+int ConnectionRecord::medianConnectMs() const
+{
+    return median(connectTimesMs);
+}
+
+ConnectionRecord &ConnectionHistory::touch(const std::string &ssid, const MacAddress &bssid, int rssi, time_t now)
+{
+    auto it = std::find_if(records_.begin(), records_.end(),
+                           [&](const ConnectionRecord &record)
+                           {
+                               return record.ssid == ssid && record.bssid == bssid;
+                           });
+    if (it == records_.end())
+    {
+        if (records_.size() >= kMaxRecords)
+        {
+            auto oldest = std::min_element(records_.begin(), records_.end(),
+                                           [](const ConnectionRecord &a, const ConnectionRecord &b)
+                                           {
+                                               return a.lastAttemptAt < b.lastAttemptAt;
+                                           });
+            records_.erase(oldest);
+        }
+        ConnectionRecord record;
+        record.ssid = ssid;
+        record.bssid = bssid;
+        records_.push_back(record);
+        it = records_.end() - 1;
+    }
+    it->attempts++;
+    it->lastAttemptAt = now;
+    if (rssi != 0)
+    {
+        it->lastRssi = rssi;
+    }
+    return *it;
+}
+
+void ConnectionHistory::recordSuccess(const std::string &ssid, const MacAddress &bssid, int connectMs, int rssi,
+                                      time_t now)
+{
+    ConnectionRecord &record = touch(ssid, bssid, rssi, now);
+    record.successes++;
+    record.consecutiveFailures = 0;
+    record.connectTimesMs.push_back(std::max(connectMs, 0));
+    if (record.connectTimesMs.size() > kMaxSamples)
+    {
+        record.connectTimesMs.erase(record.connectTimesMs.begin());
+    }
+}
+
+void ConnectionHistory::recordFailure(const std::string &ssid, const MacAddress &bssid, ConnectFailure failure,
+                                      int elapsedMs, int rssi, time_t now)
+{
+    ConnectionRecord &record = touch(ssid, bssid, rssi, now);
+    if (failure != ConnectFailure::NONE)
+    {
+        record.failures[static_cast<int>(failure) - 1]++;
+    }
+    record.lastFailureAt = now;
+    record.consecutiveFailures++;
+    elapsedMs = std::max(elapsedMs, 0);
+    record.failureCostMs = record.failureCostMs <= 0
+                               ? elapsedMs
+                               : static_cast<int>(record.failureCostMs * (1 - kFailureCostWeight) +
+                                                  elapsedMs * kFailureCostWeight);
+}
+
+const ConnectionRecord *ConnectionHistory::find(const std::string &ssid, const MacAddress &bssid) const
+{
+    for (const auto &record : records_)
+    {
+        if (record.ssid == ssid && record.bssid == bssid)
+        {
+            return &record;
+        }
+    }
+    return nullptr;
+}
+
+bool ConnectionHistory::inBackoff(const std::string &ssid, const MacAddress &bssid, time_t now) const
+{
+    if (!bssid.isZero())
+    {
+        const ConnectionRecord *record = find(ssid, bssid);
+        if (record != nullptr)
+        {
+            return recordInBackoff(*record, now);
+        }
+    }
+    // 没有该AP的记录时参考AP未知(零地址)的失败记录; 要查询的AP未知时参考该SSID的全部记录
+    for (const auto &record : records_)
+    {
+        if (record.ssid == ssid && (bssid.isZero() || record.bssid.isZero()) && recordInBackoff(record, now))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+double ConnectionHistory::expectedConnectMs(const std::string &ssid, const MacAddress &bssid, int rssi,
+                                            time_t now) const
+{
+    HistoryStats stats;
+    const ConnectionRecord *record = find(ssid, bssid);
+    if (record != nullptr && record->attempts > 0)
+    {
+        stats.add(*record);
+    }
+    else
+    {
+        // 同一网络的其他AP(漫游网络或BSSID未知时)
+        for (const auto &entry : records_)
+        {
+            if (entry.ssid == ssid)
+            {
+                stats.add(entry);
+            }
+        }
+    }
+
+    double successRate = (stats.successes + 1.0) / (stats.attempts + 2.0);
+    int connectMs = median(stats.connectTimesMs);
+    double successCost = connectMs >= 0 ? connectMs : kDefaultConnectMs;
+    double failureCost = stats.failureCostCount > 0 ? static_cast<double>(stats.failureCostTotal) / stats.failureCostCount
+                                                    : kDefaultFailureMs;
+
+    if (rssi != 0 && rssi < kWeakRssi)
+    {
+        successRate *= std::max(kMinRssiScale, 1.0 - (kWeakRssi - rssi) / 40.0);
+    }
+    if (inBackoff(ssid, bssid, now))
+    {
+        successRate *= kBackoffSuccessScale;
+    }
+    return (successRate * successCost + (1 - successRate) * failureCost) / successRate;
+}
+
+void ConnectionHistory::rank(std::vector<NetworkInfo> &candidates, time_t now) const
+{
+    std::vector<std::pair<double, NetworkInfo>> scored;
+    scored.reserve(candidates.size());
+    for (const auto &candidate : candidates)
+    {
+        scored.push_back(std::make_pair(
+            expectedConnectMs(candidate.ssid, candidate.bssid, candidate.signalStrength, now), candidate));
+    }
+    std::stable_sort(scored.begin(), scored.end(),
+                     [](const std::pair<double, NetworkInfo> &a, const std::pair<double, NetworkInfo> &b)
+                     {
+                         return a.first < b.first;
+                     });
+    for (size_t i = 0; i < scored.size(); i++)
+    {
+        candidates[i] = scored[i].second;
+    }
+}
+
+void ConnectionHistory::erase(const std::string &ssid)
+{
+    records_.erase(std::remove_if(records_.begin(), records_.end(),
+                                  [&ssid](const ConnectionRecord &record)
+                                  {
+                                      return record.ssid == ssid;
+                                  }),
+                   records_.end());
+}
+
+void ConnectionHistory::set(const ConnectionRecord &record)
+{
+    for (auto &entry : records_)
+    {
+        if (entry.ssid == record.ssid && entry.bssid == record.bssid)
+        {
+            entry = record;
+            return;
+        }
+    }
+    if (records_.size() < kMaxRecords)
+    {
+        records_.push_back(record);
+    }
+}
+
+std::string ConnectionHistory::format(const ConnectionRecord &record)
+{
+    std::string text = record.ssid + "|" + record.bssid.toString() + "|" + std::to_string(record.attempts) + "|" +
+                       std::to_string(record.successes) + "|";
+    for (size_t i = 0; i < ConnectionRecord::kFailureKinds; i++)
+    {
+        text += (i == 0 ? "" : ",") + std::to_string(record.failures[i]);
+    }
+    text += "|";
+    for (size_t i = 0; i < record.connectTimesMs.size(); i++)
+    {
+        text += (i == 0 ? "" : ",") + std::to_string(record.connectTimesMs[i]);
+    }
+    text += "|" + std::to_string(record.failureCostMs) + "|" + std::to_string(record.lastRssi) + "|" +
+            std::to_string(static_cast<long long>(record.lastAttemptAt)) + "|" +
+            std::to_string(static_cast<long long>(record.lastFailureAt)) + "|" +
+            std::to_string(record.consecutiveFailures);
+    return text;
+}
+
+bool ConnectionHistory::parse(const std::string &text, ConnectionRecord &record)
+{
+    // SSID可能包含'|', 从行尾取固定数量的字段
+    std::vector<TextView> fields;
+    size_t end = text.size();
+    while (fields.size() < kFieldCount)
+    {
+        size_t separator = text.rfind('|', end == 0 ? 0 : end - 1);
+        if (separator == std::string::npos || end == 0)
+        {
+            return false;
+        }
+        fields.push_back(TextView(text.data() + separator + 1, end - separator - 1).trim());
+        end = separator;
+    }
+    std::reverse(fields.begin(), fields.end());
+
+    ConnectionRecord parsed;
+    parsed.ssid = text.substr(0, end);
+    uint64_t lastAttemptAt = 0;
+    uint64_t lastFailureAt = 0;
+    std::vector<int> failures;
+    if (parsed.ssid.empty() || !MacAddress::parse(fields[0].data(), fields[0].size(), parsed.bssid) ||
+        !fields[1].toInt(parsed.attempts) || !fields[2].toInt(parsed.successes) ||
+        !fields[5].toInt(parsed.failureCostMs) || !fields[6].toInt(parsed.lastRssi) ||
+        !fields[7].toUInt64(lastAttemptAt) || !fields[8].toUInt64(lastFailureAt) ||
+        !fields[9].toInt(parsed.consecutiveFailures))
+    {
+        return false;
+    }
+    parseIntList(fields[3], failures, ConnectionRecord::kFailureKinds);
+    for (size_t i = 0; i < failures.size(); i++)
+    {
+        parsed.failures[i] = failures[i];
+    }
+    parseIntList(fields[4], parsed.connectTimesMs, kMaxSamples);
+    parsed.lastAttemptAt = static_cast<time_t>(lastAttemptAt);
+    parsed.lastFailureAt = static_cast<time_t>(lastFailureAt);
+    record = parsed;
+    return true;
+}
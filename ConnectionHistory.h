@@ -0,0 +1,142 @@
+#ifndef CONNECTION_HISTORY_H
+#define CONNECTION_HISTORY_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include "WifiTypes.h"
+
+// 连接失败所在的阶段
+enum class ConnectFailure
+{
+    NONE,
+    AUTHENTICATION, // wpa_supplicant报告认证失败
+    LINK,           // 超时或链路未建立
+    DHCP            // 关联成功但未获得地址
+};
+
+// 一个SSID/BSSID组合的连接记录
+struct ConnectionRecord
+{
+    static const size_t kFailureKinds = 3; // AUTHENTICATION, LINK, DHCP
+
+    std::string ssid;
+    MacAddress bssid;
+    int attempts;
+    int successes;
+    int failures[kFailureKinds];     // 按失败阶段计数
+    std::vector<int> connectTimesMs; // 最近几次成功的连接耗时, 新的在后
+    int failureCostMs;               // 失败尝试的平均耗时(指数平滑)
+    int lastRssi;                    // 最近一次尝试时的信号强度(dBm), 0表示未知
+    time_t lastAttemptAt;
+    time_t lastFailureAt;
+    int consecutiveFailures;
+
+    ConnectionRecord()
+        : attempts(0), successes(0), failures(), failureCostMs(0), lastRssi(0), lastAttemptAt(0),
+          lastFailureAt(0), consecutiveFailures(0) {}
+
+    /**
+     * 最近几次成功连接耗时的中位数
+     * @return 毫秒, 没有成功记录返回-1
+     */
+    int medianConnectMs() const;
+};
+
+/*
+ * 各SSID/BSSID的连接历史, 用于自动连接时排序候选网络
+ * 按预期连接耗时从小到大尝试: 成功率p(拉普拉斯平滑), 成功耗时ts(中位数), 失败耗时tf,
+ * 代价 (p*ts + (1-p)*tf) / p 即反复尝试该网络直到成功的期望耗时;
+ * 刚失败过的BSSID在退避时间内(随连续失败次数加倍)降低成功率, 排到后面但仍会尝试
+ */
+class ConnectionHistory
+{
+public:
+    static const size_t kMaxSamples = 8;          // 每条记录保留的成功耗时样本数
+    static const size_t kMaxRecords = 64;         // 超出时淘汰最久未尝试的记录
+    static const int kDefaultConnectMs = 6000;    // 没有成功记录时假设的连接耗时
+    static const int kDefaultFailureMs = 10000;   // 没有失败记录时假设的失败耗时(认证等待超时)
+    static const int kBackoffBaseSeconds = 30;    // 第一次失败后的退避时间
+    static const int kBackoffMaxSeconds = 1800;   // 退避时间上限
+
+    /**
+     * 记录一次成功连接
+     * @param ssid 网络名称
+     * @param bssid 关联的AP
+     * @param connectMs 连接耗时(毫秒)
+     * @param rssi 信号强度(dBm), 0表示未知
+     * @param now 当前系统时间
+     */
+    void recordSuccess(const std::string &ssid, const MacAddress &bssid, int connectMs, int rssi, time_t now);
+
+    /**
+     * 记录一次失败
+     * @param ssid 网络名称
+     * @param bssid 尝试的AP(可以为零地址)
+     * @param failure 失败阶段
+     * @param elapsedMs 失败前花费的时间(毫秒)
+     * @param rssi 信号强度(dBm), 0表示未知
+     * @param now 当前系统时间
+     */
+    void recordFailure(const std::string &ssid, const MacAddress &bssid, ConnectFailure failure, int elapsedMs,
+                       int rssi, time_t now);
+
+    /**
+     * 查找记录
+     * @return 记录, 不存在返回nullptr
+     */
+    const ConnectionRecord *find(const std::string &ssid, const MacAddress &bssid) const;
+
+    /**
+     * 预期连接耗时: 有该BSSID的记录时使用它, 否则合并该SSID的全部记录, 都没有时使用默认值
+     * @param ssid 网络名称
+     * @param bssid 扫描到的AP
+     * @param rssi 当前信号强度(dBm), 0表示未知
+     * @param now 当前系统时间
+     * @return 期望耗时(毫秒)
+     */
+    double expectedConnectMs(const std::string &ssid, const MacAddress &bssid, int rssi, time_t now) const;
+
+    /**
+     * 是否处于失败后的退避时间内.
+     * 没有该BSSID的记录时参考该SSID下AP未知(零地址)的失败记录, bssid为零地址时参考该SSID的全部记录
+     */
+    bool inBackoff(const std::string &ssid, const MacAddress &bssid, time_t now) const;
+
+    /**
+     * 按预期连接耗时排序候选网络(稳定排序, 代价相同时保持原顺序)
+     * @param candidates 候选网络(使用ssid/bssid/signalStrength)
+     * @param now 当前系统时间
+     */
+    void rank(std::vector<NetworkInfo> &candidates, time_t now) const;
+
+    /**
+     * 删除某个SSID的全部记录
+     */
+    void erase(const std::string &ssid);
+
+    const std::vector<ConnectionRecord> &records() const { return records_; }
+    size_t size() const { return records_.size(); }
+
+    /**
+     * 记录的单行文本形式:
+     * ssid|bssid|attempts|successes|auth,link,dhcp|ms,ms,...|failureCostMs|rssi|lastAttemptAt|lastFailureAt|consecutiveFailures
+     */
+    static std::string format(const ConnectionRecord &record);
+    static bool parse(const std::string &text, ConnectionRecord &record);
+
+    /**
+     * 加入一条解析得到的记录(已存在时替换)
+     */
+    void set(const ConnectionRecord &record);
+
+private:
+    std::vector<ConnectionRecord> records_;
+
+    /*
+     * 查找或创建记录(记录数超出上限时淘汰最久未尝试的)
+     */
+    ConnectionRecord &touch(const std::string &ssid, const MacAddress &bssid, int rssi, time_t now);
+};
+
+#endif // CONNECTION_HISTORY_H
@@ -0,0 +1,830 @@
+#include "DhcpClient.h"
+#include "RtNetlink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace
+{
+const uint16_t kClientPort = 68;
+const uint16_t kServerPort = 67;
+const size_t kReceiveBufferSize = 1500;
+const size_t kIpHeaderLength = 20;
+const size_t kUdpHeaderLength = 8;
+// BOOTP固定部分及最小报文长度
+const size_t kHeaderLength = 236;
+const size_t kMinMessageLength = 300;
+const uint32_t kMagicCookie = 0x63825363;
+
+const size_t kOffsetFlags = 10;
+const size_t kOffsetClientAddress = 12;
+const size_t kOffsetYourAddress = 16;
+const size_t kOffsetHardwareAddress = 28;
+
+enum DhcpOption
+{
+    kOptionPad = 0,
+    kOptionSubnetMask = 1,
+    kOptionRouter = 3,
+    kOptionDns = 6,
+    kOptionRequestedAddress = 50,
+    kOptionLeaseTime = 51,
+    kOptionMessageType = 53,
+    kOptionServerId = 54,
+    kOptionParameterList = 55,
+    kOptionClientId = 61,
+    kOptionEnd = 255
+};
+
+const uint8_t kMessageRequest = 3;
+const uint8_t kMessageAck = 5;
+const uint8_t kMessageNak = 6;
+
+// udhcpc事件脚本写入租约文件的目录
+const char kUdhcpcLeaseDirectory[] = "/tmp";
+// 续约失败后的重试间隔
+const int kRenewRetrySeconds = 60;
+// 每次续约请求等待响应的时间
+const int kRenewTimeoutMs = 2000;
+// 两次成功续约之间的最短间隔, 避免租期极短时连续发送请求
+const time_t kMinRenewIntervalSeconds = 10;
+
+/*
+ * 下一次续约时间(T1), 不早于获得租约后kMinRenewIntervalSeconds
+ */
+time_t renewTime(const DhcpLease &lease)
+{
+    return lease.obtainedAt + std::max(static_cast<time_t>(lease.leaseSeconds / 2), kMinRenewIntervalSeconds);
+}
+
+long long monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+#ifndef _WIN32
+std::string formatIPv4(const uint8_t *data)
+{
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, data, text, sizeof(text));
+    return text;
+}
+
+void appendOption(std::vector<uint8_t> &message, uint8_t code, const void *data, size_t length)
+{
+    message.push_back(code);
+    message.push_back(static_cast<uint8_t>(length));
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    message.insert(message.end(), bytes, bytes + length);
+}
+
+void storeBigEndian32(uint8_t *p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+void storeBigEndian16(uint8_t *p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+uint16_t ipChecksum(const uint8_t *data, size_t length)
+{
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < length; i += 2)
+    {
+        sum += static_cast<uint32_t>(data[i] << 8 | data[i + 1]);
+    }
+    while (sum >> 16)
+    {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return static_cast<uint16_t>(~sum);
+}
+
+/*
+ * 从链路层收到的IPv4报文中取出发往客户端端口的UDP负载
+ */
+bool extractClientPayload(const uint8_t *&data, size_t &length)
+{
+    if (length < kIpHeaderLength || (data[0] >> 4) != 4 || data[9] != IPPROTO_UDP)
+    {
+        return false;
+    }
+    size_t headerLength = static_cast<size_t>(data[0] & 0x0f) * 4;
+    size_t totalLength = static_cast<size_t>(data[2]) << 8 | data[3];
+    if (headerLength < kIpHeaderLength || totalLength > length || totalLength < headerLength + kUdpHeaderLength)
+    {
+        return false;
+    }
+    const uint8_t *udp = data + headerLength;
+    if ((static_cast<uint16_t>(udp[2]) << 8 | udp[3]) != kClientPort)
+    {
+        return false;
+    }
+    data = udp + kUdpHeaderLength;
+    length = totalLength - headerLength - kUdpHeaderLength;
+    return true;
+}
+
+uint32_t loadBigEndian32(const uint8_t *p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+#endif // _WIN32
+
+/*
+ * 依次取出以separator分隔的字段
+ */
+std::vector<std::string> splitFields(const std::string &text, char separator)
+{
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true)
+    {
+        size_t end = text.find(separator, start);
+        fields.push_back(text.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos)
+        {
+            break;
+        }
+        start = end + 1;
+    }
+    return fields;
+}
+} // namespace
+
+uint32_t DhcpLease::remainingSeconds(time_t now) const
+{
+    if (address.empty() || leaseSeconds == 0 || now < obtainedAt)
+    {
+        return 0;
+    }
+    time_t expiresAt = obtainedAt + static_cast<time_t>(leaseSeconds);
+    return now >= expiresAt ? 0 : static_cast<uint32_t>(expiresAt - now);
+}
+
+DhcpClient::DhcpClient() : fd_(-1), packetFd_(-1), ifindex_(0), xid_(0), buffer_(kReceiveBufferSize)
+{
+}
+
+DhcpClient::~DhcpClient()
+{
+    close();
+}
+
+bool DhcpClient::open(const std::string &interfaceName)
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        return true;
+    }
+    fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+    {
+        return false;
+    }
+    // 通过套接字查询接口索引和MAC地址, 与套接字处于同一网络命名空间
+    struct ifreq request;
+    memset(&request, 0, sizeof(request));
+    strncpy(request.ifr_name, interfaceName.c_str(), IFNAMSIZ - 1);
+    if (ioctl(fd_, SIOCGIFINDEX, &request) < 0)
+    {
+        close();
+        return false;
+    }
+    ifindex_ = request.ifr_ifindex;
+    if (ioctl(fd_, SIOCGIFHWADDR, &request) < 0)
+    {
+        close();
+        return false;
+    }
+    hardwareAddress_ = MacAddress::fromBytes(reinterpret_cast<const uint8_t *>(request.ifr_hwaddr.sa_data));
+
+    int enable = 1;
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(kClientPort);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0 ||
+        setsockopt(fd_, SOL_SOCKET, SO_BINDTODEVICE, interfaceName.c_str(), interfaceName.size() + 1) < 0 ||
+        bind(fd_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0)
+    {
+        close();
+        return false;
+    }
+
+    // 没有地址时只能在链路层收发: UDP套接字会借用其他接口的源地址, 也收不到发往该接口的广播响应
+    packetFd_ = socket(AF_PACKET, SOCK_DGRAM | SOCK_CLOEXEC, htons(ETH_P_IP));
+    struct sockaddr_ll link;
+    memset(&link, 0, sizeof(link));
+    link.sll_family = AF_PACKET;
+    link.sll_protocol = htons(ETH_P_IP);
+    link.sll_ifindex = ifindex_;
+    if (packetFd_ < 0 || bind(packetFd_, reinterpret_cast<struct sockaddr *>(&link), sizeof(link)) < 0)
+    {
+        close();
+        return false;
+    }
+    // 事务ID只需在网络内不易重复
+    xid_ = static_cast<uint32_t>(monotonicMs()) ^ (static_cast<uint32_t>(getpid()) << 16) ^ hardwareAddress_.octet(5);
+    return true;
+#else
+    (void)interfaceName;
+    return false;
+#endif // _WIN32
+}
+
+void DhcpClient::close()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (packetFd_ >= 0)
+    {
+        ::close(packetFd_);
+        packetFd_ = -1;
+    }
+#endif // _WIN32
+}
+
+bool DhcpClient::sendBroadcast(const std::vector<uint8_t> &message)
+{
+#ifndef _WIN32
+    if (packetFd_ < 0 || message.empty())
+    {
+        return false;
+    }
+    // IPv4(源地址0.0.0.0, 目的255.255.255.255) + UDP(68 -> 67, 不计算校验和)
+    std::vector<uint8_t> packet(kIpHeaderLength + kUdpHeaderLength + message.size(), 0);
+    uint8_t *ip = packet.data();
+    ip[0] = 0x45;
+    storeBigEndian16(ip + 2, static_cast<uint16_t>(packet.size()));
+    ip[8] = 64;
+    ip[9] = IPPROTO_UDP;
+    memset(ip + 16, 0xff, 4);
+    storeBigEndian16(ip + 10, ipChecksum(ip, kIpHeaderLength));
+    uint8_t *udp = ip + kIpHeaderLength;
+    storeBigEndian16(udp, kClientPort);
+    storeBigEndian16(udp + 2, kServerPort);
+    storeBigEndian16(udp + 4, static_cast<uint16_t>(kUdpHeaderLength + message.size()));
+    memcpy(udp + kUdpHeaderLength, message.data(), message.size());
+
+    struct sockaddr_ll link;
+    memset(&link, 0, sizeof(link));
+    link.sll_family = AF_PACKET;
+    link.sll_protocol = htons(ETH_P_IP);
+    link.sll_ifindex = ifindex_;
+    link.sll_halen = 6;
+    memset(link.sll_addr, 0xff, 6);
+    return sendto(packetFd_, packet.data(), packet.size(), 0, reinterpret_cast<struct sockaddr *>(&link),
+                  sizeof(link)) == static_cast<ssize_t>(packet.size());
+#else
+    (void)message;
+    return false;
+#endif // _WIN32
+}
+
+bool DhcpClient::sendUnicast(const std::vector<uint8_t> &message, const std::string &destination)
+{
+#ifndef _WIN32
+    if (fd_ < 0 || message.empty())
+    {
+        return false;
+    }
+    struct sockaddr_in remote;
+    memset(&remote, 0, sizeof(remote));
+    remote.sin_family = AF_INET;
+    remote.sin_port = htons(kServerPort);
+    if (inet_pton(AF_INET, destination.c_str(), &remote.sin_addr) != 1)
+    {
+        return false;
+    }
+    return sendto(fd_, message.data(), message.size(), 0, reinterpret_cast<struct sockaddr *>(&remote),
+                  sizeof(remote)) == static_cast<ssize_t>(message.size());
+#else
+    (void)message;
+    (void)destination;
+    return false;
+#endif // _WIN32
+}
+
+bool DhcpClient::sendReboot(const DhcpLease &lease)
+{
+    // INIT-REBOOT: ciaddr为0, 不带服务器标识, 广播发送
+    return sendBroadcast(buildRequest(++xid_, hardwareAddress_, lease.address, ""));
+}
+
+bool DhcpClient::sendRenew(const DhcpLease &lease)
+{
+    if (lease.server.empty())
+    {
+        return false;
+    }
+    return sendUnicast(buildRequest(++xid_, hardwareAddress_, "", lease.address), lease.server);
+}
+
+DhcpClient::Result DhcpClient::waitReply(int timeoutMs, DhcpLease &lease)
+{
+#ifndef _WIN32
+    if (fd_ < 0 || packetFd_ < 0)
+    {
+        return FAILED;
+    }
+    // 单播响应从UDP套接字到达, 广播响应从链路层套接字到达
+    struct pollfd pfds[2];
+    pfds[0].fd = fd_;
+    pfds[0].events = POLLIN;
+    pfds[1].fd = packetFd_;
+    pfds[1].events = POLLIN;
+    long long deadline = monotonicMs() + timeoutMs;
+    while (true)
+    {
+        long long remaining = deadline - monotonicMs();
+        if (remaining <= 0)
+        {
+            return TIMEOUT;
+        }
+        int ready = poll(pfds, 2, static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready < 0)
+        {
+            return FAILED;
+        }
+        if (ready == 0)
+        {
+            return TIMEOUT;
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            if (!(pfds[i].revents & POLLIN))
+            {
+                continue;
+            }
+            ssize_t received = recv(pfds[i].fd, buffer_.data(), buffer_.size(), MSG_DONTWAIT);
+            if (received < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                {
+                    continue;
+                }
+                return FAILED;
+            }
+            const uint8_t *payload = buffer_.data();
+            size_t length = static_cast<size_t>(received);
+            if (pfds[i].fd == packetFd_ && !extractClientPayload(payload, length))
+            {
+                continue;
+            }
+            // 忽略其他客户端的响应和迟到的旧事务
+            Result result = parseReply(payload, length, xid_, hardwareAddress_, lease);
+            if (result != FAILED)
+            {
+                return result;
+            }
+        }
+    }
+#else
+    (void)timeoutMs;
+    (void)lease;
+    return FAILED;
+#endif // _WIN32
+}
+
+DhcpClient::Result DhcpClient::reboot(const DhcpLease &known, int timeoutMs, DhcpLease &lease)
+{
+    return sendReboot(known) ? waitReply(timeoutMs, lease) : FAILED;
+}
+
+DhcpClient::Result DhcpClient::renew(const DhcpLease &current, int timeoutMs, DhcpLease &lease)
+{
+    return sendRenew(current) ? waitReply(timeoutMs, lease) : FAILED;
+}
+
+std::vector<uint8_t> DhcpClient::buildRequest(uint32_t xid, const MacAddress &hardwareAddress,
+                                              const std::string &requestedAddress, const std::string &clientAddress)
+{
+#ifndef _WIN32
+    struct in_addr requested;
+    struct in_addr client;
+    if ((!requestedAddress.empty() && inet_pton(AF_INET, requestedAddress.c_str(), &requested) != 1) ||
+        (!clientAddress.empty() && inet_pton(AF_INET, clientAddress.c_str(), &client) != 1))
+    {
+        return std::vector<uint8_t>();
+    }
+
+    std::vector<uint8_t> message(kHeaderLength, 0);
+    message[0] = 1; // BOOTREQUEST
+    message[1] = 1; // 以太网
+    message[2] = 6;
+    storeBigEndian32(&message[4], xid);
+    if (clientAddress.empty())
+    {
+        // 还没有地址, 要求服务器广播响应
+        message[kOffsetFlags] = 0x80;
+    }
+    else
+    {
+        memcpy(&message[kOffsetClientAddress], &client, sizeof(client));
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        message[kOffsetHardwareAddress + i] = hardwareAddress.octet(i);
+    }
+    message.resize(kHeaderLength + 4);
+    storeBigEndian32(&message[kHeaderLength], kMagicCookie);
+
+    appendOption(message, kOptionMessageType, &kMessageRequest, 1);
+    uint8_t clientId[7] = {1};
+    for (int i = 0; i < 6; i++)
+    {
+        clientId[1 + i] = hardwareAddress.octet(i);
+    }
+    appendOption(message, kOptionClientId, clientId, sizeof(clientId));
+    if (!requestedAddress.empty())
+    {
+        appendOption(message, kOptionRequestedAddress, &requested, sizeof(requested));
+    }
+    const uint8_t parameters[] = {kOptionSubnetMask, kOptionRouter, kOptionDns, kOptionLeaseTime, kOptionServerId};
+    appendOption(message, kOptionParameterList, parameters, sizeof(parameters));
+    message.push_back(kOptionEnd);
+    if (message.size() < kMinMessageLength)
+    {
+        message.resize(kMinMessageLength, kOptionPad);
+    }
+    return message;
+#else
+    (void)xid;
+    (void)hardwareAddress;
+    (void)requestedAddress;
+    (void)clientAddress;
+    return std::vector<uint8_t>();
+#endif // _WIN32
+}
+
+DhcpClient::Result DhcpClient::parseReply(const uint8_t *data, size_t length, uint32_t xid,
+                                          const MacAddress &hardwareAddress, DhcpLease &lease)
+{
+#ifndef _WIN32
+    if (length < kHeaderLength + 4 || data[0] != 2 || loadBigEndian32(data + 4) != xid ||
+        loadBigEndian32(data + kHeaderLength) != kMagicCookie ||
+        MacAddress::fromBytes(data + kOffsetHardwareAddress) != hardwareAddress)
+    {
+        return FAILED;
+    }
+
+    DhcpLease reply;
+    uint8_t messageType = 0;
+    size_t offset = kHeaderLength + 4;
+    while (offset < length)
+    {
+        uint8_t code = data[offset++];
+        if (code == kOptionPad)
+        {
+            continue;
+        }
+        if (code == kOptionEnd || offset >= length)
+        {
+            break;
+        }
+        size_t size = data[offset++];
+        if (offset + size > length)
+        {
+            break;
+        }
+        const uint8_t *value = data + offset;
+        switch (code)
+        {
+        case kOptionMessageType:
+            messageType = size >= 1 ? value[0] : 0;
+            break;
+        case kOptionSubnetMask:
+            if (size >= 4)
+            {
+                reply.prefixLength = RtNetlink::netmaskToPrefix(formatIPv4(value));
+            }
+            break;
+        case kOptionRouter:
+            if (size >= 4)
+            {
+                reply.gateway = formatIPv4(value);
+            }
+            break;
+        case kOptionDns:
+            for (size_t i = 0; i + 4 <= size; i += 4)
+            {
+                reply.dns.push_back(formatIPv4(value + i));
+            }
+            break;
+        case kOptionLeaseTime:
+            if (size >= 4)
+            {
+                reply.leaseSeconds = loadBigEndian32(value);
+            }
+            break;
+        case kOptionServerId:
+            if (size >= 4)
+            {
+                reply.server = formatIPv4(value);
+            }
+            break;
+        default:
+            break;
+        }
+        offset += size;
+    }
+
+    if (messageType == kMessageNak)
+    {
+        return NAK;
+    }
+    if (messageType != kMessageAck)
+    {
+        return FAILED;
+    }
+    reply.address = formatIPv4(data + kOffsetYourAddress);
+    if (reply.prefixLength <= 0)
+    {
+        // 未携带子网掩码时按/24处理
+        reply.prefixLength = 24;
+    }
+    reply.obtainedAt = time(nullptr);
+    lease = reply;
+    return ACK;
+#else
+    (void)data;
+    (void)length;
+    (void)xid;
+    (void)hardwareAddress;
+    (void)lease;
+    return FAILED;
+#endif // _WIN32
+}
+
+std::string DhcpClient::formatLease(const DhcpLease &lease)
+{
+    std::string dns;
+    for (size_t i = 0; i < lease.dns.size(); i++)
+    {
+        dns += (i == 0 ? "" : ",") + lease.dns[i];
+    }
+    return lease.address + "/" + std::to_string(lease.prefixLength) + "|" + lease.server + "|" + lease.gateway + "|" +
+           dns + "|" + std::to_string(lease.leaseSeconds) + "|" + std::to_string(static_cast<long long>(lease.obtainedAt)) +
+           "|" + (lease.bssid.isZero() ? "" : lease.bssid.toString());
+}
+
+bool DhcpClient::parseLease(const std::string &text, DhcpLease &lease)
+{
+    std::vector<std::string> fields = splitFields(text, '|');
+    if (fields.size() < 6)
+    {
+        return false;
+    }
+    DhcpLease parsed;
+    size_t slash = fields[0].find('/');
+    if (slash == std::string::npos)
+    {
+        return false;
+    }
+    parsed.address = fields[0].substr(0, slash);
+    parsed.prefixLength = atoi(fields[0].c_str() + slash + 1);
+    parsed.server = fields[1];
+    parsed.gateway = fields[2];
+    if (!fields[3].empty())
+    {
+        parsed.dns = splitFields(fields[3], ',');
+    }
+    parsed.leaseSeconds = static_cast<uint32_t>(strtoul(fields[4].c_str(), nullptr, 10));
+    parsed.obtainedAt = static_cast<time_t>(strtoll(fields[5].c_str(), nullptr, 10));
+    if (fields.size() >= 7)
+    {
+        MacAddress::parse(fields[6], parsed.bssid);
+    }
+    if (parsed.address.empty() || parsed.prefixLength <= 0 || parsed.prefixLength > 32)
+    {
+        return false;
+    }
+    lease = parsed;
+    return true;
+}
+
+std::string DhcpClient::udhcpcScript(const std::string &defaultScript)
+{
+    // 先写临时文件再改名, 默认脚本写入地址时租约文件已完整
+    return "#!/bin/sh\n"
+           "case \"$1\" in\n"
+           "bound|renew)\n"
+           "    lease_file=\"" + std::string(kUdhcpcLeaseDirectory) + "/udhcpc.$interface.lease\"\n"
+           "    printf 'ip=%s\\nsubnet=%s\\nmask=%s\\nrouter=%s\\ndns=%s\\nserverid=%s\\nlease=%s\\n' \\\n"
+           "        \"$ip\" \"$subnet\" \"$mask\" \"$router\" \"$dns\" \"$serverid\" \"$lease\" > \"$lease_file.tmp\" &&\n"
+           "        mv \"$lease_file.tmp\" \"$lease_file\"\n"
+           "    ;;\n"
+           "esac\n"
+           "exec " + defaultScript + " \"$@\"\n";
+}
+
+std::string DhcpClient::udhcpcLeasePath(const std::string &interfaceName)
+{
+    return std::string(kUdhcpcLeaseDirectory) + "/udhcpc." + interfaceName + ".lease";
+}
+
+bool DhcpClient::parseUdhcpcLease(const std::string &text, DhcpLease &lease)
+{
+    DhcpLease parsed;
+    std::string subnet;
+    for (const auto &line : splitFields(text, '\n'))
+    {
+        size_t equals = line.find('=');
+        if (equals == std::string::npos)
+        {
+            continue;
+        }
+        std::string key = line.substr(0, equals);
+        std::string value = line.substr(equals + 1);
+        if (key == "ip")
+        {
+            parsed.address = value;
+        }
+        else if (key == "subnet")
+        {
+            subnet = value;
+        }
+        else if (key == "mask")
+        {
+            parsed.prefixLength = atoi(value.c_str());
+        }
+        else if (key == "router")
+        {
+            // 多个路由器以空格分隔, 只使用第一个
+            parsed.gateway = value.substr(0, value.find(' '));
+        }
+        else if (key == "dns")
+        {
+            for (const auto &address : splitFields(value, ' '))
+            {
+                if (!address.empty())
+                {
+                    parsed.dns.push_back(address);
+                }
+            }
+        }
+        else if (key == "serverid")
+        {
+            parsed.server = value;
+        }
+        else if (key == "lease")
+        {
+            parsed.leaseSeconds = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+        }
+    }
+    // 较旧的udhcpc只导出点分形式的子网掩码
+    if (parsed.prefixLength <= 0 && !subnet.empty())
+    {
+        parsed.prefixLength = RtNetlink::netmaskToPrefix(subnet);
+    }
+    if (parsed.address.empty() || parsed.prefixLength <= 0 || parsed.prefixLength > 32)
+    {
+        return false;
+    }
+    parsed.obtainedAt = time(nullptr);
+    lease = parsed;
+    return true;
+}
+
+DhcpRenewer::DhcpRenewer() : running_(false), callback_(nullptr), context_(nullptr), renewCount_(0)
+{
+}
+
+DhcpRenewer::~DhcpRenewer()
+{
+    stop();
+}
+
+void DhcpRenewer::start(const std::string &interfaceName, const DhcpLease &lease, LostCallback callback, void *context)
+{
+    stop();
+    std::lock_guard<std::mutex> lock(mutex_);
+    interfaceName_ = interfaceName;
+    lease_ = lease;
+    callback_ = callback;
+    context_ = context;
+    running_ = true;
+    thread_ = std::thread(&DhcpRenewer::run, this);
+}
+
+void DhcpRenewer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        wakeup_.notify_all();
+    }
+    // 租约丢失后线程已自行结束, 这里仍需回收
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool DhcpRenewer::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+DhcpLease DhcpRenewer::getLease() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lease_;
+}
+
+int DhcpRenewer::getRenewCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return renewCount_;
+}
+
+void DhcpRenewer::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    time_t nextAttempt = renewTime(lease_);
+    while (running_)
+    {
+        time_t now = time(nullptr);
+        if (now < nextAttempt)
+        {
+            wakeup_.wait_for(lock, std::chrono::seconds(nextAttempt - now));
+            continue;
+        }
+
+        DhcpLease current = lease_;
+        lock.unlock();
+        DhcpLease renewed;
+        DhcpClient::Result result = DhcpClient::FAILED;
+        DhcpClient client;
+        if (client.open(interfaceName_))
+        {
+            result = client.renew(current, kRenewTimeoutMs, renewed);
+        }
+        lock.lock();
+        if (!running_)
+        {
+            break;
+        }
+
+        now = time(nullptr);
+        // 没有租期(option 51)的ACK无法安排下一次续约, 按失败处理
+        if (result == DhcpClient::ACK && renewed.address == current.address && renewed.leaseSeconds > 0)
+        {
+            renewed.bssid = current.bssid;
+            lease_ = renewed;
+            renewCount_++;
+            nextAttempt = renewTime(lease_);
+            continue;
+        }
+        // T2之后不再单播续约, 交回完整流程
+        time_t rebindAt = current.obtainedAt + static_cast<time_t>(current.leaseSeconds) * 7 / 8;
+        if (result == DhcpClient::NAK || now + kRenewRetrySeconds >= rebindAt)
+        {
+            running_ = false;
+            LostCallback callback = callback_;
+            void *context = context_;
+            lock.unlock();
+            if (callback != nullptr)
+            {
+                callback(current, context);
+            }
+            return;
+        }
+        nextAttempt = now + kRenewRetrySeconds;
+    }
+}
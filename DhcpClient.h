@@ -0,0 +1,219 @@
+#ifndef DHCP_CLIENT_H
+#define DHCP_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <ctime>
+#include <cstdint>
+#include "MacAddress.h"
+
+// 一个网络上最近获得的DHCP租约
+struct DhcpLease
+{
+    std::string address;          // 分配的IPv4地址
+    int prefixLength;             // 由子网掩码换算
+    std::string server;           // 服务器标识(option 54)
+    std::string gateway;          // 第一个路由器(option 3)
+    std::vector<std::string> dns; // DNS服务器(option 6)
+    uint32_t leaseSeconds;        // 租期(option 51)
+    time_t obtainedAt;            // 获得/续约时间(系统时间, 便于持久化)
+    MacAddress bssid;             // 获得租约时关联的AP
+
+    DhcpLease() : prefixLength(0), leaseSeconds(0), obtainedAt(0) {}
+
+    /**
+     * 租约剩余时间
+     * @param now 当前系统时间
+     * @return 剩余秒数, 已过期或无效返回0
+     */
+    uint32_t remainingSeconds(time_t now) const;
+};
+
+/*
+ * 最小DHCP客户端, 只实现已有租约的两种请求:
+ * INIT-REBOOT(广播DHCPREQUEST, option 50为已知地址)用于重新加入同一网络,
+ * RENEWING(单播DHCPREQUEST, ciaddr为当前地址)用于续约.
+ * 完整的DISCOVER/OFFER流程仍由udhcpc完成
+ */
+class DhcpClient
+{
+public:
+    enum Result
+    {
+        ACK,
+        NAK,
+        TIMEOUT,
+        FAILED // 套接字错误
+    };
+
+    DhcpClient();
+    ~DhcpClient();
+
+    /**
+     * 在接口上打开UDP 68端口(单播续约)和链路层套接字(接口还没有地址时收发广播)
+     * @param interfaceName 接口名称
+     * @return 成功返回true，失败返回false
+     */
+    bool open(const std::string &interfaceName);
+
+    /**
+     * 关闭套接字
+     */
+    void close();
+
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * 发送INIT-REBOOT请求, 不等待响应(调用方可以先应用地址再调用waitReply)
+     * @param lease 已知租约(只使用address)
+     * @return 发送成功返回true
+     */
+    bool sendReboot(const DhcpLease &lease);
+
+    /**
+     * 发送RENEWING请求(单播到租约服务器), 不等待响应
+     * @param lease 当前租约(address和server)
+     * @return 发送成功返回true
+     */
+    bool sendRenew(const DhcpLease &lease);
+
+    /**
+     * 等待最近一次请求的ACK/NAK
+     * @param timeoutMs 超时时间(毫秒)
+     * @param lease ACK时的租约
+     * @return 结果
+     */
+    Result waitReply(int timeoutMs, DhcpLease &lease);
+
+    /**
+     * 发送INIT-REBOOT请求并等待响应
+     */
+    Result reboot(const DhcpLease &known, int timeoutMs, DhcpLease &lease);
+
+    /**
+     * 发送RENEWING请求并等待响应
+     */
+    Result renew(const DhcpLease &current, int timeoutMs, DhcpLease &lease);
+
+    /**
+     * 构造DHCPREQUEST
+     * @param xid 事务ID
+     * @param hardwareAddress 客户端MAC地址
+     * @param requestedAddress INIT-REBOOT时的option 50, 为空时不携带
+     * @param clientAddress RENEWING时的ciaddr, 为空时为0并要求广播响应
+     * @return 消息, 地址无效时返回空
+     */
+    static std::vector<uint8_t> buildRequest(uint32_t xid, const MacAddress &hardwareAddress,
+                                             const std::string &requestedAddress, const std::string &clientAddress);
+
+    /**
+     * 解析服务器响应
+     * @param data 消息数据
+     * @param length 数据长度
+     * @param xid 期望的事务ID
+     * @param hardwareAddress 期望的客户端MAC地址
+     * @param lease ACK时的租约(obtainedAt为当前时间)
+     * @return ACK/NAK, 不是对应请求的响应返回FAILED
+     */
+    static Result parseReply(const uint8_t *data, size_t length, uint32_t xid, const MacAddress &hardwareAddress,
+                             DhcpLease &lease);
+
+    /**
+     * 租约的单行文本形式: address/prefix|server|gateway|dns,dns|leaseSeconds|obtainedAt|bssid
+     */
+    static std::string formatLease(const DhcpLease &lease);
+    static bool parseLease(const std::string &text, DhcpLease &lease);
+
+    /**
+     * udhcpc事件脚本(-s): bound/renew时先把租约写入udhcpcLeasePath(), 再执行默认脚本配置接口.
+     * udhcpc本身不导出租约, 由脚本取得租期和服务器标识, 不需要再向服务器查询
+     * @param defaultScript udhcpc默认脚本的路径
+     * @return 脚本内容
+     */
+    static std::string udhcpcScript(const std::string &defaultScript);
+    static std::string udhcpcLeasePath(const std::string &interfaceName);
+
+    /**
+     * 解析udhcpcScript()写入的租约文件
+     * @param text 文件内容(ip/subnet/mask/router/dns/serverid/lease, 每行key=value)
+     * @param lease 租约(obtainedAt为当前时间)
+     * @return 成功返回true
+     */
+    static bool parseUdhcpcLease(const std::string &text, DhcpLease &lease);
+
+private:
+    int fd_;       // UDP 68端口
+    int packetFd_; // AF_PACKET, 广播请求和响应
+    int ifindex_;
+    uint32_t xid_;
+    MacAddress hardwareAddress_;
+    std::vector<uint8_t> buffer_; // 复用的接收缓冲区
+
+    /*
+     * 以源地址0.0.0.0在链路层广播(RFC 2131: 获得地址前的请求)
+     */
+    bool sendBroadcast(const std::vector<uint8_t> &message);
+    bool sendUnicast(const std::vector<uint8_t> &message, const std::string &destination);
+
+    DhcpClient(const DhcpClient &);
+    DhcpClient &operator=(const DhcpClient &);
+};
+
+/*
+ * INIT-REBOOT快速重连后(udhcpc未运行)维护租约:
+ * T1(租期一半, 至少间隔10秒)单播续约, 失败时每分钟重试, 到T2(租期7/8)或收到NAK时通知调用方交回完整流程;
+ * 没有租期的ACK按续约失败处理
+ */
+class DhcpRenewer
+{
+public:
+    // 租约无法续约时在续约线程中调用(线程随后结束, 回调中不能调用stop/start)
+    typedef void (*LostCallback)(const DhcpLease &lease, void *context);
+
+    DhcpRenewer();
+    ~DhcpRenewer();
+
+    /**
+     * 启动续约线程(已在运行时先停止)
+     * @param interfaceName 接口名称
+     * @param lease 当前租约
+     * @param callback 租约丢失回调
+     * @param context 回调参数
+     */
+    void start(const std::string &interfaceName, const DhcpLease &lease, LostCallback callback, void *context);
+
+    /**
+     * 停止续约线程
+     */
+    void stop();
+
+    bool isRunning() const;
+
+    /**
+     * 当前租约(包含续约结果)
+     */
+    DhcpLease getLease() const;
+
+    int getRenewCount() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    std::thread thread_;
+    bool running_;
+    std::string interfaceName_;
+    DhcpLease lease_;
+    LostCallback callback_;
+    void *context_;
+    int renewCount_;
+
+    void run();
+
+    DhcpRenewer(const DhcpRenewer &);
+    DhcpRenewer &operator=(const DhcpRenewer &);
+};
+
+#endif // DHCP_CLIENT_H
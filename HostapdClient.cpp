@@ -0,0 +1,304 @@
+#include "HostapdClient.h"
+
+#include <cstdlib>
+#include <iostream>
+
+HostapdClient::HostapdClient(const std::string &ctrlDir, const std::string &clientDir)
+    : ctrlDir_(ctrlDir), ctrl_(clientDir), enabled_(false), reloadCount_(0)
+{
+}
+
+bool HostapdClient::open(const std::string &iface)
+{
+#ifndef _WIN32
+    close();
+    if (!ctrl_.open(ctrlDir_ + "/" + iface))
+    {
+        return false;
+    }
+    // 先订阅再加载, 加载期间发生的连接/断开事件会在之后的processEvents中补齐
+    if (!ctrl_.attach() || !reloadStations())
+    {
+        std::cout << "Failed to attach to hostapd control interface of " << iface << std::endl;
+        close();
+        return false;
+    }
+    enabled_ = true;
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void HostapdClient::close()
+{
+#ifndef _WIN32
+    ctrl_.close();
+    stations_.clear();
+    enabled_ = false;
+#endif // _WIN32
+}
+
+int HostapdClient::processEvents(int timeoutMs)
+{
+#ifndef _WIN32
+    if (!ctrl_.isOpen())
+    {
+        return -1;
+    }
+    int count = 0;
+    std::string event;
+    while (ctrl_.waitEvent(event, count == 0 ? timeoutMs : 0))
+    {
+        handleEvent(event);
+        count++;
+    }
+    return count;
+#else
+    return -1;
+#endif // _WIN32
+}
+
+bool HostapdClient::reloadStations()
+{
+#ifndef _WIN32
+    std::map<MacAddress, HostapdStation> previous;
+    previous.swap(stations_);
+
+    MacAddress macAddress;
+    bool found = queryStation("STA-FIRST", macAddress);
+    while (found)
+    {
+        found = queryStation("STA-NEXT " + macAddress.toString(), macAddress);
+    }
+    if (!ctrl_.isOpen())
+    {
+        return false;
+    }
+
+    // 保留已解析的IP地址和主机名
+    for (auto &entry : stations_)
+    {
+        auto it = previous.find(entry.first);
+        if (it != previous.end())
+        {
+            entry.second.ipAddress = it->second.ipAddress;
+            entry.second.hostname = it->second.hostname;
+        }
+    }
+    reloadCount_++;
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool HostapdClient::refreshStations()
+{
+#ifndef _WIN32
+    if (!ctrl_.isOpen())
+    {
+        return false;
+    }
+    std::vector<MacAddress> known;
+    for (const auto &entry : stations_)
+    {
+        known.push_back(entry.first);
+    }
+    for (const auto &macAddress : known)
+    {
+        MacAddress queried;
+        if (!queryStation("STA " + macAddress.toString(), queried))
+        {
+            // 客户端已离开但断开事件尚未到达
+            stations_.erase(macAddress);
+        }
+        if (!ctrl_.isOpen())
+        {
+            return false;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+std::vector<HostapdStation> HostapdClient::getStations() const
+{
+    std::vector<HostapdStation> result;
+    result.reserve(stations_.size());
+    for (const auto &entry : stations_)
+    {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+void HostapdClient::setStationAddress(const MacAddress &macAddress, const std::string &ipAddress, const std::string &hostname)
+{
+    auto it = stations_.find(macAddress);
+    if (it != stations_.end())
+    {
+        it->second.ipAddress = ipAddress;
+        it->second.hostname = hostname;
+    }
+}
+
+bool HostapdClient::deauthenticate(const MacAddress &macAddress)
+{
+#ifndef _WIN32
+    std::string reply;
+    if (!ctrl_.request("DEAUTHENTICATE " + macAddress.toString(), reply))
+    {
+        return false;
+    }
+    return reply.compare(0, 2, "OK") == 0;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool HostapdClient::queryStation(const std::string &command, MacAddress &macAddress)
+{
+#ifndef _WIN32
+    std::string reply;
+    if (!ctrl_.request(command, reply))
+    {
+        // hostapd已退出, 控制接口失效
+        close();
+        return false;
+    }
+
+    HostapdStation station;
+    if (!parseStation(reply, station))
+    {
+        return false;
+    }
+    auto it = stations_.find(station.macAddress);
+    if (it != stations_.end())
+    {
+        station.ipAddress = it->second.ipAddress;
+        station.hostname = it->second.hostname;
+    }
+    macAddress = station.macAddress;
+    stations_[macAddress] = station;
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void HostapdClient::handleEvent(const std::string &event)
+{
+    // 事件格式: "AP-STA-CONNECTED 02:11:22:33:44:55 [p2p_dev_addr=...]"
+    size_t space = event.find(' ');
+    std::string name = event.substr(0, space);
+    MacAddress argument;
+    if (space != std::string::npos)
+    {
+        size_t end = event.find(' ', space + 1);
+        size_t length = (end == std::string::npos ? event.size() : end) - space - 1;
+        MacAddress::parse(event.data() + space + 1, length, argument);
+    }
+
+    if (name == "AP-STA-CONNECTED")
+    {
+        MacAddress macAddress;
+        if (!argument.isZero() && !queryStation("STA " + argument.toString(), macAddress))
+        {
+            // 查询失败时仍记录该客户端, 统计信息在下次刷新时补齐
+            HostapdStation station;
+            station.macAddress = argument;
+            stations_.insert(std::make_pair(station.macAddress, station));
+        }
+    }
+    else if (name == "AP-STA-DISCONNECTED")
+    {
+        stations_.erase(argument);
+    }
+    else if (name == "AP-ENABLED")
+    {
+        enabled_ = true;
+        reloadStations();
+    }
+    else if (name == "AP-DISABLED")
+    {
+        enabled_ = false;
+        stations_.clear();
+    }
+}
+
+bool HostapdClient::parseStation(const std::string &reply, HostapdStation &station)
+{
+    size_t lineEnd = reply.find('\n');
+    size_t firstLength = (lineEnd == std::string::npos) ? reply.size() : lineEnd;
+    // 无客户端时响应为空或 "FAIL"
+    MacAddress macAddress;
+    if (!MacAddress::parse(reply.data(), firstLength, macAddress))
+    {
+        return false;
+    }
+    station = HostapdStation();
+    station.macAddress = macAddress;
+
+    size_t pos = (lineEnd == std::string::npos) ? reply.size() : lineEnd + 1;
+    while (pos < reply.size())
+    {
+        size_t end = reply.find('\n', pos);
+        if (end == std::string::npos)
+        {
+            end = reply.size();
+        }
+        size_t equal = reply.find('=', pos);
+        if (equal != std::string::npos && equal < end)
+        {
+            std::string key = reply.substr(pos, equal - pos);
+            std::string value = reply.substr(equal + 1, end - equal - 1);
+            const char *text = value.c_str();
+            if (key == "flags")
+            {
+                station.flags = value;
+            }
+            else if (key == "signal")
+            {
+                station.signalStrength = std::atoi(text);
+            }
+            else if (key == "connected_time")
+            {
+                station.connectedTime = std::atol(text);
+            }
+            else if (key == "inactive_msec")
+            {
+                station.inactiveMs = std::atol(text);
+            }
+            else if (key == "rx_bytes")
+            {
+                station.rxBytes = std::strtoull(text, nullptr, 10);
+            }
+            else if (key == "tx_bytes")
+            {
+                station.txBytes = std::strtoull(text, nullptr, 10);
+            }
+            else if (key == "rx_packets")
+            {
+                station.rxPackets = std::strtoul(text, nullptr, 10);
+            }
+            else if (key == "tx_packets")
+            {
+                station.txPackets = std::strtoul(text, nullptr, 10);
+            }
+            else if (key == "rx_rate_info")
+            {
+                // 单位为100 kbit/s, 如 "6500 vhtmcs 7 vhtnss 2"
+                station.rxBitrateKbps = std::atol(text) * 100;
+            }
+            else if (key == "tx_rate_info")
+            {
+                station.txBitrateKbps = std::atol(text) * 100;
+            }
+        }
+        pos = end + 1;
+    }
+    return true;
+}
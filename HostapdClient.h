@@ -0,0 +1,147 @@
+#ifndef HOSTAPD_CLIENT_H
+#define HOSTAPD_CLIENT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "WpaCtrl.h"
+#include "MacAddress.h"
+
+struct HostapdStation
+{
+    MacAddress macAddress;
+    std::string flags;     // 如 "[AUTH][ASSOC][AUTHORIZED]"
+    int signalStrength;    // 信号强度(dBm)
+    long connectedTime;    // 连接时间(秒)
+    long inactiveMs;       // 空闲时间(毫秒)
+    unsigned long long rxBytes;
+    unsigned long long txBytes;
+    unsigned long rxPackets;
+    unsigned long txPackets;
+    long rxBitrateKbps;    // 最近一次接收速率(kbit/s)
+    long txBitrateKbps;    // 最近一次发送速率(kbit/s)
+    std::string ipAddress; // 由调用方解析后回填, 刷新统计信息时保留
+    std::string hostname;
+
+    HostapdStation()
+        : signalStrength(0), connectedTime(0), inactiveMs(0),
+          rxBytes(0), txBytes(0), rxPackets(0), txPackets(0),
+          rxBitrateKbps(0), txBitrateKbps(0) {}
+};
+
+/*
+ * hostapd控制接口客户端
+ * 订阅AP-STA-CONNECTED/AP-STA-DISCONNECTED/AP-ENABLED等事件, 增量维护客户端表,
+ * 查询时只需处理已到达的事件, 不再每次重新枚举所有客户端
+ */
+class HostapdClient
+{
+public:
+    /**
+     * @param ctrlDir hostapd控制接口目录(对应配置中的ctrl_interface)
+     * @param clientDir 本地套接字所在目录
+     */
+    explicit HostapdClient(const std::string &ctrlDir = "/var/run/hostapd", const std::string &clientDir = "/tmp");
+
+    /**
+     * 连接指定接口的控制接口, 订阅事件并加载当前客户端表
+     * @param iface AP接口名称
+     * @return 成功返回true，失败返回false
+     */
+    bool open(const std::string &iface);
+
+    /**
+     * 断开控制接口并清空客户端表
+     */
+    void close();
+
+    /**
+     * 判断是否已连接
+     * @return 已连接返回true
+     */
+    bool isOpen() const { return ctrl_.isOpen(); }
+
+    /**
+     * 处理已到达的事件, 增量更新客户端表
+     * @param timeoutMs 等待首个事件的时间(毫秒), 0表示只处理已到达的事件
+     * @return 处理的事件数量, 连接失效时返回-1
+     */
+    int processEvents(int timeoutMs = 0);
+
+    /**
+     * 通过STA-FIRST/STA-NEXT重新加载全部客户端(等价于hostapd_cli all_sta)
+     * @return 成功返回true，失败返回false
+     */
+    bool reloadStations();
+
+    /**
+     * 重新查询已知客户端的统计信息(信号强度、连接时间、流量等)
+     * @return 成功返回true，失败返回false
+     */
+    bool refreshStations();
+
+    /**
+     * 获取当前客户端表
+     * @return 客户端列表(按MAC地址排序)
+     */
+    std::vector<HostapdStation> getStations() const;
+
+    /**
+     * 获取当前客户端数量
+     * @return 客户端数量
+     */
+    size_t getStationCount() const { return stations_.size(); }
+
+    /**
+     * 回填客户端的IP地址和主机名
+     * @param macAddress 客户端MAC地址
+     * @param ipAddress IP地址
+     * @param hostname 主机名
+     */
+    void setStationAddress(const MacAddress &macAddress, const std::string &ipAddress, const std::string &hostname);
+
+    /**
+     * 断开指定客户端(DEAUTHENTICATE)
+     * @param macAddress 客户端MAC地址
+     * @return 成功返回true，失败返回false
+     */
+    bool deauthenticate(const MacAddress &macAddress);
+
+    /**
+     * 判断AP是否处于启用状态(最近一次AP-ENABLED/AP-DISABLED事件)
+     * @return 已启用返回true
+     */
+    bool isEnabled() const { return enabled_; }
+
+    /**
+     * 获取完整重新加载客户端表的次数
+     * @return 重新加载次数
+     */
+    int getReloadCount() const { return reloadCount_; }
+
+    /**
+     * 解析STA/STA-FIRST/STA-NEXT的响应
+     * @param reply 命令响应(首行为MAC地址, 其后为key=value)
+     * @param station 解析结果
+     * @return 响应包含客户端信息返回true
+     */
+    static bool parseStation(const std::string &reply, HostapdStation &station);
+
+private:
+    std::string ctrlDir_;
+    WpaCtrl ctrl_;
+    std::map<MacAddress, HostapdStation> stations_; // 按MAC地址索引
+    bool enabled_;
+    int reloadCount_;
+
+    /*
+     * 查询单个客户端并更新客户端表
+     * @param command STA <mac> / STA-FIRST / STA-NEXT <mac>
+     * @param macAddress 查询到的客户端MAC地址
+     * @return 查询到客户端返回true
+     */
+    bool queryStation(const std::string &command, MacAddress &macAddress);
+    void handleEvent(const std::string &event);
+};
+
+#endif // HOSTAPD_CLIENT_H
@@ -0,0 +1,188 @@
+#include "IwScanParser.h"
+#include "Nl80211.h"
+
+namespace
+{
+bool isHexDigit(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    return (c >= 'a' && c <= 'f') ? c - 'a' + 10 : c - 'A' + 10;
+}
+
+void appendNetwork(const IwScanRecord &record, void *context)
+{
+    std::vector<NetworkInfo> &bssList = *static_cast<std::vector<NetworkInfo> *>(context);
+    bssList.push_back(NetworkInfo());
+    NetworkInfo &network = bssList.back();
+    MacAddress::parse(record.bssid.data(), record.bssid.size(), network.bssid);
+    IwScanParser::decodeSsid(record.ssid, network.ssid);
+    network.frequency = record.frequency;
+    network.channel = record.channel;
+    network.signalStrength = record.signalStrength;
+    network.security = record.security;
+    network.ageMs = record.ageMs;
+}
+
+void appendRow(const IwScanRecord &record, void *context)
+{
+    // SSID最长32字节, 转义后最长128字节
+    char ssid[256];
+    size_t length = IwScanParser::decodeSsid(record.ssid, ssid, sizeof(ssid));
+    MacAddress bssid;
+    MacAddress::parse(record.bssid.data(), record.bssid.size(), bssid);
+    static_cast<ScanTable *>(context)->add(bssid, TextView(ssid, length), record.frequency, record.channel,
+                                           record.signalStrength, record.security, 0,
+                                           static_cast<uint32_t>(record.ageMs));
+}
+} // namespace
+
+size_t IwScanParser::forEachBss(const char *data, size_t length, Visitor visitor, void *context)
+{
+    TextView remaining(data, length);
+    TextView rawLine;
+    IwScanRecord current;
+    bool inBss = false;
+    size_t count = 0;
+
+    while (remaining.nextLine(rawLine))
+    {
+        // 新BSS以顶格的 "BSS xx:xx:xx:xx:xx:xx(on wlan0)" 开始, 缩进的 "BSS Load:" 等不是
+        if (rawLine.startsWith("BSS"))
+        {
+            if (inBss && !current.ssid.empty())
+            {
+                visitor(current, context);
+                count++;
+            }
+            current = IwScanRecord();
+            inBss = true;
+
+            TextView rest = rawLine.substr(3);
+            size_t pos = 0;
+            while (pos < rest.size() && (rest[pos] == ' ' || rest[pos] == '\t'))
+            {
+                pos++;
+            }
+            size_t end = pos;
+            while (end < rest.size() && (rest[end] == ':' || (rest[end] >= '0' && rest[end] <= '9') ||
+                                         (rest[end] >= 'a' && rest[end] <= 'f')))
+            {
+                end++;
+            }
+            if (pos > 0)
+            {
+                current.bssid = rest.substr(pos, end - pos);
+            }
+            continue;
+        }
+
+        TextView line = rawLine.trim();
+        if (line.empty())
+        {
+            continue;
+        }
+        if (line.startsWith("last seen:"))
+        {
+            int age = 0;
+            if (line.after("last seen:").toInt(age))
+            {
+                current.ageMs = age;
+            }
+        }
+        else if (line.contains("freq:"))
+        {
+            int frequency = 0;
+            if (line.after("freq:").toInt(frequency))
+            {
+                current.frequency = frequency;
+                current.channel = Nl80211::frequencyToChannel(frequency);
+            }
+        }
+        else if (line.contains("signal:"))
+        {
+            // "signal: -45.00 dBm", 小数部分向零取整
+            int signal = 0;
+            if (line.after("signal:").toInt(signal))
+            {
+                current.signalStrength = signal;
+            }
+        }
+        else if (line.contains("SSID:"))
+        {
+            current.ssid = line.after("SSID:");
+            // 默认设置为开放网络模式
+            current.security = SecurityMode::OPEN;
+        }
+        else if (line.contains("WPA2") || line.contains("RSN"))
+        {
+            current.security = SecurityMode::WPA2_PSK;
+        }
+        else if (line.contains("WPA"))
+        {
+            current.security = SecurityMode::WPA_PSK;
+        }
+        else if (line.contains("WEP"))
+        {
+            current.security = SecurityMode::WEP;
+        }
+    }
+
+    // 最后一个BSS
+    if (inBss && !current.ssid.empty())
+    {
+        visitor(current, context);
+        count++;
+    }
+    return count;
+}
+
+size_t IwScanParser::parse(const std::string &output, std::vector<NetworkInfo> &bssList)
+{
+    return forEachBss(output.data(), output.size(), appendNetwork, &bssList);
+}
+
+size_t IwScanParser::parse(const std::string &output, ScanTable &table)
+{
+    return forEachBss(output.data(), output.size(), appendRow, &table);
+}
+
+void IwScanParser::decodeSsid(TextView escaped, std::string &ssid)
+{
+    ssid.clear();
+    if (escaped.find("\\x") == TextView::npos)
+    {
+        ssid.assign(escaped.data(), escaped.size());
+        return;
+    }
+    ssid.resize(escaped.size());
+    ssid.resize(decodeSsid(escaped, &ssid[0], ssid.size()));
+}
+
+size_t IwScanParser::decodeSsid(TextView escaped, char *buffer, size_t capacity)
+{
+    size_t length = 0;
+    size_t pos = 0;
+    while (pos < escaped.size() && length < capacity)
+    {
+        if (escaped[pos] == '\\' && pos + 3 < escaped.size() && escaped[pos + 1] == 'x' &&
+            isHexDigit(escaped[pos + 2]) && isHexDigit(escaped[pos + 3]))
+        {
+            buffer[length++] = static_cast<char>(hexValue(escaped[pos + 2]) * 16 + hexValue(escaped[pos + 3]));
+            pos += 4; // 跳过 "\\x" 和 2个十六进制字符
+        }
+        else
+        {
+            buffer[length++] = escaped[pos];
+            pos++;
+        }
+    }
+    return length;
+}
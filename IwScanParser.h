@@ -0,0 +1,84 @@
+#ifndef IW_SCAN_PARSER_H
+#define IW_SCAN_PARSER_H
+
+#include <string>
+#include <vector>
+#include "TextView.h"
+#include "WifiTypes.h"
+#include "ScanTable.h"
+
+/*
+ * iw scan输出中的一个BSS, 字符串字段均指向原始输出(不复制)
+ */
+struct IwScanRecord
+{
+    TextView bssid; // 未解析的BSSID文本
+    TextView ssid; // 未解码的SSID(可能含\xNN转义)
+    int frequency;
+    int channel;
+    int signalStrength;
+    SecurityMode security;
+    int ageMs; // "last seen: N ms ago"
+
+    IwScanRecord() : frequency(0), channel(0), signalStrength(0), security(SecurityMode::OPEN), ageMs(0) {}
+};
+
+/*
+ * iw dev <if> scan 文本输出解析器
+ * 单次遍历原始输出, 按行原地分词, 不使用正则, 解析过程中不分配内存;
+ * 只有把结果转换为NetworkInfo时才复制SSID
+ */
+class IwScanParser
+{
+public:
+    /*
+     * BSS回调
+     * @param record 解析出的BSS(仅在回调期间有效)
+     * @param context 调用者传入的上下文
+     */
+    typedef void (*Visitor)(const IwScanRecord &record, void *context);
+
+    /**
+     * 逐个BSS解析, 每个带SSID的BSS调用一次visitor
+     * @param data 原始输出(可直接传入iw scan完整输出, 无需预先过滤)
+     * @param length 输出长度
+     * @param visitor 回调函数
+     * @param context 回调上下文
+     * @return 解析出的BSS数量
+     */
+    static size_t forEachBss(const char *data, size_t length, Visitor visitor, void *context);
+
+    /**
+     * 解析全部BSS并转换为NetworkInfo(每个BSS一项, 未去重)
+     * @param output 原始输出
+     * @param bssList 追加解析结果
+     * @return 解析出的BSS数量
+     */
+    static size_t parse(const std::string &output, std::vector<NetworkInfo> &bssList);
+
+    /**
+     * 解析全部BSS并追加到扫描表(SSID直接解码到表的arena, 不经过std::string)
+     * @param output 原始输出
+     * @param table 扫描表
+     * @return 解析出的BSS数量
+     */
+    static size_t parse(const std::string &output, ScanTable &table);
+
+    /**
+     * 解码iw输出中的SSID转义(\xNN), 解决中文SSID显示问题
+     * @param escaped 转义后的SSID
+     * @param ssid 解码结果
+     */
+    static void decodeSsid(TextView escaped, std::string &ssid);
+
+    /**
+     * 解码SSID转义到调用方提供的缓冲区
+     * @param escaped 转义后的SSID
+     * @param buffer 输出缓冲区
+     * @param capacity 缓冲区大小, 超出部分被截断
+     * @return 解码后的长度
+     */
+    static size_t decodeSsid(TextView escaped, char *buffer, size_t capacity);
+};
+
+#endif // IW_SCAN_PARSER_H
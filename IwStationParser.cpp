@@ -0,0 +1,135 @@
+#include "IwStationParser.h"
+
+namespace
+{
+template <typename T>
+void assignUnsigned(TextView value, T &field)
+{
+    uint64_t number = 0;
+    if (value.toUInt64(number))
+    {
+        field = static_cast<T>(number);
+    }
+}
+} // namespace
+
+size_t IwStationParser::parse(const std::string &output, std::vector<ClientInfo> &clients)
+{
+    TextView remaining(output);
+    TextView rawLine;
+    ClientInfo *current = nullptr;
+    size_t count = 0;
+
+    while (remaining.nextLine(rawLine))
+    {
+        TextView line = rawLine.trim();
+        // 新客户端: "Station 02:11:22:33:44:55 (on wlan1)"
+        if (line.startsWith("Station"))
+        {
+            TextView rest = line.substr(7).trim();
+            size_t end = 0;
+            while (end < rest.size() && (rest[end] == ':' || (rest[end] >= '0' && rest[end] <= '9') ||
+                                         (rest[end] >= 'a' && rest[end] <= 'f')))
+            {
+                end++;
+            }
+            MacAddress macAddress;
+            if (!MacAddress::parse(rest.data(), end, macAddress))
+            {
+                current = nullptr;
+                continue;
+            }
+            clients.push_back(ClientInfo());
+            current = &clients.back();
+            current->macAddress = macAddress;
+            count++;
+            continue;
+        }
+
+        TextView key;
+        TextView value;
+        if (current && line.split(':', key, value))
+        {
+            parseField(key, value, *current);
+        }
+    }
+    return count;
+}
+
+bool IwStationParser::parseField(TextView key, TextView value, ClientInfo &client)
+{
+    long number = 0;
+    if (key == "signal")
+    {
+        // "-45 [-47, -48] dBm", 只取合成信号
+        int signal = 0;
+        if (value.toInt(signal))
+        {
+            client.signalStrength = signal;
+        }
+    }
+    else if (key == "connected time")
+    {
+        assignUnsigned(value, client.connectedTime);
+    }
+    else if (key == "inactive time")
+    {
+        assignUnsigned(value, client.inactiveMs);
+    }
+    else if (key == "rx bytes")
+    {
+        assignUnsigned(value, client.rxBytes);
+    }
+    else if (key == "tx bytes")
+    {
+        assignUnsigned(value, client.txBytes);
+    }
+    else if (key == "rx packets")
+    {
+        assignUnsigned(value, client.rxPackets);
+    }
+    else if (key == "tx packets")
+    {
+        assignUnsigned(value, client.txPackets);
+    }
+    else if (key == "tx retries")
+    {
+        assignUnsigned(value, client.txRetries);
+    }
+    else if (key == "tx failed")
+    {
+        assignUnsigned(value, client.txFailed);
+    }
+    else if (key == "beacon loss")
+    {
+        assignUnsigned(value, client.beaconLoss);
+    }
+    else if (key == "tx bitrate")
+    {
+        // "866.7 MBit/s VHT-MCS 9 80MHz short GI VHT-NSS 2"
+        if (value.toScaled(number, 1000))
+        {
+            client.txBitrateKbps = number;
+        }
+    }
+    else if (key == "rx bitrate")
+    {
+        if (value.toScaled(number, 1000))
+        {
+            client.rxBitrateKbps = number;
+        }
+    }
+    else if (key == "expected throughput")
+    {
+        // "433.0Mbps"
+        if (value.toScaled(number, 1000))
+        {
+            client.expectedThroughputKbps = number;
+        }
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef IW_STATION_PARSER_H
+#define IW_STATION_PARSER_H
+
+#include <string>
+#include <vector>
+#include "TextView.h"
+#include "WifiTypes.h"
+
+/*
+ * iw dev <if> station dump 文本输出解析器
+ * 与IwScanParser共用TextView分词, 单次遍历按 "键: 值" 原地拆分, 不使用正则;
+ * 解析过程中不分配内存(结果数组扩容除外)
+ */
+class IwStationParser
+{
+public:
+    /**
+     * 解析全部客户端
+     * @param output station dump输出
+     * @param clients 追加解析结果(IP地址和主机名不填写)
+     * @return 解析出的客户端数量
+     */
+    static size_t parse(const std::string &output, std::vector<ClientInfo> &clients);
+
+    /**
+     * 解析一个 "键: 值" 字段并写入client
+     * @param key 字段名(如 "tx bytes")
+     * @param value 字段值(如 "1234")
+     * @param client 解析结果
+     * @return 字段被识别时返回true
+     */
+    static bool parseField(TextView key, TextView value, ClientInfo &client);
+};
+
+#endif // IW_STATION_PARSER_H
@@ -0,0 +1,349 @@
+#include "LinkMonitor.h"
+#include "TextView.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#ifndef _WIN32
+#include <net/if.h>
+#endif // _WIN32
+
+static_assert(std::is_trivially_copyable<LinkSnapshot>::value, "LinkSnapshot is published word by word");
+
+const int LinkMonitor::kMaxWindowSize;
+const size_t LinkMonitor::kSnapshotWords;
+
+namespace
+{
+/*
+ * 两次累计计数之差换算为每秒次数, 计数回绕或重新关联(变小)时返回false
+ */
+bool counterRate(unsigned long previous, unsigned long current, int64_t elapsedMs, double &rate)
+{
+    if (current < previous || elapsedMs <= 0)
+    {
+        return false;
+    }
+    rate = static_cast<double>(current - previous) * 1000.0 / static_cast<double>(elapsedMs);
+    return true;
+}
+} // namespace
+
+StationLinkSource::StationLinkSource(const std::string &iface, const std::string &socketPath)
+    : iface_(iface), socketPath_(socketPath)
+{
+}
+
+bool StationLinkSource::poll(ClientInfo &station, bool &hasCounters)
+{
+#ifndef _WIN32
+    int ifindex = static_cast<int>(if_nametoindex(iface_.c_str()));
+    if (ifindex != 0 && nl80211_.open() && nl80211_.getStations(ifindex, stations_))
+    {
+        // STA接口上只有关联的AP一个站点, 没有站点即未关联
+        hasCounters = !stations_.empty();
+        if (stations_.empty())
+        {
+            return false;
+        }
+        station = stations_.front();
+        return true;
+    }
+    hasCounters = false;
+    return pollSupplicant(station);
+#else
+    (void)station;
+    hasCounters = false;
+    return false;
+#endif // _WIN32
+}
+
+bool StationLinkSource::pollSupplicant(ClientInfo &station)
+{
+    std::string status;
+    std::string signal;
+    if (!ctrl_.isOpen() && !ctrl_.open(socketPath_))
+    {
+        return false;
+    }
+    if (!ctrl_.request("STATUS", status) || !ctrl_.request("SIGNAL_POLL", signal))
+    {
+        // wpa_supplicant可能已重启, 下次重新连接
+        ctrl_.close();
+        return false;
+    }
+    station = ClientInfo();
+    if (WpaCtrl::getValue(status, "wpa_state") != "COMPLETED" ||
+        !MacAddress::parse(WpaCtrl::getValue(status, "bssid"), station.macAddress))
+    {
+        return false;
+    }
+    // LINKSPEED单位为Mbit/s
+    std::string rssi = WpaCtrl::getValue(signal, "RSSI");
+    std::string linkSpeed = WpaCtrl::getValue(signal, "LINKSPEED");
+    int speed = 0;
+    if (TextView(linkSpeed).toInt(speed))
+    {
+        station.txBitrateKbps = static_cast<long>(speed) * 1000;
+    }
+    return TextView(rssi).toInt(station.signalStrength);
+}
+
+LinkMonitor::LinkMonitor(LinkSource &source, ScanClock &clock)
+    : source_(source), clock_(clock), callback_(nullptr), callbackContext_(nullptr), running_(false),
+      nextSampleMs_(0), windowNext_(), lastCountersMs_(-1), windowSize_(0), published_(0)
+{
+    for (size_t i = 0; i < kSnapshotWords; i++)
+    {
+        words_[i].store(0, std::memory_order_relaxed);
+    }
+    resetStats(static_cast<size_t>(config_.windowSize));
+}
+
+LinkMonitor::~LinkMonitor()
+{
+    stop();
+}
+
+void LinkMonitor::setConfig(const LinkMonitorConfig &config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    config_.sampleIntervalMs = std::max(config_.sampleIntervalMs, 1);
+    config_.ewmaWeight = std::min(std::max(config_.ewmaWeight, 0.001), 1.0);
+    config_.windowSize = std::min(std::max(config_.windowSize, 1), kMaxWindowSize);
+    nextSampleMs_ = std::min(nextSampleMs_, clock_.nowMs() + config_.sampleIntervalMs);
+    wakeup_.notify_all();
+}
+
+LinkMonitorConfig LinkMonitor::getConfig() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+void LinkMonitor::setSampleCallback(SampleCallback callback, void *context)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = callback;
+    callbackContext_ = context;
+}
+
+bool LinkMonitor::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_)
+    {
+        return true;
+    }
+    running_ = true;
+    nextSampleMs_ = clock_.nowMs();
+    thread_ = std::thread(&LinkMonitor::run, this);
+    return true;
+}
+
+void LinkMonitor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        running_ = false;
+        wakeup_.notify_all();
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool LinkMonitor::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+void LinkMonitor::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_)
+    {
+        int64_t waitMs = nextSampleMs_ - clock_.nowMs();
+        if (waitMs > 0)
+        {
+            wakeup_.wait_for(lock, std::chrono::milliseconds(waitMs));
+            continue;
+        }
+        lock.unlock();
+        tick();
+        lock.lock();
+    }
+}
+
+void LinkMonitor::resetStats(size_t windowSize)
+{
+    for (int metric = 0; metric < LINK_METRIC_COUNT; metric++)
+    {
+        current_.metrics[metric] = LinkMetricStats();
+        windows_[metric].clear();
+        windows_[metric].reserve(windowSize);
+        windowNext_[metric] = 0;
+    }
+    scratch_.reserve(windowSize);
+    lastCountersMs_ = -1;
+    windowSize_ = windowSize;
+}
+
+void LinkMonitor::addSample(int metric, double value, double ewmaWeight)
+{
+    LinkMetricStats &stats = current_.metrics[metric];
+    if (stats.samples == 0)
+    {
+        stats.ewma = stats.min = stats.max = value;
+    }
+    else
+    {
+        stats.ewma += ewmaWeight * (value - stats.ewma);
+        stats.min = std::min(stats.min, value);
+        stats.max = std::max(stats.max, value);
+    }
+    stats.last = value;
+    stats.samples++;
+
+    std::vector<double> &window = windows_[metric];
+    if (window.size() < windowSize_)
+    {
+        window.push_back(value);
+    }
+    else
+    {
+        window[windowNext_[metric]] = value;
+    }
+    windowNext_[metric] = (windowNext_[metric] + 1) % windowSize_;
+
+    // 先定位中位数, 再分别在两侧定位p10/p90
+    scratch_.assign(window.begin(), window.end());
+    size_t last = scratch_.size() - 1;
+    size_t middle = last / 2;
+    size_t low = last / 10;
+    size_t high = last - last / 10;
+    std::nth_element(scratch_.begin(), scratch_.begin() + middle, scratch_.end());
+    std::nth_element(scratch_.begin(), scratch_.begin() + low, scratch_.begin() + middle);
+    if (high > middle)
+    {
+        std::nth_element(scratch_.begin() + middle + 1, scratch_.begin() + high, scratch_.end());
+    }
+    stats.p50 = scratch_[middle];
+    stats.p10 = low < middle ? scratch_[low] : stats.p50;
+    stats.p90 = high > middle ? scratch_[high] : stats.p50;
+}
+
+bool LinkMonitor::tick()
+{
+    std::lock_guard<std::mutex> tickLock(tickMutex_);
+    int64_t nowMs = clock_.nowMs();
+    LinkMonitorConfig config;
+    SampleCallback callback;
+    void *callbackContext;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (nowMs < nextSampleMs_)
+        {
+            return false;
+        }
+        nextSampleMs_ = nowMs + config_.sampleIntervalMs;
+        config = config_;
+        callback = callback_;
+        callbackContext = callbackContext_;
+    }
+
+    ClientInfo station;
+    bool hasCounters = false;
+    bool associated = source_.poll(station, hasCounters);
+    size_t windowSize = static_cast<size_t>(config.windowSize);
+    if (!associated || station.macAddress != current_.bssid || windowSize != windowSize_)
+    {
+        // 换了AP(漫游/重连)或断开, 之前的统计不再代表当前链路
+        resetStats(windowSize);
+    }
+    current_.sequence++;
+    current_.timestampMs = nowMs;
+    current_.associated = associated;
+    current_.bssid = associated ? station.macAddress : MacAddress();
+    if (associated)
+    {
+        addSample(LINK_SIGNAL, station.signalStrength, config.ewmaWeight);
+        if (station.txBitrateKbps > 0)
+        {
+            addSample(LINK_TX_BITRATE, station.txBitrateKbps / 1000.0, config.ewmaWeight);
+        }
+        if (hasCounters)
+        {
+            double rate = 0;
+            int64_t elapsedMs = nowMs - lastCountersMs_;
+            if (lastCountersMs_ >= 0 && counterRate(lastStation_.txRetries, station.txRetries, elapsedMs, rate))
+            {
+                addSample(LINK_TX_RETRIES, rate, config.ewmaWeight);
+            }
+            if (lastCountersMs_ >= 0 && counterRate(lastStation_.beaconLoss, station.beaconLoss, elapsedMs, rate))
+            {
+                addSample(LINK_BEACON_LOSS, rate, config.ewmaWeight);
+            }
+            lastStation_ = station;
+            lastCountersMs_ = nowMs;
+        }
+    }
+    publish(current_);
+    if (callback)
+    {
+        callback(current_, callbackContext);
+    }
+    return true;
+}
+
+void LinkMonitor::publish(const LinkSnapshot &snapshot)
+{
+    uint64_t words[kSnapshotWords] = {};
+    memcpy(words, &snapshot, sizeof(snapshot));
+    uint64_t sequence = published_.load(std::memory_order_relaxed);
+    published_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kSnapshotWords; i++)
+    {
+        words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    published_.store(sequence + 2, std::memory_order_release);
+}
+
+bool LinkMonitor::snapshot(LinkSnapshot &snapshot) const
+{
+    uint64_t words[kSnapshotWords];
+    while (true)
+    {
+        uint64_t before = published_.load(std::memory_order_acquire);
+        if (before == 0)
+        {
+            snapshot = LinkSnapshot();
+            return false;
+        }
+        if (before & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < kSnapshotWords; i++)
+        {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (published_.load(std::memory_order_relaxed) == before)
+        {
+            break;
+        }
+    }
+    memcpy(&snapshot, words, sizeof(snapshot));
+    return true;
+}
@@ -0,0 +1,201 @@
+#ifndef LINK_MONITOR_H
+#define LINK_MONITOR_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include "WifiTypes.h"
+#include "Nl80211.h"
+#include "ScanService.h"
+#include "WpaCtrl.h"
+
+/*
+ * 当前关联AP的站点信息来源.
+ * 由监测线程调用, 实现不能与其他线程共用套接字或控制连接
+ */
+class LinkSource
+{
+public:
+    virtual ~LinkSource() {}
+
+    /**
+     * 读取一次站点信息
+     * @param station 对端AP的信号/速率/累计计数(macAddress为BSSID)
+     * @param hasCounters 累计计数(发送包数/重传/信标丢失)是否有效
+     * @return 已关联返回true
+     */
+    virtual bool poll(ClientInfo &station, bool &hasCounters) = 0;
+};
+
+/*
+ * 优先通过nl80211 NL80211_CMD_GET_STATION读取(一次netlink往返, 不启动进程),
+ * 内核不支持时回退到wpa_supplicant的SIGNAL_POLL(只有信号和速率, 没有累计计数)
+ */
+class StationLinkSource : public LinkSource
+{
+public:
+    StationLinkSource(const std::string &iface, const std::string &socketPath);
+
+    bool poll(ClientInfo &station, bool &hasCounters) override;
+
+private:
+    std::string iface_;
+    std::string socketPath_;
+    Nl80211 nl80211_;
+    WpaCtrl ctrl_;
+    std::vector<ClientInfo> stations_; // 复用的导出缓冲
+
+    bool pollSupplicant(ClientInfo &station);
+
+    StationLinkSource(const StationLinkSource &);
+    StationLinkSource &operator=(const StationLinkSource &);
+};
+
+// 监测的链路指标, 用作LinkSnapshot::metrics的下标
+enum LinkMetric
+{
+    LINK_SIGNAL,      // 信号强度(dBm)
+    LINK_TX_BITRATE,  // 发送速率(Mbit/s)
+    LINK_TX_RETRIES,  // 每秒重传次数(由累计计数求差)
+    LINK_BEACON_LOSS, // 每秒信标丢失次数(由累计计数求差)
+    LINK_METRIC_COUNT
+};
+
+// 一个指标的平滑统计, 关联的AP变化时重新开始
+struct LinkMetricStats
+{
+    uint32_t samples; // 自重新开始以来的样本数, 0表示没有数据
+    double last;
+    double ewma; // 指数加权移动平均
+    double min;
+    double max;
+    double p10; // 最近windowSize个样本的百分位数
+    double p50;
+    double p90;
+
+    LinkMetricStats() : samples(0), last(0), ewma(0), min(0), max(0), p10(0), p50(0), p90(0) {}
+};
+
+// 监测结果快照, 可平凡复制
+struct LinkSnapshot
+{
+    uint64_t sequence;   // 采样序号, 0表示尚未采样
+    int64_t timestampMs; // 采样时间(ScanClock)
+    bool associated;
+    MacAddress bssid;
+    LinkMetricStats metrics[LINK_METRIC_COUNT];
+
+    LinkSnapshot() : sequence(0), timestampMs(0), associated(false) {}
+};
+
+struct LinkMonitorConfig
+{
+    int sampleIntervalMs; // 采样间隔
+    double ewmaWeight;    // 新样本在EWMA中的权重(0-1]
+    int windowSize;       // 百分位数窗口的样本数
+
+    LinkMonitorConfig() : sampleIntervalMs(100), ewmaWeight(0.2), windowSize(50) {}
+};
+
+/*
+ * 高频链路质量采样
+ * 按配置的间隔经LinkSource读取站点信息, 为信号、发送速率、重传和信标丢失维护EWMA、最小/最大值和
+ * 最近windowSize个样本的百分位数. 统计在采样线程中算好后以序号锁发布, snapshot()不加锁、不做I/O,
+ * 界面和决策逻辑可以随时读取. start()启动后台线程; 也可以配合VirtualScanClock调用tick()驱动
+ */
+class LinkMonitor
+{
+public:
+    static const int kMaxWindowSize = 1024;
+
+    /*
+     * 每次采样发布快照后在采样线程中调用, 不能调用LinkMonitor的接口
+     */
+    typedef void (*SampleCallback)(const LinkSnapshot &snapshot, void *context);
+
+    LinkMonitor(LinkSource &source, ScanClock &clock);
+    ~LinkMonitor();
+
+    void setConfig(const LinkMonitorConfig &config);
+    LinkMonitorConfig getConfig() const;
+
+    /**
+     * 设置采样回调(例如把样本写入MetricStore)
+     * @param callback 回调, 为nullptr时取消
+     * @param context 传给回调的上下文
+     */
+    void setSampleCallback(SampleCallback callback, void *context);
+
+    /**
+     * 启动后台采样线程
+     * @return 成功返回true
+     */
+    bool start();
+
+    /**
+     * 停止后台线程(等待正在进行的采样结束), 快照保留
+     */
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * 到达采样时间时采样一次并发布快照
+     * @return 进行了采样返回true
+     */
+    bool tick();
+
+    /**
+     * 读取最近发布的快照(无锁, 写者正在发布时重试)
+     * @param snapshot 快照
+     * @return 已有采样返回true
+     */
+    bool snapshot(LinkSnapshot &snapshot) const;
+
+private:
+    static const size_t kSnapshotWords = (sizeof(LinkSnapshot) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    LinkSource &source_;
+    ScanClock &clock_;
+    LinkMonitorConfig config_;
+    SampleCallback callback_;
+    void *callbackContext_;
+
+    mutable std::mutex mutex_; // 保护配置、回调和调度状态
+    std::mutex tickMutex_;     // 串行化采样, 保护下面的统计状态
+    std::condition_variable wakeup_;
+    std::thread thread_;
+    bool running_;
+    int64_t nextSampleMs_;
+
+    LinkSnapshot current_;                             // 采样线程维护的统计
+    std::vector<double> windows_[LINK_METRIC_COUNT];   // 各指标最近的样本(环形)
+    size_t windowNext_[LINK_METRIC_COUNT];             // 下一个写入位置
+    std::vector<double> scratch_;                      // 计算百分位数的缓冲
+    ClientInfo lastStation_;                           // 上一次的累计计数
+    int64_t lastCountersMs_;                           // 上一次累计计数的采样时间, -1表示没有
+    size_t windowSize_;                                // 当前窗口大小(配置变化时重新开始)
+
+    // 序号锁: 奇数表示正在写入
+    std::atomic<uint64_t> published_;
+    std::atomic<uint64_t> words_[kSnapshotWords];
+
+    void run();
+    /*
+     * 重新开始统计(关联的AP或窗口大小变化时), 调用时持有tickMutex_
+     */
+    void resetStats(size_t windowSize);
+    /*
+     * 加入一个样本并更新统计, 调用时持有tickMutex_
+     */
+    void addSample(int metric, double value, double ewmaWeight);
+    void publish(const LinkSnapshot &snapshot);
+
+    LinkMonitor(const LinkMonitor &);
+    LinkMonitor &operator=(const LinkMonitor &);
+};
+
+#endif // LINK_MONITOR_H
@@ -0,0 +1,194 @@
+#ifndef MAC_ADDRESS_H
+#define MAC_ADDRESS_H
+
+#include <string>
+#include <ostream>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * 48位MAC/蓝牙设备地址
+ * 以uint64_t保存(高16位为0), 可平凡复制, 比较和哈希都是整数运算;
+ * 解析不使用正则也不分配内存, 只在需要输出文本时格式化
+ */
+class MacAddress
+{
+public:
+    static const size_t kTextLength = 17; // "aa:bb:cc:dd:ee:ff"
+
+    constexpr MacAddress() : value_(0) {}
+    constexpr explicit MacAddress(uint64_t value) : value_(value & 0xffffffffffffULL) {}
+
+    /**
+     * 由6字节构造(网络字节序, 如netlink属性中的地址)
+     * @param bytes 地址字节
+     * @return 地址
+     */
+    static MacAddress fromBytes(const uint8_t *bytes)
+    {
+        uint64_t value = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            value = (value << 8) | bytes[i];
+        }
+        return MacAddress(value);
+    }
+
+    /**
+     * 解析 "aa:bb:cc:dd:ee:ff" 或 "AA-BB-CC-DD-EE-FF" 格式的地址(大小写均可)
+     * @param text 地址文本
+     * @param length 文本长度(必须为17)
+     * @param address 解析结果
+     * @return 格式正确返回true
+     */
+    static bool parse(const char *text, size_t length, MacAddress &address)
+    {
+        if (length != kTextLength)
+        {
+            return false;
+        }
+        char separator = text[2];
+        if (separator != ':' && separator != '-')
+        {
+            return false;
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < kTextLength; i += 3)
+        {
+            int high = hexValue(text[i]);
+            int low = hexValue(text[i + 1]);
+            if (high < 0 || low < 0 || (i + 2 < kTextLength && text[i + 2] != separator))
+            {
+                return false;
+            }
+            value = (value << 8) | static_cast<uint64_t>(high << 4 | low);
+        }
+        address = MacAddress(value);
+        return true;
+    }
+
+    static bool parse(const std::string &text, MacAddress &address)
+    {
+        return parse(text.data(), text.size(), address);
+    }
+
+    /**
+     * 解析地址, 格式错误时返回全零地址
+     * @param text 地址文本
+     * @return 地址
+     */
+    static MacAddress fromString(const std::string &text)
+    {
+        MacAddress address;
+        parse(text, address);
+        return address;
+    }
+
+    constexpr uint64_t value() const { return value_; }
+
+    /**
+     * 第index个字节(0为最高字节, 即文本中的第一段)
+     */
+    constexpr uint8_t octet(int index) const
+    {
+        return static_cast<uint8_t>(value_ >> (8 * (5 - index)));
+    }
+
+    constexpr bool isZero() const { return value_ == 0; }
+    constexpr bool isBroadcast() const { return value_ == 0xffffffffffffULL; }
+    constexpr bool isMulticast() const { return (octet(0) & 0x01) != 0; }
+    constexpr bool isLocallyAdministered() const { return (octet(0) & 0x02) != 0; }
+
+    /**
+     * 格式化文本中第pos个字符(编译期可求值)
+     * @param pos 字符位置(0-16)
+     * @param upperCase 是否使用大写十六进制
+     * @return 字符
+     */
+    constexpr char charAt(size_t pos, bool upperCase = false) const
+    {
+        return pos % 3 == 2 ? ':'
+                            : hexDigit((pos % 3 == 0 ? octet(static_cast<int>(pos / 3)) >> 4
+                                                     : octet(static_cast<int>(pos / 3)) & 0x0f),
+                                       upperCase);
+    }
+
+    /**
+     * 格式化到缓冲区(不分配内存)
+     * @param buffer 至少18字节, 以'\0'结尾
+     * @param upperCase 是否使用大写十六进制(bluetoothctl输出为大写, iw/内核为小写)
+     */
+    void format(char *buffer, bool upperCase = false) const
+    {
+        for (size_t pos = 0; pos < kTextLength; pos++)
+        {
+            buffer[pos] = charAt(pos, upperCase);
+        }
+        buffer[kTextLength] = '\0';
+    }
+
+    std::string toString(bool upperCase = false) const
+    {
+        char buffer[kTextLength + 1];
+        format(buffer, upperCase);
+        return std::string(buffer, kTextLength);
+    }
+
+    constexpr bool operator==(const MacAddress &other) const { return value_ == other.value_; }
+    constexpr bool operator!=(const MacAddress &other) const { return value_ != other.value_; }
+    constexpr bool operator<(const MacAddress &other) const { return value_ < other.value_; }
+    constexpr bool operator>(const MacAddress &other) const { return value_ > other.value_; }
+    constexpr bool operator<=(const MacAddress &other) const { return value_ <= other.value_; }
+    constexpr bool operator>=(const MacAddress &other) const { return value_ >= other.value_; }
+
+private:
+    uint64_t value_;
+
+    static constexpr char hexDigit(unsigned int value, bool upperCase)
+    {
+        return static_cast<char>(value < 10 ? '0' + value : (upperCase ? 'A' : 'a') + value - 10);
+    }
+
+    static int hexValue(char c)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            return c - '0';
+        }
+        if (c >= 'a' && c <= 'f')
+        {
+            return c - 'a' + 10;
+        }
+        if (c >= 'A' && c <= 'F')
+        {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+};
+
+static_assert(std::is_trivially_copyable<MacAddress>::value, "MacAddress must stay trivially copyable");
+static_assert(MacAddress(0x5cf370a1b2c3ULL).charAt(15) == 'c', "MacAddress formatting must be constexpr");
+
+inline std::ostream &operator<<(std::ostream &stream, const MacAddress &address)
+{
+    return stream << address.toString();
+}
+
+namespace std
+{
+template <>
+struct hash<MacAddress>
+{
+    size_t operator()(const MacAddress &address) const
+    {
+        // 乘法散列, 让厂商前缀相同的地址也能均匀分布
+        uint64_t value = address.value() * 0x9e3779b97f4a7c15ULL;
+        return static_cast<size_t>(value ^ (value >> 32));
+    }
+};
+} // namespace std
+
+#endif // MAC_ADDRESS_H
@@ -0,0 +1,768 @@
+#include "MetricStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif // _WIN32
+
+const size_t MetricStore::kBlockBytes;
+const size_t MetricStore::kMaxNameLength;
+const size_t MetricStore::kMaxSeries;
+
+namespace
+{
+const uint32_t kBlockMagic = 0x3153544d; // "MTS1"
+const uint16_t kBlockVersion = 1;
+
+/*
+ * 块头, 原样保存在内存块和文件槽位的开头
+ */
+struct BlockHeader
+{
+    uint32_t magic; // 写完块内容后才写入, 未使用或写了一半的槽位不是kBlockMagic
+    uint16_t version;
+    uint16_t nameLength;
+    char name[MetricStore::kMaxNameLength];
+    uint64_t sequence; // 封存顺序, 恢复时据此找到最旧的槽位
+    int64_t firstMs;
+    int64_t lastMs;
+    uint32_t count;
+    uint32_t bits; // 已写入的数据位数
+    double min;
+    double max;
+    double sum;
+};
+
+const size_t kHeaderBytes = sizeof(BlockHeader);
+const uint32_t kDataBits = static_cast<uint32_t>((MetricStore::kBlockBytes - kHeaderBytes) * 8);
+
+static_assert(sizeof(BlockHeader) == 128, "block header layout is stored on disk");
+
+BlockHeader readHeader(const uint8_t *block)
+{
+    BlockHeader header;
+    memcpy(&header, block, sizeof(header));
+    return header;
+}
+
+void writeHeader(uint8_t *block, const BlockHeader &header)
+{
+    memcpy(block, &header, sizeof(header));
+}
+
+/*
+ * 高位在前的位写入器, 写入时覆盖原有的位, 回退位置后可以直接重写
+ */
+class BitWriter
+{
+public:
+    BitWriter(uint8_t *data, uint32_t position, uint32_t capacity)
+        : data_(data), position_(position), capacity_(capacity) {}
+
+    bool write(uint64_t value, int bits)
+    {
+        if (position_ + static_cast<uint32_t>(bits) > capacity_)
+        {
+            return false;
+        }
+        while (bits > 0)
+        {
+            int offset = static_cast<int>(position_ & 7);
+            int room = 8 - offset;
+            int count = std::min(room, bits);
+            uint8_t chunk = static_cast<uint8_t>((value >> (bits - count)) & ((1u << count) - 1));
+            uint8_t mask = static_cast<uint8_t>(((1u << count) - 1) << (room - count));
+            uint8_t &byte = data_[position_ >> 3];
+            byte = static_cast<uint8_t>((byte & ~mask) | (chunk << (room - count)));
+            position_ += static_cast<uint32_t>(count);
+            bits -= count;
+        }
+        return true;
+    }
+
+    uint32_t position() const { return position_; }
+
+private:
+    uint8_t *data_;
+    uint32_t position_;
+    uint32_t capacity_;
+};
+
+class BitReader
+{
+public:
+    BitReader(const uint8_t *data, uint32_t size) : data_(data), position_(0), size_(size) {}
+
+    uint64_t read(int bits)
+    {
+        uint64_t value = 0;
+        while (bits > 0 && position_ < size_)
+        {
+            int offset = static_cast<int>(position_ & 7);
+            int room = 8 - offset;
+            int count = std::min(room, bits);
+            uint8_t byte = data_[position_ >> 3];
+            value = (value << count) | ((byte >> (room - count)) & ((1u << count) - 1));
+            position_ += static_cast<uint32_t>(count);
+            bits -= count;
+        }
+        return value;
+    }
+
+private:
+    const uint8_t *data_;
+    uint32_t position_;
+    uint32_t size_;
+};
+
+uint64_t doubleBits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int leadingZeros(uint64_t value)
+{
+    return value == 0 ? 64 : __builtin_clzll(value);
+}
+
+int trailingZeros(uint64_t value)
+{
+    return value == 0 ? 64 : __builtin_ctzll(value);
+}
+
+/*
+ * 二阶差分按大小分档: 0 -> '0', 其余前缀后跟偏移后的定长值
+ */
+struct DeltaClass
+{
+    uint64_t prefix;
+    int prefixBits;
+    int valueBits;
+    int64_t low;
+    int64_t high;
+};
+
+const DeltaClass kDeltaClasses[] = {
+    {0x2, 2, 7, -63, 64},
+    {0x6, 3, 9, -255, 256},
+    {0xe, 4, 12, -2047, 2048},
+};
+
+/*
+ * 依次解码块中的样本, 对每个样本调用visitor(时间戳, 数值), visitor返回false时停止
+ */
+template <typename Visitor>
+void decodeBlock(const uint8_t *block, Visitor visitor)
+{
+    BlockHeader header = readHeader(block);
+    if (header.count == 0)
+    {
+        return;
+    }
+    BitReader reader(block + kHeaderBytes, header.bits);
+    int64_t timestamp = header.firstMs;
+    int64_t delta = 0;
+    uint64_t bits = reader.read(64);
+    int leading = 0;
+    int trailing = 0;
+    if (!visitor(timestamp, bitsDouble(bits)))
+    {
+        return;
+    }
+    for (uint32_t i = 1; i < header.count; i++)
+    {
+        int64_t deltaOfDelta = 0;
+        if (reader.read(1) != 0)
+        {
+            bool matched = false;
+            for (const auto &entry : kDeltaClasses)
+            {
+                if (reader.read(1) == 0)
+                {
+                    deltaOfDelta = static_cast<int64_t>(reader.read(entry.valueBits)) + entry.low;
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched)
+            {
+                deltaOfDelta = static_cast<int64_t>(reader.read(64));
+            }
+        }
+        delta += deltaOfDelta;
+        timestamp += delta;
+
+        if (reader.read(1) != 0)
+        {
+            if (reader.read(1) != 0)
+            {
+                leading = static_cast<int>(reader.read(5));
+                int meaningful = static_cast<int>(reader.read(6));
+                trailing = 64 - leading - (meaningful == 0 ? 64 : meaningful);
+            }
+            int meaningful = 64 - leading - trailing;
+            bits ^= reader.read(meaningful) << trailing;
+        }
+        if (!visitor(timestamp, bitsDouble(bits)))
+        {
+            return;
+        }
+    }
+}
+
+/*
+ * 把一个桶的统计合并到按时间排序的桶列表末尾
+ */
+void mergeBucket(std::vector<MetricBucket> &buckets, int64_t startMs, uint32_t count, double min, double max,
+                 double sum)
+{
+    if (buckets.empty() || buckets.back().startMs != startMs)
+    {
+        MetricBucket bucket;
+        bucket.startMs = startMs;
+        bucket.min = min;
+        bucket.max = max;
+        buckets.push_back(bucket);
+    }
+    MetricBucket &bucket = buckets.back();
+    bucket.count += count;
+    bucket.min = std::min(bucket.min, min);
+    bucket.max = std::max(bucket.max, max);
+    bucket.sum += sum;
+}
+
+int64_t bucketStart(int64_t timestampMs, int64_t fromMs, int64_t bucketMs)
+{
+    return fromMs + (timestampMs - fromMs) / bucketMs * bucketMs;
+}
+} // namespace
+
+MetricStore::MetricStore()
+    : memoryLimit_(0), nextSequence_(1), appended_(0), rejected_(0), dropped_(0), fd_(-1), map_(nullptr),
+      slotCount_(0), nextSlot_(0)
+{
+    memoryLimit_ = std::max<size_t>(config_.memoryBytes / kBlockBytes, 1);
+}
+
+MetricStore::~MetricStore()
+{
+    close();
+}
+
+bool MetricStore::open(const MetricStoreConfig &config)
+{
+    close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    memoryLimit_ = std::max<size_t>(config_.memoryBytes / kBlockBytes, 1);
+    if (config_.spillPath.empty())
+    {
+        return true;
+    }
+#ifndef _WIN32
+    slotCount_ = config_.spillBytes / kBlockBytes;
+    if (slotCount_ == 0)
+    {
+        return true;
+    }
+    fd_ = ::open(config_.spillPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    size_t length = slotCount_ * kBlockBytes;
+    // 文件比上限大时截断(丢弃后面槽位中的块), 小时扩展为稀疏文件
+    if (fd_ < 0 || ftruncate(fd_, static_cast<off_t>(length)) != 0)
+    {
+        std::cout << "Failed to open metric spill file: " << config_.spillPath << std::endl;
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        slotCount_ = 0;
+        return false;
+    }
+    void *map = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED)
+    {
+        std::cout << "Failed to map metric spill file: " << config_.spillPath << std::endl;
+        ::close(fd_);
+        fd_ = -1;
+        slotCount_ = 0;
+        return false;
+    }
+    map_ = static_cast<uint8_t *>(map);
+    slotOwner_.assign(slotCount_, -1);
+    recover();
+    return true;
+#else
+    slotCount_ = 0;
+    return false;
+#endif // _WIN32
+}
+
+void MetricStore::recover()
+{
+    std::vector<std::pair<uint64_t, size_t>> found;
+    for (size_t slot = 0; slot < slotCount_; slot++)
+    {
+        BlockHeader header = readHeader(map_ + slot * kBlockBytes);
+        if (header.magic == kBlockMagic && header.version == kBlockVersion && header.nameLength > 0 &&
+            header.nameLength <= kMaxNameLength && header.count > 0 && header.bits <= kDataBits)
+        {
+            found.push_back(std::make_pair(header.sequence, slot));
+        }
+    }
+    std::sort(found.begin(), found.end());
+    for (const auto &entry : found)
+    {
+        const uint8_t *block = map_ + entry.second * kBlockBytes;
+        BlockHeader header = readHeader(block);
+        std::string name(header.name, header.nameLength);
+        int index = findSeries(name);
+        if (index < 0)
+        {
+            index = createSeries(name);
+        }
+        if (index < 0)
+        {
+            continue;
+        }
+        Series &series = series_[index];
+        BlockRef ref;
+        ref.sequence = entry.first;
+        ref.slot = static_cast<int>(entry.second);
+        series.blocks.push_back(ref);
+        series.lastMs = header.lastMs;
+        series.hasSamples = true;
+        slotOwner_[entry.second] = index;
+        nextSequence_ = entry.first + 1;
+        nextSlot_ = (entry.second + 1) % slotCount_;
+    }
+}
+
+void MetricStore::close()
+{
+    flush();
+    std::lock_guard<std::mutex> lock(mutex_);
+#ifndef _WIN32
+    if (map_)
+    {
+        munmap(map_, slotCount_ * kBlockBytes);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif // _WIN32
+    series_.clear();
+    index_.clear();
+    memoryOrder_.clear();
+    slotOwner_.clear();
+    slotCount_ = 0;
+    nextSlot_ = 0;
+}
+
+void MetricStore::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < series_.size(); i++)
+    {
+        if (!series_[i].active.empty())
+        {
+            seal(static_cast<int>(i));
+        }
+    }
+    if (map_)
+    {
+        while (!memoryOrder_.empty())
+        {
+            spillOldest();
+        }
+#ifndef _WIN32
+        msync(map_, slotCount_ * kBlockBytes, MS_ASYNC);
+#endif // _WIN32
+    }
+}
+
+int MetricStore::findSeries(const std::string &name) const
+{
+    auto it = index_.find(name);
+    return it == index_.end() ? -1 : it->second;
+}
+
+int MetricStore::createSeries(const std::string &name)
+{
+    if (name.empty() || name.size() > kMaxNameLength || series_.size() >= kMaxSeries)
+    {
+        return -1;
+    }
+    Series series;
+    series.name = name;
+    series_.push_back(series);
+    int index = static_cast<int>(series_.size() - 1);
+    index_[name] = index;
+    return index;
+}
+
+int MetricStore::series(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    int index = findSeries(name);
+    return index >= 0 ? index : createSeries(name);
+}
+
+bool MetricStore::append(const std::string &name, int64_t timestampMs, double value)
+{
+    return append(series(name), timestampMs, value);
+}
+
+bool MetricStore::append(int index, int64_t timestampMs, double value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index < 0 || static_cast<size_t>(index) >= series_.size())
+    {
+        return false;
+    }
+    Series &series = series_[index];
+    if (series.hasSamples && timestampMs < series.lastMs)
+    {
+        rejected_++;
+        return false;
+    }
+
+    uint64_t bits = doubleBits(value);
+    for (int attempt = 0; attempt < 2; attempt++)
+    {
+        if (series.active.empty())
+        {
+            // 新块: 第一个样本的时间戳在块头中, 数值原样写入
+            series.active.assign(kBlockBytes, 0);
+            BlockHeader header = BlockHeader();
+            header.magic = kBlockMagic;
+            header.version = kBlockVersion;
+            header.nameLength = static_cast<uint16_t>(series.name.size());
+            memcpy(header.name, series.name.data(), series.name.size());
+            header.firstMs = header.lastMs = timestampMs;
+            header.count = 1;
+            header.min = header.max = header.sum = value;
+            BitWriter writer(series.active.data() + kHeaderBytes, 0, kDataBits);
+            writer.write(bits, 64);
+            header.bits = writer.position();
+            writeHeader(series.active.data(), header);
+            series.encoder = Encoder();
+            series.encoder.previousMs = timestampMs;
+            series.encoder.previousBits = bits;
+            break;
+        }
+
+        BlockHeader header = readHeader(series.active.data());
+        Encoder encoder = series.encoder;
+        BitWriter writer(series.active.data() + kHeaderBytes, header.bits, kDataBits);
+        int64_t delta = timestampMs - encoder.previousMs;
+        int64_t deltaOfDelta = delta - encoder.previousDelta;
+        bool ok = true;
+        if (deltaOfDelta == 0)
+        {
+            ok = writer.write(0, 1);
+        }
+        else
+        {
+            bool written = false;
+            for (const auto &entry : kDeltaClasses)
+            {
+                if (deltaOfDelta >= entry.low && deltaOfDelta <= entry.high)
+                {
+                    ok = writer.write(entry.prefix, entry.prefixBits) &&
+                         writer.write(static_cast<uint64_t>(deltaOfDelta - entry.low), entry.valueBits);
+                    written = true;
+                    break;
+                }
+            }
+            if (!written)
+            {
+                ok = writer.write(0xf, 4) && writer.write(static_cast<uint64_t>(deltaOfDelta), 64);
+            }
+        }
+
+        uint64_t xorBits = bits ^ encoder.previousBits;
+        if (ok && xorBits == 0)
+        {
+            ok = writer.write(0, 1);
+        }
+        else if (ok)
+        {
+            int leading = std::min(leadingZeros(xorBits), 31);
+            int trailing = trailingZeros(xorBits);
+            if (encoder.leading >= 0 && leading >= encoder.leading && trailing >= encoder.trailing)
+            {
+                // 有效位落在上一个XOR的窗口内, 沿用窗口
+                int meaningful = 64 - encoder.leading - encoder.trailing;
+                ok = writer.write(0x2, 2) && writer.write(xorBits >> encoder.trailing, meaningful);
+            }
+            else
+            {
+                int meaningful = 64 - leading - trailing;
+                ok = writer.write(0x3, 2) && writer.write(static_cast<uint64_t>(leading), 5) &&
+                     writer.write(static_cast<uint64_t>(meaningful & 0x3f), 6) &&
+                     writer.write(xorBits >> trailing, meaningful);
+                encoder.leading = leading;
+                encoder.trailing = trailing;
+            }
+        }
+
+        if (!ok)
+        {
+            // 块已满, 未提交的位会在新块中重写
+            seal(index);
+            continue;
+        }
+        encoder.previousDelta = delta;
+        encoder.previousMs = timestampMs;
+        encoder.previousBits = bits;
+        series.encoder = encoder;
+        header.bits = writer.position();
+        header.count++;
+        header.lastMs = timestampMs;
+        header.min = std::min(header.min, value);
+        header.max = std::max(header.max, value);
+        header.sum += value;
+        writeHeader(series.active.data(), header);
+        break;
+    }
+    series.lastMs = timestampMs;
+    series.hasSamples = true;
+    appended_++;
+    return true;
+}
+
+void MetricStore::seal(int index)
+{
+    Series &series = series_[index];
+    series.blocks.push_back(BlockRef());
+    BlockRef &block = series.blocks.back();
+    block.sequence = nextSequence_++;
+    BlockHeader header = readHeader(series.active.data());
+    header.sequence = block.sequence;
+    writeHeader(series.active.data(), header);
+    block.bytes.swap(series.active);
+    memoryOrder_.push_back(std::make_pair(index, block.sequence));
+    while (memoryOrder_.size() > memoryLimit_)
+    {
+        spillOldest();
+    }
+}
+
+void MetricStore::spillOldest()
+{
+    std::pair<int, uint64_t> oldest = memoryOrder_.front();
+    memoryOrder_.pop_front();
+    Series &series = series_[oldest.first];
+    auto it = std::find_if(series.blocks.begin(), series.blocks.end(),
+                           [&oldest](const BlockRef &block)
+                           {
+                               return block.sequence == oldest.second;
+                           });
+    if (it == series.blocks.end())
+    {
+        return;
+    }
+    if (!map_)
+    {
+        // 没有转存文件, 文件中也就没有更旧的块, 它是该序列最前面的块
+        series.blocks.erase(it);
+        dropped_++;
+        return;
+    }
+
+    size_t slot = nextSlot_;
+    nextSlot_ = (nextSlot_ + 1) % slotCount_;
+    int owner = slotOwner_[slot];
+    if (owner >= 0)
+    {
+        // 覆盖的是文件中最旧的块, 即其所属序列最前面的块
+        std::deque<BlockRef> &ownerBlocks = series_[owner].blocks;
+        if (!ownerBlocks.empty() && ownerBlocks.front().slot == static_cast<int>(slot))
+        {
+            ownerBlocks.pop_front();
+        }
+        dropped_++;
+    }
+    // 先写内容再写块头, 写到一半中断时该槽位不会被当作有效块恢复
+    uint8_t *target = map_ + slot * kBlockBytes;
+    uint32_t magic = 0;
+    memcpy(target, &magic, sizeof(magic));
+    memcpy(target + sizeof(magic), it->bytes.data() + sizeof(magic), kBlockBytes - sizeof(magic));
+    memcpy(target, it->bytes.data(), sizeof(magic));
+    slotOwner_[slot] = oldest.first;
+    it->slot = static_cast<int>(slot);
+    std::vector<uint8_t>().swap(it->bytes);
+}
+
+const uint8_t *MetricStore::blockData(const BlockRef &block) const
+{
+    return block.slot >= 0 ? map_ + static_cast<size_t>(block.slot) * kBlockBytes : block.bytes.data();
+}
+
+template <typename Visitor>
+void MetricStore::forEachBlock(const Series &series, int64_t fromMs, int64_t toMs, Visitor visitor) const
+{
+    // 块按时间排序, 用块头的时间范围跳过不相交的块
+    for (const auto &block : series.blocks)
+    {
+        const uint8_t *data = blockData(block);
+        BlockHeader header = readHeader(data);
+        if (header.firstMs > toMs)
+        {
+            return;
+        }
+        if (header.lastMs >= fromMs)
+        {
+            visitor(data, header);
+        }
+    }
+    if (!series.active.empty())
+    {
+        BlockHeader header = readHeader(series.active.data());
+        if (header.lastMs >= fromMs && header.firstMs <= toMs)
+        {
+            visitor(series.active.data(), header);
+        }
+    }
+}
+
+size_t MetricStore::query(const std::string &name, int64_t fromMs, int64_t toMs, std::vector<MetricPoint> &points) const
+{
+    points.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    int index = findSeries(name);
+    if (index < 0)
+    {
+        return 0;
+    }
+    forEachBlock(series_[index], fromMs, toMs, [&](const uint8_t *block, const BlockHeader &header)
+                 {
+        (void)header;
+        decodeBlock(block, [&](int64_t timestampMs, double value)
+                    {
+            if (timestampMs > toMs)
+            {
+                return false;
+            }
+            if (timestampMs >= fromMs)
+            {
+                points.push_back(MetricPoint(timestampMs, value));
+            }
+            return true;
+        });
+    });
+    return points.size();
+}
+
+size_t MetricStore::downsample(const std::string &name, int64_t fromMs, int64_t toMs, int64_t bucketMs,
+                               std::vector<MetricBucket> &buckets) const
+{
+    buckets.clear();
+    if (bucketMs <= 0)
+    {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    int index = findSeries(name);
+    if (index < 0)
+    {
+        return 0;
+    }
+    forEachBlock(series_[index], fromMs, toMs, [&](const uint8_t *block, const BlockHeader &header)
+                 {
+        int64_t firstBucket = bucketStart(header.firstMs, fromMs, bucketMs);
+        if (header.firstMs >= fromMs && header.lastMs <= toMs &&
+            firstBucket == bucketStart(header.lastMs, fromMs, bucketMs))
+        {
+            // 整块落在一个桶内, 不用解码
+            mergeBucket(buckets, firstBucket, header.count, header.min, header.max, header.sum);
+            return;
+        }
+        decodeBlock(block, [&](int64_t timestampMs, double value)
+                    {
+            if (timestampMs > toMs)
+            {
+                return false;
+            }
+            if (timestampMs >= fromMs)
+            {
+                mergeBucket(buckets, bucketStart(timestampMs, fromMs, bucketMs), 1, value, value, value);
+            }
+            return true;
+        });
+    });
+    return buckets.size();
+}
+
+void MetricStore::seriesNames(std::vector<std::string> &names) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    names.clear();
+    for (const auto &series : series_)
+    {
+        names.push_back(series.name);
+    }
+}
+
+MetricStoreStats MetricStore::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricStoreStats stats;
+    stats.series = series_.size();
+    stats.droppedBlocks = dropped_;
+    stats.appended = appended_;
+    stats.rejected = rejected_;
+    for (const auto &series : series_)
+    {
+        forEachBlock(series, INT64_MIN, INT64_MAX, [&](const uint8_t *block, const BlockHeader &header)
+                     {
+            (void)block;
+            stats.samples += header.count;
+            stats.encodedBytes += (header.bits + 7) / 8;
+        });
+        for (const auto &block : series.blocks)
+        {
+            if (block.slot >= 0)
+            {
+                stats.spilledBlocks++;
+            }
+            else
+            {
+                stats.memoryBlocks++;
+            }
+        }
+        stats.memoryBlocks += series.active.empty() ? 0 : 1;
+    }
+    return stats;
+}
+
+int64_t MetricStore::nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+std::string MetricStore::seriesName(const char *kind, const MacAddress &address, const char *metric)
+{
+    return std::string(kind) + "/" + address.toString() + "/" + metric;
+}
@@ -0,0 +1,223 @@
+#ifndef METRIC_STORE_H
+#define METRIC_STORE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include "MacAddress.h"
+
+// 一个样本
+struct MetricPoint
+{
+    int64_t timestampMs;
+    double value;
+
+    MetricPoint() : timestampMs(0), value(0) {}
+    MetricPoint(int64_t time, double sample) : timestampMs(time), value(sample) {}
+};
+
+// 降采样的一个时间桶
+struct MetricBucket
+{
+    int64_t startMs;
+    uint32_t count;
+    double min;
+    double max;
+    double sum;
+
+    MetricBucket() : startMs(0), count(0), min(0), max(0), sum(0) {}
+    double mean() const { return count > 0 ? sum / count : 0; }
+};
+
+struct MetricStoreConfig
+{
+    size_t memoryBytes;    // 内存中保留的已封存块上限, 超出后最旧的块转存到文件
+    std::string spillPath; // 转存文件, 为空时直接丢弃最旧的块
+    size_t spillBytes;     // 转存文件大小上限, 写满后覆盖最旧的块
+
+    MetricStoreConfig() : memoryBytes(256 * 1024), spillBytes(16 * 1024 * 1024) {}
+};
+
+struct MetricStoreStats
+{
+    size_t series;
+    size_t memoryBlocks;     // 内存中的块(含各序列正在写入的块)
+    size_t spilledBlocks;    // 文件中的块
+    uint64_t droppedBlocks;  // 因容量上限丢弃的块
+    uint64_t samples;        // 当前可查询的样本数
+    uint64_t encodedBytes;   // 样本压缩后的字节数(不含块头)
+    uint64_t appended;       // 累计写入的样本数
+    uint64_t rejected;       // 时间戳早于该序列最后一个样本而被丢弃的样本数
+
+    MetricStoreStats()
+        : series(0), memoryBlocks(0), spilledBlocks(0), droppedBlocks(0), samples(0), encodedBytes(0), appended(0),
+          rejected(0) {}
+};
+
+/*
+ * 嵌入式时间序列存储, 用于回看信号/速率等指标在数小时内的变化
+ * 每个序列(如"bss/<bssid>/signal")写入固定大小的块: 时间戳按二阶差分(delta-of-delta)、
+ * 数值按与上一个值的XOR以变长位域编码, 周期采样的整数指标每个样本约1-2字节.
+ * 块头记录时间范围和min/max/sum, 区间查询跳过不相交的块, 降采样时整块落在一个桶内的直接合并块头.
+ * 已封存的块先留在内存, 超出memoryBytes后按封存顺序写入内存映射文件的环形槽位,
+ * 文件写满后覆盖最旧的块; 重新open()时从文件恢复. 所有接口线程安全
+ */
+class MetricStore
+{
+public:
+    static const size_t kBlockBytes = 1024;   // 块大小(含块头), 也是文件槽位大小
+    static const size_t kMaxNameLength = 64;  // 序列名称最大长度
+    static const size_t kMaxSeries = 1024;
+
+    MetricStore();
+    ~MetricStore();
+
+    /**
+     * 应用配置, 配置了转存文件时映射该文件并恢复其中的块
+     * @param config 内存/文件容量和文件路径
+     * @return 成功返回true, 文件无法映射时返回false(仍可只在内存中使用)
+     */
+    bool open(const MetricStoreConfig &config);
+
+    /**
+     * 封存并转存全部块后解除文件映射, 内存中的数据清空
+     */
+    void close();
+
+    /**
+     * 封存各序列正在写入的块并把内存中的块写入文件(没有转存文件时只封存)
+     */
+    void flush();
+
+    /**
+     * 查找或创建序列
+     * @param name 序列名称
+     * @return 序列编号, 名称为空/过长或序列数达到上限时返回-1
+     */
+    int series(const std::string &name);
+
+    /**
+     * 追加一个样本
+     * @param series 序列编号
+     * @param timestampMs 时间戳(毫秒), 不能早于该序列的上一个样本
+     * @param value 数值
+     * @return 成功返回true
+     */
+    bool append(int series, int64_t timestampMs, double value);
+    bool append(const std::string &name, int64_t timestampMs, double value);
+
+    /**
+     * 读取[fromMs, toMs]内的样本
+     * @param name 序列名称
+     * @param fromMs 起始时间
+     * @param toMs 结束时间(包含)
+     * @param points 按时间排序的样本
+     * @return 样本数
+     */
+    size_t query(const std::string &name, int64_t fromMs, int64_t toMs, std::vector<MetricPoint> &points) const;
+
+    /**
+     * 按bucketMs宽的时间桶降采样[fromMs, toMs]内的样本, 桶从fromMs开始对齐
+     * @param name 序列名称
+     * @param fromMs 起始时间
+     * @param toMs 结束时间(包含)
+     * @param bucketMs 桶宽度(毫秒)
+     * @param buckets 有样本的桶, 按时间排序
+     * @return 桶数
+     */
+    size_t downsample(const std::string &name, int64_t fromMs, int64_t toMs, int64_t bucketMs,
+                      std::vector<MetricBucket> &buckets) const;
+
+    /**
+     * 全部序列名称
+     */
+    void seriesNames(std::vector<std::string> &names) const;
+
+    MetricStoreStats getStats() const;
+
+    /**
+     * 当前系统时间(毫秒), 用作样本时间戳, 重启后写入的样本与文件中恢复的样本时间连续
+     */
+    static int64_t nowMs();
+
+    /**
+     * 生成序列名称, 如 seriesName("bss", bssid, "signal") -> "bss/aa:bb:cc:dd:ee:ff/signal"
+     */
+    static std::string seriesName(const char *kind, const MacAddress &address, const char *metric);
+
+private:
+    // 已封存的块: 在内存中(slot < 0)或在文件槽位slot中
+    struct BlockRef
+    {
+        uint64_t sequence;
+        int slot;
+        std::vector<uint8_t> bytes;
+
+        BlockRef() : sequence(0), slot(-1) {}
+    };
+
+    // 正在写入的块的编码状态
+    struct Encoder
+    {
+        int64_t previousMs;
+        int64_t previousDelta;
+        uint64_t previousBits;
+        int leading;  // 上一个XOR的前导零位数, -1表示尚未写入
+        int trailing; // 上一个XOR的末尾零位数
+
+        Encoder() : previousMs(0), previousDelta(0), previousBits(0), leading(-1), trailing(0) {}
+    };
+
+    struct Series
+    {
+        std::string name;
+        std::deque<BlockRef> blocks; // 已封存的块, 旧的在前(文件中的块都比内存中的旧)
+        std::vector<uint8_t> active; // 正在写入的块, 为空表示没有
+        Encoder encoder;
+        int64_t lastMs;              // 最后一个样本的时间, 包括已转存的块
+        bool hasSamples;
+
+        Series() : lastMs(0), hasSamples(false) {}
+    };
+
+    mutable std::mutex mutex_;
+    MetricStoreConfig config_;
+    std::vector<Series> series_;
+    std::unordered_map<std::string, int> index_;
+    std::deque<std::pair<int, uint64_t>> memoryOrder_; // 内存中已封存的块(序列, 序号), 按封存顺序
+    size_t memoryLimit_;                               // 内存中已封存块的数量上限
+    uint64_t nextSequence_;
+    uint64_t appended_;
+    uint64_t rejected_;
+    uint64_t dropped_;
+
+    int fd_;
+    uint8_t *map_;
+    size_t slotCount_;
+    size_t nextSlot_;
+    std::vector<int> slotOwner_; // 各槽位所属序列, -1表示空闲
+
+    /*
+     * 以下函数调用时持有mutex_
+     */
+    int findSeries(const std::string &name) const;
+    int createSeries(const std::string &name);
+    void seal(int series);
+    void spillOldest();
+    void recover();
+    const uint8_t *blockData(const BlockRef &block) const;
+    /*
+     * 按时间顺序遍历序列中与[fromMs, toMs]相交的块(含正在写入的块)
+     */
+    template <typename Visitor>
+    void forEachBlock(const Series &series, int64_t fromMs, int64_t toMs, Visitor visitor) const;
+
+    MetricStore(const MetricStore &);
+    MetricStore &operator=(const MetricStore &);
+};
+
+#endif // METRIC_STORE_H
@@ -0,0 +1,967 @@
+#include "Nl80211.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/genetlink.h>
+#include <linux/nl80211.h>
+#endif // _WIN32
+
+#ifndef _WIN32
+namespace
+{
+const size_t kReceiveBufferSize = 64 * 1024;
+
+// IEEE 802.11 信息元素ID
+const uint8_t kElementSsid = 0;
+const uint8_t kElementRsn = 48;
+const uint8_t kElementVendor = 221;
+const uint16_t kCapabilityPrivacy = 0x0010;
+
+long long monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+template <typename T>
+T readValue(const uint8_t *data)
+{
+    T value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/*
+ * 遍历netlink属性, 对每个属性调用visitor(类型, 内容, 长度)
+ */
+template <typename Visitor>
+void forEachAttribute(const uint8_t *data, size_t length, Visitor visitor)
+{
+    size_t offset = 0;
+    while (offset + NLA_HDRLEN <= length)
+    {
+        const struct nlattr *attribute = reinterpret_cast<const struct nlattr *>(data + offset);
+        if (attribute->nla_len < NLA_HDRLEN || offset + attribute->nla_len > length)
+        {
+            break;
+        }
+        visitor(static_cast<uint16_t>(attribute->nla_type & NLA_TYPE_MASK),
+                data + offset + NLA_HDRLEN, attribute->nla_len - NLA_HDRLEN);
+        offset += NLA_ALIGN(attribute->nla_len);
+    }
+}
+
+/*
+ * 遍历一段数据中的netlink消息, 对每条消息调用visitor(消息头)
+ */
+template <typename Visitor>
+void forEachMessage(const uint8_t *data, size_t length, Visitor visitor)
+{
+    size_t offset = 0;
+    while (offset + NLMSG_HDRLEN <= length)
+    {
+        const struct nlmsghdr *header = reinterpret_cast<const struct nlmsghdr *>(data + offset);
+        if (header->nlmsg_len < NLMSG_HDRLEN || offset + header->nlmsg_len > length)
+        {
+            break;
+        }
+        visitor(header);
+        offset += NLMSG_ALIGN(header->nlmsg_len);
+    }
+}
+/*
+ * 在一段事件消息中查找接口的扫描完成(1)或中止(-1)事件, 没有时返回0.
+ * frequencyCount不为空时写入完成事件中NL80211_ATTR_SCAN_FREQUENCIES的频率数(不带频率列表时为0)
+ */
+int decodeScanEvents(const uint8_t *data, size_t length, uint16_t familyId, int ifindex, int *frequencyCount)
+{
+    int outcome = 0;
+    forEachMessage(data, length, [ifindex, familyId, frequencyCount, &outcome](const struct nlmsghdr *header)
+                   {
+        if (header->nlmsg_type != familyId)
+        {
+            return;
+        }
+        const struct genlmsghdr *genl = reinterpret_cast<const struct genlmsghdr *>(NLMSG_DATA(header));
+        if (genl->cmd != NL80211_CMD_NEW_SCAN_RESULTS && genl->cmd != NL80211_CMD_SCAN_ABORTED)
+        {
+            return;
+        }
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(genl) + GENL_HDRLEN;
+        bool matched = false;
+        int frequencies = 0;
+        forEachAttribute(payload, header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN,
+                         [ifindex, &matched, &frequencies](uint16_t type, const uint8_t *value, size_t size)
+                         {
+            if (type == NL80211_ATTR_IFINDEX && size >= 4 && readValue<uint32_t>(value) == static_cast<uint32_t>(ifindex))
+            {
+                matched = true;
+            }
+            else if (type == NL80211_ATTR_SCAN_FREQUENCIES)
+            {
+                forEachAttribute(value, size, [&frequencies](uint16_t, const uint8_t *, size_t)
+                                 { frequencies++; });
+            }
+        });
+        if (matched)
+        {
+            outcome = (genl->cmd == NL80211_CMD_NEW_SCAN_RESULTS) ? 1 : -1;
+            if (frequencyCount && outcome > 0)
+            {
+                *frequencyCount = frequencies;
+            }
+        }
+    });
+    return outcome;
+}
+/*
+ * 解码NL80211_STA_INFO_TX_BITRATE/RX_BITRATE嵌套的速率, 返回kbit/s, 没有速率时返回0
+ */
+long decodeBitrateKbps(const uint8_t *data, size_t length)
+{
+    long kbps = 0;
+    forEachAttribute(data, length, [&kbps](uint16_t type, const uint8_t *value, size_t size)
+                     {
+        // 两者都是100kbit/s单位, BITRATE32存在时优先(BITRATE在超过6.5Gbit/s时为0)
+        if (type == NL80211_RATE_INFO_BITRATE32 && size >= 4)
+        {
+            kbps = static_cast<long>(readValue<uint32_t>(value)) * 100;
+        }
+        else if (type == NL80211_RATE_INFO_BITRATE && size >= 2 && kbps == 0)
+        {
+            kbps = static_cast<long>(readValue<uint16_t>(value)) * 100;
+        }
+    });
+    return kbps;
+}
+} // namespace
+#endif // _WIN32
+
+Nl80211::Nl80211()
+    : fd_(-1), eventFd_(-1), familyId_(0), scanGroup_(0), sequence_(0), buffer_(kReceiveBufferSize)
+{
+}
+
+Nl80211::~Nl80211()
+{
+    close();
+}
+
+bool Nl80211::open()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        return true;
+    }
+
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    eventFd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+    if (fd_ < 0 || eventFd_ < 0)
+    {
+        close();
+        return false;
+    }
+
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    if (bind(fd_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0 ||
+        bind(eventFd_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0)
+    {
+        close();
+        return false;
+    }
+
+    if (!resolveFamily())
+    {
+        close();
+        return false;
+    }
+
+    // 触发扫描前先加入多播组, 避免错过扫描完成事件
+    if (setsockopt(eventFd_, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP, &scanGroup_, sizeof(scanGroup_)) < 0)
+    {
+        close();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void Nl80211::close()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    if (eventFd_ >= 0)
+    {
+        ::close(eventFd_);
+        eventFd_ = -1;
+    }
+    familyId_ = 0;
+    scanGroup_ = 0;
+#endif // _WIN32
+}
+
+bool Nl80211::resolveFamily()
+{
+#ifndef _WIN32
+    std::vector<uint8_t> attributes;
+    const char familyName[] = NL80211_GENL_NAME;
+    appendAttribute(attributes, CTRL_ATTR_FAMILY_NAME, familyName, sizeof(familyName));
+    if (!sendMessage(buildMessage(GENL_ID_CTRL, NLM_F_REQUEST, ++sequence_, CTRL_CMD_GETFAMILY, attributes)))
+    {
+        return false;
+    }
+
+    ssize_t received = recv(fd_, buffer_.data(), buffer_.size(), 0);
+    if (received <= 0)
+    {
+        return false;
+    }
+
+    forEachMessage(buffer_.data(), static_cast<size_t>(received), [this](const struct nlmsghdr *header)
+                   {
+        if (header->nlmsg_type != GENL_ID_CTRL)
+        {
+            return;
+        }
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(NLMSG_DATA(header)) + GENL_HDRLEN;
+        size_t length = header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN;
+        forEachAttribute(payload, length, [this](uint16_t type, const uint8_t *data, size_t size)
+                         {
+            if (type == CTRL_ATTR_FAMILY_ID && size >= 2)
+            {
+                familyId_ = readValue<uint16_t>(data);
+            }
+            else if (type == CTRL_ATTR_MCAST_GROUPS)
+            {
+                forEachAttribute(data, size, [this](uint16_t, const uint8_t *group, size_t groupSize)
+                                 {
+                    std::string name;
+                    uint32_t id = 0;
+                    forEachAttribute(group, groupSize, [&name, &id](uint16_t groupType, const uint8_t *value, size_t valueSize)
+                                     {
+                        if (groupType == CTRL_ATTR_MCAST_GRP_NAME)
+                        {
+                            name.assign(reinterpret_cast<const char *>(value), strnlen(reinterpret_cast<const char *>(value), valueSize));
+                        }
+                        else if (groupType == CTRL_ATTR_MCAST_GRP_ID && valueSize >= 4)
+                        {
+                            id = readValue<uint32_t>(value);
+                        }
+                    });
+                    if (name == NL80211_MULTICAST_GROUP_SCAN)
+                    {
+                        scanGroup_ = id;
+                    }
+                });
+            }
+        });
+    });
+    return familyId_ != 0 && scanGroup_ != 0;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool Nl80211::sendMessage(const std::vector<uint8_t> &message)
+{
+#ifndef _WIN32
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    return sendto(fd_, message.data(), message.size(), 0,
+                  reinterpret_cast<struct sockaddr *>(&kernel), sizeof(kernel)) == static_cast<ssize_t>(message.size());
+#else
+    return false;
+#endif // _WIN32
+}
+
+int Nl80211::requestAck(uint8_t command, const std::vector<uint8_t> &attributes)
+{
+#ifndef _WIN32
+    uint32_t sequence = ++sequence_;
+    if (!sendMessage(buildMessage(familyId_, NLM_F_REQUEST | NLM_F_ACK, sequence, command, attributes)))
+    {
+        return -EIO;
+    }
+
+    while (true)
+    {
+        ssize_t received = recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            return -EIO;
+        }
+        int result = 1;
+        forEachMessage(buffer_.data(), static_cast<size_t>(received), [sequence, &result](const struct nlmsghdr *header)
+                       {
+            if (header->nlmsg_seq == sequence && header->nlmsg_type == NLMSG_ERROR)
+            {
+                result = reinterpret_cast<const struct nlmsgerr *>(NLMSG_DATA(header))->error;
+            }
+        });
+        if (result <= 0)
+        {
+            return result;
+        }
+    }
+#else
+    return -1;
+#endif // _WIN32
+}
+
+bool Nl80211::triggerScan(int ifindex)
+{
+    return triggerScan(ifindex, ScanParams());
+}
+
+bool Nl80211::triggerScan(int ifindex, const ScanParams &params)
+{
+#ifndef _WIN32
+    if (fd_ < 0)
+    {
+        return false;
+    }
+    int error = requestAck(NL80211_CMD_TRIGGER_SCAN, buildScanAttributes(ifindex, params));
+    if (error == -EBUSY)
+    {
+        // 已有扫描在进行, 等待其结果即可
+        return true;
+    }
+    if (error != 0)
+    {
+        std::cout << "nl80211 trigger scan failed: " << strerror(-error) << std::endl;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool Nl80211::waitScanDone(int ifindex, int timeoutMs)
+{
+    int frequencyCount = 0;
+    return waitScanDone(ifindex, timeoutMs, frequencyCount);
+}
+
+bool Nl80211::waitScanDone(int ifindex, int timeoutMs, int &frequencyCount)
+{
+#ifndef _WIN32
+    if (eventFd_ < 0)
+    {
+        return false;
+    }
+
+    long long deadline = monotonicMs() + timeoutMs;
+    while (true)
+    {
+        long long remaining = deadline - monotonicMs();
+        if (remaining <= 0)
+        {
+            return false;
+        }
+        struct pollfd pfd;
+        pfd.fd = eventFd_;
+        pfd.events = POLLIN;
+        int ready = poll(&pfd, 1, static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return false;
+        }
+
+        ssize_t received = recv(eventFd_, buffer_.data(), buffer_.size(), 0);
+        if (received <= 0)
+        {
+            continue;
+        }
+
+        int outcome = decodeScanEvents(buffer_.data(), static_cast<size_t>(received), familyId_, ifindex, &frequencyCount);
+        if (outcome != 0)
+        {
+            return outcome > 0;
+        }
+    }
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool Nl80211::getScanResults(int ifindex, std::vector<NetworkInfo> &networks, std::vector<uint8_t> *capture)
+{
+#ifndef _WIN32
+    networks.clear();
+    bool ok = requestDump(NL80211_CMD_GET_SCAN, ifindex, dump_);
+    if (capture)
+    {
+        capture->insert(capture->end(), dump_.begin(), dump_.end());
+    }
+    decodeScanDump(dump_.data(), dump_.size(), networks);
+    return ok;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool Nl80211::getStations(int ifindex, std::vector<ClientInfo> &stations)
+{
+#ifndef _WIN32
+    stations.clear();
+    bool ok = requestDump(NL80211_CMD_GET_STATION, ifindex, dump_);
+    decodeStationDump(dump_.data(), dump_.size(), stations);
+    return ok;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool Nl80211::requestDump(uint8_t command, int ifindex, std::vector<uint8_t> &messages)
+{
+#ifndef _WIN32
+    messages.clear();
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> attributes;
+    uint32_t index = static_cast<uint32_t>(ifindex);
+    appendAttribute(attributes, NL80211_ATTR_IFINDEX, &index, sizeof(index));
+    uint32_t sequence = ++sequence_;
+    if (!sendMessage(buildMessage(familyId_, NLM_F_REQUEST | NLM_F_DUMP, sequence, command, attributes)))
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        ssize_t received = recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            return false;
+        }
+        messages.insert(messages.end(), buffer_.data(), buffer_.data() + received);
+
+        bool done = false;
+        int error = 0;
+        forEachMessage(buffer_.data(), static_cast<size_t>(received), [sequence, &done, &error](const struct nlmsghdr *header)
+                       {
+            if (header->nlmsg_seq != sequence)
+            {
+                return;
+            }
+            if (header->nlmsg_type == NLMSG_DONE)
+            {
+                done = true;
+            }
+            else if (header->nlmsg_type == NLMSG_ERROR)
+            {
+                error = reinterpret_cast<const struct nlmsgerr *>(NLMSG_DATA(header))->error;
+                done = true;
+            }
+        });
+        if (done)
+        {
+            return error == 0;
+        }
+    }
+#else
+    (void)command;
+    (void)ifindex;
+    messages.clear();
+    return false;
+#endif // _WIN32
+}
+
+bool Nl80211::scan(int ifindex, std::vector<NetworkInfo> &networks, int timeoutMs)
+{
+    return scan(ifindex, ScanParams(), networks, timeoutMs);
+}
+
+bool Nl80211::scan(int ifindex, const ScanParams &params, std::vector<NetworkInfo> &networks, int timeoutMs)
+{
+#ifndef _WIN32
+    if (!open() || !triggerScan(ifindex, params))
+    {
+        return false;
+    }
+    if (!waitScanDone(ifindex, timeoutMs))
+    {
+        std::cout << "nl80211 scan did not complete, using cached results" << std::endl;
+    }
+    return getScanResults(ifindex, networks);
+#else
+    return false;
+#endif // _WIN32
+}
+
+size_t Nl80211::decodeScanDump(const uint8_t *data, size_t length, std::vector<NetworkInfo> &networks)
+{
+#ifndef _WIN32
+    size_t count = 0;
+    forEachMessage(data, length, [&networks, &count](const struct nlmsghdr *header)
+                   {
+        if (header->nlmsg_type < NLMSG_MIN_TYPE || header->nlmsg_len < NLMSG_HDRLEN + GENL_HDRLEN)
+        {
+            return;
+        }
+        const struct genlmsghdr *genl = reinterpret_cast<const struct genlmsghdr *>(NLMSG_DATA(header));
+        if (genl->cmd != NL80211_CMD_NEW_SCAN_RESULTS)
+        {
+            return;
+        }
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(genl) + GENL_HDRLEN;
+        forEachAttribute(payload, header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN,
+                         [&networks, &count](uint16_t type, const uint8_t *value, size_t size)
+                         {
+            if (type != NL80211_ATTR_BSS)
+            {
+                return;
+            }
+            NetworkInfo network;
+            if (decodeBss(value, size, network))
+            {
+                networks.push_back(network);
+                count++;
+            }
+        });
+    });
+    return count;
+#else
+    return 0;
+#endif // _WIN32
+}
+
+bool Nl80211::decodeBss(const uint8_t *data, size_t length, NetworkInfo &network)
+{
+#ifndef _WIN32
+    network = NetworkInfo();
+    network.security = SecurityMode::OPEN;
+    network.signalStrength = -100;
+
+    bool hasBssid = false;
+    bool hasMbm = false;
+    uint16_t capability = 0;
+    const uint8_t *elements = nullptr;
+    size_t elementsLength = 0;
+    const uint8_t *beaconElements = nullptr;
+    size_t beaconElementsLength = 0;
+
+    forEachAttribute(data, length, [&](uint16_t type, const uint8_t *value, size_t size)
+                     {
+        switch (type)
+        {
+        case NL80211_BSS_BSSID:
+            if (size >= 6)
+            {
+                network.bssid = MacAddress::fromBytes(value);
+                hasBssid = true;
+            }
+            break;
+        case NL80211_BSS_FREQUENCY:
+            if (size >= 4)
+            {
+                network.frequency = static_cast<int>(readValue<uint32_t>(value));
+                network.channel = frequencyToChannel(network.frequency);
+            }
+            break;
+        case NL80211_BSS_SIGNAL_MBM:
+            if (size >= 4)
+            {
+                // 单位为mBm(0.01 dBm)
+                network.signalStrength = readValue<int32_t>(value) / 100;
+                hasMbm = true;
+            }
+            break;
+        case NL80211_BSS_SIGNAL_UNSPEC:
+            if (size >= 1 && !hasMbm)
+            {
+                // 0-100的相对值, 近似换算为dBm
+                network.signalStrength = value[0] / 2 - 100;
+            }
+            break;
+        case NL80211_BSS_SEEN_MS_AGO:
+            if (size >= 4)
+            {
+                network.ageMs = static_cast<int>(readValue<uint32_t>(value));
+            }
+            break;
+        case NL80211_BSS_CAPABILITY:
+            if (size >= 2)
+            {
+                capability = readValue<uint16_t>(value);
+            }
+            break;
+        case NL80211_BSS_INFORMATION_ELEMENTS:
+            elements = value;
+            elementsLength = size;
+            break;
+        case NL80211_BSS_BEACON_IES:
+            beaconElements = value;
+            beaconElementsLength = size;
+            break;
+        default:
+            break;
+        }
+    });
+
+    if (!hasBssid)
+    {
+        return false;
+    }
+
+    // 优先使用探测响应中的IE, 被动扫描时只有信标IE
+    bool hasRsn = false;
+    bool hasWpa = false;
+    if (elements)
+    {
+        decodeInformationElements(elements, elementsLength, network, hasRsn, hasWpa);
+    }
+    else if (beaconElements)
+    {
+        decodeInformationElements(beaconElements, beaconElementsLength, network, hasRsn, hasWpa);
+    }
+
+    if (hasRsn && hasWpa)
+    {
+        network.security = SecurityMode::WPA_WPA2_PSK;
+    }
+    else if (hasRsn)
+    {
+        network.security = SecurityMode::WPA2_PSK;
+    }
+    else if (hasWpa)
+    {
+        network.security = SecurityMode::WPA_PSK;
+    }
+    else if (capability & kCapabilityPrivacy)
+    {
+        network.security = SecurityMode::WEP;
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void Nl80211::decodeInformationElements(const uint8_t *data, size_t length, NetworkInfo &network,
+                                        bool &hasRsn, bool &hasWpa)
+{
+#ifndef _WIN32
+    static const uint8_t kWpaOui[] = {0x00, 0x50, 0xf2, 0x01};
+    bool hasSsid = false;
+    size_t offset = 0;
+    while (offset + 2 <= length)
+    {
+        uint8_t id = data[offset];
+        uint8_t size = data[offset + 1];
+        const uint8_t *value = data + offset + 2;
+        if (offset + 2 + size > length)
+        {
+            break;
+        }
+
+        if (id == kElementSsid && !hasSsid)
+        {
+            hasSsid = true;
+            // 隐藏网络的SSID为空或全零
+            bool allZero = true;
+            for (uint8_t i = 0; i < size; i++)
+            {
+                if (value[i] != 0)
+                {
+                    allZero = false;
+                    break;
+                }
+            }
+            network.isHidden = allZero;
+            if (!allZero)
+            {
+                network.ssid.assign(reinterpret_cast<const char *>(value), size);
+            }
+        }
+        else if (id == kElementRsn)
+        {
+            hasRsn = true;
+        }
+        else if (id == kElementVendor && size >= sizeof(kWpaOui) && memcmp(value, kWpaOui, sizeof(kWpaOui)) == 0)
+        {
+            hasWpa = true;
+        }
+        offset += 2 + size;
+    }
+#endif // _WIN32
+}
+
+size_t Nl80211::decodeStationDump(const uint8_t *data, size_t length, std::vector<ClientInfo> &stations)
+{
+#ifndef _WIN32
+    size_t count = 0;
+    forEachMessage(data, length, [&stations, &count](const struct nlmsghdr *header)
+                   {
+        if (header->nlmsg_type < NLMSG_MIN_TYPE || header->nlmsg_len < NLMSG_HDRLEN + GENL_HDRLEN)
+        {
+            return;
+        }
+        const struct genlmsghdr *genl = reinterpret_cast<const struct genlmsghdr *>(NLMSG_DATA(header));
+        if (genl->cmd != NL80211_CMD_NEW_STATION)
+        {
+            return;
+        }
+        const uint8_t *payload = reinterpret_cast<const uint8_t *>(genl) + GENL_HDRLEN;
+        ClientInfo station;
+        bool hasMac = false;
+        bool hasInfo = false;
+        forEachAttribute(payload, header->nlmsg_len - NLMSG_HDRLEN - GENL_HDRLEN,
+                         [&](uint16_t type, const uint8_t *value, size_t size)
+                         {
+            if (type == NL80211_ATTR_MAC && size >= 6)
+            {
+                station.macAddress = MacAddress::fromBytes(value);
+                hasMac = true;
+            }
+            else if (type == NL80211_ATTR_STA_INFO)
+            {
+                MacAddress mac = station.macAddress;
+                hasInfo = decodeStation(value, size, station);
+                station.macAddress = mac;
+            }
+        });
+        if (hasMac && hasInfo)
+        {
+            stations.push_back(station);
+            count++;
+        }
+    });
+    return count;
+#else
+    return 0;
+#endif // _WIN32
+}
+
+bool Nl80211::decodeStation(const uint8_t *data, size_t length, ClientInfo &station)
+{
+#ifndef _WIN32
+    station = ClientInfo();
+    bool hasSignal = false;
+    forEachAttribute(data, length, [&](uint16_t type, const uint8_t *value, size_t size)
+                     {
+        switch (type)
+        {
+        case NL80211_STA_INFO_SIGNAL:
+            if (size >= 1)
+            {
+                station.signalStrength = static_cast<int8_t>(value[0]);
+                hasSignal = true;
+            }
+            break;
+        case NL80211_STA_INFO_CONNECTED_TIME:
+            if (size >= 4)
+            {
+                station.connectedTime = static_cast<long>(readValue<uint32_t>(value));
+            }
+            break;
+        case NL80211_STA_INFO_INACTIVE_TIME:
+            if (size >= 4)
+            {
+                station.inactiveMs = static_cast<long>(readValue<uint32_t>(value));
+            }
+            break;
+        case NL80211_STA_INFO_RX_BYTES64:
+            if (size >= 8)
+            {
+                station.rxBytes = readValue<uint64_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_TX_BYTES64:
+            if (size >= 8)
+            {
+                station.txBytes = readValue<uint64_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_RX_PACKETS:
+            if (size >= 4)
+            {
+                station.rxPackets = readValue<uint32_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_TX_PACKETS:
+            if (size >= 4)
+            {
+                station.txPackets = readValue<uint32_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_TX_RETRIES:
+            if (size >= 4)
+            {
+                station.txRetries = readValue<uint32_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_TX_FAILED:
+            if (size >= 4)
+            {
+                station.txFailed = readValue<uint32_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_BEACON_LOSS:
+            if (size >= 4)
+            {
+                station.beaconLoss = readValue<uint32_t>(value);
+            }
+            break;
+        case NL80211_STA_INFO_TX_BITRATE:
+            station.txBitrateKbps = decodeBitrateKbps(value, size);
+            break;
+        case NL80211_STA_INFO_RX_BITRATE:
+            station.rxBitrateKbps = decodeBitrateKbps(value, size);
+            break;
+        case NL80211_STA_INFO_EXPECTED_THROUGHPUT:
+            if (size >= 4)
+            {
+                station.expectedThroughputKbps = static_cast<long>(readValue<uint32_t>(value));
+            }
+            break;
+        default:
+            break;
+        }
+    });
+    return hasSignal;
+#else
+    (void)data;
+    (void)length;
+    station = ClientInfo();
+    return false;
+#endif // _WIN32
+}
+
+int Nl80211::frequencyToChannel(int frequency)
+{
+    if (frequency == 2484)
+    {
+        return 14;
+    }
+    if (frequency >= 2412 && frequency < 2484)
+    {
+        return (frequency - 2407) / 5;
+    }
+    if (frequency >= 5000 && frequency <= 5925)
+    {
+        return (frequency - 5000) / 5;
+    }
+    // 6GHz的2信道不在5950+5n的序列上
+    if (frequency == 5935)
+    {
+        return 2;
+    }
+    if (frequency > 5950 && frequency <= 7115)
+    {
+        return (frequency - 5950) / 5;
+    }
+    return 0;
+}
+
+std::vector<uint8_t> Nl80211::buildMessage(uint16_t type, uint16_t flags, uint32_t sequence,
+                                           uint8_t command, const std::vector<uint8_t> &attributes)
+{
+#ifndef _WIN32
+    std::vector<uint8_t> message(NLMSG_HDRLEN + GENL_HDRLEN + attributes.size(), 0);
+    if (!attributes.empty())
+    {
+        memcpy(message.data() + NLMSG_HDRLEN + GENL_HDRLEN, attributes.data(), attributes.size());
+    }
+
+    struct nlmsghdr header;
+    memset(&header, 0, sizeof(header));
+    header.nlmsg_len = static_cast<uint32_t>(message.size());
+    header.nlmsg_type = type;
+    header.nlmsg_flags = flags;
+    header.nlmsg_seq = sequence;
+    memcpy(message.data(), &header, sizeof(header));
+
+    struct genlmsghdr genl;
+    memset(&genl, 0, sizeof(genl));
+    genl.cmd = command;
+    genl.version = 1;
+    memcpy(message.data() + NLMSG_HDRLEN, &genl, sizeof(genl));
+    return message;
+#else
+    return std::vector<uint8_t>();
+#endif // _WIN32
+}
+
+std::vector<uint8_t> Nl80211::buildScanAttributes(int ifindex, const ScanParams &params)
+{
+    std::vector<uint8_t> attributes;
+#ifndef _WIN32
+    uint32_t index = static_cast<uint32_t>(ifindex);
+    appendAttribute(attributes, NL80211_ATTR_IFINDEX, &index, sizeof(index));
+
+    // 嵌套属性中各项的类型只作为序号, 内核按顺序读取
+    if (!params.frequencies.empty())
+    {
+        std::vector<uint8_t> frequencies;
+        for (size_t i = 0; i < params.frequencies.size(); i++)
+        {
+            uint32_t frequency = static_cast<uint32_t>(params.frequencies[i]);
+            appendAttribute(frequencies, static_cast<uint16_t>(i + 1), &frequency, sizeof(frequency));
+        }
+        appendAttribute(attributes, NL80211_ATTR_SCAN_FREQUENCIES | NLA_F_NESTED, frequencies.data(),
+                        frequencies.size());
+    }
+    // 没有指定SSID时发送一个空的通配SSID, 否则内核只做被动扫描(与iw scan一致, 可发现只回应探测的AP)
+    std::vector<uint8_t> ssids;
+    if (params.ssids.empty())
+    {
+        appendAttribute(ssids, 1, nullptr, 0);
+    }
+    for (size_t i = 0; i < params.ssids.size(); i++)
+    {
+        // SSID最长32字节
+        size_t length = params.ssids[i].size() > 32 ? 32 : params.ssids[i].size();
+        appendAttribute(ssids, static_cast<uint16_t>(i + 1), params.ssids[i].data(), length);
+    }
+    appendAttribute(attributes, NL80211_ATTR_SCAN_SSIDS | NLA_F_NESTED, ssids.data(), ssids.size());
+#endif // _WIN32
+    return attributes;
+}
+
+void Nl80211::appendAttribute(std::vector<uint8_t> &buffer, uint16_t type, const void *data, size_t length)
+{
+#ifndef _WIN32
+    struct nlattr attribute;
+    attribute.nla_len = static_cast<uint16_t>(NLA_HDRLEN + length);
+    attribute.nla_type = type;
+    const uint8_t *header = reinterpret_cast<const uint8_t *>(&attribute);
+    buffer.insert(buffer.end(), header, header + sizeof(attribute));
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    buffer.insert(buffer.end(), bytes, bytes + length);
+    buffer.resize(NLA_ALIGN(buffer.size()), 0);
+#endif // _WIN32
+}
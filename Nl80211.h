@@ -0,0 +1,213 @@
+#ifndef NL80211_H
+#define NL80211_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "WifiTypes.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif // _WIN32
+
+/*
+ * nl80211通用netlink扫描接口
+ * 通过NL80211_CMD_TRIGGER_SCAN触发扫描, 在"scan"多播组上等待NEW_SCAN_RESULTS,
+ * 再用NL80211_CMD_GET_SCAN导出BSS列表并直接解码为NetworkInfo;
+ * NL80211_CMD_GET_STATION导出站点信息并解码为ClientInfo.
+ * 解码函数为纯函数, 可以直接处理录制的netlink消息
+ */
+class Nl80211
+{
+public:
+    Nl80211();
+    ~Nl80211();
+
+    /**
+     * 打开netlink套接字并解析nl80211族ID及扫描多播组
+     * @return 成功返回true，失败返回false(内核不支持或无权限)
+     */
+    bool open();
+
+    /**
+     * 关闭netlink套接字
+     */
+    void close();
+
+    /**
+     * 判断是否已打开
+     * @return 已打开返回true
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * 触发一次主动扫描
+     * @param ifindex 接口索引
+     * @return 内核接受扫描请求(或已有扫描在进行)返回true
+     */
+    bool triggerScan(int ifindex);
+
+    /**
+     * 触发一次定向扫描(只扫描指定频率, 探测请求携带指定SSID)
+     * @param ifindex 接口索引
+     * @param params 扫描参数, 为空时等同于triggerScan(ifindex)
+     * @return 内核接受扫描请求(或已有扫描在进行)返回true
+     */
+    bool triggerScan(int ifindex, const ScanParams &params);
+
+    /**
+     * 等待扫描完成
+     * @param ifindex 接口索引
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 收到NEW_SCAN_RESULTS返回true, 扫描中止或超时返回false
+     */
+    bool waitScanDone(int ifindex, int timeoutMs);
+
+    /**
+     * 等待扫描完成并取得该次扫描的频率数, 也能收到其他进程(wpa_supplicant)触发的扫描
+     * @param ifindex 接口索引
+     * @param timeoutMs 超时时间(毫秒)
+     * @param frequencyCount 完成事件中NL80211_ATTR_SCAN_FREQUENCIES的频率数, 不带频率列表时为0
+     * @return 收到NEW_SCAN_RESULTS返回true, 扫描中止或超时返回false
+     */
+    bool waitScanDone(int ifindex, int timeoutMs, int &frequencyCount);
+
+    /**
+     * 导出内核当前缓存的扫描结果(NL80211_CMD_GET_SCAN)
+     * @param ifindex 接口索引
+     * @param networks 解码后的BSS列表(每个BSS一项, 未去重)
+     * @param capture 不为空时追加收到的原始netlink消息, 用于录制回放
+     * @return 成功返回true，失败返回false
+     */
+    bool getScanResults(int ifindex, std::vector<NetworkInfo> &networks, std::vector<uint8_t> *capture = nullptr);
+
+    /**
+     * 导出接口上的站点信息(NL80211_CMD_GET_STATION), STA模式下即关联的AP, AP模式下为各客户端
+     * @param ifindex 接口索引
+     * @param stations 解码后的站点列表(macAddress为对端地址, 不含IP/主机名)
+     * @return 成功返回true，失败返回false
+     */
+    bool getStations(int ifindex, std::vector<ClientInfo> &stations);
+
+    /**
+     * 触发扫描、等待完成并导出结果
+     * @param ifindex 接口索引
+     * @param networks 解码后的BSS列表
+     * @param timeoutMs 等待扫描完成的超时时间(毫秒)
+     * @return 成功返回true，失败返回false
+     */
+    bool scan(int ifindex, std::vector<NetworkInfo> &networks, int timeoutMs = 10000);
+
+    /**
+     * 触发定向扫描、等待完成并导出结果(导出的是内核的全部缓存, 可能包含其他频率上较早扫描到的BSS)
+     * @param ifindex 接口索引
+     * @param params 扫描参数
+     * @param networks 解码后的BSS列表
+     * @param timeoutMs 等待扫描完成的超时时间(毫秒)
+     * @return 成功返回true，失败返回false
+     */
+    bool scan(int ifindex, const ScanParams &params, std::vector<NetworkInfo> &networks, int timeoutMs = 10000);
+
+    /**
+     * 编码TRIGGER_SCAN的属性(NL80211_ATTR_IFINDEX/SCAN_FREQUENCIES/SCAN_SSIDS), 未指定SSID时带一个通配SSID(主动扫描)
+     * @param ifindex 接口索引
+     * @param params 扫描参数
+     * @return 已编码的属性
+     */
+    static std::vector<uint8_t> buildScanAttributes(int ifindex, const ScanParams &params);
+
+    /**
+     * 解码一段netlink消息流中的全部NEW_SCAN_RESULTS消息
+     * @param data 消息数据
+     * @param length 数据长度
+     * @param networks 追加解码出的BSS
+     * @return 解码出的BSS数量
+     */
+    static size_t decodeScanDump(const uint8_t *data, size_t length, std::vector<NetworkInfo> &networks);
+
+    /**
+     * 解码NL80211_ATTR_BSS嵌套属性
+     * @param data 嵌套属性内容
+     * @param length 内容长度
+     * @param network 解码结果
+     * @return 包含BSSID时返回true
+     */
+    static bool decodeBss(const uint8_t *data, size_t length, NetworkInfo &network);
+
+    /**
+     * 解码一段netlink消息流中的全部NEW_STATION消息
+     * @param data 消息数据
+     * @param length 数据长度
+     * @param stations 追加解码出的站点
+     * @return 解码出的站点数量
+     */
+    static size_t decodeStationDump(const uint8_t *data, size_t length, std::vector<ClientInfo> &stations);
+
+    /**
+     * 解码NL80211_ATTR_STA_INFO嵌套属性(信号/速率/收发计数/重传/信标丢失)
+     * @param data 嵌套属性内容
+     * @param length 内容长度
+     * @param station 解码结果(不含macAddress)
+     * @return 包含信号强度时返回true
+     */
+    static bool decodeStation(const uint8_t *data, size_t length, ClientInfo &station);
+
+    /**
+     * 由频率计算信道号
+     * @param frequency 频率(MHz)
+     * @return 信道号, 无法识别时返回0
+     */
+    static int frequencyToChannel(int frequency);
+
+    /**
+     * 构造一条通用netlink消息(nlmsghdr + genlmsghdr + 属性)
+     * @param type 消息类型(族ID)
+     * @param flags nlmsg_flags
+     * @param sequence 序列号
+     * @param command genl命令
+     * @param attributes 已编码的属性
+     * @return 完整的消息
+     */
+    static std::vector<uint8_t> buildMessage(uint16_t type, uint16_t flags, uint32_t sequence,
+                                             uint8_t command, const std::vector<uint8_t> &attributes);
+
+    /**
+     * 追加一个netlink属性(自动4字节对齐)
+     * @param buffer 属性缓冲区
+     * @param type 属性类型(嵌套属性需带NLA_F_NESTED)
+     * @param data 属性内容
+     * @param length 内容长度
+     */
+    static void appendAttribute(std::vector<uint8_t> &buffer, uint16_t type, const void *data, size_t length);
+
+private:
+    int fd_;      // 命令套接字
+    int eventFd_; // 订阅扫描多播组的事件套接字
+    uint16_t familyId_;
+    uint32_t scanGroup_;
+    uint32_t sequence_;
+    std::vector<uint8_t> buffer_; // 复用的接收缓冲区
+    std::vector<uint8_t> dump_;   // 复用的导出结果缓冲区
+
+    bool resolveFamily();
+    /*
+     * 发送请求并等待ACK
+     * @return 内核返回的错误码(0表示成功), 通信失败返回-EIO
+     */
+    int requestAck(uint8_t command, const std::vector<uint8_t> &attributes);
+    bool sendMessage(const std::vector<uint8_t> &message);
+    /*
+     * 发送带NL80211_ATTR_IFINDEX的导出请求, 收集到NLMSG_DONE为止的全部消息
+     * @return 内核未返回错误时返回true
+     */
+    bool requestDump(uint8_t command, int ifindex, std::vector<uint8_t> &messages);
+    static void decodeInformationElements(const uint8_t *data, size_t length, NetworkInfo &network,
+                                          bool &hasRsn, bool &hasWpa);
+
+    Nl80211(const Nl80211 &);
+    Nl80211 &operator=(const Nl80211 &);
+};
+
+#endif // NL80211_H
@@ -0,0 +1,281 @@
+#include "PhaseTracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif // _WIN32
+
+std::atomic<bool> PhaseTracer::enabled_(false);
+const size_t PhaseTracer::kRingCapacity;
+
+namespace
+{
+/*
+ * 单写者环形缓冲区
+ * 写者先声明要写的序号(claimed), 写完再提交(committed); 读者复制后重新读取claimed,
+ * 丢弃可能在复制期间被覆盖的槽位(序号锁思路, 读者从不阻塞写者)
+ */
+struct TraceSlot
+{
+    std::atomic<const char *> category;
+    std::atomic<const char *> name;
+    std::atomic<int64_t> startNs;
+    std::atomic<int64_t> durationNs;
+    std::atomic<int> threadId;
+};
+
+struct TraceRing
+{
+    TraceSlot slots[PhaseTracer::kRingCapacity];
+    std::atomic<uint64_t> claimed;
+    std::atomic<uint64_t> committed;
+    std::atomic<uint64_t> floor; // clear()之后的读取起点
+    std::atomic<bool> inUse;     // 所属线程退出后可由新线程复用, 已有事件保留
+
+    TraceRing() : claimed(0), committed(0), floor(0), inUse(true) {}
+};
+
+const uint64_t kRingMask = PhaseTracer::kRingCapacity - 1;
+
+// 环形缓冲区只增加不释放(线程数有限), 注册时加锁, 写入路径无锁
+std::mutex gRingsMutex;
+std::vector<TraceRing *> gRings;
+
+int currentThreadId()
+{
+#ifndef _WIN32
+    return static_cast<int>(syscall(SYS_gettid));
+#else
+    static std::atomic<int> nextId(1);
+    return nextId++;
+#endif // _WIN32
+}
+
+TraceRing *acquireRing()
+{
+    std::lock_guard<std::mutex> lock(gRingsMutex);
+    for (auto ring : gRings)
+    {
+        bool idle = false;
+        if (ring->inUse.compare_exchange_strong(idle, true))
+        {
+            return ring;
+        }
+    }
+    gRings.push_back(new TraceRing());
+    return gRings.back();
+}
+
+// 线程退出时归还缓冲区
+struct ThreadRing
+{
+    TraceRing *ring;
+    int threadId;
+
+    ThreadRing() : ring(acquireRing()), threadId(currentThreadId()) {}
+    ~ThreadRing() { ring->inUse.store(false, std::memory_order_release); }
+};
+
+ThreadRing &threadRing()
+{
+    static thread_local ThreadRing local;
+    return local;
+}
+
+void copyRing(TraceRing *ring, std::vector<TraceEvent> &events)
+{
+    uint64_t end = ring->committed.load(std::memory_order_acquire);
+    uint64_t begin = std::max(ring->floor.load(std::memory_order_relaxed),
+                              end > PhaseTracer::kRingCapacity ? end - PhaseTracer::kRingCapacity : 0);
+    size_t first = events.size();
+    for (uint64_t index = begin; index < end; index++)
+    {
+        const TraceSlot &slot = ring->slots[index & kRingMask];
+        TraceEvent event;
+        event.category = slot.category.load(std::memory_order_relaxed);
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.startNs = slot.startNs.load(std::memory_order_relaxed);
+        event.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+        event.threadId = slot.threadId.load(std::memory_order_relaxed);
+        events.push_back(event);
+    }
+    // 复制期间写者声明的序号覆盖了[claimed - capacity, ...)之前的槽位
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+    if (claimed > PhaseTracer::kRingCapacity && claimed - PhaseTracer::kRingCapacity > begin)
+    {
+        size_t overwritten = static_cast<size_t>(std::min(claimed - PhaseTracer::kRingCapacity, end) - begin);
+        events.erase(events.begin() + first, events.begin() + first + overwritten);
+    }
+}
+
+void appendJsonString(std::ostringstream &out, const char *text)
+{
+    out << '"';
+    for (const char *p = text ? text : ""; *p; p++)
+    {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << *p;
+        }
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out << escaped;
+        }
+        else
+        {
+            out << *p;
+        }
+    }
+    out << '"';
+}
+} // namespace
+
+int64_t PhaseTracer::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void PhaseTracer::record(const char *category, const char *name, int64_t startNs, int64_t durationNs)
+{
+    ThreadRing &local = threadRing();
+    TraceRing *ring = local.ring;
+    uint64_t index = ring->committed.load(std::memory_order_relaxed);
+    ring->claimed.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    TraceSlot &slot = ring->slots[index & kRingMask];
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.durationNs.store(durationNs, std::memory_order_relaxed);
+    slot.threadId.store(local.threadId, std::memory_order_relaxed);
+    ring->committed.store(index + 1, std::memory_order_release);
+}
+
+void PhaseTracer::collect(std::vector<TraceEvent> &events)
+{
+    events.clear();
+    std::vector<TraceRing *> rings;
+    {
+        std::lock_guard<std::mutex> lock(gRingsMutex);
+        rings = gRings;
+    }
+    for (auto ring : rings)
+    {
+        copyRing(ring, events);
+    }
+    // 起点相同时外层阶段(持续更久)在前
+    std::stable_sort(events.begin(), events.end(),
+                     [](const TraceEvent &a, const TraceEvent &b)
+                     {
+                         return a.startNs != b.startNs ? a.startNs < b.startNs : a.durationNs > b.durationNs;
+                     });
+}
+
+void PhaseTracer::clear()
+{
+    std::lock_guard<std::mutex> lock(gRingsMutex);
+    for (auto ring : gRings)
+    {
+        ring->floor.store(ring->committed.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+std::string PhaseTracer::exportChromeJson()
+{
+    std::vector<TraceEvent> events;
+    collect(events);
+#ifndef _WIN32
+    int pid = static_cast<int>(getpid());
+#else
+    int pid = 1;
+#endif // _WIN32
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        const TraceEvent &event = events[i];
+        out << (i == 0 ? "\n" : ",\n") << "{\"name\":";
+        appendJsonString(out, event.name);
+        out << ",\"cat\":";
+        appendJsonString(out, event.category);
+        // Chrome trace的时间单位是微秒
+        out << ",\"ph\":\"X\",\"ts\":" << event.startNs / 1000.0 << ",\"dur\":" << event.durationNs / 1000.0
+            << ",\"pid\":" << pid << ",\"tid\":" << event.threadId << "}";
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+bool PhaseTracer::writeChromeJson(const std::string &path)
+{
+    std::ofstream file(path.c_str());
+    if (!file.is_open())
+    {
+        return false;
+    }
+    file << exportChromeJson();
+    return file.good();
+}
+
+std::string PhaseTracer::summary()
+{
+    struct PhaseStats
+    {
+        std::string label;
+        int count;
+        int64_t totalNs;
+        int64_t maxNs;
+        int64_t lastNs;
+    };
+
+    std::vector<TraceEvent> events;
+    collect(events);
+    // 按首次出现的顺序输出, 与连接流程的步骤顺序一致
+    std::vector<PhaseStats> phases;
+    for (const auto &event : events)
+    {
+        std::string label = std::string(event.category ? event.category : "") + "/" + (event.name ? event.name : "");
+        auto it = std::find_if(phases.begin(), phases.end(),
+                               [&label](const PhaseStats &stats)
+                               {
+                                   return stats.label == label;
+                               });
+        if (it == phases.end())
+        {
+            PhaseStats stats = {label, 0, 0, 0, 0};
+            phases.push_back(stats);
+            it = phases.end() - 1;
+        }
+        it->count++;
+        it->totalNs += event.durationNs;
+        it->maxNs = std::max(it->maxNs, event.durationNs);
+        it->lastNs = event.durationNs;
+    }
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << std::left << std::setw(40) << "phase" << std::right << std::setw(6) << "count" << std::setw(11) << "avg ms"
+        << std::setw(11) << "max ms" << std::setw(11) << "last ms" << "\n";
+    for (const auto &stats : phases)
+    {
+        out << std::left << std::setw(40) << stats.label << std::right << std::setw(6) << stats.count << std::setw(11)
+            << stats.totalNs / 1e6 / stats.count << std::setw(11) << stats.maxNs / 1e6 << std::setw(11)
+            << stats.lastNs / 1e6 << "\n";
+    }
+    return out.str();
+}
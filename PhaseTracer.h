@@ -0,0 +1,133 @@
+#ifndef PHASE_TRACER_H
+#define PHASE_TRACER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+
+// 一个已结束的阶段
+struct TraceEvent
+{
+    const char *category; // 所属操作, 如"wifi"
+    const char *name;     // 阶段名称(字符串常量)
+    int64_t startNs;      // 单调时钟起点(纳秒)
+    int64_t durationNs;   // 持续时间(纳秒)
+    int threadId;         // 记录线程
+};
+
+/*
+ * 连接流程的阶段耗时记录
+ * 每个线程写入自己的环形缓冲区(单写者, 无锁), 导出时复制各缓冲区中未被覆盖的事件;
+ * 关闭时TraceSpan只读取一次开关, 不读时钟也不写缓冲区
+ */
+class PhaseTracer
+{
+public:
+    static const size_t kRingCapacity = 1024; // 每个线程保留的事件数, 2的幂
+
+    /**
+     * 开启或关闭记录(已记录的事件保留)
+     */
+    static void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * 单调时钟(纳秒)
+     */
+    static int64_t nowNs();
+
+    /**
+     * 写入当前线程的环形缓冲区
+     * @param category 所属操作(字符串常量, 只保存指针)
+     * @param name 阶段名称(字符串常量, 只保存指针)
+     * @param startNs 起点
+     * @param durationNs 持续时间
+     */
+    static void record(const char *category, const char *name, int64_t startNs, int64_t durationNs);
+
+    /**
+     * 复制所有线程的事件, 按起点排序
+     * @param events 输出事件
+     */
+    static void collect(std::vector<TraceEvent> &events);
+
+    /**
+     * 丢弃已记录的事件(只移动读取起点, 不影响正在写入的线程)
+     */
+    static void clear();
+
+    /**
+     * Chrome trace-event JSON(chrome://tracing或Perfetto打开), 每个阶段一个"X"事件
+     */
+    static std::string exportChromeJson();
+
+    /**
+     * 写入Chrome trace-event JSON文件
+     * @param path 文件路径
+     * @return 成功返回true，失败返回false
+     */
+    static bool writeChromeJson(const std::string &path);
+
+    /**
+     * 按阶段汇总: 次数, 平均/最大/最近一次耗时(毫秒)
+     */
+    static std::string summary();
+
+private:
+    static std::atomic<bool> enabled_;
+
+    PhaseTracer();
+};
+
+/*
+ * 作用域内的一个阶段, 析构或end()时记录; next()结束当前阶段并开始下一个,
+ * 便于按顺序标注一个函数中的各步骤
+ */
+class TraceSpan
+{
+public:
+    TraceSpan(const char *category, const char *name)
+        : category_(category), name_(name), startNs_(PhaseTracer::isEnabled() ? PhaseTracer::nowNs() : -1)
+    {
+    }
+
+    ~TraceSpan() { end(); }
+
+    /**
+     * 结束当前阶段(重复调用无效)
+     */
+    void end()
+    {
+        if (startNs_ >= 0)
+        {
+            PhaseTracer::record(category_, name_, startNs_, PhaseTracer::nowNs() - startNs_);
+            startNs_ = -1;
+        }
+    }
+
+    /**
+     * 结束当前阶段并开始下一个阶段
+     * @param name 下一个阶段名称(字符串常量)
+     */
+    void next(const char *name)
+    {
+        end();
+        name_ = name;
+        if (PhaseTracer::isEnabled())
+        {
+            startNs_ = PhaseTracer::nowNs();
+        }
+    }
+
+private:
+    const char *category_;
+    const char *name_;
+    int64_t startNs_; // 未记录时为-1
+
+    TraceSpan(const TraceSpan &);
+    TraceSpan &operator=(const TraceSpan &);
+};
+
+#endif // PHASE_TRACER_H
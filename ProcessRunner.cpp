@@ -0,0 +1,565 @@
+#include "ProcessRunner.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char **environ;
+#endif // _WIN32
+
+#ifndef _WIN32
+namespace
+{
+const size_t kReadBufferSize = 64 * 1024; // 单次读取64KB, 避免逐行读取
+const int kExitPollMs = 100;              // 无数据时检查子进程是否已退出的间隔
+
+long elapsedSince(const std::chrono::steady_clock::time_point &start)
+{
+    return static_cast<long>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count());
+}
+
+int decodeWaitStatus(int status)
+{
+    if (WIFEXITED(status))
+    {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status))
+    {
+        return 128 + WTERMSIG(status);
+    }
+    return -1;
+}
+
+void closeFd(int &fd)
+{
+    if (fd >= 0)
+    {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void setNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0)
+    {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+}
+
+std::vector<char *> buildArgv(const std::vector<std::string> &argv)
+{
+    std::vector<char *> args;
+    args.reserve(argv.size() + 1);
+    for (const auto &arg : argv)
+    {
+        args.push_back(const_cast<char *>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+    return args;
+}
+
+// 子进程恢复默认信号处理和信号掩码, 避免继承父进程的屏蔽状态
+void initSpawnAttr(posix_spawnattr_t &attr, bool newSession)
+{
+    posix_spawnattr_init(&attr);
+    sigset_t emptyMask;
+    sigset_t defaultSignals;
+    sigemptyset(&emptyMask);
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    sigaddset(&defaultSignals, SIGINT);
+    sigaddset(&defaultSignals, SIGTERM);
+    sigaddset(&defaultSignals, SIGCHLD);
+    posix_spawnattr_setsigmask(&attr, &emptyMask);
+    posix_spawnattr_setsigdefault(&attr, &defaultSignals);
+
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+#ifdef POSIX_SPAWN_USEVFORK
+    flags |= POSIX_SPAWN_USEVFORK;
+#endif
+#ifdef POSIX_SPAWN_SETSID
+    if (newSession)
+    {
+        flags |= POSIX_SPAWN_SETSID;
+    }
+#else
+    (void)newSession;
+#endif
+    posix_spawnattr_setflags(&attr, flags);
+}
+
+// 读取fd中当前可用的数据, 返回false表示已到达EOF或出错
+bool drainFd(int fd, std::vector<char> &buffer, std::string &out)
+{
+    while (true)
+    {
+        ssize_t n = read(fd, buffer.data(), buffer.size());
+        if (n > 0)
+        {
+            out.append(buffer.data(), static_cast<size_t>(n));
+            if (static_cast<size_t>(n) < buffer.size())
+            {
+                return true;
+            }
+            continue;
+        }
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && errno == EAGAIN)
+        {
+            return true;
+        }
+        return false;
+    }
+}
+} // namespace
+#endif // _WIN32
+
+ProcessRunner::ProcessRunner() : buffer_(
+#ifndef _WIN32
+                                     kReadBufferSize
+#else
+                                     0
+#endif // _WIN32
+                                 )
+{
+}
+
+ProcessRunner::~ProcessRunner()
+{
+#ifndef _WIN32
+    reapDetached();
+#endif // _WIN32
+}
+
+bool ProcessRunner::run(const std::vector<std::string> &argv, ProcessResult &result,
+                        int timeoutMs, const std::string &input)
+{
+#ifndef _WIN32
+    result = ProcessResult();
+    if (argv.empty())
+    {
+        return false;
+    }
+    reapDetached();
+
+    auto start = std::chrono::steady_clock::now();
+
+    int outPipe[2] = {-1, -1};
+    int errPipe[2] = {-1, -1};
+    int inPipe[2] = {-1, -1};
+    if (pipe2(outPipe, O_CLOEXEC) != 0 || pipe2(errPipe, O_CLOEXEC) != 0 ||
+        (!input.empty() && pipe2(inPipe, O_CLOEXEC) != 0))
+    {
+        closeFd(outPipe[0]);
+        closeFd(outPipe[1]);
+        closeFd(errPipe[0]);
+        closeFd(errPipe[1]);
+        closeFd(inPipe[0]);
+        closeFd(inPipe[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (input.empty())
+    {
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    else
+    {
+        posix_spawn_file_actions_adddup2(&actions, inPipe[0], STDIN_FILENO);
+    }
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+
+    posix_spawnattr_t attr;
+    initSpawnAttr(attr, false);
+
+    std::vector<char *> args = buildArgv(argv);
+    pid_t pid = -1;
+    int spawnError = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    closeFd(outPipe[1]);
+    closeFd(errPipe[1]);
+    closeFd(inPipe[0]);
+
+    if (spawnError != 0)
+    {
+        closeFd(outPipe[0]);
+        closeFd(errPipe[0]);
+        closeFd(inPipe[1]);
+        result.errorOutput = std::string("spawn failed: ") + strerror(spawnError);
+        result.elapsedUs = elapsedSince(start);
+        return false;
+    }
+
+    // 写入标准输入时屏蔽SIGPIPE, 子进程提前退出时write返回EPIPE
+    sigset_t pipeMask;
+    sigset_t oldMask;
+    sigemptyset(&pipeMask);
+    sigaddset(&pipeMask, SIGPIPE);
+    bool maskedPipe = false;
+    if (inPipe[1] >= 0)
+    {
+        setNonBlocking(inPipe[1]);
+        maskedPipe = pthread_sigmask(SIG_BLOCK, &pipeMask, &oldMask) == 0;
+    }
+
+    int outFd = outPipe[0];
+    int errFd = errPipe[0];
+    int inFd = inPipe[1];
+    size_t inputOffset = 0;
+    bool exited = false;
+    int status = 0;
+
+    while (outFd >= 0 || errFd >= 0)
+    {
+        int waitMs = kExitPollMs;
+        if (timeoutMs >= 0)
+        {
+            long remainingMs = timeoutMs - elapsedSince(start) / 1000;
+            if (remainingMs <= 0)
+            {
+                result.timedOut = true;
+                break;
+            }
+            if (remainingMs < waitMs)
+            {
+                waitMs = static_cast<int>(remainingMs);
+            }
+        }
+
+        struct pollfd fds[3];
+        nfds_t count = 0;
+        int outIndex = -1, errIndex = -1, inIndex = -1;
+        if (outFd >= 0)
+        {
+            fds[count].fd = outFd;
+            fds[count].events = POLLIN;
+            outIndex = static_cast<int>(count++);
+        }
+        if (errFd >= 0)
+        {
+            fds[count].fd = errFd;
+            fds[count].events = POLLIN;
+            errIndex = static_cast<int>(count++);
+        }
+        if (inFd >= 0)
+        {
+            fds[count].fd = inFd;
+            fds[count].events = POLLOUT;
+            inIndex = static_cast<int>(count++);
+        }
+
+        int ready = poll(fds, count, waitMs);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        if (ready == 0)
+        {
+            // 子进程已退出但管道仍被其派生的守护进程持有时, 读完剩余数据后结束
+            pid_t waited = waitpid(pid, &status, WNOHANG);
+            if (waited == pid)
+            {
+                exited = true;
+                if (outFd >= 0)
+                {
+                    setNonBlocking(outFd);
+                    drainFd(outFd, buffer_, result.output);
+                }
+                if (errFd >= 0)
+                {
+                    setNonBlocking(errFd);
+                    drainFd(errFd, buffer_, result.errorOutput);
+                }
+                break;
+            }
+            continue;
+        }
+
+        if (inIndex >= 0 && (fds[inIndex].revents & (POLLOUT | POLLERR | POLLHUP)))
+        {
+            ssize_t n = write(inFd, input.data() + inputOffset, input.size() - inputOffset);
+            if (n > 0)
+            {
+                inputOffset += static_cast<size_t>(n);
+            }
+            if ((n < 0 && errno != EAGAIN && errno != EINTR) || inputOffset >= input.size())
+            {
+                closeFd(inFd);
+            }
+        }
+        if (outIndex >= 0 && (fds[outIndex].revents & (POLLIN | POLLHUP | POLLERR)))
+        {
+            ssize_t n = read(outFd, buffer_.data(), buffer_.size());
+            if (n > 0)
+            {
+                result.output.append(buffer_.data(), static_cast<size_t>(n));
+            }
+            else if (n == 0 || (errno != EINTR && errno != EAGAIN))
+            {
+                closeFd(outFd);
+            }
+        }
+        if (errIndex >= 0 && (fds[errIndex].revents & (POLLIN | POLLHUP | POLLERR)))
+        {
+            ssize_t n = read(errFd, buffer_.data(), buffer_.size());
+            if (n > 0)
+            {
+                result.errorOutput.append(buffer_.data(), static_cast<size_t>(n));
+            }
+            else if (n == 0 || (errno != EINTR && errno != EAGAIN))
+            {
+                closeFd(errFd);
+            }
+        }
+    }
+
+    closeFd(outFd);
+    closeFd(errFd);
+    closeFd(inFd);
+    if (maskedPipe)
+    {
+        // 丢弃写管道期间产生的SIGPIPE, 再恢复原信号掩码
+        struct timespec zero = {0, 0};
+        while (sigtimedwait(&pipeMask, nullptr, &zero) > 0)
+        {
+        }
+        pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+    }
+
+    if (!exited)
+    {
+        if (result.timedOut)
+        {
+            kill(pid, SIGTERM);
+            // 给子进程最多1秒处理SIGTERM, 之后强制结束
+            for (int i = 0; i < 100; i++)
+            {
+                if (waitpid(pid, &status, WNOHANG) == pid)
+                {
+                    exited = true;
+                    break;
+                }
+                usleep(10000);
+            }
+            if (!exited)
+            {
+                kill(pid, SIGKILL);
+            }
+        }
+        while (!exited)
+        {
+            pid_t waited = waitpid(pid, &status, 0);
+            if (waited == pid || (waited < 0 && errno != EINTR))
+            {
+                exited = true;
+            }
+        }
+    }
+
+    result.exitStatus = result.timedOut ? 124 : decodeWaitStatus(status);
+    result.elapsedUs = elapsedSince(start);
+    return true;
+#else
+    result = ProcessResult();
+    return false;
+#endif // _WIN32
+}
+
+std::string ProcessRunner::capture(const std::vector<std::string> &argv, int timeoutMs)
+{
+    ProcessResult result;
+    if (!run(argv, result, timeoutMs))
+    {
+        return "";
+    }
+    return result.output;
+}
+
+bool ProcessRunner::succeeded(const std::vector<std::string> &argv, int timeoutMs)
+{
+    ProcessResult result;
+    return run(argv, result, timeoutMs) && result.exitStatus == 0;
+}
+
+bool ProcessRunner::spawnDetached(const std::vector<std::string> &argv, const std::string &logPath)
+{
+#ifndef _WIN32
+    if (argv.empty())
+    {
+        return false;
+    }
+    reapDetached();
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    if (logPath.empty())
+    {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    }
+    else
+    {
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, logPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    posix_spawnattr_t attr;
+    initSpawnAttr(attr, true);
+
+    std::vector<char *> args = buildArgv(argv);
+    pid_t pid = -1;
+    int spawnError = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    if (spawnError != 0)
+    {
+        return false;
+    }
+    detached_.push_back(pid);
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool ProcessRunner::spawnPiped(const std::vector<std::string> &argv, pid_t &pid, int &stdinFd, int &stdoutFd)
+{
+#ifndef _WIN32
+    pid = -1;
+    stdinFd = -1;
+    stdoutFd = -1;
+    if (argv.empty())
+    {
+        return false;
+    }
+
+    int inPipe[2] = {-1, -1};
+    int outPipe[2] = {-1, -1};
+    if (pipe2(inPipe, O_CLOEXEC) != 0 || pipe2(outPipe, O_CLOEXEC) != 0)
+    {
+        closeFd(inPipe[0]);
+        closeFd(inPipe[1]);
+        closeFd(outPipe[0]);
+        closeFd(outPipe[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, inPipe[0], STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDERR_FILENO);
+
+    posix_spawnattr_t attr;
+    initSpawnAttr(attr, false);
+
+    std::vector<char *> args = buildArgv(argv);
+    int spawnError = posix_spawnp(&pid, args[0], &actions, &attr, args.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    closeFd(inPipe[0]);
+    closeFd(outPipe[1]);
+    if (spawnError != 0)
+    {
+        closeFd(inPipe[1]);
+        closeFd(outPipe[0]);
+        pid = -1;
+        return false;
+    }
+
+    stdinFd = inPipe[1];
+    stdoutFd = outPipe[0];
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+int ProcessRunner::terminate(pid_t pid, int graceMs)
+{
+#ifndef _WIN32
+    if (pid <= 0)
+    {
+        return -1;
+    }
+
+    int status = 0;
+    const int stepMs = 10;
+    for (int waited = 0; waited <= graceMs; waited += stepMs)
+    {
+        pid_t result = waitpid(pid, &status, WNOHANG);
+        if (result == pid)
+        {
+            return decodeWaitStatus(status);
+        }
+        if (result < 0)
+        {
+            return -1;
+        }
+        usleep(stepMs * 1000);
+    }
+
+    kill(pid, SIGTERM);
+    for (int waited = 0; waited <= 1000; waited += stepMs)
+    {
+        if (waitpid(pid, &status, WNOHANG) == pid)
+        {
+            return decodeWaitStatus(status);
+        }
+        usleep(stepMs * 1000);
+    }
+
+    kill(pid, SIGKILL);
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR)
+    {
+    }
+    return decodeWaitStatus(status);
+#else
+    return -1;
+#endif // _WIN32
+}
+
+void ProcessRunner::reapDetached()
+{
+#ifndef _WIN32
+    for (size_t i = 0; i < detached_.size();)
+    {
+        int status = 0;
+        pid_t waited = waitpid(detached_[i], &status, WNOHANG);
+        if (waited == detached_[i] || (waited < 0 && errno == ECHILD))
+        {
+            detached_[i] = detached_.back();
+            detached_.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+#endif // _WIN32
+}
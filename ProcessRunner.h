@@ -0,0 +1,100 @@
+#ifndef PROCESS_RUNNER_H
+#define PROCESS_RUNNER_H
+
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif // _WIN32
+
+struct ProcessResult
+{
+    int exitStatus;          // 退出码(被信号终止时为128+信号值, 启动失败为-1, 超时为124)
+    std::string output;      // 标准输出
+    std::string errorOutput; // 标准错误输出
+    long elapsedUs;          // 执行耗时(微秒)
+    bool timedOut;           // 是否因超时被终止
+
+    ProcessResult() : exitStatus(-1), elapsedUs(0), timedOut(false) {}
+};
+
+/*
+ * 轻量进程执行器
+ * 通过posix_spawn直接启动argv指定的程序(不经过/bin/sh),
+ * 使用poll同时读取stdout/stderr, 读缓冲区在多次调用间复用
+ */
+class ProcessRunner
+{
+public:
+    ProcessRunner();
+    ~ProcessRunner();
+
+    /**
+     * 执行命令并等待其结束
+     * @param argv 程序及参数(argv[0]按PATH查找)
+     * @param result 执行结果
+     * @param timeoutMs 超时时间(毫秒), 小于0表示不超时; 超时后终止子进程并保留已读取的输出
+     * @param input 写入子进程标准输入的数据, 为空时标准输入重定向到/dev/null
+     * @return 进程成功启动返回true(不代表退出码为0)
+     */
+    bool run(const std::vector<std::string> &argv, ProcessResult &result,
+             int timeoutMs = -1, const std::string &input = "");
+
+    /**
+     * 执行命令并返回标准输出
+     * @param argv 程序及参数
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 标准输出内容, 启动失败返回空字符串
+     */
+    std::string capture(const std::vector<std::string> &argv, int timeoutMs = -1);
+
+    /**
+     * 执行命令并判断退出码
+     * @param argv 程序及参数
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 退出码为0返回true
+     */
+    bool succeeded(const std::vector<std::string> &argv, int timeoutMs = -1);
+
+    /**
+     * 启动后台进程, 不等待其结束(替代shell中的 "cmd &")
+     * 子进程在新会话中运行, 标准输入重定向到/dev/null
+     * @param argv 程序及参数
+     * @param logPath 标准输出和标准错误的重定向文件, 为空时重定向到/dev/null
+     * @return 启动成功返回true
+     */
+    bool spawnDetached(const std::vector<std::string> &argv, const std::string &logPath = "");
+
+    /**
+     * 启动长期运行的协同进程, 返回与其标准输入/输出相连的管道
+     * 标准错误合并到标准输出, 管道均设置O_CLOEXEC
+     * @param argv 程序及参数
+     * @param pid 子进程ID
+     * @param stdinFd 写入端, 连接子进程标准输入
+     * @param stdoutFd 读取端, 连接子进程标准输出
+     * @return 启动成功返回true
+     */
+    static bool spawnPiped(const std::vector<std::string> &argv, pid_t &pid, int &stdinFd, int &stdoutFd);
+
+    /**
+     * 结束并回收子进程: 先等待graceMs, 再依次发送SIGTERM和SIGKILL
+     * @param pid 子进程ID
+     * @param graceMs 等待子进程自行退出的时间(毫秒)
+     * @return 子进程退出码(同ProcessResult::exitStatus)
+     */
+    static int terminate(pid_t pid, int graceMs);
+
+private:
+    std::vector<char> buffer_;    // 复用的读缓冲区
+    std::vector<pid_t> detached_; // 已启动的后台进程, 用于回收僵尸进程
+
+    void reapDetached();
+
+    ProcessRunner(const ProcessRunner &);
+    ProcessRunner &operator=(const ProcessRunner &);
+};
+
+#endif // PROCESS_RUNNER_H
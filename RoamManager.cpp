@@ -0,0 +1,378 @@
+#include "RoamManager.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+// 候选表上限(一个SSID在一层楼内的AP数量)
+const size_t kMaxCandidates = 32;
+
+int elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+}
+} // namespace
+
+SupplicantRoamLink::SupplicantRoamLink(const std::string &socketPath) : socketPath_(socketPath)
+{
+}
+
+bool SupplicantRoamLink::ensureOpen()
+{
+    return ctrl_.isOpen() || ctrl_.open(socketPath_);
+}
+
+bool SupplicantRoamLink::poll(LinkSample &sample)
+{
+    std::string status;
+    std::string signal;
+    if (!ensureOpen())
+    {
+        return false;
+    }
+    if (!ctrl_.request("STATUS", status) || !ctrl_.request("SIGNAL_POLL", signal))
+    {
+        // wpa_supplicant可能已重启, 下次重新连接
+        ctrl_.close();
+        return false;
+    }
+    if (WpaCtrl::getValue(status, "wpa_state") != "COMPLETED" ||
+        !MacAddress::parse(WpaCtrl::getValue(status, "bssid"), sample.bssid))
+    {
+        return false;
+    }
+    sample.ssid = WpaCtrl::getValue(status, "ssid");
+    std::string rssi = WpaCtrl::getValue(signal, "RSSI");
+    std::string frequency = WpaCtrl::getValue(signal, "FREQUENCY");
+    if (!TextView(frequency).toInt(sample.frequency))
+    {
+        sample.frequency = 0;
+    }
+    return TextView(rssi).toInt(sample.signalStrength);
+}
+
+bool SupplicantRoamLink::roam(const MacAddress &bssid, int timeoutMs)
+{
+    std::string reply;
+    if (!ensureOpen() || (!ctrl_.isAttached() && !ctrl_.attach()))
+    {
+        return false;
+    }
+    if (!ctrl_.request("ROAM " + bssid.toString(), reply) || reply.compare(0, 2, "OK") != 0)
+    {
+        ctrl_.detach();
+        return false;
+    }
+
+    // 重新关联完成时报告 "CTRL-EVENT-CONNECTED - Connection to <bssid> completed"
+    bool connected = false;
+    std::string target = bssid.toString();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!connected)
+    {
+        int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                             deadline - std::chrono::steady_clock::now())
+                                             .count());
+        std::string event;
+        if (remaining <= 0 || !ctrl_.waitEvent(event, remaining))
+        {
+            break;
+        }
+        connected = event.compare(0, 20, "CTRL-EVENT-CONNECTED") == 0 && event.find(target) != std::string::npos;
+    }
+    ctrl_.detach();
+    return connected;
+}
+
+RoamManager::RoamManager(ScanSource &source, ScanClock &clock, RoamLink &link)
+    : source_(source), clock_(clock), link_(link), running_(false), lowSamples_(0), nextSampleMs_(0),
+      cooldownUntilMs_(0)
+{
+}
+
+RoamManager::~RoamManager()
+{
+    stop();
+}
+
+void RoamManager::setConfig(const RoamConfig &config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    nextSampleMs_ = std::min(nextSampleMs_, clock_.nowMs() + config_.sampleIntervalMs);
+    wakeup_.notify_all();
+}
+
+RoamConfig RoamManager::getConfig() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+bool RoamManager::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_)
+    {
+        return true;
+    }
+    running_ = true;
+    nextSampleMs_ = clock_.nowMs();
+    thread_ = std::thread(&RoamManager::run, this);
+    return true;
+}
+
+void RoamManager::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        running_ = false;
+        wakeup_.notify_all();
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool RoamManager::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+void RoamManager::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_)
+    {
+        int64_t waitMs = nextSampleMs_ - clock_.nowMs();
+        if (waitMs > 0)
+        {
+            wakeup_.wait_for(lock, std::chrono::milliseconds(waitMs));
+            continue;
+        }
+        lock.unlock();
+        tick();
+        lock.lock();
+    }
+}
+
+RoamCandidate &RoamManager::updateCandidate(const MacAddress &bssid, int frequency, int signalStrength,
+                                             int64_t nowMs)
+{
+    auto it = std::find_if(candidates_.begin(), candidates_.end(),
+                           [&bssid](const RoamCandidate &candidate)
+                           {
+                               return candidate.bssid == bssid;
+                           });
+    if (it == candidates_.end())
+    {
+        if (candidates_.size() >= kMaxCandidates)
+        {
+            candidates_.erase(std::min_element(candidates_.begin(), candidates_.end(),
+                                               [](const RoamCandidate &a, const RoamCandidate &b)
+                                               {
+                                                   return a.lastSeenMs < b.lastSeenMs;
+                                               }));
+        }
+        RoamCandidate candidate;
+        candidate.bssid = bssid;
+        candidates_.push_back(candidate);
+        it = candidates_.end() - 1;
+    }
+    if (frequency > 0)
+    {
+        it->frequency = frequency;
+    }
+    it->signalStrength = signalStrength;
+    it->lastSeenMs = nowMs;
+    return *it;
+}
+
+bool RoamManager::tick()
+{
+    std::lock_guard<std::mutex> tickLock(tickMutex_);
+    int64_t nowMs = clock_.nowMs();
+    RoamConfig config;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (nowMs < nextSampleMs_)
+        {
+            return false;
+        }
+        nextSampleMs_ = nowMs + config_.sampleIntervalMs;
+        config = config_;
+    }
+
+    LinkSample sample;
+    bool associated = link_.poll(sample) && !sample.ssid.empty();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.samples++;
+        if (!associated)
+        {
+            lowSamples_ = 0;
+            return true;
+        }
+        if (sample.ssid != ssid_)
+        {
+            // 换了网络, 之前的候选没有意义
+            ssid_ = sample.ssid;
+            candidates_.clear();
+            lowSamples_ = 0;
+        }
+        updateCandidate(sample.bssid, sample.frequency, sample.signalStrength, nowMs);
+        // 丢弃长时间没有扫描到的候选
+        candidates_.erase(std::remove_if(candidates_.begin(), candidates_.end(),
+                                         [&](const RoamCandidate &candidate)
+                                         {
+                                             return nowMs - candidate.lastSeenMs > config.candidateMaxAgeMs;
+                                         }),
+                          candidates_.end());
+
+        if (sample.signalStrength >= config.thresholdDbm)
+        {
+            lowSamples_ = 0;
+            return true;
+        }
+        if (++lowSamples_ < config.lowSampleCount || nowMs < cooldownUntilMs_)
+        {
+            return true;
+        }
+        lowSamples_ = 0;
+        stats_.triggers++;
+    }
+    evaluate(sample);
+    return true;
+}
+
+bool RoamManager::scanForCandidate(const ScanParams &params, const LinkSample &sample, RoamCandidate &best)
+{
+    bool ok = source_.scanTargeted(table_, params);
+    int64_t nowMs = clock_.nowMs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ok)
+    {
+        return false;
+    }
+    bool found = false;
+    for (uint32_t row = 0; row < table_.size(); row++)
+    {
+        if (table_.ssid(row) != TextView(ssid_))
+        {
+            continue;
+        }
+        const RoamCandidate &candidate =
+            updateCandidate(table_.bssid(row), table_.frequency(row), table_.signalStrength(row), nowMs);
+        if (candidate.bssid == sample.bssid || candidate.failedUntilMs > nowMs ||
+            candidate.signalStrength < sample.signalStrength + config_.hysteresisDb)
+        {
+            continue;
+        }
+        if (!found || candidate.signalStrength > best.signalStrength)
+        {
+            best = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void RoamManager::evaluate(const LinkSample &sample)
+{
+    auto triggerStart = std::chrono::steady_clock::now();
+    ScanParams params;
+    params.ssids.push_back(sample.ssid);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &candidate : candidates_)
+        {
+            if (candidate.frequency > 0 &&
+                std::find(params.frequencies.begin(), params.frequencies.end(), candidate.frequency) ==
+                    params.frequencies.end())
+            {
+                params.frequencies.push_back(candidate.frequency);
+            }
+        }
+    }
+
+    // 先只扫描已知AP所在的频率, 没有更好的AP时再扫描全部信道
+    RoamCandidate best;
+    bool found = false;
+    if (!params.frequencies.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.directedScans++;
+        }
+        found = scanForCandidate(params, sample, best);
+    }
+    if (!found)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.fullScans++;
+        }
+        params.frequencies.clear();
+        found = scanForCandidate(params, sample, best);
+    }
+
+    RoamConfig config = getConfig();
+    if (!found)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.noCandidate++;
+        cooldownUntilMs_ = clock_.nowMs() + config.cooldownMs;
+        return;
+    }
+
+    auto roamStart = std::chrono::steady_clock::now();
+    bool roamed = link_.roam(best.bssid, config.roamTimeoutMs);
+    int roamMs = elapsedMs(roamStart);
+    int totalMs = elapsedMs(triggerStart);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t nowMs = clock_.nowMs();
+    cooldownUntilMs_ = nowMs + config.cooldownMs;
+    if (roamed)
+    {
+        stats_.roams++;
+        stats_.lastRoamMs = roamMs;
+        stats_.lastTotalMs = totalMs;
+        stats_.totalRoamMs += roamMs;
+        return;
+    }
+    stats_.failures++;
+    for (auto &candidate : candidates_)
+    {
+        if (candidate.bssid == best.bssid)
+        {
+            // 漫游失败的AP暂时不再选择, 避免反复尝试
+            candidate.failedUntilMs = nowMs + 4 * static_cast<int64_t>(config.cooldownMs);
+        }
+    }
+}
+
+void RoamManager::candidates(std::vector<RoamCandidate> &candidates) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    candidates = candidates_;
+    std::sort(candidates.begin(), candidates.end(),
+              [](const RoamCandidate &a, const RoamCandidate &b)
+              {
+                  return a.signalStrength > b.signalStrength;
+              });
+}
+
+RoamStats RoamManager::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
@@ -0,0 +1,197 @@
+#ifndef ROAM_MANAGER_H
+#define ROAM_MANAGER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include "WifiTypes.h"
+#include "ScanTable.h"
+#include "ScanService.h"
+#include "WpaCtrl.h"
+
+// 一次链路采样
+struct LinkSample
+{
+    std::string ssid;
+    MacAddress bssid;
+    int signalStrength; // dBm
+    int frequency;      // MHz
+
+    LinkSample() : signalStrength(0), frequency(0) {}
+};
+
+/*
+ * 当前关联的链路: 采样信号并执行漫游.
+ * 由漫游线程调用, 实现不能与其他线程共用控制连接
+ */
+class RoamLink
+{
+public:
+    virtual ~RoamLink() {}
+
+    /**
+     * 读取当前关联状态
+     * @param sample 采样结果
+     * @return 已关联返回true
+     */
+    virtual bool poll(LinkSample &sample) = 0;
+
+    /**
+     * 漫游到同一SSID的另一个BSSID, 阻塞到完成或超时
+     * @param bssid 目标AP
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 已关联到目标AP返回true
+     */
+    virtual bool roam(const MacAddress &bssid, int timeoutMs) = 0;
+};
+
+/*
+ * 通过wpa_supplicant控制接口采样(STATUS/SIGNAL_POLL)和漫游(ROAM <bssid>),
+ * 使用独立的控制连接, 不影响前台的请求和事件订阅
+ */
+class SupplicantRoamLink : public RoamLink
+{
+public:
+    explicit SupplicantRoamLink(const std::string &socketPath);
+
+    bool poll(LinkSample &sample) override;
+    bool roam(const MacAddress &bssid, int timeoutMs) override;
+
+private:
+    std::string socketPath_;
+    WpaCtrl ctrl_;
+
+    bool ensureOpen();
+
+    SupplicantRoamLink(const SupplicantRoamLink &);
+    SupplicantRoamLink &operator=(const SupplicantRoamLink &);
+};
+
+struct RoamConfig
+{
+    int thresholdDbm;     // 信号低于该值开始计数
+    int hysteresisDb;     // 候选AP至少比当前AP强这么多才漫游
+    int lowSampleCount;   // 连续这么多次采样低于阈值才触发
+    int sampleIntervalMs; // 采样间隔
+    int cooldownMs;       // 漫游(或未找到候选)后暂停触发的时间
+    int roamTimeoutMs;    // 等待漫游完成的时间
+    int candidateMaxAgeMs; // 候选AP超过该时间未扫描到则丢弃
+
+    RoamConfig()
+        : thresholdDbm(-75), hysteresisDb(8), lowSampleCount(3), sampleIntervalMs(2000), cooldownMs(15000),
+          roamTimeoutMs(3000), candidateMaxAgeMs(120000) {}
+};
+
+// 同一SSID的一个BSS
+struct RoamCandidate
+{
+    MacAddress bssid;
+    int frequency;
+    int signalStrength;
+    int64_t lastSeenMs;
+    int64_t failedUntilMs; // 漫游失败后在此之前不再选择
+
+    RoamCandidate() : frequency(0), signalStrength(0), lastSeenMs(0), failedUntilMs(0) {}
+};
+
+struct RoamStats
+{
+    int samples;       // 链路采样次数
+    int triggers;      // 信号持续低于阈值而开始查找候选的次数
+    int directedScans; // 只扫描候选AP所在频率
+    int fullScans;     // 定向扫描未找到更好的AP后全信道扫描
+    int noCandidate;   // 没有满足迟滞条件的候选AP
+    int roams;         // 成功漫游
+    int failures;      // 漫游失败
+    int lastRoamMs;    // 最近一次ROAM到关联完成的耗时
+    int lastTotalMs;   // 最近一次从触发(扫描开始)到关联完成的耗时
+    int64_t totalRoamMs;
+
+    RoamStats()
+        : samples(0), triggers(0), directedScans(0), fullScans(0), noCandidate(0), roams(0), failures(0),
+          lastRoamMs(-1), lastTotalMs(-1), totalRoamMs(0) {}
+};
+
+/*
+ * 同一SSID多个AP之间的信号触发漫游
+ * 定期采样当前链路, 信号连续lowSampleCount次低于阈值时先在已知候选AP的频率上定向扫描,
+ * 没有比当前AP强hysteresisDb以上的AP时再全信道扫描, 找到后经RoamLink漫游并记录耗时.
+ * 扫描结果中该SSID的全部BSSID都保留为候选. start()启动后台线程; 也可以配合VirtualScanClock调用tick()驱动
+ */
+class RoamManager
+{
+public:
+    RoamManager(ScanSource &source, ScanClock &clock, RoamLink &link);
+    ~RoamManager();
+
+    void setConfig(const RoamConfig &config);
+    RoamConfig getConfig() const;
+
+    /**
+     * 启动后台采样线程
+     * @return 成功返回true
+     */
+    bool start();
+
+    /**
+     * 停止后台线程(等待正在进行的扫描/漫游结束)
+     */
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * 到达采样时间时采样一次, 满足条件时扫描并漫游
+     * @return 进行了采样返回true
+     */
+    bool tick();
+
+    /**
+     * 当前SSID的候选AP(包括当前AP)
+     * @param candidates 按信号从强到弱
+     */
+    void candidates(std::vector<RoamCandidate> &candidates) const;
+
+    RoamStats getStats() const;
+
+private:
+    ScanSource &source_;
+    ScanClock &clock_;
+    RoamLink &link_;
+    RoamConfig config_;
+
+    mutable std::mutex mutex_; // 保护配置、候选表、统计和调度状态
+    std::mutex tickMutex_;     // 串行化采样(扫描和漫游期间不持有mutex_)
+    std::condition_variable wakeup_;
+    std::thread thread_;
+    bool running_;
+
+    std::string ssid_;
+    std::vector<RoamCandidate> candidates_;
+    ScanTable table_; // 扫描缓冲, 只在持有tickMutex_时访问
+    RoamStats stats_;
+    int lowSamples_;
+    int64_t nextSampleMs_;
+    int64_t cooldownUntilMs_;
+
+    void run();
+    /*
+     * 查找并漫游到更好的AP
+     */
+    void evaluate(const LinkSample &sample);
+    /*
+     * 扫描并合并结果, 返回满足迟滞条件的最强候选
+     */
+    bool scanForCandidate(const ScanParams &params, const LinkSample &sample, RoamCandidate &best);
+    /*
+     * 更新候选表, 调用时持有mutex_
+     */
+    RoamCandidate &updateCandidate(const MacAddress &bssid, int frequency, int signalStrength, int64_t nowMs);
+
+    RoamManager(const RoamManager &);
+    RoamManager &operator=(const RoamManager &);
+};
+
+#endif // ROAM_MANAGER_H
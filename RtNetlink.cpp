@@ -0,0 +1,709 @@
+#include "RtNetlink.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/neighbour.h>
+#include <net/if.h>
+#endif // _WIN32
+
+#ifndef _WIN32
+namespace
+{
+const size_t kReceiveBufferSize = 64 * 1024;
+
+std::string formatIPv4(const uint8_t *data)
+{
+    char text[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, data, text, sizeof(text));
+    return text;
+}
+
+/*
+ * 遍历一段数据中指定类型的rtnetlink消息, 对每条消息调用visitor(消息体, 长度)
+ */
+template <typename Visitor>
+void forEachMessage(const uint8_t *data, size_t length, uint16_t type, Visitor visitor)
+{
+    size_t offset = 0;
+    while (offset + NLMSG_HDRLEN <= length)
+    {
+        const struct nlmsghdr *header = reinterpret_cast<const struct nlmsghdr *>(data + offset);
+        if (header->nlmsg_len < NLMSG_HDRLEN || offset + header->nlmsg_len > length)
+        {
+            break;
+        }
+        if (header->nlmsg_type == type)
+        {
+            visitor(reinterpret_cast<const uint8_t *>(NLMSG_DATA(header)), header->nlmsg_len - NLMSG_HDRLEN);
+        }
+        offset += NLMSG_ALIGN(header->nlmsg_len);
+    }
+}
+
+/*
+ * 遍历消息体中固定头之后的rtattr属性, 对每个属性调用visitor(类型, 内容, 长度)
+ */
+template <typename Visitor>
+void forEachAttribute(const uint8_t *payload, size_t length, size_t headerLength, Visitor visitor)
+{
+    size_t offset = NLMSG_ALIGN(headerLength);
+    while (offset + RTA_LENGTH(0) <= length)
+    {
+        const struct rtattr *attribute = reinterpret_cast<const struct rtattr *>(payload + offset);
+        if (attribute->rta_len < RTA_LENGTH(0) || offset + attribute->rta_len > length)
+        {
+            break;
+        }
+        visitor(attribute->rta_type, payload + offset + RTA_LENGTH(0), attribute->rta_len - RTA_LENGTH(0));
+        offset += RTA_ALIGN(attribute->rta_len);
+    }
+}
+
+/*
+ * 构造只含固定头的请求消息, 属性通过appendAttribute追加
+ */
+std::vector<uint8_t> startMessage(uint16_t type, uint16_t flags, const void *header, size_t headerLength)
+{
+    std::vector<uint8_t> message(NLMSG_SPACE(headerLength), 0);
+    struct nlmsghdr *nlh = reinterpret_cast<struct nlmsghdr *>(message.data());
+    nlh->nlmsg_len = static_cast<uint32_t>(message.size());
+    nlh->nlmsg_type = type;
+    nlh->nlmsg_flags = static_cast<uint16_t>(NLM_F_REQUEST | flags);
+    memcpy(NLMSG_DATA(nlh), header, headerLength);
+    return message;
+}
+
+void appendAttribute(std::vector<uint8_t> &message, uint16_t type, const void *data, size_t length)
+{
+    size_t offset = message.size();
+    message.resize(offset + RTA_SPACE(length), 0);
+    struct rtattr *attribute = reinterpret_cast<struct rtattr *>(message.data() + offset);
+    attribute->rta_len = static_cast<uint16_t>(RTA_LENGTH(length));
+    attribute->rta_type = type;
+    memcpy(RTA_DATA(attribute), data, length);
+    reinterpret_cast<struct nlmsghdr *>(message.data())->nlmsg_len = static_cast<uint32_t>(message.size());
+}
+
+const char *operationName(uint16_t type)
+{
+    switch (type)
+    {
+    case RTM_NEWADDR:
+        return "add address";
+    case RTM_DELADDR:
+        return "delete address";
+    case RTM_NEWROUTE:
+        return "add default route";
+    case RTM_DELROUTE:
+        return "delete default route";
+    case RTM_NEWLINK:
+        return "set link up";
+    default:
+        return "request";
+    }
+}
+} // namespace
+#endif // _WIN32
+
+RtNetlink::RtNetlink()
+    : fd_(-1), sequence_(0), buffer_(kReceiveBufferSize)
+{
+}
+
+RtNetlink::~RtNetlink()
+{
+    close();
+}
+
+bool RtNetlink::open()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        return true;
+    }
+    fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd_ < 0)
+    {
+        return false;
+    }
+    struct sockaddr_nl local;
+    memset(&local, 0, sizeof(local));
+    local.nl_family = AF_NETLINK;
+    if (bind(fd_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0)
+    {
+        close();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void RtNetlink::close()
+{
+#ifndef _WIN32
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif // _WIN32
+}
+
+template <typename Entry>
+bool RtNetlink::dump(uint16_t type, const void *header, size_t headerLength,
+                     void (*decoder)(const uint8_t *, size_t, std::vector<Entry> &), std::vector<Entry> &entries)
+{
+#ifndef _WIN32
+    entries.clear();
+    if (!open())
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> request = startMessage(type, NLM_F_DUMP, header, headerLength);
+    struct nlmsghdr *message = reinterpret_cast<struct nlmsghdr *>(request.data());
+    message->nlmsg_seq = ++sequence_;
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd_, request.data(), message->nlmsg_len, 0,
+               reinterpret_cast<struct sockaddr *>(&kernel), sizeof(kernel)) < 0)
+    {
+        close();
+        return false;
+    }
+
+    uint32_t sequence = sequence_;
+    while (true)
+    {
+        ssize_t received = recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            close();
+            return false;
+        }
+
+        bool done = false;
+        bool failed = false;
+        size_t offset = 0;
+        size_t length = static_cast<size_t>(received);
+        while (offset + NLMSG_HDRLEN <= length)
+        {
+            const struct nlmsghdr *reply = reinterpret_cast<const struct nlmsghdr *>(buffer_.data() + offset);
+            if (reply->nlmsg_len < NLMSG_HDRLEN || offset + reply->nlmsg_len > length)
+            {
+                break;
+            }
+            if (reply->nlmsg_seq == sequence)
+            {
+                if (reply->nlmsg_type == NLMSG_DONE)
+                {
+                    done = true;
+                }
+                else if (reply->nlmsg_type == NLMSG_ERROR)
+                {
+                    done = true;
+                    failed = true;
+                }
+            }
+            offset += NLMSG_ALIGN(reply->nlmsg_len);
+        }
+        decoder(buffer_.data(), length, entries);
+        if (done)
+        {
+            return !failed;
+        }
+    }
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool RtNetlink::getAddresses(std::vector<InterfaceAddress> &addresses)
+{
+#ifndef _WIN32
+    struct ifaddrmsg header;
+    memset(&header, 0, sizeof(header));
+    header.ifa_family = AF_INET;
+    return dump(RTM_GETADDR, &header, sizeof(header), &RtNetlink::decodeAddresses, addresses);
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool RtNetlink::getRoutes(std::vector<RouteEntry> &routes)
+{
+#ifndef _WIN32
+    struct rtmsg header;
+    memset(&header, 0, sizeof(header));
+    header.rtm_family = AF_INET;
+    header.rtm_table = RT_TABLE_MAIN;
+    return dump(RTM_GETROUTE, &header, sizeof(header), &RtNetlink::decodeRoutes, routes);
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool RtNetlink::getNeighbors(std::vector<NeighborEntry> &neighbors)
+{
+#ifndef _WIN32
+    struct ndmsg header;
+    memset(&header, 0, sizeof(header));
+    header.ndm_family = AF_INET;
+    return dump(RTM_GETNEIGH, &header, sizeof(header), &RtNetlink::decodeNeighbors, neighbors);
+#else
+    return false;
+#endif // _WIN32
+}
+
+void RtNetlink::decodeAddresses(const uint8_t *data, size_t length, std::vector<InterfaceAddress> &addresses)
+{
+#ifndef _WIN32
+    forEachMessage(data, length, RTM_NEWADDR, [&addresses](const uint8_t *payload, size_t size)
+                   {
+        if (size < sizeof(struct ifaddrmsg))
+        {
+            return;
+        }
+        struct ifaddrmsg header;
+        memcpy(&header, payload, sizeof(header));
+        if (header.ifa_family != AF_INET)
+        {
+            return;
+        }
+
+        InterfaceAddress entry;
+        entry.ifindex = static_cast<int>(header.ifa_index);
+        entry.prefixLength = header.ifa_prefixlen;
+        std::string local;
+        std::string address;
+        forEachAttribute(payload, size, sizeof(header), [&](uint16_t type, const uint8_t *value, size_t valueSize)
+                         {
+            if (type == IFA_LOCAL && valueSize >= 4)
+            {
+                local = formatIPv4(value);
+            }
+            else if (type == IFA_ADDRESS && valueSize >= 4)
+            {
+                address = formatIPv4(value);
+            }
+            else if (type == IFA_BROADCAST && valueSize >= 4)
+            {
+                entry.broadcast = formatIPv4(value);
+            }
+            else if (type == IFA_LABEL)
+            {
+                entry.label.assign(reinterpret_cast<const char *>(value), strnlen(reinterpret_cast<const char *>(value), valueSize));
+            }
+        });
+        // 点对点接口的IFA_ADDRESS为对端地址, 本机地址以IFA_LOCAL为准
+        entry.address = local.empty() ? address : local;
+        if (!entry.address.empty())
+        {
+            addresses.push_back(entry);
+        }
+    });
+#endif // _WIN32
+}
+
+void RtNetlink::decodeRoutes(const uint8_t *data, size_t length, std::vector<RouteEntry> &routes)
+{
+#ifndef _WIN32
+    forEachMessage(data, length, RTM_NEWROUTE, [&routes](const uint8_t *payload, size_t size)
+                   {
+        if (size < sizeof(struct rtmsg))
+        {
+            return;
+        }
+        struct rtmsg header;
+        memcpy(&header, payload, sizeof(header));
+        if (header.rtm_family != AF_INET || header.rtm_type != RTN_UNICAST)
+        {
+            return;
+        }
+
+        RouteEntry entry;
+        entry.prefixLength = header.rtm_dst_len;
+        entry.table = header.rtm_table;
+        entry.destination = "0.0.0.0";
+        forEachAttribute(payload, size, sizeof(header), [&entry](uint16_t type, const uint8_t *value, size_t valueSize)
+                         {
+            if (type == RTA_DST && valueSize >= 4)
+            {
+                entry.destination = formatIPv4(value);
+            }
+            else if (type == RTA_GATEWAY && valueSize >= 4)
+            {
+                entry.gateway = formatIPv4(value);
+            }
+            else if (type == RTA_OIF && valueSize >= 4)
+            {
+                uint32_t ifindex;
+                memcpy(&ifindex, value, sizeof(ifindex));
+                entry.ifindex = static_cast<int>(ifindex);
+            }
+            else if (type == RTA_PRIORITY && valueSize >= 4)
+            {
+                uint32_t metric;
+                memcpy(&metric, value, sizeof(metric));
+                entry.metric = static_cast<int>(metric);
+            }
+            else if (type == RTA_TABLE && valueSize >= 4)
+            {
+                uint32_t table;
+                memcpy(&table, value, sizeof(table));
+                entry.table = static_cast<int>(table);
+            }
+        });
+        if (entry.table == RT_TABLE_MAIN)
+        {
+            routes.push_back(entry);
+        }
+    });
+#endif // _WIN32
+}
+
+void RtNetlink::decodeNeighbors(const uint8_t *data, size_t length, std::vector<NeighborEntry> &neighbors)
+{
+#ifndef _WIN32
+    forEachMessage(data, length, RTM_NEWNEIGH, [&neighbors](const uint8_t *payload, size_t size)
+                   {
+        if (size < sizeof(struct ndmsg))
+        {
+            return;
+        }
+        struct ndmsg header;
+        memcpy(&header, payload, sizeof(header));
+        if (header.ndm_family != AF_INET)
+        {
+            return;
+        }
+
+        NeighborEntry entry;
+        entry.ifindex = header.ndm_ifindex;
+        entry.state = header.ndm_state;
+        forEachAttribute(payload, size, sizeof(header), [&entry](uint16_t type, const uint8_t *value, size_t valueSize)
+                         {
+            if (type == NDA_DST && valueSize >= 4)
+            {
+                entry.ipAddress = formatIPv4(value);
+            }
+            else if (type == NDA_LLADDR && valueSize >= 6)
+            {
+                entry.macAddress = MacAddress::fromBytes(value);
+            }
+        });
+        // 未完成解析或已失效的条目没有链路层地址
+        if (!entry.ipAddress.empty() && !entry.macAddress.isZero() && !(entry.state & (NUD_INCOMPLETE | NUD_FAILED)))
+        {
+            neighbors.push_back(entry);
+        }
+    });
+#endif // _WIN32
+}
+
+bool RtNetlink::sendBatch(std::vector<std::vector<uint8_t>> &messages, std::vector<int> &errors)
+{
+#ifndef _WIN32
+    errors.assign(messages.size(), -EIO);
+    if (messages.empty())
+    {
+        return true;
+    }
+    if (!open())
+    {
+        return false;
+    }
+
+    // 所有请求拼接到一个缓冲区中一次发送, 内核按顺序逐条处理并逐条ACK
+    uint32_t firstSequence = sequence_ + 1;
+    std::vector<uint8_t> batch;
+    for (auto &message : messages)
+    {
+        struct nlmsghdr *header = reinterpret_cast<struct nlmsghdr *>(message.data());
+        header->nlmsg_flags |= NLM_F_REQUEST | NLM_F_ACK;
+        header->nlmsg_seq = ++sequence_;
+        batch.insert(batch.end(), message.begin(), message.end());
+    }
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+    if (sendto(fd_, batch.data(), batch.size(), 0, reinterpret_cast<struct sockaddr *>(&kernel), sizeof(kernel)) < 0)
+    {
+        close();
+        return false;
+    }
+
+    size_t pending = messages.size();
+    while (pending > 0)
+    {
+        ssize_t received = recv(fd_, buffer_.data(), buffer_.size(), 0);
+        if (received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (received <= 0)
+        {
+            close();
+            return false;
+        }
+        size_t offset = 0;
+        size_t length = static_cast<size_t>(received);
+        while (offset + NLMSG_HDRLEN <= length)
+        {
+            const struct nlmsghdr *reply = reinterpret_cast<const struct nlmsghdr *>(buffer_.data() + offset);
+            if (reply->nlmsg_len < NLMSG_HDRLEN || offset + reply->nlmsg_len > length)
+            {
+                break;
+            }
+            uint32_t index = reply->nlmsg_seq - firstSequence;
+            if (reply->nlmsg_type == NLMSG_ERROR && index < messages.size() && errors[index] == -EIO)
+            {
+                errors[index] = reinterpret_cast<const struct nlmsgerr *>(NLMSG_DATA(reply))->error;
+                pending--;
+            }
+            offset += NLMSG_ALIGN(reply->nlmsg_len);
+        }
+    }
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool RtNetlink::applyStaticIPv4(int ifindex, const std::string &address, int prefixLength, const std::string &gateway)
+{
+#ifndef _WIN32
+    std::vector<uint8_t> addAddress = buildAddressMessage(RTM_NEWADDR, NLM_F_CREATE | NLM_F_REPLACE, ifindex, address, prefixLength);
+    std::vector<uint8_t> addRoute = buildDefaultRouteMessage(RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, ifindex, gateway);
+    if (addAddress.empty() || addRoute.empty())
+    {
+        std::cout << "Error: Invalid static IP address or gateway" << std::endl;
+        return false;
+    }
+
+    // 记录原有地址和默认路由, 用于回滚
+    std::vector<InterfaceAddress> addresses;
+    std::vector<RouteEntry> routes;
+    if (!getAddresses(addresses) || !getRoutes(routes))
+    {
+        return false;
+    }
+    std::vector<InterfaceAddress> previousAddresses;
+    for (const auto &entry : addresses)
+    {
+        if (entry.ifindex == ifindex)
+        {
+            previousAddresses.push_back(entry);
+        }
+    }
+    std::vector<RouteEntry> previousRoutes;
+    for (const auto &route : routes)
+    {
+        if (route.ifindex == ifindex && route.prefixLength == 0 && !route.gateway.empty())
+        {
+            previousRoutes.push_back(route);
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> batch;
+    for (const auto &entry : previousAddresses)
+    {
+        batch.push_back(buildAddressMessage(RTM_DELADDR, 0, ifindex, entry.address, entry.prefixLength));
+    }
+    size_t addressIndex = batch.size();
+    batch.push_back(addAddress);
+    batch.push_back(buildLinkUpMessage(ifindex));
+    size_t routeIndex = batch.size();
+    batch.push_back(addRoute);
+
+    std::vector<int> errors;
+    if (!sendBatch(batch, errors))
+    {
+        return false;
+    }
+
+    // 已存在默认路由(如有线网口)与原实现一致, 只提示不回滚
+    int failedIndex = -1;
+    for (size_t i = addressIndex; i < batch.size(); i++)
+    {
+        if (errors[i] != 0 && !(i == routeIndex && errors[i] == -EEXIST))
+        {
+            failedIndex = static_cast<int>(i);
+            break;
+        }
+    }
+    if (failedIndex < 0)
+    {
+        if (errors[routeIndex] == -EEXIST)
+        {
+            std::cout << "Warning: A default route already exists, gateway was not changed" << std::endl;
+        }
+        return true;
+    }
+
+    uint16_t failedType = reinterpret_cast<const struct nlmsghdr *>(batch[failedIndex].data())->nlmsg_type;
+    std::cout << "Error: Failed to " << operationName(failedType) << ": " << strerror(-errors[failedIndex])
+              << ", rolling back" << std::endl;
+
+    std::vector<std::vector<uint8_t>> rollback;
+    if (errors[addressIndex] == 0)
+    {
+        rollback.push_back(buildAddressMessage(RTM_DELADDR, 0, ifindex, address, prefixLength));
+    }
+    for (const auto &entry : previousAddresses)
+    {
+        rollback.push_back(buildAddressMessage(RTM_NEWADDR, NLM_F_CREATE | NLM_F_REPLACE, ifindex, entry.address, entry.prefixLength));
+    }
+    for (const auto &route : previousRoutes)
+    {
+        rollback.push_back(buildDefaultRouteMessage(RTM_NEWROUTE, NLM_F_CREATE | NLM_F_REPLACE, ifindex, route.gateway));
+    }
+    sendBatch(rollback, errors);
+    return false;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool RtNetlink::clearStaticIPv4(int ifindex, const std::string &address, int prefixLength, const std::string &gateway)
+{
+#ifndef _WIN32
+    std::vector<std::vector<uint8_t>> batch;
+    std::vector<uint8_t> deleteAddress = buildAddressMessage(RTM_DELADDR, 0, ifindex, address, prefixLength);
+    if (!deleteAddress.empty())
+    {
+        batch.push_back(deleteAddress);
+    }
+    std::vector<uint8_t> deleteRoute = buildDefaultRouteMessage(RTM_DELROUTE, 0, ifindex, gateway);
+    if (!deleteRoute.empty())
+    {
+        batch.push_back(deleteRoute);
+    }
+    batch.push_back(buildLinkUpMessage(ifindex));
+
+    std::vector<int> errors;
+    return sendBatch(batch, errors);
+#else
+    return false;
+#endif // _WIN32
+}
+
+std::vector<uint8_t> RtNetlink::buildAddressMessage(uint16_t type, uint16_t flags, int ifindex,
+                                                    const std::string &address, int prefixLength)
+{
+#ifndef _WIN32
+    struct in_addr value;
+    if (prefixLength < 0 || prefixLength > 32 || inet_pton(AF_INET, address.c_str(), &value) != 1)
+    {
+        return std::vector<uint8_t>();
+    }
+    struct ifaddrmsg header;
+    memset(&header, 0, sizeof(header));
+    header.ifa_family = AF_INET;
+    header.ifa_prefixlen = static_cast<uint8_t>(prefixLength);
+    header.ifa_scope = RT_SCOPE_UNIVERSE;
+    header.ifa_index = static_cast<uint32_t>(ifindex);
+    std::vector<uint8_t> message = startMessage(type, flags, &header, sizeof(header));
+    appendAttribute(message, IFA_LOCAL, &value, sizeof(value));
+    appendAttribute(message, IFA_ADDRESS, &value, sizeof(value));
+    return message;
+#else
+    return std::vector<uint8_t>();
+#endif // _WIN32
+}
+
+std::vector<uint8_t> RtNetlink::buildDefaultRouteMessage(uint16_t type, uint16_t flags, int ifindex, const std::string &gateway)
+{
+#ifndef _WIN32
+    struct in_addr value;
+    if (inet_pton(AF_INET, gateway.c_str(), &value) != 1)
+    {
+        return std::vector<uint8_t>();
+    }
+    struct rtmsg header;
+    memset(&header, 0, sizeof(header));
+    header.rtm_family = AF_INET;
+    header.rtm_table = RT_TABLE_MAIN;
+    header.rtm_protocol = RTPROT_BOOT;
+    header.rtm_scope = (type == RTM_DELROUTE) ? RT_SCOPE_NOWHERE : RT_SCOPE_UNIVERSE;
+    header.rtm_type = RTN_UNICAST;
+    std::vector<uint8_t> message = startMessage(type, flags, &header, sizeof(header));
+    uint32_t oif = static_cast<uint32_t>(ifindex);
+    appendAttribute(message, RTA_GATEWAY, &value, sizeof(value));
+    appendAttribute(message, RTA_OIF, &oif, sizeof(oif));
+    return message;
+#else
+    return std::vector<uint8_t>();
+#endif // _WIN32
+}
+
+std::vector<uint8_t> RtNetlink::buildLinkUpMessage(int ifindex)
+{
+#ifndef _WIN32
+    struct ifinfomsg header;
+    memset(&header, 0, sizeof(header));
+    header.ifi_family = AF_UNSPEC;
+    header.ifi_index = ifindex;
+    header.ifi_flags = IFF_UP;
+    header.ifi_change = IFF_UP;
+    return startMessage(RTM_NEWLINK, 0, &header, sizeof(header));
+#else
+    return std::vector<uint8_t>();
+#endif // _WIN32
+}
+
+std::string RtNetlink::prefixToNetmask(int prefixLength)
+{
+#ifndef _WIN32
+    if (prefixLength < 0 || prefixLength > 32)
+    {
+        return "";
+    }
+    uint32_t mask = prefixLength == 0 ? 0 : htonl(0xFFFFFFFFu << (32 - prefixLength));
+    return formatIPv4(reinterpret_cast<const uint8_t *>(&mask));
+#else
+    return "";
+#endif // _WIN32
+}
+
+int RtNetlink::netmaskToPrefix(const std::string &netmask)
+{
+#ifndef _WIN32
+    struct in_addr address;
+    if (inet_pton(AF_INET, netmask.c_str(), &address) != 1)
+    {
+        return -1;
+    }
+    uint32_t mask = ntohl(address.s_addr);
+    // 掩码必须是连续的1后接连续的0
+    if ((mask | (mask - 1)) != 0xFFFFFFFFu && mask != 0)
+    {
+        return -1;
+    }
+    int prefixLength = 0;
+    while (mask & 0x80000000u)
+    {
+        prefixLength++;
+        mask <<= 1;
+    }
+    return prefixLength;
+#else
+    return -1;
+#endif // _WIN32
+}
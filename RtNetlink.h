@@ -0,0 +1,195 @@
+#ifndef RT_NETLINK_H
+#define RT_NETLINK_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "MacAddress.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif // _WIN32
+
+struct InterfaceAddress
+{
+    int ifindex;
+    std::string address;   // IPv4地址
+    int prefixLength;      // 前缀长度
+    std::string broadcast; // 广播地址
+    std::string label;     // 接口标签(如 wlan0)
+
+    InterfaceAddress() : ifindex(0), prefixLength(0) {}
+};
+
+struct RouteEntry
+{
+    int ifindex;             // 出接口索引
+    std::string destination; // 目的网络, 默认路由为 "0.0.0.0"
+    int prefixLength;        // 目的前缀长度
+    std::string gateway;     // 网关, 直连路由为空
+    int metric;
+    int table; // 路由表ID
+
+    RouteEntry() : ifindex(0), prefixLength(0), metric(0), table(0) {}
+};
+
+struct NeighborEntry
+{
+    int ifindex;
+    std::string ipAddress;
+    MacAddress macAddress;
+    uint16_t state;         // NUD_* 状态
+
+    NeighborEntry() : ifindex(0), state(0) {}
+};
+
+/*
+ * rtnetlink(NETLINK_ROUTE)查询接口
+ * 通过RTM_GETADDR/RTM_GETROUTE/RTM_GETNEIGH导出IPv4地址、路由和邻居表,
+ * 直接解析二进制响应, 替代 ip/route/arp 命令及其文本解析
+ */
+class RtNetlink
+{
+public:
+    RtNetlink();
+    ~RtNetlink();
+
+    /**
+     * 打开netlink套接字(已打开时直接返回true)
+     * @return 成功返回true，失败返回false
+     */
+    bool open();
+
+    /**
+     * 关闭netlink套接字
+     */
+    void close();
+
+    /**
+     * 导出全部IPv4地址
+     * @param addresses 地址列表
+     * @return 成功返回true，失败返回false
+     */
+    bool getAddresses(std::vector<InterfaceAddress> &addresses);
+
+    /**
+     * 导出IPv4路由表(main表)
+     * @param routes 路由列表
+     * @return 成功返回true，失败返回false
+     */
+    bool getRoutes(std::vector<RouteEntry> &routes);
+
+    /**
+     * 导出IPv4邻居表(ARP表)
+     * @param neighbors 邻居列表
+     * @return 成功返回true，失败返回false
+     */
+    bool getNeighbors(std::vector<NeighborEntry> &neighbors);
+
+    /**
+     * 以一次批量请求应用静态IPv4配置:
+     * 删除接口上原有的IPv4地址, 添加新地址, 启用接口, 添加默认路由, 一次收集全部ACK.
+     * 地址或接口操作失败时回滚到原有地址和默认路由
+     * @param ifindex 接口索引
+     * @param address IP地址
+     * @param prefixLength 前缀长度
+     * @param gateway 默认网关
+     * @return 成功返回true，失败(已回滚)返回false
+     */
+    bool applyStaticIPv4(int ifindex, const std::string &address, int prefixLength, const std::string &gateway);
+
+    /**
+     * 以一次批量请求清除静态IPv4配置: 删除地址和经由网关的默认路由, 并保持接口启用
+     * @param ifindex 接口索引
+     * @param address IP地址
+     * @param prefixLength 前缀长度
+     * @param gateway 默认网关, 为空时不删除路由
+     * @return 请求发送成功返回true(地址或路由已不存在不视为失败)
+     */
+    bool clearStaticIPv4(int ifindex, const std::string &address, int prefixLength, const std::string &gateway);
+
+    /**
+     * 构造RTM_NEWADDR/RTM_DELADDR消息
+     * @param type RTM_NEWADDR或RTM_DELADDR
+     * @param flags 附加的nlmsg_flags(如NLM_F_CREATE)
+     * @param ifindex 接口索引
+     * @param address IPv4地址
+     * @param prefixLength 前缀长度
+     * @return 消息, 地址无效时返回空
+     */
+    static std::vector<uint8_t> buildAddressMessage(uint16_t type, uint16_t flags, int ifindex,
+                                                    const std::string &address, int prefixLength);
+
+    /**
+     * 构造默认路由的RTM_NEWROUTE/RTM_DELROUTE消息
+     * @param type RTM_NEWROUTE或RTM_DELROUTE
+     * @param flags 附加的nlmsg_flags
+     * @param ifindex 出接口索引
+     * @param gateway 网关地址
+     * @return 消息, 地址无效时返回空
+     */
+    static std::vector<uint8_t> buildDefaultRouteMessage(uint16_t type, uint16_t flags, int ifindex, const std::string &gateway);
+
+    /**
+     * 构造启用接口(IFF_UP)的RTM_NEWLINK消息
+     * @param ifindex 接口索引
+     * @return 消息
+     */
+    static std::vector<uint8_t> buildLinkUpMessage(int ifindex);
+
+    /**
+     * 前缀长度转换为点分十进制掩码
+     * @param prefixLength 前缀长度(0-32)
+     * @return 掩码字符串, 前缀无效时返回空字符串
+     */
+    static std::string prefixToNetmask(int prefixLength);
+
+    /**
+     * 点分十进制掩码转换为前缀长度
+     * @param netmask 掩码字符串
+     * @return 前缀长度, 掩码无效(非连续)时返回-1
+     */
+    static int netmaskToPrefix(const std::string &netmask);
+
+    /**
+     * 解码一段消息流中的RTM_NEWADDR/RTM_NEWROUTE/RTM_NEWNEIGH消息(只保留IPv4)
+     * @param data 消息数据
+     * @param length 数据长度
+     * @param addresses/routes/neighbors 追加解码结果
+     */
+    static void decodeAddresses(const uint8_t *data, size_t length, std::vector<InterfaceAddress> &addresses);
+    static void decodeRoutes(const uint8_t *data, size_t length, std::vector<RouteEntry> &routes);
+    static void decodeNeighbors(const uint8_t *data, size_t length, std::vector<NeighborEntry> &neighbors);
+
+private:
+    int fd_;
+    uint32_t sequence_;
+    std::vector<uint8_t> buffer_; // 复用的接收缓冲区
+
+    /*
+     * 一次发送多条请求(每条都带NLM_F_ACK), 并按顺序收集每条请求的错误码
+     * @param messages 请求列表
+     * @param errors 每条请求的错误码(0为成功, 负数为-errno)
+     * @return 收齐全部ACK返回true
+     */
+    bool sendBatch(std::vector<std::vector<uint8_t>> &messages, std::vector<int> &errors);
+
+    /*
+     * 发送dump请求并把全部响应消息交给decoder
+     * @param type 请求类型(RTM_GETADDR等)
+     * @param header 请求头(ifaddrmsg/rtmsg/ndmsg)
+     * @param headerLength 请求头长度
+     * @param decoder 解码函数
+     * @return 收到NLMSG_DONE返回true
+     */
+    template <typename Entry>
+    bool dump(uint16_t type, const void *header, size_t headerLength,
+              void (*decoder)(const uint8_t *, size_t, std::vector<Entry> &), std::vector<Entry> &entries);
+
+    RtNetlink(const RtNetlink &);
+    RtNetlink &operator=(const RtNetlink &);
+};
+
+#endif // RT_NETLINK_H
@@ -0,0 +1,293 @@
+#include "ScanBroker.h"
+
+#include <algorithm>
+#ifndef _WIN32
+#include <net/if.h>
+#endif // _WIN32
+
+namespace
+{
+// 监听线程检查停止标志的间隔
+const int kWatchPollMs = 500;
+
+/*
+ * 复制不超过maxAgeMs的BSS(内核缓存中可能残留很久以前扫描到的BSS)
+ */
+void copyRecentRows(const ScanTable &source, uint32_t maxAgeMs, ScanTable &target)
+{
+    target.clear();
+    for (uint32_t row = 0; row < source.size(); row++)
+    {
+        if (source.ageMs(row) <= maxAgeMs)
+        {
+            target.add(source, row);
+        }
+    }
+}
+
+void copyRowsOnFrequencies(const ScanTable &source, const std::vector<int> &frequencies, ScanTable &target)
+{
+    target.clear();
+    for (uint32_t row = 0; row < source.size(); row++)
+    {
+        if (frequencies.empty() ||
+            std::find(frequencies.begin(), frequencies.end(), source.frequency(row)) != frequencies.end())
+        {
+            target.add(source, row);
+        }
+    }
+}
+} // namespace
+
+ScanBroker::ScanBroker(ScanSource &source, ScanClock &clock)
+    : source_(source), clock_(clock), cacheValid_(false), cacheTimeMs_(0), fullScanMs_(-1),
+      inFlight_(false), generation_(0), lastActive_(false), lastResult_(false)
+{
+}
+
+bool ScanBroker::acquire(ScanTable &table, int maxAgeMs)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool waited = false;
+    while (true)
+    {
+        if (isFresh(clock_.nowMs(), maxAgeMs))
+        {
+            if (waited)
+            {
+                stats_.coalesced++;
+            }
+            else
+            {
+                stats_.hits++;
+            }
+            table = cache_;
+            return true;
+        }
+        if (!inFlight_)
+        {
+            break;
+        }
+
+        uint64_t generation = generation_;
+        done_.wait(lock, [this, generation]
+                   { return generation_ != generation; });
+        waited = true;
+        if (lastActive_)
+        {
+            // 共用刚完成的主动扫描, 不论成功与否都不再重复扫描
+            stats_.coalesced++;
+            if (!lastResult_)
+            {
+                table.clear();
+                return false;
+            }
+            table = cache_;
+            return true;
+        }
+        // 完成的是内核缓存读取, 可能不满足本调用方的maxAgeMs, 重新判断
+    }
+
+    inFlight_ = true;
+    int64_t fullScanMs = fullScanMs_;
+    bool fullScanFresh = fullScanMs >= 0 && clock_.nowMs() - fullScanMs <= maxAgeMs;
+    lock.unlock();
+
+    // 定向扫描(漫游、已保存网络的信道扫描)和wpa_supplicant的扫描也会刷新内核缓存中部分BSS的时间,
+    // 只有最近一次全信道扫描足够新时内核缓存才是完整的列表
+    bool kernelHit = false;
+    if (maxAgeMs > 0 && fullScanFresh && source_.dump(scratch_) && !scratch_.empty())
+    {
+        copyRecentRows(scratch_, static_cast<uint32_t>(maxAgeMs), filtered_);
+        kernelHit = true;
+    }
+    bool result = kernelHit || source_.scan(scratch_);
+    int64_t finishedMs = clock_.nowMs();
+
+    lock.lock();
+    inFlight_ = false;
+    generation_++;
+    lastActive_ = !kernelHit;
+    lastResult_ = result;
+    if (kernelHit)
+    {
+        stats_.kernelHits++;
+        cache_ = filtered_;
+        cacheTimeMs_ = fullScanMs;
+        cacheValid_ = true;
+    }
+    else
+    {
+        stats_.misses++;
+        if (result)
+        {
+            cache_ = scratch_;
+            cacheTimeMs_ = finishedMs;
+            cacheValid_ = true;
+            fullScanMs_ = finishedMs;
+        }
+        else
+        {
+            stats_.failures++;
+        }
+    }
+    done_.notify_all();
+
+    if (!result)
+    {
+        table.clear();
+        return false;
+    }
+    table = cache_;
+    return true;
+}
+
+bool ScanBroker::scan(ScanTable &table)
+{
+    return acquire(table, 0);
+}
+
+bool ScanBroker::scanTargeted(ScanTable &table, const ScanParams &params)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (inFlight_)
+    {
+        uint64_t generation = generation_;
+        done_.wait(lock, [this, generation]
+                   { return generation_ != generation; });
+        if (lastActive_ && lastResult_)
+        {
+            stats_.coalesced++;
+            copyRowsOnFrequencies(cache_, params.frequencies, table);
+            return true;
+        }
+    }
+    stats_.targeted++;
+    lock.unlock();
+
+    if (source_.scanTargeted(table, params))
+    {
+        return true;
+    }
+    lock.lock();
+    stats_.failures++;
+    return false;
+}
+
+void ScanBroker::noteFullScan()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    fullScanMs_ = std::max(fullScanMs_, clock_.nowMs());
+}
+
+void ScanBroker::invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    cacheValid_ = false;
+    fullScanMs_ = -1;
+}
+
+int64_t ScanBroker::lastScanMs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cacheValid_ ? cacheTimeMs_ : -1;
+}
+
+ScanBrokerStats ScanBroker::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool ScanBroker::isFresh(int64_t nowMs, int maxAgeMs) const
+{
+    return cacheValid_ && maxAgeMs > 0 && nowMs - cacheTimeMs_ <= maxAgeMs;
+}
+
+ScanEventWatcher::ScanEventWatcher(const std::string &iface, ScanBroker &broker)
+    : iface_(iface), broker_(broker), running_(false), maxFrequencyCount_(0), fullScanCount_(0)
+{
+}
+
+ScanEventWatcher::~ScanEventWatcher()
+{
+    stop();
+}
+
+bool ScanEventWatcher::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_)
+    {
+        return true;
+    }
+    if (!nl80211_.open())
+    {
+        return false;
+    }
+    running_ = true;
+    thread_ = std::thread(&ScanEventWatcher::run, this);
+    return true;
+}
+
+void ScanEventWatcher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        running_ = false;
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+    nl80211_.close();
+}
+
+bool ScanEventWatcher::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+bool ScanEventWatcher::onScanEvent(int frequencyCount)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool known = maxFrequencyCount_ > 0;
+    maxFrequencyCount_ = std::max(maxFrequencyCount_, frequencyCount);
+    if (frequencyCount > 0 && (!known || frequencyCount < maxFrequencyCount_))
+    {
+        // 定向扫描(或还不知道全部信道数)
+        return false;
+    }
+    fullScanCount_++;
+    lock.unlock();
+
+    broker_.noteFullScan();
+    return true;
+}
+
+int ScanEventWatcher::getFullScanCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fullScanCount_;
+}
+
+void ScanEventWatcher::run()
+{
+#ifndef _WIN32
+    while (isRunning())
+    {
+        // 接口可能被重新创建, 每次按名称取索引
+        int ifindex = static_cast<int>(if_nametoindex(iface_.c_str()));
+        int frequencyCount = 0;
+        if (nl80211_.waitScanDone(ifindex, kWatchPollMs, frequencyCount))
+        {
+            onScanEvent(frequencyCount);
+        }
+    }
+#endif // _WIN32
+}
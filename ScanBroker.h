@@ -0,0 +1,158 @@
+#ifndef SCAN_BROKER_H
+#define SCAN_BROKER_H
+
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string>
+#include <cstdint>
+#include "ScanTable.h"
+#include "ScanService.h"
+
+// 扫描请求统计
+struct ScanBrokerStats
+{
+    int hits;       // 直接使用本地缓存
+    int kernelHits; // 使用内核缓存(scan dump), 未触发扫描
+    int misses;     // 触发了一次主动扫描
+    int coalesced;  // 等待并共用其他调用方正在进行的扫描
+    int targeted;   // 定向扫描(只扫描指定频率)
+    int failures;   // 扫描失败(主动或定向)
+
+    ScanBrokerStats() : hits(0), kernelHits(0), misses(0), coalesced(0), targeted(0), failures(0) {}
+};
+
+/*
+ * 扫描结果新鲜度策略
+ * 调用方给出能接受的最大结果年龄, 按以下顺序取结果:
+ *   1. 本地缓存足够新 -> 直接返回
+ *   2. 已有扫描正在进行 -> 等待它完成并共用结果
+ *   3. 最近一次全信道扫描(本实例的, 或经noteFullScan()得知的其他进程的扫描)足够新 -> 读取内核缓存
+ *      (scan dump, 含之后定向扫描更新的BSS), 去掉过旧的BSS后返回, 不触发扫描
+ *   4. 主动扫描
+ * 本身也是一个ScanSource(scan()即不接受缓存的acquire), 后台扫描服务经由它扫描时也会与前台请求合并
+ */
+class ScanBroker : public ScanSource
+{
+public:
+    ScanBroker(ScanSource &source, ScanClock &clock);
+
+    /**
+     * 获取扫描结果
+     * @param table 扫描结果(先清空), 本地缓存的副本
+     * @param maxAgeMs 能接受的最大结果年龄(毫秒), 0表示必须扫描(仍可合并到正在进行的扫描)
+     * @return 成功返回true
+     */
+    bool acquire(ScanTable &table, int maxAgeMs);
+
+    bool scan(ScanTable &table) override;
+
+    /**
+     * 定向扫描, 结果不进入缓存(只覆盖部分信道).
+     * 已有全信道扫描在进行时等待并从其结果中取指定频率上的BSS
+     */
+    bool scanTargeted(ScanTable &table, const ScanParams &params) override;
+
+    /**
+     * 记录一次不是本实例发起的全信道扫描(例如wpa_supplicant的周期扫描)刚刚完成,
+     * 本地缓存过期后可以读取内核缓存代替主动扫描
+     */
+    void noteFullScan();
+
+    /**
+     * 丢弃本地缓存和全信道扫描时间(接口关闭后内核缓存也被清空), 下次请求主动扫描
+     */
+    void invalidate();
+
+    /**
+     * 本地缓存对应的扫描时间
+     * @return 时钟毫秒数, 没有缓存时返回-1
+     */
+    int64_t lastScanMs() const;
+
+    ScanBrokerStats getStats() const;
+
+private:
+    ScanSource &source_;
+    ScanClock &clock_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable done_;
+    ScanTable cache_;
+    bool cacheValid_;
+    int64_t cacheTimeMs_;
+    int64_t fullScanMs_; // 最近一次全信道扫描完成的时间, -1表示没有
+
+    // 正在进行的请求, 只有发起方访问scratch_/filtered_
+    bool inFlight_;
+    uint64_t generation_;  // 每完成一次请求加1, 等待方据此判断
+    bool lastActive_;      // 最近完成的请求是否为主动扫描
+    bool lastResult_;      // 最近完成的请求是否成功
+    ScanTable scratch_;
+    ScanTable filtered_;
+
+    ScanBrokerStats stats_;
+
+    /*
+     * 本地缓存是否满足maxAgeMs, 调用时持有mutex_
+     */
+    bool isFresh(int64_t nowMs, int maxAgeMs) const;
+
+    ScanBroker(const ScanBroker &);
+    ScanBroker &operator=(const ScanBroker &);
+};
+
+/*
+ * 扫描事件监听
+ * 在nl80211"scan"多播组上等待接口的扫描完成事件, 把其他进程发起的全信道扫描告诉ScanBroker.
+ * 完成事件带有本次扫描的频率列表: 不带列表, 或频率数不少于此前见过的最大值(全部可用信道)时视为全信道扫描,
+ * 第一个带列表的事件只用来确定信道数. start()启动后台线程; 也可以直接调用onScanEvent()驱动
+ */
+class ScanEventWatcher
+{
+public:
+    ScanEventWatcher(const std::string &iface, ScanBroker &broker);
+    ~ScanEventWatcher();
+
+    /**
+     * 打开netlink事件套接字并启动监听线程
+     * @return 成功返回true, nl80211不可用时返回false
+     */
+    bool start();
+
+    /**
+     * 停止监听线程
+     */
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * 处理一次扫描完成事件
+     * @param frequencyCount 本次扫描的频率数, 0表示事件不带频率列表
+     * @return 视为全信道扫描并通知了ScanBroker返回true
+     */
+    bool onScanEvent(int frequencyCount);
+
+    /**
+     * 已通知ScanBroker的全信道扫描次数
+     */
+    int getFullScanCount() const;
+
+private:
+    std::string iface_;
+    ScanBroker &broker_;
+    Nl80211 nl80211_; // 只在监听线程中使用
+
+    mutable std::mutex mutex_;
+    std::thread thread_;
+    bool running_;
+    int maxFrequencyCount_; // 见过的最大频率数, 0表示还没有
+    int fullScanCount_;
+
+    void run();
+
+    ScanEventWatcher(const ScanEventWatcher &);
+    ScanEventWatcher &operator=(const ScanEventWatcher &);
+};
+
+#endif // SCAN_BROKER_H
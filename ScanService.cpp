@@ -0,0 +1,610 @@
+#include "ScanService.h"
+#include "IwScanParser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#ifndef _WIN32
+#include <net/if.h>
+#endif // _WIN32
+
+InterfaceScanSource::InterfaceScanSource(const std::string &iface) : iface_(iface)
+{
+}
+
+bool InterfaceScanSource::scan(ScanTable &table)
+{
+#ifndef _WIN32
+    std::lock_guard<std::mutex> lock(mutex_);
+    table.clear();
+    int ifindex = static_cast<int>(if_nametoindex(iface_.c_str()));
+    bssList_.clear();
+    if (ifindex != 0 && nl80211_.open() && nl80211_.scan(ifindex, bssList_))
+    {
+        fillTable(table, std::vector<int>());
+        return true;
+    }
+
+    // nl80211不可用时回退到iw, 直接解析原始输出
+    std::string scanOutput = runner_.capture({"iw", "dev", iface_, "scan"});
+    if (scanOutput.empty())
+    {
+        return false;
+    }
+    IwScanParser::parse(scanOutput, table);
+    return true;
+#else
+    table.clear();
+    return false;
+#endif // _WIN32
+}
+
+bool InterfaceScanSource::scanTargeted(ScanTable &table, const ScanParams &params)
+{
+#ifndef _WIN32
+    std::lock_guard<std::mutex> lock(mutex_);
+    table.clear();
+    int ifindex = static_cast<int>(if_nametoindex(iface_.c_str()));
+    bssList_.clear();
+    // 导出的是内核全部缓存, 按频率过滤掉本次没有扫描的信道上残留的BSS
+    if (ifindex != 0 && nl80211_.open() && nl80211_.scan(ifindex, params, bssList_))
+    {
+        fillTable(table, params.frequencies);
+        return true;
+    }
+
+    std::vector<std::string> argv = {"iw", "dev", iface_, "scan"};
+    if (!params.frequencies.empty())
+    {
+        argv.push_back("freq");
+        for (int frequency : params.frequencies)
+        {
+            argv.push_back(std::to_string(frequency));
+        }
+    }
+    if (!params.ssids.empty())
+    {
+        argv.push_back("ssid");
+        argv.insert(argv.end(), params.ssids.begin(), params.ssids.end());
+    }
+    std::string scanOutput = runner_.capture(argv);
+    if (scanOutput.empty())
+    {
+        return false;
+    }
+    IwScanParser::parse(scanOutput, bssList_);
+    fillTable(table, params.frequencies);
+    return true;
+#else
+    (void)params;
+    table.clear();
+    return false;
+#endif // _WIN32
+}
+
+bool InterfaceScanSource::dump(ScanTable &table)
+{
+#ifndef _WIN32
+    std::lock_guard<std::mutex> lock(mutex_);
+    table.clear();
+    int ifindex = static_cast<int>(if_nametoindex(iface_.c_str()));
+    bssList_.clear();
+    if (ifindex != 0 && nl80211_.open() && nl80211_.getScanResults(ifindex, bssList_))
+    {
+        fillTable(table, std::vector<int>());
+        return true;
+    }
+
+    std::string dumpOutput = runner_.capture({"iw", "dev", iface_, "scan", "dump"});
+    if (dumpOutput.empty())
+    {
+        return false;
+    }
+    IwScanParser::parse(dumpOutput, table);
+    return true;
+#else
+    table.clear();
+    return false;
+#endif // _WIN32
+}
+
+void InterfaceScanSource::fillTable(ScanTable &table, const std::vector<int> &frequencies) const
+{
+    for (const auto &network : bssList_)
+    {
+        if (frequencies.empty() ||
+            std::find(frequencies.begin(), frequencies.end(), network.frequency) != frequencies.end())
+        {
+            table.add(network);
+        }
+    }
+}
+
+ScriptedScanSource::ScriptedScanSource(const ScanClock *clock)
+    : clock_(clock), hasCache_(false), cacheTimeMs_(0), delayMs_(0), scanCount_(0), targetedCount_(0),
+      dumpCount_(0)
+{
+}
+
+void ScriptedScanSource::setScanDelay(int delayMs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    delayMs_ = delayMs;
+}
+
+void ScriptedScanSource::push(const ScanTable &table)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    script_.push_back(table);
+    results_.push_back(true);
+}
+
+void ScriptedScanSource::pushFailure()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    script_.push_back(ScanTable());
+    results_.push_back(false);
+}
+
+void ScriptedScanSource::refreshCache(const ScanTable &table)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_ = table;
+    hasCache_ = true;
+    cacheTimeMs_ = clock_ ? clock_->nowMs() : 0;
+}
+
+bool ScriptedScanSource::next(std::unique_lock<std::mutex> &lock, ScanTable &table)
+{
+    int delayMs = delayMs_;
+    if (delayMs > 0)
+    {
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        lock.lock();
+    }
+    if (script_.empty())
+    {
+        // 脚本用完后按扫描失败处理
+        table.clear();
+        return false;
+    }
+    table = script_.front();
+    bool result = results_.front();
+    script_.pop_front();
+    results_.pop_front();
+    return result;
+}
+
+bool ScriptedScanSource::scanTargeted(ScanTable &table, const ScanParams &params)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    targetedCount_++;
+    ScanTable heard;
+    bool result = next(lock, heard);
+    table.clear();
+    for (uint32_t row = 0; row < heard.size(); row++)
+    {
+        if (params.frequencies.empty() ||
+            std::find(params.frequencies.begin(), params.frequencies.end(), heard.frequency(row)) !=
+                params.frequencies.end())
+        {
+            table.add(heard, row);
+        }
+    }
+    if (result && hasCache_)
+    {
+        // 与内核一样只刷新扫描到的BSS, 其余BSS继续老化
+        int64_t nowMs = clock_ ? clock_->nowMs() : 0;
+        uint32_t elapsedMs = static_cast<uint32_t>(nowMs - cacheTimeMs_);
+        ScanTable merged;
+        for (uint32_t row = 0; row < table.size(); row++)
+        {
+            merged.add(table, row);
+        }
+        for (uint32_t row = 0; row < cache_.size(); row++)
+        {
+            if (std::find(table.bssids().begin(), table.bssids().end(), cache_.bssid(row)) == table.bssids().end())
+            {
+                merged.add(cache_.bssid(row), cache_.ssid(row), cache_.frequency(row), cache_.channel(row),
+                           cache_.signalStrength(row), cache_.security(row), cache_.flags(row),
+                           cache_.ageMs(row) + elapsedMs);
+            }
+        }
+        cache_ = merged;
+        cacheTimeMs_ = nowMs;
+    }
+    return result;
+}
+
+bool ScriptedScanSource::scan(ScanTable &table)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    scanCount_++;
+    bool result = next(lock, table);
+    if (result)
+    {
+        cache_ = table;
+        hasCache_ = true;
+        cacheTimeMs_ = clock_ ? clock_->nowMs() : 0;
+    }
+    return result;
+}
+
+bool ScriptedScanSource::dump(ScanTable &table)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    dumpCount_++;
+    table.clear();
+    if (!hasCache_)
+    {
+        return false;
+    }
+    uint32_t elapsedMs = clock_ ? static_cast<uint32_t>(clock_->nowMs() - cacheTimeMs_) : 0;
+    for (uint32_t row = 0; row < cache_.size(); row++)
+    {
+        table.add(cache_.bssid(row), cache_.ssid(row), cache_.frequency(row), cache_.channel(row),
+                  cache_.signalStrength(row), cache_.security(row), cache_.flags(row),
+                  cache_.ageMs(row) + elapsedMs);
+    }
+    return true;
+}
+
+size_t ScriptedScanSource::remaining() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return script_.size();
+}
+
+int ScriptedScanSource::scanCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scanCount_;
+}
+
+int ScriptedScanSource::targetedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return targetedCount_;
+}
+
+int ScriptedScanSource::dumpCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dumpCount_;
+}
+
+int64_t SteadyScanClock::nowMs() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t VirtualScanClock::nowMs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nowMs_;
+}
+
+void VirtualScanClock::set(int64_t nowMs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    nowMs_ = nowMs;
+}
+
+void VirtualScanClock::advance(int64_t deltaMs)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    nowMs_ += deltaMs;
+}
+
+ScanService::ScanService(ScanSource &source, ScanClock &clock)
+    : source_(source), clock_(clock), running_(false), nextListenerId_(1),
+      nextScanMs_(0), scanCount_(0), failureCount_(0)
+{
+}
+
+ScanService::~ScanService()
+{
+    stop();
+}
+
+void ScanService::setConfig(const ScanServiceConfig &config)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    nextScanMs_ = std::min(nextScanMs_, clock_.nowMs() + config_.intervalMs);
+    wakeup_.notify_all();
+}
+
+ScanServiceConfig ScanService::getConfig() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+bool ScanService::start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_)
+    {
+        return true;
+    }
+    running_ = true;
+    nextScanMs_ = clock_.nowMs();
+    thread_ = std::thread(&ScanService::run, this);
+    return true;
+}
+
+void ScanService::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        running_ = false;
+        wakeup_.notify_all();
+    }
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+bool ScanService::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+bool ScanService::tick()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (clock_.nowMs() < nextScanMs_)
+        {
+            return false;
+        }
+    }
+    runScan();
+    return true;
+}
+
+bool ScanService::scanNow()
+{
+    return runScan();
+}
+
+int ScanService::subscribe(Listener listener, void *context)
+{
+    std::lock_guard<std::mutex> lock(listenerMutex_);
+    Subscription subscription = {nextListenerId_++, listener, context};
+    listeners_.push_back(subscription);
+    return subscription.id;
+}
+
+void ScanService::unsubscribe(int id)
+{
+    std::lock_guard<std::mutex> lock(listenerMutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [id](const Subscription &subscription)
+                                    { return subscription.id == id; }),
+                     listeners_.end());
+}
+
+void ScanService::snapshot(std::vector<BssRecord> &records) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    records.clear();
+    records.reserve(records_.size());
+    for (const auto &entry : records_)
+    {
+        records.push_back(entry.second);
+    }
+}
+
+bool ScanService::find(const MacAddress &bssid, BssRecord &record) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = records_.find(bssid);
+    if (it == records_.end())
+    {
+        return false;
+    }
+    record = it->second;
+    return true;
+}
+
+size_t ScanService::size() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return records_.size();
+}
+
+int64_t ScanService::nextScanMs() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nextScanMs_;
+}
+
+int ScanService::getScanCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scanCount_;
+}
+
+int ScanService::getFailureCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failureCount_;
+}
+
+void ScanService::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_)
+    {
+        int64_t waitMs = nextScanMs_ - clock_.nowMs();
+        if (waitMs > 0)
+        {
+            wakeup_.wait_for(lock, std::chrono::milliseconds(waitMs));
+            continue;
+        }
+        lock.unlock();
+        runScan();
+        lock.lock();
+    }
+}
+
+bool ScanService::runScan()
+{
+    // 扫描和事件分发期间不持有mutex_, 读取BSS表的调用方不会被阻塞;
+    // 持有scanMutex_保证事件按扫描顺序送达
+    std::lock_guard<std::mutex> scanLock(scanMutex_);
+    std::vector<BssEvent> events;
+    bool scanned = source_.scan(table_);
+    int64_t nowMs = clock_.nowMs();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        nextScanMs_ = nowMs + config_.intervalMs;
+        scanCount_++;
+        if (scanned)
+        {
+            merge(table_, nowMs, events);
+            // 扫描失败时不做老化, 避免驱动短暂故障时清空整个BSS表
+            expire(nowMs, events);
+        }
+        else
+        {
+            failureCount_++;
+        }
+    }
+    dispatch(events);
+    return scanned;
+}
+
+void ScanService::merge(const ScanTable &table, int64_t nowMs, std::vector<BssEvent> &events)
+{
+    for (uint32_t row = 0; row < table.size(); row++)
+    {
+        MacAddress bssid = table.bssid(row);
+        int signal = table.signalStrength(row);
+        int channel = table.channel(row);
+        SecurityMode security = table.security(row);
+
+        auto it = records_.find(bssid);
+        if (it == records_.end())
+        {
+            BssRecord record;
+            record.bssid = bssid;
+            record.ssid = table.ssid(row).toString();
+            record.signalStrength = signal;
+            record.reportedSignal = signal;
+            record.channel = channel;
+            record.frequency = table.frequency(row);
+            record.security = security;
+            record.firstSeenMs = nowMs;
+            record.lastSeenMs = nowMs;
+            records_.insert(std::make_pair(bssid, record));
+
+            BssEvent event;
+            event.type = BssEventType::ADDED;
+            event.bssid = bssid;
+            event.ssid = record.ssid;
+            event.signalStrength = signal;
+            event.previousSignal = signal;
+            event.channel = channel;
+            event.previousChannel = channel;
+            event.security = security;
+            event.timestampMs = nowMs;
+            events.push_back(event);
+            continue;
+        }
+
+        BssRecord &record = it->second;
+        uint8_t changes = 0;
+        if (std::abs(signal - record.reportedSignal) >= config_.rssiThreshold)
+        {
+            changes |= kBssSignalChanged;
+        }
+        if (security != record.security)
+        {
+            changes |= kBssSecurityChanged;
+        }
+        if (channel != record.channel)
+        {
+            changes |= kBssChannelChanged;
+        }
+        if (changes != 0)
+        {
+            BssEvent event;
+            event.type = BssEventType::CHANGED;
+            event.changes = changes;
+            event.bssid = bssid;
+            event.ssid = record.ssid;
+            event.signalStrength = signal;
+            event.previousSignal = record.reportedSignal;
+            event.channel = channel;
+            event.previousChannel = record.channel;
+            event.security = security;
+            event.timestampMs = nowMs;
+            events.push_back(event);
+            record.reportedSignal = signal;
+        }
+        record.signalStrength = signal;
+        record.channel = channel;
+        record.frequency = table.frequency(row);
+        record.security = security;
+        record.lastSeenMs = nowMs;
+    }
+}
+
+void ScanService::expire(int64_t nowMs, std::vector<BssEvent> &events)
+{
+    auto it = records_.begin();
+    while (it != records_.end())
+    {
+        const BssRecord &record = it->second;
+        if (nowMs - record.lastSeenMs <= config_.maxAgeMs)
+        {
+            ++it;
+            continue;
+        }
+        BssEvent event;
+        event.type = BssEventType::REMOVED;
+        event.bssid = record.bssid;
+        event.ssid = record.ssid;
+        event.signalStrength = record.signalStrength;
+        event.previousSignal = record.reportedSignal;
+        event.channel = record.channel;
+        event.previousChannel = record.channel;
+        event.security = record.security;
+        event.timestampMs = nowMs;
+        events.push_back(event);
+        it = records_.erase(it);
+    }
+}
+
+void ScanService::dispatch(const std::vector<BssEvent> &events)
+{
+    if (events.empty())
+    {
+        return;
+    }
+    std::vector<Subscription> listeners;
+    {
+        std::lock_guard<std::mutex> lock(listenerMutex_);
+        listeners = listeners_;
+    }
+    for (const auto &event : events)
+    {
+        for (const auto &subscription : listeners)
+        {
+            subscription.listener(event, subscription.context);
+        }
+    }
+}
@@ -0,0 +1,362 @@
+#ifndef SCAN_SERVICE_H
+#define SCAN_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include "ScanTable.h"
+#include "Nl80211.h"
+#include "ProcessRunner.h"
+
+/*
+ * 扫描来源
+ * scan()可能阻塞数秒(驱动扫描), 实现需保证可以在后台线程中调用
+ */
+class ScanSource
+{
+public:
+    virtual ~ScanSource() {}
+
+    /**
+     * 执行一次扫描
+     * @param table 扫描结果(先清空)
+     * @return 成功返回true
+     */
+    virtual bool scan(ScanTable &table) = 0;
+
+    /**
+     * 执行一次定向扫描, 不支持定向扫描的来源执行全信道扫描
+     * @param table 扫描结果(先清空), 只包含指定频率上的BSS
+     * @param params 扫描频率和探测的SSID
+     * @return 成功返回true
+     */
+    virtual bool scanTargeted(ScanTable &table, const ScanParams &params)
+    {
+        (void)params;
+        return scan(table);
+    }
+
+    /**
+     * 读取已缓存的扫描结果, 不触发新的扫描(相当于 iw dev <if> scan dump)
+     * @param table 缓存的结果(先清空), 每行带有ageMs
+     * @return 支持且读取成功返回true
+     */
+    virtual bool dump(ScanTable &table)
+    {
+        table.clear();
+        return false;
+    }
+};
+
+/*
+ * 网卡扫描来源: 优先nl80211, 不可用时解析iw输出.
+ * 内部加锁, 前台扫描和后台扫描可以共用一个实例
+ */
+class InterfaceScanSource : public ScanSource
+{
+public:
+    explicit InterfaceScanSource(const std::string &iface);
+
+    bool scan(ScanTable &table) override;
+    bool scanTargeted(ScanTable &table, const ScanParams &params) override;
+    bool dump(ScanTable &table) override;
+
+private:
+    std::string iface_;
+    std::mutex mutex_;
+    Nl80211 nl80211_;
+    ProcessRunner runner_;
+    std::vector<NetworkInfo> bssList_; // nl80211结果缓冲, 复用容量
+
+    /*
+     * 把bssList_写入扫描表, frequencies不为空时只保留其中频率上的BSS, 调用时持有mutex_
+     */
+    void fillTable(ScanTable &table, const std::vector<int> &frequencies) const;
+
+    InterfaceScanSource(const InterfaceScanSource &);
+    InterfaceScanSource &operator=(const InterfaceScanSource &);
+};
+
+class ScanClock;
+
+/*
+ * 脚本化扫描来源, 按顺序返回预先设置的扫描结果, 用于测试和基准.
+ * 最近一次成功的结果作为"内核缓存"供dump()读取, 给定时钟时按经过的时间增加ageMs
+ */
+class ScriptedScanSource : public ScanSource
+{
+public:
+    explicit ScriptedScanSource(const ScanClock *clock = nullptr);
+
+    /**
+     * 每次scan()额外阻塞的真实时间, 模拟驱动扫描耗时
+     * @param delayMs 毫秒
+     */
+    void setScanDelay(int delayMs);
+
+    /**
+     * 追加一次扫描结果
+     * @param table 扫描结果
+     */
+    void push(const ScanTable &table);
+
+    /**
+     * 追加一次失败的扫描
+     */
+    void pushFailure();
+
+    /**
+     * 模拟其他进程(wpa_supplicant)的全信道扫描: 直接替换"内核缓存", 不计入scanCount()
+     * @param table 扫描结果
+     */
+    void refreshCache(const ScanTable &table);
+
+    /**
+     * 取下一次扫描结果, 只保留params.frequencies中频率上的BSS(模拟只在这些信道上收到响应)
+     */
+    bool scanTargeted(ScanTable &table, const ScanParams &params) override;
+    bool scan(ScanTable &table) override;
+    bool dump(ScanTable &table) override;
+
+    size_t remaining() const;
+    int scanCount() const;
+    int targetedCount() const;
+    int dumpCount() const;
+
+private:
+    mutable std::mutex mutex_;
+    const ScanClock *clock_;
+    std::deque<ScanTable> script_;
+    std::deque<bool> results_;
+    ScanTable cache_;
+    bool hasCache_;
+    int64_t cacheTimeMs_;
+    int delayMs_;
+    int scanCount_;
+    int targetedCount_;
+    int dumpCount_;
+
+    /*
+     * 等待扫描延迟后取出下一项脚本, 返回时持有lock
+     */
+    bool next(std::unique_lock<std::mutex> &lock, ScanTable &table);
+};
+
+/*
+ * 时钟(毫秒), 后台扫描的调度和BSS老化都以它为准
+ */
+class ScanClock
+{
+public:
+    virtual ~ScanClock() {}
+    virtual int64_t nowMs() const = 0;
+};
+
+class SteadyScanClock : public ScanClock
+{
+public:
+    int64_t nowMs() const override;
+};
+
+/*
+ * 虚拟时钟, 只在调用advance()/set()时前进
+ */
+class VirtualScanClock : public ScanClock
+{
+public:
+    VirtualScanClock() : nowMs_(0) {}
+
+    int64_t nowMs() const override;
+    void set(int64_t nowMs);
+    void advance(int64_t deltaMs);
+
+private:
+    mutable std::mutex mutex_;
+    int64_t nowMs_;
+};
+
+// BSS变化事件类型
+enum class BssEventType
+{
+    ADDED = 0,   // 首次扫描到
+    REMOVED = 1, // 超过maxAgeMs未再扫描到
+    CHANGED = 2  // 信号/加密方式/信道变化
+};
+
+// CHANGED事件中的变化项
+enum BssChange
+{
+    kBssSignalChanged = 0x01,   // 与上次通知的信号强度相差达到阈值
+    kBssSecurityChanged = 0x02, // 加密方式变化
+    kBssChannelChanged = 0x04   // 信道变化
+};
+
+struct BssEvent
+{
+    BssEventType type;
+    uint8_t changes; // BssChange组合(仅CHANGED)
+    MacAddress bssid;
+    std::string ssid;
+    int signalStrength;
+    int previousSignal;
+    int channel;
+    int previousChannel;
+    SecurityMode security;
+    int64_t timestampMs;
+
+    BssEvent()
+        : type(BssEventType::ADDED), changes(0), signalStrength(0), previousSignal(0),
+          channel(0), previousChannel(0), security(SecurityMode::OPEN), timestampMs(0) {}
+};
+
+// 老化BSS表中的一项
+struct BssRecord
+{
+    MacAddress bssid;
+    std::string ssid;
+    int signalStrength; // 最近一次扫描的信号强度
+    int reportedSignal; // 最近一次通知订阅者的信号强度
+    int channel;
+    int frequency;
+    SecurityMode security;
+    int64_t firstSeenMs;
+    int64_t lastSeenMs;
+
+    BssRecord()
+        : signalStrength(0), reportedSignal(0), channel(0), frequency(0),
+          security(SecurityMode::OPEN), firstSeenMs(0), lastSeenMs(0) {}
+};
+
+struct ScanServiceConfig
+{
+    int intervalMs;    // 扫描间隔(从上次扫描结束算起)
+    int maxAgeMs;      // BSS超过该时间未扫描到则移除
+    int rssiThreshold; // 信号变化达到该值(dB)才发出CHANGED事件
+
+    ScanServiceConfig() : intervalMs(30000), maxAgeMs(90000), rssiThreshold(5) {}
+};
+
+/*
+ * 后台连续扫描服务
+ * 按配置的间隔调用ScanSource, 把结果合并到以BSSID为键的老化BSS表,
+ * 并向订阅者发布新增/移除/变化事件, 订阅者无需自行比较完整列表.
+ * start()启动后台线程; 也可以不启动线程, 由调用方(测试)配合VirtualScanClock调用tick()驱动
+ */
+class ScanService
+{
+public:
+    /*
+     * 事件回调, 在扫描线程中调用(不持有服务内部锁, 可以在回调中读取BSS表)
+     * @param event BSS事件
+     * @param context 订阅时传入的上下文
+     */
+    typedef void (*Listener)(const BssEvent &event, void *context);
+
+    ScanService(ScanSource &source, ScanClock &clock);
+    ~ScanService();
+
+    /**
+     * 设置调度和老化参数, 已在运行时下次扫描按新间隔重新调度
+     * @param config 配置
+     */
+    void setConfig(const ScanServiceConfig &config);
+    ScanServiceConfig getConfig() const;
+
+    /**
+     * 启动后台扫描线程(立即进行第一次扫描)
+     * @return 成功返回true
+     */
+    bool start();
+
+    /**
+     * 停止后台扫描线程(等待正在进行的扫描结束)
+     */
+    void stop();
+    bool isRunning() const;
+
+    /**
+     * 到达调度时间时执行一次扫描
+     * @return 执行了扫描返回true
+     */
+    bool tick();
+
+    /**
+     * 立即执行一次扫描并重新调度
+     * @return 扫描成功返回true
+     */
+    bool scanNow();
+
+    /**
+     * 订阅BSS事件
+     * @param listener 回调函数
+     * @param context 回调上下文
+     * @return 订阅编号
+     */
+    int subscribe(Listener listener, void *context);
+    void unsubscribe(int id);
+
+    /**
+     * 复制当前BSS表
+     * @param records 全部BSS(无序)
+     */
+    void snapshot(std::vector<BssRecord> &records) const;
+
+    /**
+     * 查找BSS
+     * @param bssid BSSID
+     * @param record 查找结果
+     * @return 存在返回true
+     */
+    bool find(const MacAddress &bssid, BssRecord &record) const;
+
+    size_t size() const;
+    int64_t nextScanMs() const;
+    int getScanCount() const;
+    int getFailureCount() const;
+
+private:
+    struct Subscription
+    {
+        int id;
+        Listener listener;
+        void *context;
+    };
+
+    ScanSource &source_;
+    ScanClock &clock_;
+    ScanServiceConfig config_;
+    ScanTable table_; // 扫描缓冲, 只在持有scanMutex_时访问
+
+    mutable std::mutex mutex_; // 保护BSS表、配置和调度状态
+    std::mutex scanMutex_;     // 串行化扫描
+    std::mutex listenerMutex_;
+    std::condition_variable wakeup_;
+    std::thread thread_;
+    bool running_;
+
+    std::unordered_map<MacAddress, BssRecord> records_;
+    std::vector<Subscription> listeners_;
+    int nextListenerId_;
+    int64_t nextScanMs_;
+    int scanCount_;
+    int failureCount_;
+
+    void run();
+    bool runScan();
+    /*
+     * 合并一次扫描结果并移除过期BSS, 调用时持有mutex_
+     */
+    void merge(const ScanTable &table, int64_t nowMs, std::vector<BssEvent> &events);
+    void expire(int64_t nowMs, std::vector<BssEvent> &events);
+    void dispatch(const std::vector<BssEvent> &events);
+
+    ScanService(const ScanService &);
+    ScanService &operator=(const ScanService &);
+};
+
+#endif // SCAN_SERVICE_H
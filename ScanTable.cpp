@@ -0,0 +1,304 @@
+#include "ScanTable.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+const size_t kMinBuckets = 64;
+const size_t kMaxSsidLength = 255;
+} // namespace
+
+const uint32_t ScanTable::npos;
+
+ScanTable::ScanTable() : bySignalValid_(false), byChannelValid_(false)
+{
+}
+
+void ScanTable::clear()
+{
+    bssids_.clear();
+    frequencies_.clear();
+    channels_.clear();
+    signals_.clear();
+    securities_.clear();
+    flags_.clear();
+    ages_.clear();
+    ssidIds_.clear();
+    arena_.clear();
+    ssidOffsets_.clear();
+    ssidLengths_.clear();
+    ssidHashes_.clear();
+    bestRows_.clear();
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    bySignalValid_ = false;
+    byChannelValid_ = false;
+}
+
+void ScanTable::reserve(size_t rows, size_t arenaBytes)
+{
+    bssids_.reserve(rows);
+    frequencies_.reserve(rows);
+    channels_.reserve(rows);
+    signals_.reserve(rows);
+    securities_.reserve(rows);
+    flags_.reserve(rows);
+    ages_.reserve(rows);
+    ssidIds_.reserve(rows);
+    arena_.reserve(arenaBytes);
+}
+
+uint32_t ScanTable::add(const MacAddress &bssid, TextView ssid, int frequency, int channel, int signalStrength,
+                        SecurityMode security, uint8_t flags, uint32_t ageMs)
+{
+    uint32_t row = static_cast<uint32_t>(bssids_.size());
+    uint32_t id = intern(ssid);
+    if (ssid.empty())
+    {
+        flags |= kScanHidden;
+    }
+    // 信号强度限制在int8_t范围内(实际为-100 ~ 0 dBm)
+    signalStrength = std::max(-128, std::min(127, signalStrength));
+
+    bssids_.push_back(bssid);
+    frequencies_.push_back(static_cast<uint16_t>(frequency));
+    channels_.push_back(static_cast<uint8_t>(channel));
+    signals_.push_back(static_cast<int8_t>(signalStrength));
+    securities_.push_back(static_cast<uint8_t>(security));
+    flags_.push_back(flags);
+    ages_.push_back(ageMs);
+    ssidIds_.push_back(id);
+
+    if (bestRows_[id] == npos || signalStrength > signals_[bestRows_[id]])
+    {
+        bestRows_[id] = row;
+    }
+    bySignalValid_ = false;
+    byChannelValid_ = false;
+    return row;
+}
+
+uint32_t ScanTable::add(const NetworkInfo &network)
+{
+    return add(network.bssid, TextView(network.ssid), network.frequency, network.channel, network.signalStrength,
+               network.security, network.isHidden ? kScanHidden : 0,
+               static_cast<uint32_t>(network.ageMs < 0 ? 0 : network.ageMs));
+}
+
+uint32_t ScanTable::add(const ScanTable &source, uint32_t row)
+{
+    return add(source.bssids_[row], source.ssid(row), source.frequencies_[row], source.channels_[row],
+               source.signals_[row], source.security(row), source.flags_[row], source.ages_[row]);
+}
+
+TextView ScanTable::ssidText(uint32_t id) const
+{
+    return TextView(arena_.data() + ssidOffsets_[id], ssidLengths_[id]);
+}
+
+uint32_t ScanTable::findSsid(TextView ssid) const
+{
+    if (buckets_.empty())
+    {
+        return npos;
+    }
+    if (ssid.size() > kMaxSsidLength)
+    {
+        ssid = ssid.substr(0, kMaxSsidLength);
+    }
+    return lookup(ssid, hashText(ssid));
+}
+
+uint32_t ScanTable::strongest(TextView ssid) const
+{
+    uint32_t id = findSsid(ssid);
+    return id == npos ? npos : bestRows_[id];
+}
+
+size_t ScanTable::setSsidFlag(TextView ssid, uint8_t flag, bool enabled)
+{
+    uint32_t id = findSsid(ssid);
+    if (id == npos)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    for (size_t row = 0; row < ssidIds_.size(); row++)
+    {
+        if (ssidIds_[row] == id)
+        {
+            flags_[row] = enabled ? static_cast<uint8_t>(flags_[row] | flag) : static_cast<uint8_t>(flags_[row] & ~flag);
+            count++;
+        }
+    }
+    return count;
+}
+
+const std::vector<uint32_t> &ScanTable::bySignal() const
+{
+    if (!bySignalValid_)
+    {
+        bySignal_.resize(bssids_.size());
+        for (size_t row = 0; row < bySignal_.size(); row++)
+        {
+            bySignal_[row] = static_cast<uint32_t>(row);
+        }
+        const std::vector<int8_t> &signals = signals_;
+        std::stable_sort(bySignal_.begin(), bySignal_.end(),
+                         [&signals](uint32_t a, uint32_t b)
+                         { return signals[a] > signals[b]; });
+        bySignalValid_ = true;
+    }
+    return bySignal_;
+}
+
+const std::vector<uint32_t> &ScanTable::byChannel() const
+{
+    if (!byChannelValid_)
+    {
+        // 由信号索引稳定排序, 同一信道内保持信号从强到弱
+        byChannel_ = bySignal();
+        const std::vector<uint8_t> &channels = channels_;
+        std::stable_sort(byChannel_.begin(), byChannel_.end(),
+                         [&channels](uint32_t a, uint32_t b)
+                         { return channels[a] < channels[b]; });
+        byChannelValid_ = true;
+    }
+    return byChannel_;
+}
+
+void ScanTable::strongestPerSsid(std::vector<uint32_t> &rows, uint8_t excludeFlags) const
+{
+    rows.clear();
+    for (size_t id = 0; id < bestRows_.size(); id++)
+    {
+        uint32_t row = bestRows_[id];
+        if (row == npos || ssidLengths_[id] == 0 || (flags_[row] & excludeFlags) != 0)
+        {
+            continue;
+        }
+        rows.push_back(row);
+    }
+    // 与原std::map实现保持一致, 按SSID字节序排序
+    std::sort(rows.begin(), rows.end(),
+              [this](uint32_t a, uint32_t b)
+              {
+                  TextView left = ssid(a);
+                  TextView right = ssid(b);
+                  int result = std::memcmp(left.data(), right.data(), std::min(left.size(), right.size()));
+                  return result != 0 ? result < 0 : left.size() < right.size();
+              });
+}
+
+uint32_t ScanTable::newestAgeMs() const
+{
+    if (ages_.empty())
+    {
+        return npos;
+    }
+    return *std::min_element(ages_.begin(), ages_.end());
+}
+
+NetworkInfo ScanTable::toNetworkInfo(uint32_t row) const
+{
+    NetworkInfo network;
+    network.ssid = ssid(row).toString();
+    network.signalStrength = signals_[row];
+    network.security = security(row);
+    network.channel = channels_[row];
+    network.isHidden = has(row, kScanHidden);
+    network.bssid = bssids_[row];
+    network.frequency = frequencies_[row];
+    network.ageMs = static_cast<int>(ages_[row]);
+    return network;
+}
+
+size_t ScanTable::memoryBytes() const
+{
+    return bssids_.capacity() * sizeof(MacAddress) + frequencies_.capacity() * sizeof(uint16_t) +
+           channels_.capacity() + signals_.capacity() + securities_.capacity() + flags_.capacity() +
+           ages_.capacity() * sizeof(uint32_t) +
+           ssidIds_.capacity() * sizeof(uint32_t) + arena_.capacity() +
+           ssidOffsets_.capacity() * sizeof(uint32_t) + ssidLengths_.capacity() +
+           ssidHashes_.capacity() * sizeof(uint32_t) + bestRows_.capacity() * sizeof(uint32_t) +
+           buckets_.capacity() * sizeof(uint32_t) +
+           (bySignal_.capacity() + byChannel_.capacity()) * sizeof(uint32_t);
+}
+
+uint32_t ScanTable::intern(TextView ssid)
+{
+    if (ssid.size() > kMaxSsidLength)
+    {
+        ssid = ssid.substr(0, kMaxSsidLength);
+    }
+    // 负载因子不超过1/2
+    if ((ssidOffsets_.size() + 1) * 2 > buckets_.size())
+    {
+        growBuckets();
+    }
+    uint32_t hash = hashText(ssid);
+    uint32_t id = lookup(ssid, hash);
+    if (id != npos)
+    {
+        return id;
+    }
+
+    id = static_cast<uint32_t>(ssidOffsets_.size());
+    ssidOffsets_.push_back(static_cast<uint32_t>(arena_.size()));
+    ssidLengths_.push_back(static_cast<uint8_t>(ssid.size()));
+    ssidHashes_.push_back(hash);
+    bestRows_.push_back(npos);
+    arena_.insert(arena_.end(), ssid.begin(), ssid.end());
+
+    size_t mask = buckets_.size() - 1;
+    size_t slot = hash & mask;
+    while (buckets_[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+    buckets_[slot] = id + 1;
+    return id;
+}
+
+uint32_t ScanTable::lookup(TextView ssid, uint32_t hash) const
+{
+    size_t mask = buckets_.size() - 1;
+    size_t slot = hash & mask;
+    while (buckets_[slot] != 0)
+    {
+        uint32_t id = buckets_[slot] - 1;
+        if (ssidHashes_[id] == hash && ssidText(id) == ssid)
+        {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return npos;
+}
+
+void ScanTable::growBuckets()
+{
+    size_t capacity = std::max(kMinBuckets, buckets_.size() * 2);
+    buckets_.assign(capacity, 0);
+    size_t mask = capacity - 1;
+    for (uint32_t id = 0; id < ssidHashes_.size(); id++)
+    {
+        size_t slot = ssidHashes_[id] & mask;
+        while (buckets_[slot] != 0)
+        {
+            slot = (slot + 1) & mask;
+        }
+        buckets_[slot] = id + 1;
+    }
+}
+
+uint32_t ScanTable::hashText(TextView text)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c : text)
+    {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,194 @@
+#ifndef SCAN_TABLE_H
+#define SCAN_TABLE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "TextView.h"
+#include "MacAddress.h"
+#include "WifiTypes.h"
+
+// BSS标志
+enum ScanFlag
+{
+    kScanHidden = 0x01, // 隐藏网络(SSID为空)
+    kScanSaved = 0x02   // SSID在已保存网络列表中
+};
+
+/*
+ * 一次扫描的BSS表
+ * 按列存放(BSSID/频率/信道/信号/加密方式/标志/时间各一个数组), SSID在每次扫描的arena中去重保存,
+ * 每个BSS只记录SSID编号. 读取通过行号访问各列或TextView, 不复制字符串;
+ * 按信号和信道排序的索引在首次使用时生成, 表修改前一直有效.
+ * clear()保留容量, 同一个表重复用于每次扫描时不再分配内存
+ */
+class ScanTable
+{
+public:
+    static const uint32_t npos = 0xffffffffu;
+
+    ScanTable();
+
+    /**
+     * 清空表(保留已分配的容量)
+     */
+    void clear();
+
+    /**
+     * 预留容量
+     * @param rows BSS数量
+     * @param arenaBytes SSID总字节数
+     */
+    void reserve(size_t rows, size_t arenaBytes);
+
+    /**
+     * 添加一个BSS
+     * @param bssid BSSID
+     * @param ssid 已解码的SSID(复制到arena, 相同SSID只保存一次)
+     * @param frequency 频率(MHz)
+     * @param channel 信道
+     * @param signalStrength 信号强度(dBm)
+     * @param security 加密方式
+     * @param flags ScanFlag组合(SSID为空时自动加上kScanHidden)
+     * @param ageMs 距内核最近一次收到该BSS的时间(毫秒)
+     * @return 行号
+     */
+    uint32_t add(const MacAddress &bssid, TextView ssid, int frequency, int channel, int signalStrength,
+                 SecurityMode security, uint8_t flags = 0, uint32_t ageMs = 0);
+    uint32_t add(const NetworkInfo &network);
+
+    /**
+     * 复制另一个表中的一行
+     * @param source 源表(不能是本表)
+     * @param row 源表行号
+     * @return 本表中的行号
+     */
+    uint32_t add(const ScanTable &source, uint32_t row);
+
+    size_t size() const { return bssids_.size(); }
+    bool empty() const { return bssids_.empty(); }
+
+    // 按行读取, row必须小于size()
+    MacAddress bssid(uint32_t row) const { return bssids_[row]; }
+    int frequency(uint32_t row) const { return frequencies_[row]; }
+    int channel(uint32_t row) const { return channels_[row]; }
+    int signalStrength(uint32_t row) const { return signals_[row]; }
+    SecurityMode security(uint32_t row) const { return static_cast<SecurityMode>(securities_[row]); }
+    uint8_t flags(uint32_t row) const { return flags_[row]; }
+    uint32_t ageMs(uint32_t row) const { return ages_[row]; }
+    bool has(uint32_t row, uint8_t flag) const { return (flags_[row] & flag) == flag; }
+    uint32_t ssidId(uint32_t row) const { return ssidIds_[row]; }
+
+    /**
+     * BSS的SSID
+     * @param row 行号
+     * @return 指向arena的视图(表修改后失效)
+     */
+    TextView ssid(uint32_t row) const { return ssidText(ssidIds_[row]); }
+
+    // 整列只读访问, 下标即行号
+    const std::vector<MacAddress> &bssids() const { return bssids_; }
+    const std::vector<int8_t> &signals() const { return signals_; }
+    const std::vector<uint16_t> &frequencies() const { return frequencies_; }
+
+    /**
+     * 不同SSID的数量(SSID编号为0 ~ ssidCount()-1)
+     */
+    size_t ssidCount() const { return ssidOffsets_.size(); }
+    TextView ssidText(uint32_t id) const;
+
+    /**
+     * 查找SSID编号
+     * @param ssid 网络名称
+     * @return SSID编号, 未扫描到返回npos
+     */
+    uint32_t findSsid(TextView ssid) const;
+
+    /**
+     * 某个SSID信号最强的BSS
+     * @param ssid 网络名称
+     * @return 行号, 未扫描到返回npos
+     */
+    uint32_t strongest(TextView ssid) const;
+
+    /**
+     * 设置或清除某个SSID所有BSS的标志
+     * @param ssid 网络名称
+     * @param flag ScanFlag组合
+     * @param enabled 设置或清除
+     * @return 受影响的BSS数量
+     */
+    size_t setSsidFlag(TextView ssid, uint8_t flag, bool enabled);
+
+    /**
+     * 按信号强度排序的行号(最强在前)
+     * @return 索引(表修改后失效)
+     */
+    const std::vector<uint32_t> &bySignal() const;
+
+    /**
+     * 按信道排序的行号(同一信道内信号最强在前)
+     * @return 索引(表修改后失效)
+     */
+    const std::vector<uint32_t> &byChannel() const;
+
+    /**
+     * 每个非隐藏SSID信号最强的BSS, 按SSID排序
+     * @param rows 行号结果
+     * @param excludeFlags 带有其中任一标志的SSID被跳过(0表示不过滤)
+     */
+    void strongestPerSsid(std::vector<uint32_t> &rows, uint8_t excludeFlags = 0) const;
+
+    /**
+     * 最近收到的BSS距今的时间, 即这批结果对应的扫描时间
+     * @return 最小的ageMs, 表为空时返回npos
+     */
+    uint32_t newestAgeMs() const;
+
+    /**
+     * 转换为NetworkInfo(兼容旧接口)
+     * @param row 行号
+     * @return 网络信息
+     */
+    NetworkInfo toNetworkInfo(uint32_t row) const;
+
+    /**
+     * 已分配的内存(字节, 按容量计算)
+     */
+    size_t memoryBytes() const;
+
+private:
+    // 列
+    std::vector<MacAddress> bssids_;
+    std::vector<uint16_t> frequencies_;
+    std::vector<uint8_t> channels_;
+    std::vector<int8_t> signals_;
+    std::vector<uint8_t> securities_;
+    std::vector<uint8_t> flags_;
+    std::vector<uint32_t> ages_;
+    std::vector<uint32_t> ssidIds_;
+
+    // SSID arena, 按编号记录偏移/长度/最强BSS
+    std::vector<char> arena_;
+    std::vector<uint32_t> ssidOffsets_;
+    std::vector<uint8_t> ssidLengths_;
+    std::vector<uint32_t> ssidHashes_;
+    std::vector<uint32_t> bestRows_;
+    std::vector<uint32_t> buckets_; // 开放寻址哈希表, 保存SSID编号+1, 0为空
+
+    mutable std::vector<uint32_t> bySignal_;
+    mutable std::vector<uint32_t> byChannel_;
+    mutable bool bySignalValid_;
+    mutable bool byChannelValid_;
+
+    /*
+     * 查找SSID, 不存在时加入arena
+     */
+    uint32_t intern(TextView ssid);
+    uint32_t lookup(TextView ssid, uint32_t hash) const;
+    void growBuckets();
+    static uint32_t hashText(TextView text);
+};
+
+#endif // SCAN_TABLE_H
@@ -0,0 +1,168 @@
+#include "SightingStore.h"
+
+#include <algorithm>
+
+namespace
+{
+/*
+ * 依次取出逗号分隔的各项(去除首尾空白)
+ */
+template <typename Visitor>
+void forEachItem(TextView text, Visitor visitor)
+{
+    while (!text.empty())
+    {
+        TextView item;
+        TextView rest;
+        if (!text.split(',', item, rest))
+        {
+            item = text.trim();
+            rest = TextView();
+        }
+        if (!item.empty())
+        {
+            visitor(item);
+        }
+        text = rest;
+    }
+}
+} // namespace
+
+const size_t SightingStore::kMaxEntries;
+const size_t SightingStore::kMaxProbeSsids;
+
+bool SightingStore::update(const ScanTable &table, const std::vector<std::string> &ssids)
+{
+    bool changed = false;
+    const std::vector<uint32_t> &rows = table.bySignal();
+    for (const auto &ssid : ssids)
+    {
+        uint32_t id = table.findSsid(ssid);
+        if (id == ScanTable::npos)
+        {
+            continue;
+        }
+
+        NetworkSighting sighting;
+        for (uint32_t row : rows)
+        {
+            if (table.ssidId(row) != id)
+            {
+                continue;
+            }
+            if (sighting.bssids.size() < kMaxEntries)
+            {
+                sighting.bssids.push_back(table.bssid(row));
+            }
+            int frequency = table.frequency(row);
+            if (sighting.frequencies.size() < kMaxEntries &&
+                std::find(sighting.frequencies.begin(), sighting.frequencies.end(), frequency) ==
+                    sighting.frequencies.end())
+            {
+                sighting.frequencies.push_back(frequency);
+            }
+        }
+        // 按信号选出后再排序保存, 信号抖动不会导致重写配置文件
+        std::sort(sighting.frequencies.begin(), sighting.frequencies.end());
+        std::sort(sighting.bssids.begin(), sighting.bssids.end());
+
+        NetworkSighting &stored = sightings_[ssid];
+        if (stored.frequencies != sighting.frequencies || stored.bssids != sighting.bssids)
+        {
+            stored = sighting;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+bool SightingStore::buildScanParams(const std::vector<std::string> &ssids, ScanParams &params) const
+{
+    params = ScanParams();
+    for (const auto &ssid : ssids)
+    {
+        if (params.ssids.size() < kMaxProbeSsids)
+        {
+            params.ssids.push_back(ssid);
+        }
+        const NetworkSighting *sighting = find(ssid);
+        if (sighting == nullptr)
+        {
+            continue;
+        }
+        for (int frequency : sighting->frequencies)
+        {
+            if (std::find(params.frequencies.begin(), params.frequencies.end(), frequency) == params.frequencies.end())
+            {
+                params.frequencies.push_back(frequency);
+            }
+        }
+    }
+    std::sort(params.frequencies.begin(), params.frequencies.end());
+    return !params.frequencies.empty();
+}
+
+const NetworkSighting *SightingStore::find(const std::string &ssid) const
+{
+    auto it = sightings_.find(ssid);
+    return it == sightings_.end() ? nullptr : &it->second;
+}
+
+void SightingStore::set(const std::string &ssid, const NetworkSighting &sighting)
+{
+    sightings_[ssid] = sighting;
+}
+
+void SightingStore::erase(const std::string &ssid)
+{
+    sightings_.erase(ssid);
+}
+
+std::string SightingStore::format(const std::string &ssid) const
+{
+    std::string text;
+    const NetworkSighting *sighting = find(ssid);
+    if (sighting != nullptr)
+    {
+        for (size_t i = 0; i < sighting->frequencies.size(); i++)
+        {
+            text += (i == 0 ? "" : ",") + std::to_string(sighting->frequencies[i]);
+        }
+    }
+    text += "|";
+    if (sighting != nullptr)
+    {
+        for (size_t i = 0; i < sighting->bssids.size(); i++)
+        {
+            text += (i == 0 ? "" : ",") + sighting->bssids[i].toString();
+        }
+    }
+    return text;
+}
+
+void SightingStore::parse(const std::string &ssid, const std::string &frequencies, const std::string &bssids)
+{
+    NetworkSighting sighting;
+    forEachItem(TextView(frequencies), [&sighting](TextView item)
+                {
+                    int frequency = 0;
+                    if (item.toInt(frequency) && frequency > 0 && sighting.frequencies.size() < kMaxEntries)
+                    {
+                        sighting.frequencies.push_back(frequency);
+                    }
+                });
+    forEachItem(TextView(bssids), [&sighting](TextView item)
+                {
+                    MacAddress bssid;
+                    if (MacAddress::parse(item.data(), item.size(), bssid) && sighting.bssids.size() < kMaxEntries)
+                    {
+                        sighting.bssids.push_back(bssid);
+                    }
+                });
+    if (sighting.frequencies.empty() && sighting.bssids.empty())
+    {
+        sightings_.erase(ssid);
+        return;
+    }
+    sightings_[ssid] = sighting;
+}
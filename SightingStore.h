@@ -0,0 +1,69 @@
+#ifndef SIGHTING_STORE_H
+#define SIGHTING_STORE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "WifiTypes.h"
+#include "ScanTable.h"
+
+/*
+ * 已保存网络最近出现的频率和BSSID
+ * 每次扫描后按SSID更新, 重连时据此生成只覆盖这些频率的定向扫描参数,
+ * 避免为了确认少数已保存网络是否在范围内而扫描全部信道
+ */
+class SightingStore
+{
+public:
+    // 每个网络最多记录的频率/BSSID数量
+    static const size_t kMaxEntries = 4;
+    // 一次定向扫描最多探测的SSID数量(多数驱动的max_scan_ssids不小于4)
+    static const size_t kMaxProbeSsids = 4;
+
+    /**
+     * 用扫描结果更新指定SSID的记录(取信号最强的若干个BSS), 未扫描到的SSID保留原记录
+     * @param table 扫描结果
+     * @param ssids 需要记录的SSID(已保存网络)
+     * @return 有记录发生变化返回true(需要写回配置文件)
+     */
+    bool update(const ScanTable &table, const std::vector<std::string> &ssids);
+
+    /**
+     * 生成定向扫描参数: 这些SSID最近出现过的频率(去重), 以及携带这些SSID的探测请求
+     * @param ssids 要查找的SSID
+     * @param params 扫描参数
+     * @return 至少有一个SSID有频率记录返回true, 否则只能全信道扫描
+     */
+    bool buildScanParams(const std::vector<std::string> &ssids, ScanParams &params) const;
+
+    /**
+     * 查找记录
+     * @param ssid 网络名称
+     * @return 记录, 不存在返回nullptr
+     */
+    const NetworkSighting *find(const std::string &ssid) const;
+
+    void set(const std::string &ssid, const NetworkSighting &sighting);
+    void erase(const std::string &ssid);
+    size_t size() const { return sightings_.size(); }
+
+    /**
+     * 格式化为配置文件字段 "2412,5180|aa:bb:cc:dd:ee:ff,..."
+     * @param ssid 网络名称
+     * @return 字段内容, 没有记录时返回 "|"
+     */
+    std::string format(const std::string &ssid) const;
+
+    /**
+     * 解析配置文件字段
+     * @param ssid 网络名称
+     * @param frequencies 逗号分隔的频率
+     * @param bssids 逗号分隔的BSSID
+     */
+    void parse(const std::string &ssid, const std::string &frequencies, const std::string &bssids);
+
+private:
+    std::map<std::string, NetworkSighting> sightings_;
+};
+
+#endif // SIGHTING_STORE_H
@@ -0,0 +1,302 @@
+#include "SupplicantProfile.h"
+#include "IwScanParser.h"
+#include "TextView.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+const size_t kRawPskLength = 64;
+
+bool isHexText(const std::string &text)
+{
+    for (char c : text)
+    {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * 64位十六进制为预先计算的PSK, 直接写入; 否则为口令, 加引号
+ */
+std::string encodePsk(const std::string &password)
+{
+    if (password.size() == kRawPskLength && isHexText(password))
+    {
+        return password;
+    }
+    return "\"" + password + "\"";
+}
+} // namespace
+
+SupplicantProfile::SupplicantProfile(WpaCtrl &ctrl) : ctrl_(ctrl), loaded_(false), commandCount_(0)
+{
+}
+
+bool SupplicantProfile::load()
+{
+#ifndef _WIN32
+    reset();
+    std::string reply;
+    commandCount_++;
+    if (!ctrl_.request("LIST_NETWORKS", reply) || reply.compare(0, 4, "FAIL") == 0)
+    {
+        return false;
+    }
+    std::map<std::string, int> networks;
+    parseNetworkList(reply, networks);
+    for (const auto &network : networks)
+    {
+        // 配置来自配置文件, 内容未知, 首次apply()时全部重新下发
+        Entry entry;
+        entry.id = network.second;
+        entry.network.ssid = network.first;
+        entry.configured = false;
+        entry.enabled = false;
+        entries_[network.first] = entry;
+    }
+    loaded_ = true;
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void SupplicantProfile::reset()
+{
+    entries_.clear();
+    loaded_ = false;
+}
+
+int SupplicantProfile::apply(const SupplicantNetwork &network)
+{
+#ifndef _WIN32
+    auto it = entries_.find(network.ssid);
+    if (it == entries_.end())
+    {
+        std::string reply;
+        commandCount_++;
+        if (!ctrl_.request("ADD_NETWORK", reply) || reply.empty() || reply[0] < '0' || reply[0] > '9')
+        {
+            std::cout << "wpa_supplicant ADD_NETWORK failed" << std::endl;
+            return -1;
+        }
+        Entry entry;
+        entry.id = atoi(reply.c_str());
+        entry.network.ssid = network.ssid;
+        entry.configured = false;
+        entry.enabled = false; // 新网络默认禁用
+        if (!setField(entry.id, "ssid", encodeSsid(network.ssid)))
+        {
+            command("REMOVE_NETWORK " + std::to_string(entry.id));
+            return -1;
+        }
+        it = entries_.insert(std::make_pair(network.ssid, entry)).first;
+    }
+
+    Entry &entry = it->second;
+    const SupplicantNetwork &applied = entry.network;
+    bool force = !entry.configured;
+    std::string id = std::to_string(entry.id);
+    // 失败时下次全部重新下发
+    entry.configured = false;
+
+    if (force || network.password != applied.password)
+    {
+        if (network.password.empty())
+        {
+            if (!setField(entry.id, "key_mgmt", "NONE"))
+            {
+                return -1;
+            }
+        }
+        else if (((force || applied.password.empty()) && !setField(entry.id, "key_mgmt", "WPA-PSK")) ||
+                 !setField(entry.id, "psk", encodePsk(network.password)))
+        {
+            return -1;
+        }
+    }
+    if ((force || network.priority != applied.priority) &&
+        !setField(entry.id, "priority", std::to_string(network.priority)))
+    {
+        return -1;
+    }
+    if ((force || network.hidden != applied.hidden) && !setField(entry.id, "scan_ssid", network.hidden ? "1" : "0"))
+    {
+        return -1;
+    }
+    if ((force || network.enabled != entry.enabled) &&
+        !command((network.enabled ? "ENABLE_NETWORK " : "DISABLE_NETWORK ") + id))
+    {
+        return -1;
+    }
+
+    entry.network = network;
+    entry.enabled = network.enabled;
+    entry.configured = true;
+    return entry.id;
+#else
+    return -1;
+#endif // _WIN32
+}
+
+bool SupplicantProfile::select(const std::string &ssid)
+{
+    auto it = entries_.find(ssid);
+    if (it == entries_.end() || !command("SELECT_NETWORK " + std::to_string(it->second.id)))
+    {
+        return false;
+    }
+    for (auto &entry : entries_)
+    {
+        entry.second.enabled = entry.first == ssid;
+    }
+    return true;
+}
+
+bool SupplicantProfile::restoreAutoConnect()
+{
+    bool success = true;
+    for (auto &entry : entries_)
+    {
+        if (entry.second.network.enabled && !entry.second.enabled)
+        {
+            if (command("ENABLE_NETWORK " + std::to_string(entry.second.id)))
+            {
+                entry.second.enabled = true;
+            }
+            else
+            {
+                success = false;
+            }
+        }
+    }
+    return success;
+}
+
+bool SupplicantProfile::remove(const std::string &ssid)
+{
+    auto it = entries_.find(ssid);
+    if (it == entries_.end())
+    {
+        return true;
+    }
+    if (!command("REMOVE_NETWORK " + std::to_string(it->second.id)))
+    {
+        return false;
+    }
+    entries_.erase(it);
+    return true;
+}
+
+int SupplicantProfile::find(const std::string &ssid) const
+{
+    auto it = entries_.find(ssid);
+    return it == entries_.end() ? -1 : it->second.id;
+}
+
+std::string SupplicantProfile::encodeSsid(const std::string &ssid)
+{
+    bool printable = true;
+    for (char c : ssid)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (byte < 0x20 || byte == 0x7f)
+        {
+            printable = false;
+            break;
+        }
+    }
+    if (printable)
+    {
+        return "\"" + ssid + "\"";
+    }
+
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(ssid.size() * 2);
+    for (char c : ssid)
+    {
+        unsigned char byte = static_cast<unsigned char>(c);
+        hex.push_back(kHexDigits[byte >> 4]);
+        hex.push_back(kHexDigits[byte & 0x0f]);
+    }
+    return hex;
+}
+
+std::string SupplicantProfile::formatNetworkBlock(const SupplicantNetwork &network)
+{
+    std::string block = "network={\n";
+    block += "    ssid=" + encodeSsid(network.ssid) + "\n";
+    if (!network.password.empty())
+    {
+        block += "    psk=" + encodePsk(network.password) + "\n";
+    }
+    else
+    {
+        block += "    key_mgmt=NONE\n";
+    }
+    block += "    priority=" + std::to_string(network.priority) + "\n";
+    if (network.hidden)
+    {
+        block += "    scan_ssid=1\n";
+    }
+    if (!network.enabled)
+    {
+        block += "    disabled=1\n";
+    }
+    block += "}\n";
+    return block;
+}
+
+size_t SupplicantProfile::parseNetworkList(const std::string &reply, std::map<std::string, int> &networks)
+{
+    networks.clear();
+    TextView remaining(reply);
+    TextView line;
+    // 跳过表头 "network id / ssid / bssid / flags"
+    remaining.nextLine(line);
+    while (remaining.nextLine(line))
+    {
+        size_t tab = line.find('\t');
+        int id = 0;
+        if (tab == TextView::npos || !line.substr(0, tab).toInt(id))
+        {
+            continue;
+        }
+        TextView rest = line.substr(tab + 1);
+        TextView ssid = rest.substr(0, rest.find('\t'));
+        std::string decoded;
+        IwScanParser::decodeSsid(ssid, decoded);
+        networks[decoded] = id;
+    }
+    return networks.size();
+}
+
+bool SupplicantProfile::command(const std::string &text)
+{
+#ifndef _WIN32
+    std::string reply;
+    commandCount_++;
+    if (!ctrl_.request(text, reply) || reply.compare(0, 2, "OK") != 0)
+    {
+        std::cout << "wpa_supplicant command failed: " << text.substr(0, text.find(' ', text.find(' ') + 1))
+                  << std::endl;
+        return false;
+    }
+    return true;
+#else
+    (void)text;
+    return false;
+#endif // _WIN32
+}
+
+bool SupplicantProfile::setField(int id, const std::string &field, const std::string &value)
+{
+    return command("SET_NETWORK " + std::to_string(id) + " " + field + " " + value);
+}
@@ -0,0 +1,139 @@
+#ifndef SUPPLICANT_PROFILE_H
+#define SUPPLICANT_PROFILE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include "WpaCtrl.h"
+
+// wpa_supplicant中的一个网络配置
+struct SupplicantNetwork
+{
+    std::string ssid;
+    std::string password; // 为空表示开放网络
+    int priority;         // 越大越优先被自动选择
+    bool enabled;         // 允许wpa_supplicant自动连接
+    bool hidden;          // 扫描时发送携带SSID的探测请求(scan_ssid=1)
+
+    SupplicantNetwork() : priority(0), enabled(false), hidden(false) {}
+};
+
+/*
+ * 常驻wpa_supplicant的多网络配置
+ * 通过控制接口的ADD_NETWORK/SET_NETWORK/SELECT_NETWORK/REMOVE_NETWORK维护网络表,
+ * 切换网络只需重新关联, 不再为每次连接重写配置文件并重启进程.
+ * 记录每个网络已下发的字段, 重复调用apply()时只发送变化的部分
+ */
+class SupplicantProfile
+{
+public:
+    /**
+     * @param ctrl wpa_supplicant控制接口(由调用方打开和关闭)
+     */
+    explicit SupplicantProfile(WpaCtrl &ctrl);
+
+    /**
+     * 通过LIST_NETWORKS同步网络编号(wpa_supplicant启动后调用一次)
+     * @return 成功返回true，失败返回false
+     */
+    bool load();
+
+    /**
+     * 忘记已同步的网络表(wpa_supplicant停止或控制接口断开后调用)
+     */
+    void reset();
+
+    /**
+     * 判断是否已与运行中的wpa_supplicant同步
+     * @return 已同步返回true
+     */
+    bool isLoaded() const { return loaded_; }
+
+    /**
+     * 添加或更新网络, 只发送与已下发内容不同的字段
+     * @param network 网络配置
+     * @return 网络编号, 失败返回-1
+     */
+    int apply(const SupplicantNetwork &network);
+
+    /**
+     * 切换到指定网络(SELECT_NETWORK, wpa_supplicant会暂时禁用其他网络)
+     * @param ssid 网络名称(必须已apply)
+     * @return 成功返回true，失败返回false
+     */
+    bool select(const std::string &ssid);
+
+    /**
+     * 重新启用SELECT_NETWORK禁用的自动连接网络, 链路断开后wpa_supplicant可以自行重连
+     * @return 成功返回true，失败返回false
+     */
+    bool restoreAutoConnect();
+
+    /**
+     * 删除网络(REMOVE_NETWORK)
+     * @param ssid 网络名称
+     * @return 网络不存在或删除成功返回true
+     */
+    bool remove(const std::string &ssid);
+
+    /**
+     * 查找网络编号
+     * @param ssid 网络名称
+     * @return 网络编号, 不存在返回-1
+     */
+    int find(const std::string &ssid) const;
+
+    size_t size() const { return entries_.size(); }
+
+    /**
+     * 已发送的控制命令数量
+     */
+    int getCommandCount() const { return commandCount_; }
+
+    /**
+     * 编码SET_NETWORK/配置文件中的SSID: 可打印字符用引号, 否则用十六进制
+     * @param ssid 网络名称
+     * @return 编码后的值
+     */
+    static std::string encodeSsid(const std::string &ssid);
+
+    /**
+     * 生成配置文件中的network块
+     * @param network 网络配置
+     * @return network={...}文本
+     */
+    static std::string formatNetworkBlock(const SupplicantNetwork &network);
+
+    /**
+     * 解析LIST_NETWORKS的响应
+     * @param reply 命令响应(首行为表头, 其后为 "id\tssid\tbssid\tflags")
+     * @param networks SSID到网络编号的映射
+     * @return 解析出的网络数量
+     */
+    static size_t parseNetworkList(const std::string &reply, std::map<std::string, int> &networks);
+
+private:
+    struct Entry
+    {
+        int id;
+        SupplicantNetwork network; // 已下发的配置
+        bool configured;           // network中的password/priority/hidden已下发
+        bool enabled;              // wpa_supplicant中的实际启用状态
+    };
+
+    WpaCtrl &ctrl_;
+    std::map<std::string, Entry> entries_; // 按SSID索引
+    bool loaded_;
+    int commandCount_;
+
+    /*
+     * 发送命令并检查响应为OK
+     */
+    bool command(const std::string &text);
+    bool setField(int id, const std::string &field, const std::string &value);
+
+    SupplicantProfile(const SupplicantProfile &);
+    SupplicantProfile &operator=(const SupplicantProfile &);
+};
+
+#endif // SUPPLICANT_PROFILE_H
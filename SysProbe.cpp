@@ -0,0 +1,230 @@
+#include "SysProbe.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <dirent.h>
+#include <signal.h>
+#include <net/if.h>
+#endif // _WIN32
+
+namespace
+{
+const size_t kCommLength = 15; // 内核截断comm的长度(TASK_COMM_LEN - 1)
+
+#ifndef _WIN32
+/*
+ * 读取文件到buffer(以'\0'结尾), 返回读取的字节数, 失败返回-1
+ */
+ssize_t readFile(const char *path, char *buffer, size_t size)
+{
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    ssize_t length = ::read(fd, buffer, size - 1);
+    ::close(fd);
+    if (length < 0)
+    {
+        return -1;
+    }
+    buffer[length] = '\0';
+    return length;
+}
+
+/*
+ * 判断pid对应进程的名称是否为name
+ */
+bool matchesName(pid_t pid, const std::string &name)
+{
+    char path[64];
+    char buffer[256];
+    std::snprintf(path, sizeof(path), "/proc/%d/comm", static_cast<int>(pid));
+    ssize_t length = readFile(path, buffer, sizeof(buffer));
+    if (length <= 0)
+    {
+        return false;
+    }
+    if (buffer[length - 1] == '\n')
+    {
+        buffer[--length] = '\0';
+    }
+    if (name.size() <= kCommLength)
+    {
+        return name.compare(buffer) == 0;
+    }
+    // comm被截断, 再按cmdline中argv[0]的程序名完整匹配
+    if (name.compare(0, kCommLength, buffer) != 0)
+    {
+        return false;
+    }
+    std::snprintf(path, sizeof(path), "/proc/%d/cmdline", static_cast<int>(pid));
+    if (readFile(path, buffer, sizeof(buffer)) <= 0)
+    {
+        return false;
+    }
+    const char *program = std::strrchr(buffer, '/');
+    program = program ? program + 1 : buffer;
+    return name.compare(program) == 0;
+}
+#endif // _WIN32
+} // namespace
+
+SysProbe::SysProbe() : scanCount_(0)
+{
+}
+
+bool SysProbe::interfaceExists(const std::string &iface)
+{
+#ifndef _WIN32
+    return !iface.empty() && if_nametoindex(iface.c_str()) != 0;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool SysProbe::getInterfaceFlags(const std::string &iface, unsigned int &flags)
+{
+#ifndef _WIN32
+    std::string content;
+    if (!readTextFile(("/sys/class/net/" + iface + "/flags").c_str(), content))
+    {
+        return false;
+    }
+    // 内容为十六进制, 如 "0x1003"
+    flags = static_cast<unsigned int>(std::strtoul(content.c_str(), nullptr, 16));
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool SysProbe::isInterfaceUp(const std::string &iface)
+{
+#ifndef _WIN32
+    unsigned int flags = 0;
+    return getInterfaceFlags(iface, flags) && (flags & IFF_UP) != 0;
+#else
+    return true;
+#endif // _WIN32
+}
+
+std::string SysProbe::getOperState(const std::string &iface)
+{
+    std::string state;
+#ifndef _WIN32
+    readTextFile(("/sys/class/net/" + iface + "/operstate").c_str(), state);
+#endif // _WIN32
+    return state;
+}
+
+std::string SysProbe::getHardwareAddress(const std::string &iface)
+{
+    std::string address;
+#ifndef _WIN32
+    readTextFile(("/sys/class/net/" + iface + "/address").c_str(), address);
+#endif // _WIN32
+    return address;
+}
+
+pid_t SysProbe::findProcess(const std::string &name)
+{
+#ifndef _WIN32
+    auto cached = pidCache_.find(name);
+    if (cached != pidCache_.end())
+    {
+        if (isProcessAlive(cached->second, name))
+        {
+            return cached->second;
+        }
+        pidCache_.erase(cached);
+    }
+
+    scanCount_++;
+    DIR *dir = opendir("/proc");
+    if (!dir)
+    {
+        return -1;
+    }
+    pid_t found = -1;
+    pid_t self = getpid();
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        if (entry->d_name[0] < '1' || entry->d_name[0] > '9')
+        {
+            continue;
+        }
+        char *end = nullptr;
+        long pid = std::strtol(entry->d_name, &end, 10);
+        if (*end != '\0' || pid == self)
+        {
+            continue;
+        }
+        if (matchesName(static_cast<pid_t>(pid), name) && isProcessAlive(static_cast<pid_t>(pid), name))
+        {
+            found = static_cast<pid_t>(pid);
+            break;
+        }
+    }
+    closedir(dir);
+
+    if (found > 0)
+    {
+        pidCache_[name] = found;
+    }
+    return found;
+#else
+    return -1;
+#endif // _WIN32
+}
+
+bool SysProbe::isProcessAlive(pid_t pid, const std::string &name)
+{
+#ifndef _WIN32
+    if (pid <= 0 || (kill(pid, 0) != 0 && errno != EPERM))
+    {
+        return false;
+    }
+    // 僵尸进程的comm仍可读取, 需排除
+    char path[64];
+    char buffer[512];
+    std::snprintf(path, sizeof(path), "/proc/%d/stat", static_cast<int>(pid));
+    if (readFile(path, buffer, sizeof(buffer)) <= 0)
+    {
+        return false;
+    }
+    const char *state = std::strrchr(buffer, ')');
+    if (!state || state[1] == '\0' || state[2] == 'Z' || state[2] == 'X')
+    {
+        return false;
+    }
+    return matchesName(pid, name);
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool SysProbe::readTextFile(const char *path, std::string &content)
+{
+#ifndef _WIN32
+    char buffer[256];
+    ssize_t length = readFile(path, buffer, sizeof(buffer));
+    if (length < 0)
+    {
+        return false;
+    }
+    while (length > 0 && (buffer[length - 1] == '\n' || buffer[length - 1] == ' '))
+    {
+        length--;
+    }
+    content.assign(buffer, static_cast<size_t>(length));
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
@@ -0,0 +1,104 @@
+#ifndef SYS_PROBE_H
+#define SYS_PROBE_H
+
+#include <string>
+#include <map>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif // _WIN32
+
+/*
+ * sysfs/procfs状态探测
+ * 直接读取 /sys/class/net/<if>/{operstate,flags,address} 和 /proc/<pid>/comm,
+ * 替代 ifconfig、ip link show、ps|grep、pidof 等只用于检查状态的命令.
+ * 进程查找结果按名称缓存pid, 再次查询时只校验该pid是否仍存活且名称一致
+ */
+class SysProbe
+{
+public:
+    SysProbe();
+
+    /**
+     * 判断网络接口是否存在
+     * @param iface 接口名称
+     * @return 存在返回true
+     */
+    static bool interfaceExists(const std::string &iface);
+
+    /**
+     * 读取接口标志(IFF_*)
+     * @param iface 接口名称
+     * @param flags 接口标志
+     * @return 成功返回true，接口不存在返回false
+     */
+    static bool getInterfaceFlags(const std::string &iface, unsigned int &flags);
+
+    /**
+     * 判断接口是否已启用(IFF_UP, 等同于ifconfig输出中的UP)
+     * @param iface 接口名称
+     * @return 已启用返回true
+     */
+    static bool isInterfaceUp(const std::string &iface);
+
+    /**
+     * 读取接口运行状态(等同于ip link show输出中的state)
+     * @param iface 接口名称
+     * @return "up"/"down"/"dormant"/"unknown"等, 接口不存在返回空字符串
+     */
+    static std::string getOperState(const std::string &iface);
+
+    /**
+     * 读取接口硬件地址
+     * @param iface 接口名称
+     * @return MAC地址(小写, 冒号分隔), 接口不存在返回空字符串
+     */
+    static std::string getHardwareAddress(const std::string &iface);
+
+    /**
+     * 按进程名(/proc/<pid>/comm)查找进程
+     * @param name 进程名称(完整匹配, 超过15个字符时按cmdline中的程序名匹配)
+     * @return 进程ID, 未找到返回-1
+     */
+    pid_t findProcess(const std::string &name);
+
+    /**
+     * 判断指定名称的进程是否正在运行
+     * @param name 进程名称
+     * @return 正在运行返回true
+     */
+    bool isProcessRunning(const std::string &name) { return findProcess(name) > 0; }
+
+    /**
+     * 判断进程是否存活且名称一致(用于校验缓存的pid, 防止pid被复用)
+     * @param pid 进程ID
+     * @param name 进程名称
+     * @return 存活且名称一致返回true
+     */
+    static bool isProcessAlive(pid_t pid, const std::string &name);
+
+    /**
+     * 获取全量扫描/proc的次数(缓存未命中次数)
+     * @return 扫描次数
+     */
+    unsigned long getScanCount() const { return scanCount_; }
+
+private:
+    std::map<std::string, pid_t> pidCache_; // 进程名 -> 上次找到的pid
+    unsigned long scanCount_;
+
+    /*
+     * 读取小文件内容并去掉末尾换行
+     * @param path 文件路径
+     * @param content 文件内容
+     * @return 成功返回true
+     */
+    static bool readTextFile(const char *path, std::string &content);
+
+    SysProbe(const SysProbe &);
+    SysProbe &operator=(const SysProbe &);
+};
+
+#endif // SYS_PROBE_H
@@ -0,0 +1,269 @@
+#ifndef TEXT_VIEW_H
+#define TEXT_VIEW_H
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * 只读文本视图(C++11下的string_view替代)
+ * 只保存指针和长度, 不拥有也不复制数据, 用于在命令输出上原地分词
+ */
+class TextView
+{
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    TextView() : data_(nullptr), size_(0) {}
+    TextView(const char *data, size_t size) : data_(data), size_(size) {}
+    TextView(const char *text) : data_(text), size_(std::strlen(text)) {}
+    TextView(const std::string &text) : data_(text.data()), size_(text.size()) {}
+
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    char operator[](size_t index) const { return data_[index]; }
+    const char *begin() const { return data_; }
+    const char *end() const { return data_ + size_; }
+
+    /**
+     * 截取子视图
+     * @param pos 起始位置(超出长度时返回空视图)
+     * @param count 长度, 超出剩余长度时截取到末尾
+     * @return 子视图
+     */
+    TextView substr(size_t pos, size_t count = npos) const
+    {
+        if (pos >= size_)
+        {
+            return TextView(data_ + size_, 0);
+        }
+        size_t remaining = size_ - pos;
+        return TextView(data_ + pos, count < remaining ? count : remaining);
+    }
+
+    /**
+     * 查找字符
+     * @param c 字符
+     * @param pos 起始位置
+     * @return 位置, 未找到返回npos
+     */
+    size_t find(char c, size_t pos = 0) const
+    {
+        if (pos >= size_)
+        {
+            return npos;
+        }
+        const void *found = std::memchr(data_ + pos, c, size_ - pos);
+        return found ? static_cast<size_t>(static_cast<const char *>(found) - data_) : npos;
+    }
+
+    /**
+     * 查找子串
+     * @param needle 子串
+     * @param pos 起始位置
+     * @return 位置, 未找到返回npos
+     */
+    size_t find(TextView needle, size_t pos = 0) const
+    {
+        if (needle.empty())
+        {
+            return pos <= size_ ? pos : npos;
+        }
+        while (pos + needle.size_ <= size_)
+        {
+            size_t first = find(needle.data_[0], pos);
+            if (first == npos || first + needle.size_ > size_)
+            {
+                return npos;
+            }
+            if (std::memcmp(data_ + first, needle.data_, needle.size_) == 0)
+            {
+                return first;
+            }
+            pos = first + 1;
+        }
+        return npos;
+    }
+
+    bool contains(TextView needle) const { return find(needle) != npos; }
+
+    bool startsWith(TextView prefix) const
+    {
+        return prefix.size_ <= size_ && (prefix.size_ == 0 || std::memcmp(data_, prefix.data_, prefix.size_) == 0);
+    }
+
+    /**
+     * 去除首尾空格和制表符(及行尾的'\r')
+     * @return 去除后的视图
+     */
+    TextView trim() const
+    {
+        size_t first = 0;
+        size_t last = size_;
+        while (first < last && isBlank(data_[first]))
+        {
+            first++;
+        }
+        while (last > first && (isBlank(data_[last - 1]) || data_[last - 1] == '\r'))
+        {
+            last--;
+        }
+        return TextView(data_ + first, last - first);
+    }
+
+    /**
+     * 取key之后的内容(去除首尾空白), 如 "freq: 2412".after("freq:") 返回 "2412"
+     * @param key 字段名
+     * @return 字段值, 不含key时返回空视图
+     */
+    TextView after(TextView key) const
+    {
+        size_t pos = find(key);
+        return pos == npos ? TextView() : substr(pos + key.size()).trim();
+    }
+
+    /**
+     * 按第一个分隔符拆分为键和值(均去除首尾空白), 如 "tx bytes:\t1234"
+     * @param separator 分隔符
+     * @param key 键
+     * @param value 值
+     * @return 包含分隔符时返回true
+     */
+    bool split(char separator, TextView &key, TextView &value) const
+    {
+        size_t pos = find(separator);
+        if (pos == npos)
+        {
+            return false;
+        }
+        key = substr(0, pos).trim();
+        value = substr(pos + 1).trim();
+        return true;
+    }
+
+    /**
+     * 从当前位置取出一行(不含换行符), 并把视图前移到下一行
+     * @param line 取出的行
+     * @return 视图为空时返回false
+     */
+    bool nextLine(TextView &line)
+    {
+        if (size_ == 0)
+        {
+            return false;
+        }
+        size_t end = find('\n');
+        if (end == npos)
+        {
+            line = *this;
+            data_ += size_;
+            size_ = 0;
+        }
+        else
+        {
+            line = TextView(data_, end);
+            data_ += end + 1;
+            size_ -= end + 1;
+        }
+        return true;
+    }
+
+    /**
+     * 解析开头的十进制整数(可带负号), 忽略小数部分, 等价于向零取整
+     * @param value 解析结果
+     * @return 开头为数字时返回true
+     */
+    bool toInt(int &value) const
+    {
+        size_t pos = 0;
+        bool negative = false;
+        if (pos < size_ && (data_[pos] == '-' || data_[pos] == '+'))
+        {
+            negative = data_[pos] == '-';
+            pos++;
+        }
+        if (pos >= size_ || data_[pos] < '0' || data_[pos] > '9')
+        {
+            return false;
+        }
+        long result = 0;
+        while (pos < size_ && data_[pos] >= '0' && data_[pos] <= '9' && result < 100000000L)
+        {
+            result = result * 10 + (data_[pos] - '0');
+            pos++;
+        }
+        value = static_cast<int>(negative ? -result : result);
+        return true;
+    }
+
+    /**
+     * 解析开头的无符号十进制整数
+     * @param value 解析结果
+     * @return 开头为数字时返回true
+     */
+    bool toUInt64(uint64_t &value) const
+    {
+        if (size_ == 0 || data_[0] < '0' || data_[0] > '9')
+        {
+            return false;
+        }
+        uint64_t result = 0;
+        for (size_t pos = 0; pos < size_ && data_[pos] >= '0' && data_[pos] <= '9'; pos++)
+        {
+            result = result * 10 + static_cast<uint64_t>(data_[pos] - '0');
+        }
+        value = result;
+        return true;
+    }
+
+    /**
+     * 解析开头的非负定点小数并乘以scale, 如 "866.7 MBit/s" 以1000缩放得到866700
+     * @param value 解析结果(超出scale精度的小数位被截断)
+     * @param scale 缩放倍数(10的幂)
+     * @return 开头为数字时返回true
+     */
+    bool toScaled(long &value, long scale) const
+    {
+        if (size_ == 0 || data_[0] < '0' || data_[0] > '9')
+        {
+            return false;
+        }
+        size_t pos = 0;
+        long result = 0;
+        while (pos < size_ && data_[pos] >= '0' && data_[pos] <= '9')
+        {
+            result = result * 10 + (data_[pos] - '0');
+            pos++;
+        }
+        result *= scale;
+        if (pos < size_ && data_[pos] == '.')
+        {
+            pos++;
+            for (long digit = scale / 10; digit > 0 && pos < size_ && data_[pos] >= '0' && data_[pos] <= '9'; digit /= 10)
+            {
+                result += (data_[pos] - '0') * digit;
+                pos++;
+            }
+        }
+        value = result;
+        return true;
+    }
+
+    std::string toString() const { return std::string(data_, size_); }
+
+    bool operator==(TextView other) const
+    {
+        return size_ == other.size_ && (size_ == 0 || std::memcmp(data_, other.data_, size_) == 0);
+    }
+    bool operator!=(TextView other) const { return !(*this == other); }
+
+private:
+    const char *data_;
+    size_t size_;
+
+    static bool isBlank(char c) { return c == ' ' || c == '\t'; }
+};
+
+#endif // TEXT_VIEW_H
@@ -1,9 +1,35 @@
 #include "WifiInterface.h"
 
+namespace
+{
+// 用户主动刷新列表时能接受的扫描结果年龄
+const int kInteractiveScanMaxAgeMs = 5000;
+// 判断已保存网络是否在范围内(包括自动连接)时能接受的扫描结果年龄
+const int kSavedNetworkScanMaxAgeMs = 30000;
+// 自动连接网络在wpa_supplicant中的优先级(其余网络为0且禁用)
+const int kAutoConnectPriority = 10;
+// udhcpc返回后等待地址写入接口的最长时间(未获得租约时udhcpc转入后台继续请求)
+const int kDhcpAddressTimeoutMs = 3000;
+// INIT-REBOOT等待服务器确认的时间, 超时后转入完整DHCP
+const int kDhcpRebootTimeoutMs = 1500;
+// udhcpc的默认事件脚本, 记录租约的脚本执行完后交给它配置接口
+const char kUdhcpcDefaultScript[] = "/usr/share/udhcpc/default.script";
+const char kUdhcpcScriptPath[] = "/etc/udhcpc_lease.script";
+// 剩余租期不足时不再尝试INIT-REBOOT
+const uint32_t kMinLeaseRemainingSeconds = 60;
+// getSignalStrength()使用链路监测快照的最大时效
+const int64_t kLinkSnapshotMaxAgeMs = 1000;
+} // namespace
+
 WifiInterface::WifiInterface(const std::string &staInterface, const std::string &apInterface)
     : staInterface_(staInterface), apInterface_(apInterface),
       connectionStatus_(ConnectionStatus::DISCONNECTED), isAPRunning_(false),
-      wpaSupplicantPid_(-1), hostapdPid_(-1)
+      wpaSupplicantPid_(-1), hostapdPid_(-1), dhcpLatencyMs_(-1), supplicant_(wpaCtrl_),
+      staScanSource_(staInterface), scanBroker_(staScanSource_, scanClock_),
+      scanWatcher_(staInterface, scanBroker_), scanService_(scanBroker_, scanClock_), roamLink_("/var/run/wpa_supplicant/" + staInterface),
+      roamManager_(scanBroker_, scanClock_, roamLink_),
+      linkSource_(staInterface, "/var/run/wpa_supplicant/" + staInterface), linkMonitor_(linkSource_, scanClock_),
+      metricStore_(nullptr), recordedSamples_()
 {
     // 初始化默认AP配置
     apConfig_.ssid = "ONWA_AP";
@@ -21,85 +47,102 @@ WifiInterface::WifiInterface(const std::string &staInterface, const std::string
     currentMode_ = detectActualMode();
 
     loadNetworkConfig();
+    loadLeaseCache();
+    loadConnectionHistory();
     loadAPConfig();
+    installUdhcpcScript();
 }
 
 WifiInterface::~WifiInterface()
 {
+    // 后台扫描/漫游/链路监测线程会访问其他成员, 必须在成员析构前停止
+    linkMonitor_.stop();
+    roamManager_.stop();
+    scanService_.stop();
+    scanWatcher_.stop();
+    stopLeaseRenewal();
 }
-std::string WifiInterface::executeCommand(const std::string &command)
+std::string WifiInterface::executeCommand(const std::vector<std::string> &argv, int timeoutMs)
 {
 #ifndef _WIN32
-    char buffer[128];
-    std::string result = "";
-    FILE *pipe = popen(command.c_str(), "r");
-    if (!pipe)
-    {
-        return "Error: popen failed";
-    }
-    while (fgets(buffer, sizeof(buffer), pipe) != nullptr)
+    ProcessResult result;
+    if (!runner_.run(argv, result, timeoutMs))
     {
-        result += buffer;
+        return "";
     }
-    pclose(pipe);
-    return result;
+    return result.output;
 #else
     return "";
 #endif // _WIN32
 }
 
-bool WifiInterface::executeCommandWithResult(const std::string &command)
+bool WifiInterface::executeCommandWithResult(const std::vector<std::string> &argv, int timeoutMs)
 {
 #ifndef _WIN32
-    int result = system(command.c_str());
-    return (result == 0);
+    return runner_.succeeded(argv, timeoutMs);
 #else
     return true;
 #endif // _WIN32
 }
 
-std::string WifiInterface::decodeHexString(const std::string &hexString)
+bool WifiInterface::isProcessRunning(const std::string &name)
 {
-    std::string result = "";
-    size_t pos = 0;
-    // printf("hexString: %s\n", hexString.c_str());
 #ifndef _WIN32
-    while (pos < hexString.length())
+    return probe_.isProcessRunning(name);
+#else
+    return false;
+#endif // _WIN32
+}
+
+std::string WifiInterface::findLineField(const std::string &text, const std::string &pattern, size_t fieldIndex)
+{
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line))
     {
-        if (hexString.substr(pos, 2) == "\\x" && pos + 3 < hexString.length())
+        if (line.find(pattern) == std::string::npos)
         {
-            std::string hexByte = hexString.substr(pos + 2, 2);
-            try
-            {
-                int byteValue = std::stoi(hexByte, nullptr, 16);
-                result += static_cast<char>(byteValue);
-                pos += 4; // 跳过 "\\x" 和 2个十六进制字符
-            }
-            catch (...)
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string field;
+        for (size_t i = 0; fields >> field; i++)
+        {
+            if (i == fieldIndex)
             {
-                // 转换失败,保留原字符
-                result += hexString[pos];
-                pos++;
+                return field;
             }
         }
-        else
+    }
+    return "";
+}
+
+std::string WifiInterface::readFileTail(const std::string &path, size_t lineCount)
+{
+    std::ifstream file(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lines.push_back(line);
+        if (lines.size() > lineCount)
         {
-            result += hexString[pos];
-            pos++;
+            lines.erase(lines.begin());
         }
     }
-    // printf("decodeHexString: %s\n", result.c_str());
-    return result;
-#else
-    return result;
-#endif // _WIN32
+
+    std::string tail;
+    for (const auto &item : lines)
+    {
+        tail += item + "\n";
+    }
+    return tail;
 }
 
 bool WifiInterface::enableInterface(const std::string &iface)
 {
 #ifndef _WIN32
-    std::string command = "ifconfig " + iface + " up";
-    return executeCommandWithResult(command);
+    return executeCommandWithResult({"ifconfig", iface, "up"});
 #else
     return true;
 #endif // _WIN32
@@ -107,8 +150,7 @@ bool WifiInterface::enableInterface(const std::string &iface)
 bool WifiInterface::disableInterface(const std::string &iface)
 {
 #ifndef _WIN32
-    std::string command = "ifconfig " + iface + " down";
-    return executeCommandWithResult(command);
+    return executeCommandWithResult({"ifconfig", iface, "down"});
 #else
     return true;
 #endif // _WIN32
@@ -118,9 +160,14 @@ bool WifiInterface::enableSTAInterface()
 {
 #ifndef _WIN32
     // 清理接口地址信息，避免IP冲突
-    std::string cleanupCommand = "ip addr flush dev " + staInterface_;
-    executeCommandWithResult(cleanupCommand);
-    return enableInterface(staInterface_);
+    executeCommandWithResult({"ip", "addr", "flush", "dev", staInterface_});
+    if (!enableInterface(staInterface_))
+    {
+        return false;
+    }
+    // nl80211不可用时只是不能复用其他进程的扫描结果
+    scanWatcher_.start();
+    return true;
 #else
     return true;
 #endif // _WIN32
@@ -128,6 +175,9 @@ bool WifiInterface::enableSTAInterface()
 bool WifiInterface::disableSTAInterface()
 {
 #ifndef _WIN32
+    // 接口关闭后内核会清空BSS缓存, 本地缓存同样作废
+    scanWatcher_.stop();
+    scanBroker_.invalidate();
     return disableInterface(staInterface_);
 #else
     return true;
@@ -142,8 +192,7 @@ bool WifiInterface::enableAPInterface()
     disableInterface(apInterface_);
     sleep(1); // 确保接口完全关闭
 
-    std::string setModeCommand = "iw dev " + apInterface_ + " set type __ap";
-    if (!executeCommandWithResult(setModeCommand))
+    if (!executeCommandWithResult({"iw", "dev", apInterface_, "set", "type", "__ap"}))
     {
         std::cout << "Warning: Failed to set interface type to AP, continuing anyway..." << std::endl;
     }
@@ -155,15 +204,12 @@ bool WifiInterface::enableAPInterface()
     }
     sleep(2); // 等待接口完全启动
 
-    std::string cleanupCommand = "ip addr del 192.168.7.1/24 dev " + apInterface_ + " 2>/dev/null";
-    executeCommandWithResult(cleanupCommand);
+    executeCommandWithResult({"ip", "addr", "del", "192.168.7.1/24", "dev", apInterface_});
 
-    std::string statusCommand = "ifconfig " + apInterface_;
-    std::string statusResult = executeCommand(statusCommand);
-    if (statusResult.find("UP") == std::string::npos)
+    if (!SysProbe::isInterfaceUp(apInterface_))
     {
         std::cout << "Error: AP interface " << apInterface_ << " is not UP after enabling" << std::endl;
-        std::cout << "Interface status: " << statusResult << std::endl;
+        std::cout << "Interface status: " << SysProbe::getOperState(apInterface_) << std::endl;
         return false;
     }
     std::cout << "AP interface " << apInterface_ << " enabled successfully" << std::endl;
@@ -190,6 +236,8 @@ Todo:
 bool WifiInterface::setOperationMode(WifiMode mode)
 {
 #ifndef _WIN32
+    TraceSpan total("setOperationMode", "total");
+    TraceSpan phase("setOperationMode", "stopServices");
     if (isAPRunning_)
     {
         std::cout << "Stop AP service..." << std::endl;
@@ -203,6 +251,7 @@ bool WifiInterface::setOperationMode(WifiMode mode)
 
     currentMode_ = mode;
 
+    phase.next("startServices");
     bool success = false;
     switch (mode)
     {
@@ -247,14 +296,8 @@ WifiMode WifiInterface::getCurrentMode()
 WifiMode WifiInterface::detectActualMode()
 {
 #ifndef _WIN32
-    std::string wlan0Check = "ifconfig wlan0 2>/dev/null | grep -q 'UP' && echo '1'";
-    std::string wlan1Check = "ifconfig wlan1 2>/dev/null | grep -q 'UP' && echo '1'";
-
-    std::string wlan0Result = executeCommand(wlan0Check);
-    std::string wlan1Result = executeCommand(wlan1Check);
-
-    bool wlan0Up = !wlan0Result.empty() && wlan0Result.find('1') != std::string::npos;
-    bool wlan1Up = !wlan1Result.empty() && wlan1Result.find('1') != std::string::npos;
+    bool wlan0Up = SysProbe::isInterfaceUp("wlan0");
+    bool wlan1Up = SysProbe::isInterfaceUp("wlan1");
 
     if (wlan0Up && wlan1Up)
     {
@@ -298,332 +341,124 @@ bool WifiInterface::scanNetworks()
         return false;
     }
 
-    std::string command = "iw dev " + staInterface_ + " scan | grep -E \"^BSS|SSID:|signal:|freq:|WPA|RSN|WEP\"";
-    std::string scanOutput = executeCommand(command);
-
-    // 解析扫描结果
-    return parseScanResults(scanOutput);
+    if (!scanInto(scanTable_, kInteractiveScanMaxAgeMs))
+    {
+        return false;
+    }
+    std::vector<uint32_t> rows;
+    scanTable_.strongestPerSsid(rows, kScanSaved);
+    return !rows.empty();
 #else
     return true;
 #endif // _WIN32
 }
 
-bool WifiInterface::parseScanResults(const std::string &scanOutput)
+bool WifiInterface::scanInto(ScanTable &table, int maxAgeMs)
 {
 #ifndef _WIN32
-    scanResults_.clear();
-
-    std::istringstream stream(scanOutput);
-    std::string line;
-    NetworkInfo currentNetwork;
-    bool hasNetwork = false;
-
-    // 由于iw scan出来的设备有重复的，因此需要去重，只保留信号最强的网络
-    std::map<std::string, NetworkInfo> uniqueNetworks;
-
-    while (std::getline(stream, line))
+    if (!scanBroker_.acquire(table, maxAgeMs))
     {
-        // 去除行首尾的空格
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-
-        if (line.find("BSS") == 0) // 以BSS开头的行
-        {
-            // 新的网络开始，保存前一个网络
-            if (hasNetwork && !currentNetwork.ssid.empty())
-            {
-                // 去重:只保留信号最强的网络
-                auto it = uniqueNetworks.find(currentNetwork.ssid);
-                if (it == uniqueNetworks.end() ||
-                    currentNetwork.signalStrength > it->second.signalStrength)
-                {
-                    uniqueNetworks[currentNetwork.ssid] = currentNetwork;
-                }
-            }
-            currentNetwork = NetworkInfo();
-            hasNetwork = false;
-
-            // 提取BSSID
-            std::regex bssRegex("BSS\\s+([0-9a-f:]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, bssRegex))
-            {
-                currentNetwork.bssid = match[1];
-            }
-        }
-        else if (line.find("freq:") != std::string::npos)
-        {
-            // 提取频率
-            std::regex freqRegex("freq:\\s*([0-9]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, freqRegex))
-            {
-                currentNetwork.frequency = std::stoi(match[1]);
-                // 根据频率计算信道
-                if (currentNetwork.frequency >= 2412 && currentNetwork.frequency <= 2484)
-                {
-                    currentNetwork.channel = (currentNetwork.frequency - 2412) / 5 + 1;
-                }
-                else if (currentNetwork.frequency >= 5180 && currentNetwork.frequency <= 5825)
-                {
-                    currentNetwork.channel = (currentNetwork.frequency - 5180) / 5 + 36;
-                }
-            }
-        }
-        else if (line.find("signal:") != std::string::npos)
-        {
-            // 提取信号强度
-            std::regex signalRegex("signal:\\s*(-?[0-9]+\\.[0-9]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, signalRegex))
-            {
-                // 将浮点数转换为整数(取整)
-                float signalFloat = std::stof(match[1]);
-                currentNetwork.signalStrength = static_cast<int>(signalFloat);
-            }
-            else
-            {
-                // 如果没有小数点，则匹配整数
-                std::regex signalRegexInt("signal:\\s*(-?[0-9]+)");
-                std::smatch matchInt;
-                if (std::regex_search(line, matchInt, signalRegexInt))
-                {
-                    currentNetwork.signalStrength = std::stoi(matchInt[1]);
-                }
-            }
-        }
-        else if (line.find("SSID:") != std::string::npos)
-        {
-            // 提取SSID
-            size_t pos = line.find("SSID:") + 5;
-            currentNetwork.ssid = line.substr(pos);
-
-            currentNetwork.ssid.erase(0, currentNetwork.ssid.find_first_not_of(" \t"));
-            currentNetwork.ssid.erase(currentNetwork.ssid.find_last_not_of(" \t") + 1);
-            // 处理中文编码问题
-            if (currentNetwork.ssid.find("\\x") != std::string::npos)
-            {
-                currentNetwork.ssid = decodeHexString(currentNetwork.ssid);
-            }
-            hasNetwork = true;
-
-            // 默认设置为开放网络模式
-            currentNetwork.security = SecurityMode::OPEN;
-        }
-        else if (line.find("WPA") != std::string::npos || line.find("RSN") != std::string::npos)
-        {
-            if (line.find("WPA2") != std::string::npos || line.find("RSN") != std::string::npos)
-            {
-                currentNetwork.security = SecurityMode::WPA2_PSK;
-            }
-            else if (line.find("WPA") != std::string::npos)
-            {
-                currentNetwork.security = SecurityMode::WPA_PSK;
-            }
-        }
-        else if (line.find("WEP") != std::string::npos)
-        {
-            currentNetwork.security = SecurityMode::WEP;
-        }
+        return false;
     }
+    markSavedNetworks(table);
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
 
-    // 保存最后一个网络
-    if (hasNetwork && !currentNetwork.ssid.empty())
+void WifiInterface::markSavedNetworks(ScanTable &table)
+{
+    std::vector<std::string> ssids;
+    ssids.reserve(savedNetworks_.size());
+    for (const auto &savedNetwork : savedNetworks_)
     {
-        auto it = uniqueNetworks.find(currentNetwork.ssid);
-        if (it == uniqueNetworks.end() ||
-            currentNetwork.signalStrength > it->second.signalStrength)
-        {
-            uniqueNetworks[currentNetwork.ssid] = currentNetwork;
-        }
+        table.setSsidFlag(savedNetwork.ssid, kScanSaved, true);
+        ssids.push_back(savedNetwork.ssid);
     }
+    if (sightings_.update(table, ssids))
+    {
+        saveNetworkConfig();
+    }
+}
 
-    // 将去重后的网络添加到结果列表
-    for (const auto &pair : uniqueNetworks)
+void WifiInterface::collectSavedNetworks(const ScanTable &table, std::vector<NetworkInfo> &networks) const
+{
+    networks.clear();
+    for (const auto &network : savedNetworks_)
     {
-        bool isSaved = false;
-        for (const auto &savedNetwork : savedNetworks_)
+        // 只有当网络在范围内时才添加到返回列表
+        uint32_t row = table.strongest(network.ssid);
+        if (row == ScanTable::npos)
         {
-            if (savedNetwork.ssid == pair.second.ssid)
-            {
-                isSaved = true;
-                break;
-            }
+            continue;
         }
-        if (!isSaved)
+        NetworkInfo info = network;
+        auto autoConnectIt = autoConnectNetworks_.find(network.ssid);
+        if (autoConnectIt != autoConnectNetworks_.end())
         {
-            scanResults_.push_back(pair.second);
+            info.autoConnect = autoConnectIt->second;
         }
+        info.signalStrength = table.signalStrength(row);
+        info.bssid = table.bssid(row);
+        networks.push_back(info);
     }
-
-    return !scanResults_.empty();
-#else
-    return true;
-#endif // _WIN32
 }
 
-std::vector<NetworkInfo> WifiInterface::parseScanResultsWithoutFiltering(const std::string &scanOutput)
+bool WifiInterface::scanSavedNetworkChannels(std::vector<NetworkInfo> &networks)
 {
 #ifndef _WIN32
-    std::vector<NetworkInfo> allNetworks;
-
-    std::istringstream stream(scanOutput);
-    std::string line;
-    NetworkInfo currentNetwork;
-    bool hasNetwork = false;
-
-    // 由于iw scan出来的设备有重复的，因此需要去重，只保留信号最强的网络
-    std::map<std::string, NetworkInfo> uniqueNetworks;
-
-    while (std::getline(stream, line))
+    networks.clear();
+    std::vector<std::string> ssids;
+    for (const auto &network : savedNetworks_)
     {
-        // 去除行首尾的空格
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-
-        if (line.find("BSS") == 0) // 以BSS开头的行
-        {
-            // 新的网络开始，保存前一个网络
-            if (hasNetwork && !currentNetwork.ssid.empty())
-            {
-                // 去重:只保留信号最强的网络
-                auto it = uniqueNetworks.find(currentNetwork.ssid);
-                if (it == uniqueNetworks.end() ||
-                    currentNetwork.signalStrength > it->second.signalStrength)
-                {
-                    uniqueNetworks[currentNetwork.ssid] = currentNetwork;
-                }
-            }
-            currentNetwork = NetworkInfo();
-            hasNetwork = false;
-
-            // 提取BSSID
-            std::regex bssRegex("BSS\\s+([0-9a-f:]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, bssRegex))
-            {
-                currentNetwork.bssid = match[1];
-            }
-        }
-        else if (line.find("freq:") != std::string::npos)
-        {
-            // 提取频率
-            std::regex freqRegex("freq:\\s*([0-9]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, freqRegex))
-            {
-                currentNetwork.frequency = std::stoi(match[1]);
-                // 根据频率计算信道
-                if (currentNetwork.frequency >= 2412 && currentNetwork.frequency <= 2484)
-                {
-                    currentNetwork.channel = (currentNetwork.frequency - 2412) / 5 + 1;
-                }
-                else if (currentNetwork.frequency >= 5180 && currentNetwork.frequency <= 5825)
-                {
-                    currentNetwork.channel = (currentNetwork.frequency - 5180) / 5 + 36;
-                }
-            }
-        }
-        else if (line.find("signal:") != std::string::npos)
-        {
-            // 提取信号强度
-            std::regex signalRegex("signal:\\s*(-?[0-9]+\\.[0-9]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, signalRegex))
-            {
-                // 将浮点数转换为整数(取整)
-                float signalFloat = std::stof(match[1]);
-                currentNetwork.signalStrength = static_cast<int>(signalFloat);
-            }
-            else
-            {
-                // 如果没有小数点，则匹配整数
-                std::regex signalRegexInt("signal:\\s*(-?[0-9]+)");
-                std::smatch matchInt;
-                if (std::regex_search(line, matchInt, signalRegexInt))
-                {
-                    currentNetwork.signalStrength = std::stoi(matchInt[1]);
-                }
-            }
-        }
-        else if (line.find("SSID:") != std::string::npos)
-        {
-            // 提取SSID
-            size_t pos = line.find("SSID:") + 5;
-            currentNetwork.ssid = line.substr(pos);
-
-            currentNetwork.ssid.erase(0, currentNetwork.ssid.find_first_not_of(" \t"));
-            currentNetwork.ssid.erase(currentNetwork.ssid.find_last_not_of(" \t") + 1);
-            // 处理中文编码问题
-            if (currentNetwork.ssid.find("\\x") != std::string::npos)
-            {
-                currentNetwork.ssid = decodeHexString(currentNetwork.ssid);
-            }
-            hasNetwork = true;
-
-            // 默认设置为开放网络模式
-            currentNetwork.security = SecurityMode::OPEN;
-        }
-        else if (line.find("WPA") != std::string::npos || line.find("RSN") != std::string::npos)
-        {
-            if (line.find("WPA2") != std::string::npos || line.find("RSN") != std::string::npos)
-            {
-                currentNetwork.security = SecurityMode::WPA2_PSK;
-            }
-            else if (line.find("WPA") != std::string::npos)
-            {
-                currentNetwork.security = SecurityMode::WPA_PSK;
-            }
-        }
-        else if (line.find("WEP") != std::string::npos)
+        auto autoConnectIt = autoConnectNetworks_.find(network.ssid);
+        if (autoConnectIt != autoConnectNetworks_.end() && autoConnectIt->second)
         {
-            currentNetwork.security = SecurityMode::WEP;
+            ssids.push_back(network.ssid);
         }
     }
 
-    // 保存最后一个网络
-    if (hasNetwork && !currentNetwork.ssid.empty())
+    ScanParams params;
+    if (!sightings_.buildScanParams(ssids, params))
     {
-        auto it = uniqueNetworks.find(currentNetwork.ssid);
-        if (it == uniqueNetworks.end() ||
-            currentNetwork.signalStrength > it->second.signalStrength)
-        {
-            uniqueNetworks[currentNetwork.ssid] = currentNetwork;
-        }
+        return false;
     }
-
-    // 将去重后的网络添加到结果列表（不进行已保存网络过滤）
-    for (const auto &pair : uniqueNetworks)
+    if (!enableSTAInterface())
+    {
+        return false;
+    }
+    std::cout << "Scanning " << params.frequencies.size() << " last-seen channel(s) for saved networks" << std::endl;
+    ScanTable table;
+    if (!scanBroker_.scanTargeted(table, params))
     {
-        allNetworks.push_back(pair.second);
+        return false;
     }
-
-    return allNetworks;
+    markSavedNetworks(table);
+    collectSavedNetworks(table, networks);
+    return !networks.empty();
 #else
-    return std::vector<NetworkInfo>();
+    (void)networks;
+    return false;
 #endif // _WIN32
 }
 
 bool WifiInterface::stopWpaSupplicant()
 {
 #ifndef _WIN32
-    std::string killCommand = "killall wpa_supplicant";
-    executeCommandWithResult(killCommand);
+    wpaCtrl_.close();
+    supplicant_.reset();
 
-    std::string forceKillCommand = "killall -9 wpa_supplicant";
-    executeCommandWithResult(forceKillCommand);
+    executeCommandWithResult({"killall", "wpa_supplicant"});
+    executeCommandWithResult({"killall", "-9", "wpa_supplicant"});
 
     // 清理残留的控制接口文件
-    std::string cleanupCommand = "rm -f /var/run/wpa_supplicant/" + staInterface_;
-    executeCommandWithResult(cleanupCommand);
+    unlink(("/var/run/wpa_supplicant/" + staInterface_).c_str());
 
     sleep(1); // 等待进程完全停止
 
     // 再次检查是否还有wpa_supplicant进程在运行
-    std::string checkCommand = "ps | grep wpa_supplicant | grep -v grep";
-    std::string checkResult = executeCommand(checkCommand);
-
-    if (checkResult.empty())
+    if (!isProcessRunning("wpa_supplicant"))
     {
         wpaSupplicantPid_ = -1; // 标记为未运行
         return true;
@@ -640,14 +475,15 @@ bool WifiInterface::startWpaSupplicant()
 #ifndef _WIN32
     stopWpaSupplicant();
 
-    std::string cleanupCommand = "rm -f /var/run/wpa_supplicant/" + staInterface_;
-    executeCommandWithResult(cleanupCommand);
-
-    std::string mkdirCommand = "mkdir -p /var/run/wpa_supplicant";
-    executeCommandWithResult(mkdirCommand);
+    if (!configureWpaSupplicant())
+    {
+        std::cout << "Error: Failed to configure wpa_supplicant.conf" << std::endl;
+        return false;
+    }
+    unlink(("/var/run/wpa_supplicant/" + staInterface_).c_str());
+    mkdir("/var/run/wpa_supplicant", 0755);
 
-    std::string command = "wpa_supplicant -B -Dnl80211 -c /etc/wpa_supplicant.conf -i " + staInterface_;
-    if (executeCommandWithResult(command))
+    if (executeCommandWithResult({"wpa_supplicant", "-B", "-Dnl80211", "-c", "/etc/wpa_supplicant.conf", "-i", staInterface_}))
     {
         wpaSupplicantPid_ = 1; // 标记为运行中
         return true;
@@ -658,111 +494,427 @@ bool WifiInterface::startWpaSupplicant()
 #endif // _WIN32
 }
 
-std::vector<NetworkInfo> WifiInterface::getScanResults()
-{
-    return scanResults_;
-}
-
-bool WifiInterface::connectToNetwork(const std::string &ssid, const std::string &password)
+bool WifiInterface::ensureWpaSupplicant()
 {
 #ifndef _WIN32
-    clearStaticIPConfig();
-
-    connectionStatus_ = ConnectionStatus::CONNECTING;
+    if (openWpaControl() && (supplicant_.isLoaded() || supplicant_.load()))
+    {
+        return true;
+    }
 
-    if (!configureWpaSupplicant(ssid, password))
+    // 没有运行或控制接口已失效(进程被外部结束), 重新启动
+    std::cout << "Starting wpa_supplicant with " << savedNetworks_.size() << " saved network(s)..." << std::endl;
+    if (!startWpaSupplicant() || !openWpaControl(1000) || !supplicant_.load())
     {
-        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
-        std::cout << "Error: Failed to configure wpa_supplicant.conf" << std::endl;
         return false;
     }
+    return true;
+#else
+    return true;
+#endif // _WIN32
+}
 
-    // 重启wpa_supplicant以应用新配置
-    if (wpaSupplicantPid_ > 0)
+SupplicantNetwork WifiInterface::buildSupplicantNetwork(const std::string &ssid, const std::string &password) const
+{
+    SupplicantNetwork network;
+    network.ssid = ssid;
+    network.password = resolvePsk(ssid, password);
+    auto autoConnectIt = autoConnectNetworks_.find(ssid);
+    network.enabled = autoConnectIt != autoConnectNetworks_.end() && autoConnectIt->second;
+    network.priority = network.enabled ? kAutoConnectPriority : 0;
+    auto savedIt = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
+                                [&ssid](const NetworkInfo &saved)
+                                {
+                                    return saved.ssid == ssid;
+                                });
+    network.hidden = savedIt != savedNetworks_.end() && savedIt->isHidden;
+    return network;
+}
+
+std::string WifiInterface::resolvePsk(const std::string &ssid, const std::string &password) const
+{
+    if (!WpaPsk::isPassphrase(password))
     {
-        stopWpaSupplicant();
+        return password;
     }
-
-    if (!startWpaSupplicant())
+    auto passwordIt = savedPasswords_.find(ssid);
+    auto pskIt = savedPsks_.find(ssid);
+    if (passwordIt != savedPasswords_.end() && passwordIt->second == password && pskIt != savedPsks_.end())
     {
-        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
-        std::cout << "Error: Failed to start wpa_supplicant" << std::endl;
-        return false;
+        return pskIt->second;
     }
+    return WpaPsk::deriveHex(password, ssid);
+}
 
-    // 等待连接建立
-    std::cout << "Waiting for WiFi connection to be established..." << std::endl;
-    for (int i = 0; i < 10; i++) // 最多等待10秒
+bool WifiInterface::openWpaControl(int waitMs)
+{
+#ifndef _WIN32
+    if (wpaCtrl_.isOpen())
     {
-        sleep(1);
-
-        // 检查wpa_supplicant连接状态
-        std::string wpaStatusCommand = "wpa_cli -i " + staInterface_ + " status";
-        std::string wpaStatus = executeCommand(wpaStatusCommand);
+        return true;
+    }
 
-        if (wpaStatus.find("wpa_state=COMPLETED") != std::string::npos)
+    // wpa_supplicant -B 返回后控制接口可能稍晚才创建
+    std::string socketPath = "/var/run/wpa_supplicant/" + staInterface_;
+    for (int waited = 0;; waited += 50)
+    {
+        if (wpaCtrl_.open(socketPath))
         {
-            // wpa_supplicant认证成功
-            break;
+            return true;
         }
-
-        if (wpaStatus.find("wpa_state=DISCONNECTED") != std::string::npos)
+        if (waited >= waitMs)
         {
-            connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
-            std::cout << "WiFi authentication failed, please check whether the password is correct" << std::endl;
             return false;
         }
+        usleep(50 * 1000);
     }
+#else
+    return false;
+#endif // _WIN32
+}
 
-    // 检查WiFi链路状态
-    std::string linkCommand = "iw dev " + staInterface_ + " link";
-    std::string linkStatus = executeCommand(linkCommand);
-
-    if (linkStatus.find("Connected") == std::string::npos)
-    {
-        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
-        std::cout << "WiFi link connection failed" << std::endl;
-        return false;
-    }
-
-    // 获取DHCP分配的IP地址
-    std::cout << "Get IP address..." << std::endl;
-    std::string dhcpCommand = "udhcpc -b -i " + staInterface_ + " -R -t 5 -n";
-    if (!executeCommandWithResult(dhcpCommand))
+ConnectionStatus WifiInterface::waitForWpaConnection(const std::string &ssid, int timeoutMs)
+{
+#ifndef _WIN32
+    if (!wpaCtrl_.isAttached() && !wpaCtrl_.attach())
     {
-        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
-        std::cout << "DHCP failed to obtain IP address" << std::endl;
-        return false;
+        std::cout << "Error: Failed to attach to wpa_supplicant control interface" << std::endl;
+        return ConnectionStatus::CONNECTION_FAILED;
     }
 
-    sleep(3); // 等待IP地址分配
-
-    // 验证IP地址是否成功分配
-    std::string ipAddress = getIPAddress();
-    if (ipAddress.empty())
+    // 订阅前可能已完成关联, 先查询一次当前状态(切换网络时可能仍关联在旧网络上)
+    std::string status;
+    if (wpaCtrl_.request("STATUS", status) && WpaCtrl::getValue(status, "wpa_state") == "COMPLETED" &&
+        WpaCtrl::getValue(status, "ssid") == ssid)
     {
-        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
-        std::cout << "IP address allocation failed!!!" << std::endl;
-        return false;
+        wpaCtrl_.detach();
+        return ConnectionStatus::CONNECTED;
     }
 
-    // 更新连接状态和网络信息
-    connectionStatus_ = ConnectionStatus::CONNECTED;
-
-    // 更新当前网络信息
-    for (const auto &network : scanResults_)
+    ConnectionStatus result = ConnectionStatus::CONNECTING;
+    bool disconnected = false;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (result == ConnectionStatus::CONNECTING)
     {
-        if (network.ssid == ssid)
+        int remaining = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                             deadline - std::chrono::steady_clock::now())
+                                             .count());
+        std::string event;
+        if (remaining <= 0 || !wpaCtrl_.waitEvent(event, remaining))
         {
-            currentNetwork_ = network;
             break;
         }
-    }
+        auto startsWith = [&event](const std::string &prefix)
+        {
+            return event.compare(0, prefix.size(), prefix) == 0;
+        };
 
-    // 添加到已连接网络列表
-    auto it = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
-                           [&ssid](const NetworkInfo &network)
-                           {
+        if (startsWith("CTRL-EVENT-CONNECTED"))
+        {
+            result = ConnectionStatus::CONNECTED;
+        }
+        else if (startsWith("CTRL-EVENT-SSID-TEMP-DISABLED") &&
+                 event.find("ssid=\"" + ssid + "\"") != std::string::npos)
+        {
+            // 认证失败(如 reason=WRONG_KEY), wpa_supplicant暂时禁用该网络
+            std::cout << "wpa_supplicant: " << event << std::endl;
+            result = ConnectionStatus::CONNECTION_FAILED;
+        }
+        else if (startsWith("CTRL-EVENT-DISCONNECTED"))
+        {
+            // 启动时可能先断开旧连接, 继续等待后续的连接或禁用事件
+            disconnected = true;
+        }
+    }
+
+    if (result == ConnectionStatus::CONNECTING && disconnected)
+    {
+        result = ConnectionStatus::CONNECTION_FAILED;
+    }
+    wpaCtrl_.detach();
+    return result;
+#else
+    return ConnectionStatus::CONNECTED;
+#endif // _WIN32
+}
+
+std::vector<NetworkInfo> WifiInterface::getScanResults()
+{
+    std::vector<uint32_t> rows;
+    scanTable_.strongestPerSsid(rows, kScanSaved);
+    std::vector<NetworkInfo> networks;
+    networks.reserve(rows.size());
+    for (uint32_t row : rows)
+    {
+        networks.push_back(scanTable_.toNetworkInfo(row));
+    }
+    return networks;
+}
+
+bool WifiInterface::startBackgroundScan(const ScanServiceConfig &config)
+{
+#ifndef _WIN32
+    if (!enableSTAInterface())
+    {
+        std::cout << "Error: Failed to enable interface " << staInterface_ << std::endl;
+        return false;
+    }
+    scanService_.setConfig(config);
+    return scanService_.start();
+#else
+    return false;
+#endif // _WIN32
+}
+
+void WifiInterface::stopBackgroundScan()
+{
+    scanService_.stop();
+}
+
+bool WifiInterface::startRoaming(const RoamConfig &config)
+{
+#ifndef _WIN32
+    roamManager_.setConfig(config);
+    return roamManager_.start();
+#else
+    (void)config;
+    return false;
+#endif // _WIN32
+}
+
+void WifiInterface::stopRoaming()
+{
+    roamManager_.stop();
+}
+
+bool WifiInterface::startLinkMonitor(const LinkMonitorConfig &config)
+{
+#ifndef _WIN32
+    linkMonitor_.setConfig(config);
+    return linkMonitor_.start();
+#else
+    (void)config;
+    return false;
+#endif // _WIN32
+}
+
+void WifiInterface::stopLinkMonitor()
+{
+    linkMonitor_.stop();
+}
+
+void WifiInterface::setMetricStore(MetricStore *store)
+{
+    metricStore_.store(store, std::memory_order_release);
+    linkMonitor_.setSampleCallback(store ? &WifiInterface::recordLinkSample : nullptr, this);
+}
+
+void WifiInterface::recordClientMetrics(const std::vector<ClientInfo> &clients)
+{
+    MetricStore *store = metricStore_.load(std::memory_order_acquire);
+    if (!store)
+    {
+        return;
+    }
+    int64_t nowMs = MetricStore::nowMs();
+    for (const auto &client : clients)
+    {
+        store->append(MetricStore::seriesName("client", client.macAddress, "signal"), nowMs, client.signalStrength);
+        store->append(MetricStore::seriesName("client", client.macAddress, "txrate"), nowMs,
+                      client.txBitrateKbps / 1000.0);
+    }
+}
+
+void WifiInterface::recordLinkSample(const LinkSnapshot &snapshot, void *context)
+{
+    static const char *const kMetricNames[LINK_METRIC_COUNT] = {"signal", "txrate", "retries", "beaconloss"};
+    WifiInterface *self = static_cast<WifiInterface *>(context);
+    MetricStore *store = self->metricStore_.load(std::memory_order_acquire);
+    if (!store || !snapshot.associated)
+    {
+        return;
+    }
+    int64_t nowMs = MetricStore::nowMs();
+    for (int metric = 0; metric < LINK_METRIC_COUNT; metric++)
+    {
+        // 样本数变化说明本次采样更新了该指标(换AP后统计重新开始, 样本数也会变化)
+        const LinkMetricStats &stats = snapshot.metrics[metric];
+        if (stats.samples == 0 || stats.samples == self->recordedSamples_[metric])
+        {
+            continue;
+        }
+        self->recordedSamples_[metric] = stats.samples;
+        store->append(MetricStore::seriesName("bss", snapshot.bssid, kMetricNames[metric]), nowMs, stats.last);
+    }
+}
+
+bool WifiInterface::connectToNetwork(const std::string &ssid, const std::string &password)
+{
+    // 用户从扫描列表中选择的网络, 候选AP为列表中信号最强的BSS
+    MacAddress bssid;
+    int rssi = 0;
+    uint32_t row = scanTable_.strongest(ssid);
+    if (row != ScanTable::npos)
+    {
+        bssid = scanTable_.bssid(row);
+        rssi = scanTable_.signalStrength(row);
+    }
+    return connectToCandidate(ssid, password, bssid, rssi);
+}
+
+bool WifiInterface::connectToCandidate(const std::string &ssid, const std::string &password,
+                                       const MacAddress &candidateBssid, int candidateRssi)
+{
+#ifndef _WIN32
+    TraceSpan total("connectToNetwork", "total");
+    TraceSpan phase("connectToNetwork", "clearStaticIP");
+    auto connectStart = std::chrono::steady_clock::now();
+    clearStaticIPConfig();
+
+    connectionStatus_ = ConnectionStatus::CONNECTING;
+
+    // 如果密码为空，使用已保存的密码
+    std::string actualPassword = password;
+    if (password.empty())
+    {
+        auto passwordIt = savedPasswords_.find(ssid);
+        if (passwordIt != savedPasswords_.end())
+        {
+            actualPassword = passwordIt->second;
+        }
+    }
+
+    // wpa_supplicant常驻, 已在运行时只需下发网络并切换, 不再重启进程
+    phase.next("ensureWpaSupplicant");
+    if (!ensureWpaSupplicant())
+    {
+        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
+        std::cout << "Error: Failed to start wpa_supplicant" << std::endl;
+        return false;
+    }
+
+    phase.next("selectNetwork");
+    bool isSaved = savedPasswords_.find(ssid) != savedPasswords_.end();
+    // 先订阅事件再SELECT_NETWORK, 否则很快到达的认证失败事件会丢失, 只能等到超时
+    if (!wpaCtrl_.isAttached() && !wpaCtrl_.attach())
+    {
+        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
+        std::cout << "Error: Failed to attach to wpa_supplicant control interface" << std::endl;
+        return false;
+    }
+    // 下发网络后的每个失败出口: 未保存的网络不留在wpa_supplicant中,
+    // 并重新启用SELECT_NETWORK禁用的其他自动连接网络
+    auto abandon = [this, &ssid, isSaved]()
+    {
+        connectionStatus_ = ConnectionStatus::CONNECTION_FAILED;
+        if (wpaCtrl_.isAttached())
+        {
+            wpaCtrl_.detach();
+        }
+        if (!isSaved)
+        {
+            supplicant_.remove(ssid);
+        }
+        supplicant_.restoreAutoConnect();
+        return false;
+    };
+    // 新口令的PSK只在这里计算一次, 连接成功后随密码一起保存
+    SupplicantNetwork network = buildSupplicantNetwork(ssid, actualPassword);
+    if (supplicant_.apply(network) < 0 || !supplicant_.select(ssid))
+    {
+        std::cout << "Error: Failed to select network " << ssid << " in wpa_supplicant" << std::endl;
+        return abandon();
+    }
+
+    // 等待连接建立, 由控制接口事件驱动
+    std::cout << "Waiting for WiFi connection to be established..." << std::endl;
+    phase.next("association");
+    if (waitForWpaConnection(ssid, 10000) == ConnectionStatus::CONNECTION_FAILED) // 最多等待10秒
+    {
+        std::cout << "WiFi authentication failed, please check whether the password is correct" << std::endl;
+        recordConnectAttempt(ssid, candidateBssid, ConnectFailure::AUTHENTICATION, candidateRssi, connectStart);
+        return abandon();
+    }
+
+    // 检查WiFi链路状态
+    phase.next("linkCheck");
+    std::string linkStatus = executeCommand({"iw", "dev", staInterface_, "link"});
+
+    if (linkStatus.find("Connected") == std::string::npos)
+    {
+        std::cout << "WiFi link connection failed" << std::endl;
+        recordConnectAttempt(ssid, candidateBssid, ConnectFailure::LINK, candidateRssi, connectStart);
+        return abandon();
+    }
+
+    TextView link(linkStatus);
+    MacAddress linkBssid;
+    TextView connectedTo = link.after("Connected to");
+    MacAddress::parse(connectedTo.data(), std::min<size_t>(connectedTo.size(), 17), linkBssid);
+    if (linkBssid.isZero())
+    {
+        linkBssid = candidateBssid;
+    }
+    int ifindex = static_cast<int>(if_nametoindex(staInterface_.c_str()));
+
+    // 获取IP地址: 该网络的租约未过期时先INIT-REBOOT, 被拒绝或超时再由udhcpc完整获取
+    std::cout << "Get IP address..." << std::endl;
+    phase.next("dhcp");
+    stopLeaseRenewal();
+    auto dhcpStart = std::chrono::steady_clock::now();
+    std::string ipAddress;
+    DhcpLease lease;
+    if (rejoinWithCachedLease(ssid, ifindex, linkBssid, lease))
+    {
+        ipAddress = lease.address;
+    }
+    else
+    {
+        // 启动udhcpc前订阅地址事件, 地址写入接口后立即继续
+        TraceSpan dhcpPhase("dhcp", "udhcpcStart");
+        AddressWatcher addressWatcher;
+        addressWatcher.open();
+        std::remove(DhcpClient::udhcpcLeasePath(staInterface_).c_str());
+        if (!executeCommandWithResult(udhcpcCommand()))
+        {
+            std::cout << "DHCP failed to obtain IP address" << std::endl;
+            recordConnectAttempt(ssid, linkBssid, ConnectFailure::DHCP, candidateRssi, connectStart);
+            return abandon();
+        }
+
+        // 验证IP地址是否成功分配
+        dhcpPhase.next("addressWait");
+        InterfaceAddress leasedAddress;
+        if (ifindex == 0 || !addressWatcher.waitForAddress(ifindex, kDhcpAddressTimeoutMs, leasedAddress))
+        {
+            std::cout << "IP address allocation failed!!!" << std::endl;
+            recordConnectAttempt(ssid, linkBssid, ConnectFailure::DHCP, candidateRssi, connectStart);
+            return abandon();
+        }
+        ipAddress = leasedAddress.address;
+        dhcpPhase.next("learnLease");
+        learnLease(ssid, linkBssid, ipAddress);
+    }
+    dhcpLatencyMs_ = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                          std::chrono::steady_clock::now() - dhcpStart)
+                                          .count());
+    std::cout << "DHCP address obtained in " << dhcpLatencyMs_ << " ms" << std::endl;
+
+    // 更新连接状态和网络信息
+    phase.next("saveConfig");
+    connectionStatus_ = ConnectionStatus::CONNECTED;
+
+    // 更新当前网络信息
+    uint32_t row = scanTable_.strongest(ssid);
+    if (row != ScanTable::npos)
+    {
+        currentNetwork_ = scanTable_.toNetworkInfo(row);
+    }
+
+    // 添加到已连接网络列表
+    auto it = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
+                           [&ssid](const NetworkInfo &network)
+                           {
                                return network.ssid == ssid;
                            });
     if (it == savedNetworks_.end())
@@ -771,6 +923,7 @@ bool WifiInterface::connectToNetwork(const std::string &ssid, const std::string
     }
 
     std::cout << "Connection successful! IP address:" << ipAddress << std::endl;
+    recordConnectAttempt(ssid, linkBssid, ConnectFailure::NONE, candidateRssi, connectStart);
 
     // 连接成功后，保存密码
     if (connectionStatus_ == ConnectionStatus::CONNECTED)
@@ -786,7 +939,37 @@ bool WifiInterface::connectToNetwork(const std::string &ssid, const std::string
         }
 
         savedPasswords_[ssid] = passwordToSave;
+        if (network.password != passwordToSave)
+        {
+            savedPsks_[ssid] = network.password;
+        }
+        else
+        {
+            savedPsks_.erase(ssid);
+        }
         autoConnectNetworks_[ssid] = true;
+        // 按自动连接设置更新优先级, 并重新启用SELECT_NETWORK禁用的其他自动连接网络
+        supplicant_.apply(buildSupplicantNetwork(ssid, passwordToSave));
+        supplicant_.restoreAutoConnect();
+
+        // 隐藏网络在全信道扫描结果中没有SSID, 从关联信息记录它的位置
+        if (sightings_.find(ssid) == nullptr)
+        {
+            NetworkSighting sighting;
+            if (!linkBssid.isZero())
+            {
+                sighting.bssids.push_back(linkBssid);
+            }
+            int frequency = 0;
+            if (link.after("freq:").toInt(frequency) && frequency > 0)
+            {
+                sighting.frequencies.push_back(frequency);
+            }
+            if (!sighting.frequencies.empty())
+            {
+                sightings_.set(ssid, sighting);
+            }
+        }
         saveNetworkConfig();
     }
 
@@ -830,44 +1013,32 @@ bool WifiInterface::setStaticIPConfig(const StaticIPConfig &staticConfig)
         return false;
     }
 
-    // 设置静态IP配置
-    staticIPConfig_ = staticConfig;
-    useStaticIP_ = true;
-
-    std::cout << "Applying static IP configuration to interface " << staInterface_ << "..." << std::endl;
-
-    // 1. 清除现有IP配置
-    std::string clearIPCommand = "ip addr flush dev " + staInterface_;
-    if (!executeCommandWithResult(clearIPCommand))
+    int prefixLength = RtNetlink::netmaskToPrefix(staticConfig.subnetMask);
+    if (prefixLength <= 0)
     {
-        std::cout << "Warning: Failed to clear existing IP configuration" << std::endl;
+        std::cout << "Error: Invalid subnet mask: " << staticConfig.subnetMask << std::endl;
+        return false;
     }
 
-    // 2. 设置静态IP地址和子网掩码
-    std::string setIPCommand = "ip addr add " + staticConfig.ipAddress + "/" +
-                               (staticConfig.subnetMask == "255.255.255.0" ? "24" : staticConfig.subnetMask == "255.255.0.0" ? "16"
-                                                                                                                             : "24") +
-                               " dev " + staInterface_;
-    if (!executeCommandWithResult(setIPCommand))
+    int ifindex = static_cast<int>(if_nametoindex(staInterface_.c_str()));
+    if (ifindex == 0)
     {
-        std::cout << "Error: Failed to set static IP address" << std::endl;
+        std::cout << "Error: Interface " << staInterface_ << " not found" << std::endl;
         return false;
     }
 
-    // 3. 启用接口
-    std::string upCommand = "ip link set " + staInterface_ + " up";
-    if (!executeCommandWithResult(upCommand))
+    std::cout << "Applying static IP configuration to interface " << staInterface_ << "..." << std::endl;
+
+    // 清除现有地址、设置地址、启用接口、设置默认网关在一次netlink批量请求中完成, 失败时回滚
+    if (!rtnl_.applyStaticIPv4(ifindex, staticConfig.ipAddress, prefixLength, staticConfig.gateway))
     {
-        std::cout << "Error: Failed to enable interface" << std::endl;
+        std::cout << "Error: Failed to apply static IP configuration" << std::endl;
         return false;
     }
 
-    // 4. 设置默认网关
-    std::string routeCommand = "ip route add default via " + staticConfig.gateway + " dev " + staInterface_;
-    if (!executeCommandWithResult(routeCommand))
-    {
-        std::cout << "Warning: Failed to set default gateway, you may need to set it manually" << std::endl;
-    }
+    // 设置静态IP配置
+    staticIPConfig_ = staticConfig;
+    useStaticIP_ = true;
 
     std::cout << "Static IP configuration set and applied successfully:" << std::endl;
     std::cout << "  IP Address: " << staticIPConfig_.ipAddress << std::endl;
@@ -893,30 +1064,17 @@ bool WifiInterface::clearStaticIPConfig()
 
     std::cout << "Clearing static IP configuration from interface " << staInterface_ << "..." << std::endl;
 
-    // 1. 清除静态IP地址
-    if (!staticIPConfig_.ipAddress.empty())
-    {
-        std::string clearIPCommand = "ip addr del " + staticIPConfig_.ipAddress + "/" +
-                                     (staticIPConfig_.subnetMask == "255.255.255.0" ? "24" : staticIPConfig_.subnetMask == "255.255.0.0" ? "16"
-                                                                                                                                         : "24") +
-                                     " dev " + staInterface_;
-        executeCommandWithResult(clearIPCommand);
-    }
-
-    // 2. 清除默认路由
-    if (!staticIPConfig_.gateway.empty())
+    // 删除静态地址和默认路由并保持接口启用, 在一次netlink批量请求中完成
+    int ifindex = static_cast<int>(if_nametoindex(staInterface_.c_str()));
+    if (ifindex > 0)
     {
-        std::string clearRouteCommand = "ip route del default via " + staticIPConfig_.gateway + " dev " + staInterface_;
-        executeCommandWithResult(clearRouteCommand);
+        rtnl_.clearStaticIPv4(ifindex, staticIPConfig_.ipAddress,
+                              RtNetlink::netmaskToPrefix(staticIPConfig_.subnetMask), staticIPConfig_.gateway);
     }
 
-    // 3. 重置为默认值
+    // 重置为默认值
     staticIPConfig_ = StaticIPConfig();
 
-    // 4. 启用接口(使用DHCP)
-    std::string upCommand = "ip link set " + staInterface_ + " up";
-    executeCommandWithResult(upCommand);
-
     std::cout << "Static IP configuration cleared, interface " << staInterface_ << " will use DHCP" << std::endl;
     return true;
 #else
@@ -924,7 +1082,7 @@ bool WifiInterface::clearStaticIPConfig()
 #endif // _WIN32
 }
 
-bool WifiInterface::configureWpaSupplicant(const std::string &ssid, const std::string &password)
+bool WifiInterface::configureWpaSupplicant()
 {
 #ifndef _WIN32
     std::ofstream configFile("/etc/wpa_supplicant.conf");
@@ -938,30 +1096,15 @@ bool WifiInterface::configureWpaSupplicant(const std::string &ssid, const std::s
     configFile << "update_config=1\n";
     configFile << "country=US\n";
 
-    configFile << "network={\n";
-    configFile << "    ssid=\"" << ssid << "\"\n";
-
-    // 如果密码为空，检查是否有已保存的密码
-    std::string actualPassword = password;
-    if (password.empty())
+    // 全部已保存网络, 自动连接的网络启用并优先, wpa_supplicant启动后即可自行连接
+    for (const auto &network : savedNetworks_)
     {
-        auto passwordIt = savedPasswords_.find(ssid);
+        auto passwordIt = savedPasswords_.find(network.ssid);
         if (passwordIt != savedPasswords_.end())
         {
-            actualPassword = passwordIt->second;
-            std::cout << "----->actualPassword: " << actualPassword << std::endl;
+            configFile << SupplicantProfile::formatNetworkBlock(buildSupplicantNetwork(network.ssid, passwordIt->second));
         }
     }
-
-    if (!actualPassword.empty())
-    {
-        configFile << "    psk=\"" << actualPassword << "\"\n";
-    }
-    else
-    {
-        configFile << "    key_mgmt=NONE\n";
-    }
-    configFile << "}\n";
     configFile.close();
     return true;
 #else
@@ -975,23 +1118,25 @@ bool WifiInterface::disconnect()
     ConnectionStatus actualStatus = getConnectionStatus();
     if (actualStatus == ConnectionStatus::CONNECTED)
     {
-        stopWpaSupplicant();
+        // wpa_supplicant保持运行, DISCONNECT后不再自动重连, 直到下次选择网络
+        std::string reply;
+        if (!openWpaControl() || !wpaCtrl_.request("DISCONNECT", reply) || reply.compare(0, 2, "OK") != 0)
+        {
+            stopWpaSupplicant();
+        }
 
-        // 杀死udhcpc进程
-        std::string killCommand = "killall udhcpc 2>/dev/null";
-        executeCommandWithResult(killCommand);
+        // 停止续约并杀死udhcpc进程, 租约保留用于下次INIT-REBOOT
+        stopLeaseRenewal();
+        executeCommandWithResult({"killall", "udhcpc"});
 
         // 清除IP地址
-        std::string clearIPCommand = "ip addr flush dev " + staInterface_;
-        executeCommandWithResult(clearIPCommand);
+        executeCommandWithResult({"ip", "addr", "flush", "dev", staInterface_});
 
         // 禁用网络接口
-        std::string downCommand = "ip link set " + staInterface_ + " down";
-        executeCommandWithResult(downCommand);
+        executeCommandWithResult({"ip", "link", "set", staInterface_, "down"});
 
         // 重新启用网络接口(清除所有配置)
-        std::string upCommand = "ip link set " + staInterface_ + " up";
-        executeCommandWithResult(upCommand);
+        executeCommandWithResult({"ip", "link", "set", staInterface_, "up"});
 
         connectionStatus_ = ConnectionStatus::DISCONNECTED;
         currentNetwork_ = NetworkInfo(); // 清空当前网络信息
@@ -1008,8 +1153,7 @@ bool WifiInterface::disconnect()
 NetworkInfo WifiInterface::getCurrentNetwork()
 {
 #ifndef _WIN32
-    std::string command = "iw dev " + staInterface_ + " link";
-    std::string linkStatus = executeCommand(command);
+    std::string linkStatus = executeCommand({"iw", "dev", staInterface_, "link"});
 
     if (linkStatus.find("Connected") == std::string::npos)
     {
@@ -1020,7 +1164,7 @@ NetworkInfo WifiInterface::getCurrentNetwork()
         emptyNetwork.security = SecurityMode::OPEN;
         emptyNetwork.channel = 0;
         emptyNetwork.isHidden = false;
-        emptyNetwork.bssid = "";
+        emptyNetwork.bssid = MacAddress();
         emptyNetwork.frequency = 0;
         return emptyNetwork;
     }
@@ -1047,7 +1191,7 @@ NetworkInfo WifiInterface::getCurrentNetwork()
         emptyNetwork.security = SecurityMode::OPEN;
         emptyNetwork.channel = 0;
         emptyNetwork.isHidden = false;
-        emptyNetwork.bssid = "";
+        emptyNetwork.bssid = MacAddress();
         emptyNetwork.frequency = 0;
         return emptyNetwork;
     }
@@ -1059,13 +1203,10 @@ NetworkInfo WifiInterface::getCurrentNetwork()
     currentNetwork.ssid = ssid;
     currentNetwork.signalStrength = signalStrength;
 
-    for (const auto &network : scanResults_)
+    uint32_t row = scanTable_.strongest(ssid);
+    if (row != ScanTable::npos)
     {
-        if (network.ssid == ssid)
-        {
-            currentNetwork = network;
-            break;
-        }
+        currentNetwork = scanTable_.toNetworkInfo(row);
     }
 
     currentNetwork_ = currentNetwork;
@@ -1080,159 +1221,451 @@ std::vector<NetworkInfo> WifiInterface::getSavedNetworks()
 {
 #ifndef _WIN32
     std::vector<NetworkInfo> networks;
-    std::string command = "iw dev " + staInterface_ + " scan | grep -E \"^BSS|SSID:|signal:|freq:|WPA|RSN|WEP\"";
-    std::string scanOutput = executeCommand(command);
-
-    if (scanOutput.empty())
+    ScanTable table;
+    if (!scanInto(table, kSavedNetworkScanMaxAgeMs))
     {
         std::cout << "Warning: Network scan failed, cannot determine available saved networks" << std::endl;
         return networks;
     }
 
-    std::vector<NetworkInfo> allNetworks = parseScanResultsWithoutFiltering(scanOutput);
+    collectSavedNetworks(table, networks);
+    return networks;
+#else
+    return std::vector<NetworkInfo>();
+#endif // _WIN32
+}
 
-    if (allNetworks.empty())
+bool WifiInterface::forgetNetwork(const std::string &ssid)
+{
+#ifndef _WIN32
+    auto it = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
+                           [&ssid](const NetworkInfo &network)
+                           {
+                               return network.ssid == ssid;
+                           });
+    if (it != savedNetworks_.end())
     {
-        // 没有扫描到任何网络，返回空列表
-        return networks;
+        savedNetworks_.erase(it);
+        savedPasswords_.erase(ssid);
+        savedPsks_.erase(ssid);
+        autoConnectNetworks_.erase(ssid);
+        if (leases_.erase(ssid) > 0)
+        {
+            saveLeaseCache();
+        }
+        history_.erase(ssid);
+        saveConnectionHistory();
+        sightings_.erase(ssid);
+        if (wpaCtrl_.isOpen())
+        {
+            supplicant_.remove(ssid);
+        }
+        saveNetworkConfig();
+        return true;
+    }
+    return false;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void WifiInterface::saveNetworkConfig()
+{
+#ifndef _WIN32
+    std::ofstream configFile("/etc/wifi_networks.conf");
+    if (!configFile.is_open())
+    {
+        std::cout << "Unable to create network profile" << std::endl;
+        return;
     }
 
     for (const auto &network : savedNetworks_)
     {
-        NetworkInfo info = network;
+        auto passwordIt = savedPasswords_.find(network.ssid);
         auto autoConnectIt = autoConnectNetworks_.find(network.ssid);
-        if (autoConnectIt != autoConnectNetworks_.end())
+
+        if (passwordIt != savedPasswords_.end() && autoConnectIt != autoConnectNetworks_.end())
         {
-            info.autoConnect = autoConnectIt->second;
+            // ssid|password|autoConnect|最近出现的频率|最近出现的BSSID|PSK
+            auto pskIt = savedPsks_.find(network.ssid);
+            configFile << network.ssid << "|"
+                       << passwordIt->second << "|"
+                       << (autoConnectIt->second ? "1" : "0") << "|"
+                       << sightings_.format(network.ssid) << "|"
+                       << (pskIt != savedPsks_.end() ? pskIt->second : "") << std::endl;
         }
-        // 检查网络是否在当前范围内
-        bool isInRange = false;
-        for (const auto &scannedNetwork : allNetworks)
+    }
+    configFile.close();
+#else
+    return;
+#endif // _WIN32
+}
+
+void WifiInterface::loadNetworkConfig()
+{
+#ifndef _WIN32
+    std::ifstream configFile("/etc/wifi_networks.conf");
+    if (!configFile.is_open())
+    {
+        return;
+    }
+
+    std::vector<WpaPsk::Request> pending; // 缺少PSK的口令(旧版配置文件)
+    std::string line;
+    while (std::getline(configFile, line))
+    {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (true)
         {
-            if (scannedNetwork.ssid == network.ssid)
+            size_t end = line.find('|', start);
+            fields.push_back(line.substr(start, end == std::string::npos ? std::string::npos : end - start));
+            if (end == std::string::npos)
             {
-                isInRange = true;
-                info.signalStrength = scannedNetwork.signalStrength;
                 break;
             }
+            start = end + 1;
         }
 
-        // 只有当网络在范围内时才添加到返回列表
-        if (isInRange)
+        if (fields.size() >= 3)
         {
-            networks.push_back(info);
+            // 旧版配置文件只有前三项或前五项
+            const std::string &ssid = fields[0];
+            const std::string &password = fields[1];
+            bool autoConnect = fields[2] == "1";
+            if (fields.size() >= 5)
+            {
+                sightings_.parse(ssid, fields[3], fields[4]);
+            }
+            if (fields.size() >= 6 && fields[5].size() == WpaPsk::kPskLength * 2)
+            {
+                savedPsks_[ssid] = fields[5];
+            }
+            else if (WpaPsk::isPassphrase(password))
+            {
+                WpaPsk::Request request;
+                request.passphrase = password;
+                request.ssid = ssid;
+                pending.push_back(request);
+            }
+
+            // 保存密码和自动连接设置
+            savedPasswords_[ssid] = password;
+            autoConnectNetworks_[ssid] = autoConnect;
+
+            // 创建NetworkInfo并添加到savedNetworks_列表
+            NetworkInfo networkInfo;
+            networkInfo.ssid = ssid;
+            networkInfo.autoConnect = autoConnect;
+
+            // 检查是否已存在该网络，避免重复添加
+            auto it = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
+                                   [&ssid](const NetworkInfo &network)
+                                   {
+                                       return network.ssid == ssid;
+                                   });
+            if (it == savedNetworks_.end())
+            {
+                savedNetworks_.push_back(networkInfo);
+            }
         }
     }
+    configFile.close();
 
-    return networks;
+    // 一次性批量补算并写回, 之后启动wpa_supplicant不再计算
+    if (!pending.empty())
+    {
+        WpaPsk::deriveBatch(pending);
+        for (const auto &request : pending)
+        {
+            savedPsks_[request.ssid] = WpaPsk::toHex(request.psk, WpaPsk::kPskLength);
+        }
+        saveNetworkConfig();
+    }
+#else
+    return;
+#endif // _WIN32
+}
+
+bool WifiInterface::rejoinWithCachedLease(const std::string &ssid, int ifindex, const MacAddress &bssid, DhcpLease &lease)
+{
+#ifndef _WIN32
+    auto leaseIt = leases_.find(ssid);
+    if (ifindex == 0 || leaseIt == leases_.end() || leaseIt->second.gateway.empty() ||
+        leaseIt->second.remainingSeconds(time(nullptr)) < kMinLeaseRemainingSeconds)
+    {
+        return false;
+    }
+    TraceSpan dhcpPhase("dhcp", "initReboot");
+    const DhcpLease cached = leaseIt->second;
+    DhcpClient client;
+    if (!client.open(staInterface_) || !client.sendReboot(cached))
+    {
+        return false;
+    }
+
+    // 等待确认的同时先应用原地址
+    bool applied = applyLease(ifindex, cached);
+    DhcpClient::Result result = client.waitReply(kDhcpRebootTimeoutMs, lease);
+    if (result == DhcpClient::ACK && lease.address == cached.address)
+    {
+        if (!applied || lease.prefixLength != cached.prefixLength || lease.gateway != cached.gateway ||
+            lease.dns != cached.dns)
+        {
+            applied = !lease.gateway.empty() && applyLease(ifindex, lease);
+        }
+        if (applied)
+        {
+            lease.bssid = bssid;
+            leases_[ssid] = lease;
+            saveLeaseCache();
+            leaseSsid_ = ssid;
+            dhcpRenewer_.start(staInterface_, lease, &WifiInterface::onLeaseLost, this);
+            std::cout << "Rejoined with cached DHCP lease " << lease.address << std::endl;
+            return true;
+        }
+    }
+
+    if (result == DhcpClient::NAK || result == DhcpClient::ACK)
+    {
+        std::cout << "DHCP server rejected the cached lease, running full DHCP" << std::endl;
+        leases_.erase(ssid);
+        saveLeaseCache();
+    }
+    else
+    {
+        std::cout << "No reply to DHCP INIT-REBOOT, running full DHCP" << std::endl;
+    }
+    if (applied)
+    {
+        rtnl_.clearStaticIPv4(ifindex, cached.address, cached.prefixLength, cached.gateway);
+    }
+    return false;
+#else
+    (void)ssid;
+    (void)ifindex;
+    (void)bssid;
+    (void)lease;
+    return false;
+#endif // _WIN32
+}
+
+bool WifiInterface::applyLease(int ifindex, const DhcpLease &lease)
+{
+#ifndef _WIN32
+    if (!rtnl_.applyStaticIPv4(ifindex, lease.address, lease.prefixLength, lease.gateway))
+    {
+        return false;
+    }
+    // 与udhcpc默认脚本一致, 由租约中的DNS服务器生成resolv.conf
+    if (!lease.dns.empty())
+    {
+        std::ofstream resolvConf("/etc/resolv.conf");
+        for (const auto &server : lease.dns)
+        {
+            resolvConf << "nameserver " << server << "\n";
+        }
+    }
+    return true;
+#else
+    (void)ifindex;
+    (void)lease;
+    return false;
+#endif // _WIN32
+}
+
+void WifiInterface::learnLease(const std::string &ssid, const MacAddress &bssid, const std::string &address)
+{
+#ifndef _WIN32
+    // 事件脚本在默认脚本写入地址之前已写好租约文件
+    std::ifstream leaseFile(DhcpClient::udhcpcLeasePath(staInterface_));
+    std::stringstream text;
+    text << leaseFile.rdbuf();
+    DhcpLease lease;
+    if (leaseFile.is_open() && DhcpClient::parseUdhcpcLease(text.str(), lease) && lease.address == address)
+    {
+        lease.bssid = bssid;
+        leases_[ssid] = lease;
+        saveLeaseCache();
+    }
+#else
+    (void)ssid;
+    (void)bssid;
+    (void)address;
+#endif // _WIN32
+}
+
+void WifiInterface::installUdhcpcScript()
+{
+#ifndef _WIN32
+    if (access(kUdhcpcDefaultScript, X_OK) != 0)
+    {
+        return;
+    }
+    {
+        std::ofstream script(kUdhcpcScriptPath);
+        script << DhcpClient::udhcpcScript(kUdhcpcDefaultScript);
+        if (!script)
+        {
+            return;
+        }
+    }
+    if (chmod(kUdhcpcScriptPath, 0755) == 0)
+    {
+        udhcpcScript_ = kUdhcpcScriptPath;
+    }
+#endif // _WIN32
+}
+
+std::vector<std::string> WifiInterface::udhcpcCommand() const
+{
+    std::vector<std::string> argv = {"udhcpc", "-b", "-i", staInterface_, "-R", "-t", "5", "-n"};
+    if (!udhcpcScript_.empty())
+    {
+        argv.push_back("-s");
+        argv.push_back(udhcpcScript_);
+    }
+    return argv;
+}
+
+void WifiInterface::stopLeaseRenewal()
+{
+    if (!dhcpRenewer_.isRunning())
+    {
+        dhcpRenewer_.stop();
+        return;
+    }
+    DhcpLease lease = dhcpRenewer_.getLease();
+    dhcpRenewer_.stop();
+    // 保存续约后的租期, 已删除的网络不再写回
+    if (savedPasswords_.find(leaseSsid_) != savedPasswords_.end())
+    {
+        leases_[leaseSsid_] = lease;
+        saveLeaseCache();
+    }
+}
+
+void WifiInterface::onLeaseLost(const DhcpLease &lease, void *context)
+{
+#ifndef _WIN32
+    // 续约线程中调用: 租约无法续约, 交回udhcpc完整获取(不访问成员状态)
+    WifiInterface *self = static_cast<WifiInterface *>(context);
+    std::cout << "DHCP lease " << lease.address << " could not be renewed, restarting udhcpc" << std::endl;
+    ProcessRunner runner;
+    runner.succeeded(self->udhcpcCommand());
 #else
-    return std::vector<NetworkInfo>();
+    (void)lease;
+    (void)context;
 #endif // _WIN32
 }
 
-bool WifiInterface::forgetNetwork(const std::string &ssid)
+void WifiInterface::saveLeaseCache()
 {
 #ifndef _WIN32
-    auto it = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
-                           [&ssid](const NetworkInfo &network)
-                           {
-                               return network.ssid == ssid;
-                           });
-    if (it != savedNetworks_.end())
+    std::ofstream leaseFile("/etc/wifi_leases.conf");
+    if (!leaseFile.is_open())
     {
-        savedNetworks_.erase(it);
-        savedPasswords_.erase(ssid);
-        autoConnectNetworks_.erase(ssid);
-        saveNetworkConfig();
-        return true;
+        return;
+    }
+    // ssid|address/prefix|server|gateway|dns|leaseSeconds|obtainedAt|bssid
+    for (const auto &lease : leases_)
+    {
+        leaseFile << lease.first << "|" << DhcpClient::formatLease(lease.second) << std::endl;
     }
-    return false;
-#else
-    return false;
 #endif // _WIN32
 }
 
-void WifiInterface::saveNetworkConfig()
+void WifiInterface::loadLeaseCache()
 {
 #ifndef _WIN32
-    std::ofstream configFile("/etc/wifi_networks.conf");
-    if (!configFile.is_open())
+    std::ifstream leaseFile("/etc/wifi_leases.conf");
+    if (!leaseFile.is_open())
     {
-        std::cout << "Unable to create network profile" << std::endl;
         return;
     }
-
-    for (const auto &network : savedNetworks_)
+    std::string line;
+    time_t now = time(nullptr);
+    while (std::getline(leaseFile, line))
     {
-        auto passwordIt = savedPasswords_.find(network.ssid);
-        auto autoConnectIt = autoConnectNetworks_.find(network.ssid);
-
-        if (passwordIt != savedPasswords_.end() && autoConnectIt != autoConnectNetworks_.end())
+        size_t separator = line.find('|');
+        DhcpLease lease;
+        if (separator == std::string::npos || !DhcpClient::parseLease(line.substr(separator + 1), lease))
         {
-            configFile << network.ssid << "|"
-                       << passwordIt->second << "|"
-                       << (autoConnectIt->second ? "1" : "0") << std::endl;
+            continue;
+        }
+        // 过期的租约没有用处
+        std::string ssid = line.substr(0, separator);
+        if (lease.remainingSeconds(now) > 0 && savedPasswords_.find(ssid) != savedPasswords_.end())
+        {
+            leases_[ssid] = lease;
         }
     }
-    configFile.close();
-#else
-    return;
 #endif // _WIN32
 }
 
-void WifiInterface::loadNetworkConfig()
+void WifiInterface::saveConnectionHistory()
 {
 #ifndef _WIN32
-    std::ifstream configFile("/etc/wifi_networks.conf");
-    if (!configFile.is_open())
+    std::ofstream historyFile("/etc/wifi_history.conf");
+    if (!historyFile.is_open())
     {
         return;
     }
+    for (const auto &record : history_.records())
+    {
+        historyFile << ConnectionHistory::format(record) << std::endl;
+    }
+#endif // _WIN32
+}
 
+void WifiInterface::loadConnectionHistory()
+{
+#ifndef _WIN32
+    std::ifstream historyFile("/etc/wifi_history.conf");
+    if (!historyFile.is_open())
+    {
+        return;
+    }
     std::string line;
-    while (std::getline(configFile, line))
+    while (std::getline(historyFile, line))
     {
-        size_t pos1 = line.find('|');
-        size_t pos2 = line.find('|', pos1 + 1);
-
-        if (pos1 != std::string::npos && pos2 != std::string::npos)
+        ConnectionRecord record;
+        if (ConnectionHistory::parse(line, record) && savedPasswords_.find(record.ssid) != savedPasswords_.end())
         {
-            std::string ssid = line.substr(0, pos1);
-            std::string password = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            bool autoConnect = line.substr(pos2 + 1) == "1";
-
-            // 保存密码和自动连接设置
-            savedPasswords_[ssid] = password;
-            autoConnectNetworks_[ssid] = autoConnect;
-
-            // 创建NetworkInfo并添加到savedNetworks_列表
-            NetworkInfo networkInfo;
-            networkInfo.ssid = ssid;
-            networkInfo.autoConnect = autoConnect;
-
-            // 检查是否已存在该网络，避免重复添加
-            auto it = std::find_if(savedNetworks_.begin(), savedNetworks_.end(),
-                                   [&ssid](const NetworkInfo &network)
-                                   {
-                                       return network.ssid == ssid;
-                                   });
-            if (it == savedNetworks_.end())
-            {
-                savedNetworks_.push_back(networkInfo);
-            }
+            history_.set(record);
         }
     }
-    configFile.close();
-#else
-    return;
 #endif // _WIN32
 }
 
+void WifiInterface::recordConnectAttempt(const std::string &ssid, const MacAddress &bssid, ConnectFailure failure,
+                                         int rssi, std::chrono::steady_clock::time_point start)
+{
+    int elapsedMs = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count());
+    if (failure == ConnectFailure::NONE)
+    {
+        history_.recordSuccess(ssid, bssid, elapsedMs, rssi, time(nullptr));
+    }
+    else
+    {
+        history_.recordFailure(ssid, bssid, failure, elapsedMs, rssi, time(nullptr));
+    }
+    saveConnectionHistory();
+}
+
 bool WifiInterface::setAutoConnect(const std::string &ssid, bool autoConnect)
 {
 #ifndef _WIN32
     autoConnectNetworks_[ssid] = autoConnect;
     saveNetworkConfig();
+
+    // 同步到运行中的wpa_supplicant(启用/禁用及优先级)
+    auto passwordIt = savedPasswords_.find(ssid);
+    if (passwordIt != savedPasswords_.end() && supplicant_.find(ssid) >= 0 && wpaCtrl_.isOpen())
+    {
+        supplicant_.apply(buildSupplicantNetwork(ssid, passwordIt->second));
+    }
     return true;
 #else
     return false;
@@ -1243,7 +1676,18 @@ bool WifiInterface::autoConnectToSavedNetworks()
 {
 #ifndef _WIN32
     std::cout << "Trying to automatically connect to a saved network..." << std::endl;
-    auto savedNetworks = getSavedNetworks();
+    // 先在已保存网络最近出现的频率上定向扫描, 都没找到时再主动扫描全部信道.
+    // 定向扫描刚刷新过内核缓存中那几个信道的BSS, 不能复用缓存, 否则在其他信道上的已保存网络找不到
+    std::vector<NetworkInfo> savedNetworks;
+    if (!scanSavedNetworkChannels(savedNetworks))
+    {
+        ScanTable table;
+        if (!scanInto(table, 0))
+        {
+            std::cout << "Warning: Network scan failed, cannot determine available saved networks" << std::endl;
+        }
+        collectSavedNetworks(table, savedNetworks);
+    }
     if (savedNetworks.empty())
     {
         std::cout << "No saved network configuration" << std::endl;
@@ -1265,6 +1709,9 @@ bool WifiInterface::autoConnectToSavedNetworks()
         return false;
     }
 
+    // 按连接历史估计的耗时排序, 刚失败过的AP排到后面
+    history_.rank(availableNetworks, time(nullptr));
+
     for (const auto &network : availableNetworks)
     {
         std::cout << "Try to connect to the network: " << network.ssid << std::endl;
@@ -1277,7 +1724,8 @@ bool WifiInterface::autoConnectToSavedNetworks()
             continue;
         }
 
-        if (connectToNetwork(network.ssid, passwordIt->second))
+        // 连接历史记在排序时使用的候选AP上, 下次排序的退避才作用于这个AP
+        if (connectToCandidate(network.ssid, passwordIt->second, network.bssid, network.signalStrength))
         {
             std::cout << "Automatic connection successful! Connect to the network: " << network.ssid << std::endl;
             return true;
@@ -1299,8 +1747,7 @@ ConnectionStatus WifiInterface::getConnectionStatus()
 {
 #ifndef _WIN32
     // 检查STA接口的连接状态
-    std::string command = "iw dev " + staInterface_ + " link";
-    std::string linkStatus = executeCommand(command);
+    std::string linkStatus = executeCommand({"iw", "dev", staInterface_, "link"});
 
     if (linkStatus.empty())
     {
@@ -1336,14 +1783,8 @@ ConnectionStatus WifiInterface::getConnectionStatus()
 std::string WifiInterface::getIPAddress()
 {
 #ifndef _WIN32
-    std::string command = "ip addr show " + staInterface_ + " | grep 'inet ' | awk '{print $2}' | cut -d/ -f1";
-    std::string ip = executeCommand(command);
-
-    if (!ip.empty() && ip.back() == '\n')
-    {
-        ip.pop_back();
-    }
-    return ip;
+    InterfaceAddress address;
+    return getInterfaceAddress(staInterface_, address) ? address.address : "";
 #else
     return "192.168.0.1";
 #endif // _WIN32
@@ -1352,36 +1793,8 @@ std::string WifiInterface::getIPAddress()
 std::string WifiInterface::getSubnetMask()
 {
 #ifndef _WIN32
-    std::string command = "ip addr show " + staInterface_ + " | grep 'inet' | awk '{print $2}' | cut -d/ -f2";
-    std::string mask = executeCommand(command);
-
-    if (!mask.empty() && mask.back() == '\n')
-    {
-        mask.pop_back();
-    }
-    // 将CIDR掩码转换为点分十进制格式
-    if (!mask.empty())
-    {
-        try
-        {
-            int cidr = std::stoi(mask);
-            if (cidr >= 0 && cidr <= 32)
-            {
-                uint32_t subnetMask = 0xFFFFFFFF << (32 - cidr);
-                subnetMask = htonl(subnetMask);
-
-                struct in_addr addr;
-                addr.s_addr = subnetMask;
-                return std::string(inet_ntoa(addr));
-            }
-        }
-        catch (...)
-        {
-            // 转换失败，返回空字符串
-            return "";
-        }
-    }
-    return "";
+    InterfaceAddress address;
+    return getInterfaceAddress(staInterface_, address) ? RtNetlink::prefixToNetmask(address.prefixLength) : "";
 #else
     return "255.255.255.0";
 #endif // _WIN32
@@ -1391,12 +1804,19 @@ std::string WifiInterface::getGateway()
 {
 #ifndef _WIN32
     // 优先从默认路由表中获取网关地址
-    std::string command = "ip route show default | grep " + staInterface_ + " | awk '{print $3}'";
-    std::string gateway = executeCommand(command);
-
-    if (!gateway.empty() && gateway.back() == '\n')
+    std::string gateway;
+    std::vector<RouteEntry> routes;
+    int ifindex = static_cast<int>(if_nametoindex(staInterface_.c_str()));
+    if (ifindex > 0 && rtnl_.getRoutes(routes))
     {
-        gateway.pop_back();
+        for (const auto &route : routes)
+        {
+            if (route.prefixLength == 0 && route.ifindex == ifindex && !route.gateway.empty())
+            {
+                gateway = route.gateway;
+                break;
+            }
+        }
     }
 
     // 如果没有获取到，从静态配置中获取网关地址
@@ -1413,14 +1833,7 @@ std::string WifiInterface::getGateway()
 std::string WifiInterface::getMACAddress()
 {
 #ifndef _WIN32
-    std::string command = "cat /sys/class/net/" + staInterface_ + "/address";
-    std::string mac = executeCommand(command);
-
-    if (!mac.empty() && mac.back() == '\n')
-    {
-        mac.pop_back();
-    }
-    return mac;
+    return SysProbe::getHardwareAddress(staInterface_);
 #else
     return "";
 #endif // _WIN32
@@ -1429,8 +1842,33 @@ std::string WifiInterface::getMACAddress()
 int WifiInterface::getSignalStrength()
 {
 #ifndef _WIN32
-    std::string command = "iw dev " + staInterface_ + " link | grep 'signal:' | awk '{print $2}'";
-    std::string signalStr = executeCommand(command);
+    // 链路监测运行时快照足够新, 不再经过控制接口
+    LinkSnapshot snapshot;
+    if (linkMonitor_.snapshot(snapshot) && snapshot.associated &&
+        scanClock_.nowMs() - snapshot.timestampMs <= kLinkSnapshotMaxAgeMs)
+    {
+        return static_cast<int>(snapshot.metrics[LINK_SIGNAL].last);
+    }
+
+    // 优先通过控制接口SIGNAL_POLL获取, wpa_supplicant未运行时回退到iw
+    std::string signalStr;
+    std::string reply;
+    if (openWpaControl())
+    {
+        if (wpaCtrl_.request("SIGNAL_POLL", reply))
+        {
+            signalStr = WpaCtrl::getValue(reply, "RSSI");
+        }
+        else
+        {
+            wpaCtrl_.close(); // wpa_supplicant可能已被外部重启, 下次重新连接
+            supplicant_.reset();
+        }
+    }
+    if (signalStr.empty())
+    {
+        signalStr = findLineField(executeCommand({"iw", "dev", staInterface_, "link"}), "signal:", 1);
+    }
 
     if (!signalStr.empty())
     {
@@ -1528,23 +1966,35 @@ bool WifiInterface::startAP()
     }
 
     std::cout << "Starting AP mode with enhanced safety measures..." << std::endl;
+    TraceSpan total("startAP", "total");
+    TraceSpan phase("startAP", "routeBackup");
 
     // 保存当前网络状态
-    std::string saveRoute = "route -n > /tmp/route_backup.txt 2>/dev/null";
-    executeCommandWithResult(saveRoute);
+    std::string routeTable = executeCommand({"route", "-n"});
+    std::ofstream routeBackup("/tmp/route_backup.txt");
+    routeBackup << routeTable;
+    routeBackup.close();
 
     // 先检查SSH连接使用的接口
-    std::string sshInterface = "route -n | grep '^0.0.0.0' | awk '{print $8}' | head -1";
-    std::string sshIfResult = executeCommand(sshInterface);
+    std::string sshIfResult;
+    std::istringstream routeStream(routeTable);
+    std::string routeLine;
+    while (std::getline(routeStream, routeLine))
+    {
+        if (routeLine.compare(0, 7, "0.0.0.0") == 0)
+        {
+            sshIfResult = findLineField(routeLine, "0.0.0.0", 7);
+            break;
+        }
+    }
     if (!sshIfResult.empty())
     {
         std::cout << "SSH connection uses interface: " << sshIfResult << std::endl;
     }
 
     // 检查AP接口状态，如果接口未启用则启用它
-    std::string statusCommand = "ifconfig " + apInterface_;
-    std::string statusResult = executeCommand(statusCommand);
-    if (statusResult.find("UP") == std::string::npos)
+    phase.next("interfaceUp");
+    if (!SysProbe::isInterfaceUp(apInterface_))
     {
         std::cout << "AP interface " << apInterface_ << " is not UP, enabling it..." << std::endl;
         if (!enableAPInterface())
@@ -1558,11 +2008,11 @@ bool WifiInterface::startAP()
         std::cout << "AP interface " << apInterface_ << " is already enabled" << std::endl;
     }
 
-    std::string cleanupCommand = "killall -9 hostapd dnsmasq 2 >/dev/null";
-    executeCommandWithResult(cleanupCommand);
+    phase.next("configure");
+    executeCommandWithResult({"killall", "-9", "hostapd", "dnsmasq"});
 
-    std::string rmConfigCommand = "rm -f /etc/hostapd.conf /etc/dnsmasq.conf";
-    executeCommandWithResult(rmConfigCommand);
+    unlink("/etc/hostapd.conf");
+    unlink("/etc/dnsmasq.conf");
 
     if (!configureHostapd(apConfig_))
     {
@@ -1570,8 +2020,7 @@ bool WifiInterface::startAP()
         return false;
     }
     // 先设置AP接口的IP地址
-    std::string ipCommand = "ip addr add 192.168.7.1/24 dev " + apInterface_;
-    if (!executeCommandWithResult(ipCommand))
+    if (!executeCommandWithResult({"ip", "addr", "add", "192.168.7.1/24", "dev", apInterface_}))
     {
         std::cout << "Error: Failed to set IP address for AP interface" << std::endl;
         return false;
@@ -1579,22 +2028,24 @@ bool WifiInterface::startAP()
     std::cout << "IP address 192.168.7.1/24 set for AP interface" << std::endl;
 
     // 启用IP转发
-    std::string ipForwardCommand = "echo 1 > /proc/sys/net/ipv4/ip_forward";
-    executeCommandWithResult(ipForwardCommand);
+    phase.next("forwarding");
+    std::ofstream ipForward("/proc/sys/net/ipv4/ip_forward");
+    ipForward << "1";
+    ipForward.close();
 
-    std::string natCommand = "iptables -t nat -A POSTROUTING -o " + apInterface_ + " -j MASQUERADE";
-    executeCommandWithResult(natCommand);
+    executeCommandWithResult({"iptables", "-t", "nat", "-A", "POSTROUTING", "-o", apInterface_, "-j", "MASQUERADE"});
 
-    std::string forwardRule1 = "iptables -A FORWARD -i " + apInterface_ + " -o eth0 -j ACCEPT";
-    std::string forwardRule2 = "iptables -A FORWARD -i eth0 -o " + apInterface_ + " -m state --state RELATED,ESTABLISHED -j ACCEPT";
-    executeCommandWithResult(forwardRule1);
-    executeCommandWithResult(forwardRule2);
+    executeCommandWithResult({"iptables", "-A", "FORWARD", "-i", apInterface_, "-o", "eth0", "-j", "ACCEPT"});
+    executeCommandWithResult({"iptables", "-A", "FORWARD", "-i", "eth0", "-o", apInterface_,
+                              "-m", "state", "--state", "RELATED,ESTABLISHED", "-j", "ACCEPT"});
 
+    phase.next("dhcpServer");
     if (!startDHCPServer())
     {
         std::cout << "Warning: Failed to start DHCP server, clients will need manual IP configuration" << std::endl;
     }
 
+    phase.next("hostapd");
     if (!startHostapdSafe())
     {
         std::cout << "Error: Failed to start hostapd" << std::endl;
@@ -1602,12 +2053,11 @@ bool WifiInterface::startAP()
         return false;
     }
 
+    phase.next("hostapdSettle");
     sleep(3); // 等待hostapd完全启动
 
     // 检查hostapd是否正常运行
-    std::string checkCommand = "ps | grep hostapd | grep -v grep";
-    std::string checkResult = executeCommand(checkCommand);
-    if (checkResult.empty())
+    if (!isProcessRunning("hostapd"))
     {
         std::cout << "Error: hostapd process not found after startup" << std::endl;
         stopAP();
@@ -1615,9 +2065,9 @@ bool WifiInterface::startAP()
     }
 
     // 检查网络连接状态
-    std::string pingCheck = "ping -c 1 -W 2 8.8.8.8 >/dev/null 2>&1 && echo 'Internet connection: OK' || echo 'Internet connection: Failed'";
-    std::string pingResult = executeCommand(pingCheck);
-    std::cout << pingResult << std::endl;
+    phase.next("internetCheck");
+    bool pingOk = executeCommandWithResult({"ping", "-c", "1", "-W", "2", "8.8.8.8"});
+    std::cout << (pingOk ? "Internet connection: OK" : "Internet connection: Failed") << std::endl;
 
     isAPRunning_ = true;
     std::cout << "AP mode is enabled, interface:" << apInterface_ << std::endl;
@@ -1649,15 +2099,12 @@ bool WifiInterface::startDHCPServer()
     dhcpConfig.close();
 
     // 启动dnsmasq
-    std::string command = "dnsmasq -C /etc/dnsmasq.conf";
-    if (executeCommandWithResult(command))
+    if (executeCommandWithResult({"dnsmasq", "-C", "/etc/dnsmasq.conf"}))
     {
         sleep(2);
 
         // 检查dnsmasq是否运行
-        std::string checkCommand = "ps | grep dnsmasq | grep -v grep";
-        std::string checkResult = executeCommand(checkCommand);
-        if (!checkResult.empty())
+        if (isProcessRunning("dnsmasq"))
         {
             std::cout << "DHCP server started successfully" << std::endl;
             return true;
@@ -1689,6 +2136,7 @@ bool WifiInterface::configureHostapd(const APConfig &config)
     configFile << "# Hostapd configuration file for " << apInterface_ << "\n";
     configFile << "interface=" << apInterface_ << "\n";
     configFile << "driver=nl80211\n";
+    configFile << "ctrl_interface=/var/run/hostapd\n";
     configFile << "ssid=" << config.ssid << "\n";
 
     std::string hw_mode;
@@ -1773,25 +2221,19 @@ bool WifiInterface::startHostapdSafe()
         stopHostapd();
     }
 
-    std::string cleanupCommand = "killall -9 hostapd 2>/dev/null";
-    executeCommandWithResult(cleanupCommand);
+    executeCommandWithResult({"killall", "-9", "hostapd"});
 
-    std::string command = "setsid hostapd /etc/hostapd.conf -B > /dev/null 2>&1";
-    if (executeCommandWithResult(command))
+    if (executeCommandWithResult({"setsid", "hostapd", "/etc/hostapd.conf", "-B"}))
     {
         sleep(3); // 等待hostapd启动
 
         // 检查hostapd是否正常运行
-        std::string checkCommand = "ps | grep hostapd | grep -v grep";
-        std::string checkResult = executeCommand(checkCommand);
-        if (!checkResult.empty())
+        if (isProcessRunning("hostapd"))
         {
             hostapdPid_ = 1; // 标记为正在运行状态
             std::cout << "hostapd started successfully using safe method" << std::endl;
 
-            std::string ifconfig = "ifconfig " + apInterface_;
-            std::string ifconfigResult = executeCommand(ifconfig);
-            if (!ifconfigResult.empty())
+            if (SysProbe::interfaceExists(apInterface_))
             {
                 std::cout << "AP interface " << apInterface_ << " is ready" << std::endl;
             }
@@ -1803,13 +2245,10 @@ bool WifiInterface::startHostapdSafe()
     std::cout << "Error: Failed to start hostapd using safe method" << std::endl;
 
     std::cout << "Trying alternative startup method..." << std::endl;
-    std::string altCommand = "hostapd -B /etc/hostapd.conf";
-    if (executeCommandWithResult(altCommand))
+    if (executeCommandWithResult({"hostapd", "-B", "/etc/hostapd.conf"}))
     {
         sleep(2);
-        std::string checkCommand = "ps | grep hostapd | grep -v grep";
-        std::string checkResult = executeCommand(checkCommand);
-        if (!checkResult.empty())
+        if (isProcessRunning("hostapd"))
         {
             hostapdPid_ = 1;
             std::cout << "hostapd started successfully using alternative method" << std::endl;
@@ -1831,25 +2270,20 @@ bool WifiInterface::startHostapd()
         stopHostapd();
     }
 
-    std::string cleanupCommand = "killall -9 hostapd 2>/dev/null";
-    executeCommandWithResult(cleanupCommand);
+    executeCommandWithResult({"killall", "-9", "hostapd"});
 
-    std::string command = "nohup hostapd /etc/hostapd.conf > /var/log/hostapd.log 2>&1 &";
-    if (executeCommandWithResult(command))
+    if (runner_.spawnDetached({"hostapd", "/etc/hostapd.conf"}, "/var/log/hostapd.log"))
     {
         sleep(2); // 等待hostapd启动
 
         // 检查hostapd是否正常运行
-        std::string checkCommand = "ps | grep hostapd | grep -v grep";
-        std::string checkResult = executeCommand(checkCommand);
-        if (!checkResult.empty())
+        if (isProcessRunning("hostapd"))
         {
             hostapdPid_ = 1; // 标记为正在运行状态
             std::cout << "hostapd started successfully" << std::endl;
 
             // 检查hostapd日志
-            std::string logCheck = "tail -5 /var/log/hostapd.log";
-            std::string logResult = executeCommand(logCheck);
+            std::string logResult = readFileTail("/var/log/hostapd.log", 5);
             if (!logResult.empty())
             {
                 std::cout << "Hostapd log (last 5 lines):" << std::endl;
@@ -1862,8 +2296,7 @@ bool WifiInterface::startHostapd()
 
     std::cout << "Error: Failed to start hostapd" << std::endl;
 
-    std::string errorLog = "cat /var/log/hostapd.log 2>/dev/null | tail -10";
-    std::string errorResult = executeCommand(errorLog);
+    std::string errorResult = readFileTail("/var/log/hostapd.log", 10);
     if (!errorResult.empty())
     {
         std::cout << "Hostapd error log:" << std::endl;
@@ -1879,11 +2312,10 @@ bool WifiInterface::startHostapd()
 bool WifiInterface::stopHostapd()
 {
 #ifndef _WIN32
-    // 先检查hostapd进程是否存在
-    std::string checkCommand = "ps | grep hostapd | grep -v grep";
-    std::string checkResult = executeCommand(checkCommand);
+    hostapd_.close();
 
-    if (checkResult.empty())
+    // 先检查hostapd进程是否存在
+    if (!isProcessRunning("hostapd"))
     {
         // hostapd进程不存在，直接返回成功
         hostapdPid_ = -1;
@@ -1893,14 +2325,12 @@ bool WifiInterface::stopHostapd()
     std::cout << "Stopping hostapd process..." << std::endl;
 
     // 停止hostapd服务
-    std::string command = "killall hostapd 2>/dev/null &";
-    executeCommandWithResult(command);
+    executeCommandWithResult({"killall", "hostapd"});
 
     sleep(1); // 等待进程停止
 
     // 检查进程是否已停止
-    checkResult = executeCommand(checkCommand);
-    if (checkResult.empty())
+    if (!isProcessRunning("hostapd"))
     {
         hostapdPid_ = -1;
         std::cout << "hostapd stopped successfully" << std::endl;
@@ -1909,14 +2339,12 @@ bool WifiInterface::stopHostapd()
 
     // 若无法正常停止，则强制杀死hostapd进程
     std::cout << "Forcing hostapd to stop..." << std::endl;
-    std::string forceCommand = "killall -9 hostapd 2>/dev/null &";
-    executeCommandWithResult(forceCommand);
+    executeCommandWithResult({"killall", "-9", "hostapd"});
 
     sleep(1); // 等待强制停止完成
 
     // 再次检查进程是否已停止
-    checkResult = executeCommand(checkCommand);
-    if (checkResult.empty())
+    if (!isProcessRunning("hostapd"))
     {
         hostapdPid_ = -1;
         std::cout << "hostapd has been forced to stop" << std::endl;
@@ -1941,9 +2369,7 @@ bool WifiInterface::stopAP()
 
     std::cout << "Stopping AP service..." << std::endl;
 
-    // 使用后台进程执行清理命令，避免阻塞
-    std::string killDHCPServer = "killall -9 dnsmasq 2>/dev/null";
-    executeCommandWithResult(killDHCPServer);
+    executeCommandWithResult({"killall", "-9", "dnsmasq"});
 
     // 停止hostapd进程
     if (!stopHostapd())
@@ -1952,17 +2378,14 @@ bool WifiInterface::stopAP()
     }
 
     // 清理IP地址
-    std::string ipCleanup = "ip addr del 192.168.8.1/24 dev " + apInterface_ + " 2>/dev/null &";
-    executeCommandWithResult(ipCleanup);
+    // 使用后台进程执行清理命令，避免阻塞
+    runner_.spawnDetached({"ip", "addr", "del", "192.168.8.1/24", "dev", apInterface_});
 
     // 清理iptables规则
-    std::string cleanupNatRule = "iptables -t nat -D POSTROUTING -o " + apInterface_ + " -j MASQUERADE 2>/dev/null &";
-    std::string cleanupForward1 = "iptables -D FORWARD -i " + apInterface_ + " -o eth0 -j ACCEPT 2>/dev/null &";
-    std::string cleanupForward2 = "iptables -D FORWARD -i eth0 -o " + apInterface_ + " -m state --state RELATED,ESTABLISHED -j ACCEPT 2>/dev/null &";
-
-    executeCommandWithResult(cleanupNatRule);
-    executeCommandWithResult(cleanupForward1);
-    executeCommandWithResult(cleanupForward2);
+    runner_.spawnDetached({"iptables", "-t", "nat", "-D", "POSTROUTING", "-o", apInterface_, "-j", "MASQUERADE"});
+    runner_.spawnDetached({"iptables", "-D", "FORWARD", "-i", apInterface_, "-o", "eth0", "-j", "ACCEPT"});
+    runner_.spawnDetached({"iptables", "-D", "FORWARD", "-i", "eth0", "-o", apInterface_,
+                           "-m", "state", "--state", "RELATED,ESTABLISHED", "-j", "ACCEPT"});
 
     sleep(2); // 等待清理操作完成
 
@@ -2001,24 +2424,26 @@ int WifiInterface::getClientCount()
         return 0;
     }
 
-    // 从hostapd的日志或状态文件中获取客户端连接数量
-    std::string command = "iw dev " + apInterface_ + " station dump | grep Station | wc -l";
-    std::string countStr = executeCommand(command);
+    // 客户端表由hostapd事件增量维护, 只需处理已到达的事件
+    if (openHostapdControl() && hostapd_.processEvents() >= 0)
+    {
+        return static_cast<int>(hostapd_.getStationCount());
+    }
+
+    // 控制接口不可用时回退到iw station dump
+    std::string stationDump = executeCommand({"iw", "dev", apInterface_, "station", "dump"});
 
-    if (!countStr.empty())
+    int count = 0;
+    std::istringstream stream(stationDump);
+    std::string line;
+    while (std::getline(stream, line))
     {
-        try
+        if (line.find("Station") != std::string::npos)
         {
-            countStr.erase(0, countStr.find_first_not_of(" \t\n\r"));
-            countStr.erase(countStr.find_last_not_of(" \t\n\r") + 1);
-            return std::stoi(countStr);
-        }
-        catch (...)
-        {
-            return 0; // 转换失败
+            count++;
         }
     }
-    return 0; // 未找到客户端数量信息
+    return count;
 #else
     return 0;
 #endif // _WIN32
@@ -2034,9 +2459,32 @@ std::vector<ClientInfo> WifiInterface::getConnectedClients()
         return clients;
     }
 
-    // 获取客户端列表
-    std::string command = "iw dev " + apInterface_ + " station dump";
-    std::string clientInfo = executeCommand(command);
+    if (openHostapdControl() && hostapd_.processEvents() >= 0 && hostapd_.refreshStations())
+    {
+        resolveClientAddresses();
+        for (const auto &station : hostapd_.getStations())
+        {
+            ClientInfo client;
+            client.macAddress = station.macAddress;
+            client.signalStrength = station.signalStrength;
+            client.connectedTime = station.connectedTime;
+            client.inactiveMs = station.inactiveMs;
+            client.rxBytes = station.rxBytes;
+            client.txBytes = station.txBytes;
+            client.rxPackets = station.rxPackets;
+            client.txPackets = station.txPackets;
+            client.txBitrateKbps = station.txBitrateKbps;
+            client.rxBitrateKbps = station.rxBitrateKbps;
+            client.ipAddress = station.ipAddress.empty() ? "unknown" : station.ipAddress;
+            client.hostname = station.hostname.empty() ? "unknown" : station.hostname;
+            clients.push_back(client);
+        }
+        recordClientMetrics(clients);
+        return clients;
+    }
+
+    // 控制接口不可用时回退到iw station dump
+    std::string clientInfo = executeCommand({"iw", "dev", apInterface_, "station", "dump"});
 
     if (clientInfo.empty())
     {
@@ -2044,110 +2492,139 @@ std::vector<ClientInfo> WifiInterface::getConnectedClients()
         return clients;
     }
 
-    // 解析客户端信息
-    std::istringstream stream(clientInfo);
-    std::string line;
-    ClientInfo currentClient;
-    bool hasClient = false;
+    // 解析客户端信息(含收发统计和速率)
+    IwStationParser::parse(clientInfo, clients);
 
-    while (std::getline(stream, line))
+    // 为每个客户端获取IP地址和主机名, 邻居表只导出一次
+    std::vector<NeighborEntry> neighbors;
+    if (!clients.empty())
+    {
+        rtnl_.getNeighbors(neighbors);
+    }
+    for (auto &client : clients)
     {
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
+        // 通过邻居表获取IP地址
+        std::string ip = findNeighborIP(neighbors, client.macAddress);
+        client.ipAddress = ip.empty() ? "unknown" : ip;
 
-        if (line.find("Station") == 0)
+        // 主机名解析
+        if (client.ipAddress != "unknown")
         {
-            // 新的客户端开始，保存前一个客户端
-            if (hasClient)
-            {
-                clients.push_back(currentClient);
-                currentClient = ClientInfo();
-                hasClient = false;
-            }
+            std::string hostname = lookupHostname(client.ipAddress);
+            client.hostname = hostname.empty() ? "unknown" : hostname;
+        }
+        else
+        {
+            client.hostname = "unknown";
+        }
+    }
+    recordClientMetrics(clients);
+    return clients;
+#else
+    return std::vector<ClientInfo>();
+#endif // _WIN32
+}
 
-            // 提取MAC地址
-            std::regex macRegex("Station\\s+([0-9a-f:]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, macRegex))
-            {
-                currentClient.macAddress = match[1];
-                hasClient = true;
-            }
+bool WifiInterface::openHostapdControl()
+{
+#ifndef _WIN32
+    if (hostapd_.isOpen())
+    {
+        return true;
+    }
+    return hostapd_.open(apInterface_);
+#else
+    return false;
+#endif // _WIN32
+}
+
+void WifiInterface::resolveClientAddresses()
+{
+#ifndef _WIN32
+    std::vector<NeighborEntry> neighbors;
+    bool neighborsLoaded = false;
+    for (const auto &station : hostapd_.getStations())
+    {
+        // IP地址和主机名只在客户端首次出现时解析
+        if (!station.ipAddress.empty())
+        {
+            continue;
         }
-        else if (line.find("signal:") != std::string::npos)
+        if (!neighborsLoaded)
         {
-            // 提取信号强度
-            std::regex signalRegex("signal:\\s*(-?[0-9]+\\.[0-9]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, signalRegex))
-            {
-                // 将浮点数转换为整数(取整)
-                float signalFloat = std::stof(match[1]);
-                currentClient.signalStrength = static_cast<int>(signalFloat);
-            }
-            else
-            {
-                // 如果没有小数点，则匹配整数
-                std::regex signalRegexInt("signal:\\s*(-?[0-9]+)");
-                std::smatch matchInt;
-                if (std::regex_search(line, matchInt, signalRegexInt))
-                {
-                    currentClient.signalStrength = std::stoi(matchInt[1]);
-                }
-            }
+            rtnl_.getNeighbors(neighbors);
+            neighborsLoaded = true;
         }
-        else if (line.find("connected time:") != std::string::npos)
+        std::string ip = findNeighborIP(neighbors, station.macAddress);
+        if (ip.empty())
         {
-            // 提取连接时间
-            std::regex timeRegex("connected time:\\s*([0-9]+)");
-            std::smatch match;
-            if (std::regex_search(line, match, timeRegex))
-            {
-                currentClient.connectedTime = std::stol(match[1]);
-            }
+            continue; // DHCP尚未完成, 下次查询时再解析
         }
+
+        std::string hostname = lookupHostname(ip);
+        hostapd_.setStationAddress(station.macAddress, ip, hostname.empty() ? "unknown" : hostname);
     }
-    // 保存最后一个客户端
-    if (hasClient)
+#endif // _WIN32
+}
+
+bool WifiInterface::getInterfaceAddress(const std::string &iface, InterfaceAddress &address)
+{
+#ifndef _WIN32
+    int ifindex = static_cast<int>(if_nametoindex(iface.c_str()));
+    std::vector<InterfaceAddress> addresses;
+    if (ifindex == 0 || !rtnl_.getAddresses(addresses))
     {
-        clients.push_back(currentClient);
+        return false;
     }
-    // 为每个客户端获取IP地址和主机名
-    for (auto &client : clients)
+    for (const auto &entry : addresses)
     {
-        // 通过ARP表获取IP地址
-        std::string arpCommand = "arp -a | grep " + client.macAddress + " | awk '{print $2}' | tr -d '()'";
-        std::string ip = executeCommand(arpCommand);
-        if (!ip.empty() && ip.back() == '\n')
+        if (entry.ifindex == ifindex)
         {
-            ip.pop_back();
+            address = entry;
+            return true;
         }
-        client.ipAddress = ip.empty() ? "unknown" : ip;
+    }
+    return false;
+#else
+    return false;
+#endif // _WIN32
+}
 
-        // 主机名解析
-        if (client.ipAddress != "unknown")
-        {
-            std::string hostnameCommand = "nslookup " + client.ipAddress + " | grep 'name =' | awk '{print $4}'";
-            std::string hostname = executeCommand(hostnameCommand);
-            if (!hostname.empty() && hostname.back() == '\n')
-            {
-                hostname.pop_back();
-                hostname.pop_back();
-            }
-            client.hostname = hostname.empty() ? "unknown" : hostname;
-        }
-        else
+std::string WifiInterface::findNeighborIP(const std::vector<NeighborEntry> &neighbors, const MacAddress &macAddress)
+{
+    for (const auto &neighbor : neighbors)
+    {
+        if (neighbor.macAddress == macAddress)
         {
-            client.hostname = "unknown";
+            return neighbor.ipAddress;
         }
     }
-    return clients;
+    return "";
+}
+
+std::string WifiInterface::lookupHostname(const std::string &ipAddress)
+{
+#ifndef _WIN32
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    if (inet_pton(AF_INET, ipAddress.c_str(), &address.sin_addr) != 1)
+    {
+        return "";
+    }
+    char hostname[NI_MAXHOST];
+    if (getnameinfo(reinterpret_cast<struct sockaddr *>(&address), sizeof(address),
+                    hostname, sizeof(hostname), nullptr, 0, NI_NAMEREQD) != 0)
+    {
+        return "";
+    }
+    return hostname;
 #else
-    return std::vector<ClientInfo>();
+    return "";
 #endif // _WIN32
 }
 
-bool WifiInterface::disconnectClient(const std::string &macAddress)
+bool WifiInterface::disconnectClient(const MacAddress &macAddress)
 {
 #ifndef _WIN32
     if (!isAPRunning_)
@@ -2155,16 +2632,19 @@ bool WifiInterface::disconnectClient(const std::string &macAddress)
         return false;
     }
 
-    // 验证MAC地址格式
-    std::regex macRegex("^([0-9A-Fa-f]{2}[:-]){5}([0-9A-Fa-f]{2})$");
-    if (!std::regex_match(macAddress, macRegex))
+    // 全零地址表示调用方传入的地址文本无效
+    if (macAddress.isZero())
     {
-        std::cout << "Invalid MAC address format:" << macAddress << std::endl;
+        std::cout << "Invalid MAC address" << std::endl;
         return false;
     }
 
-    std::string command = "hostapd_cli -i " + apInterface_ + " deauthenticate " + macAddress;
-    return executeCommandWithResult(command);
+    if (!openHostapdControl())
+    {
+        std::cout << "Error: hostapd control interface is not available" << std::endl;
+        return false;
+    }
+    return hostapd_.deauthenticate(macAddress);
 #else
     return false;
 #endif // _WIN32
@@ -2178,17 +2658,10 @@ std::string WifiInterface::getAPIPAddress()
     }
 
     // 获取AP接口的实际IP地址
-    std::string command = "ip addr show " + apInterface_ + " | grep 'inet ' | awk '{print $2}' | cut -d/ -f1";
-    std::string ip = executeCommand(command);
-
-    if (!ip.empty() && ip.back() == '\n')
-    {
-        ip.pop_back();
-    }
-
-    if (!ip.empty())
+    InterfaceAddress address;
+    if (getInterfaceAddress(apInterface_, address))
     {
-        return ip;
+        return address.address;
     }
 
     // 如果未获取到IP地址，返回"unknown"
@@ -2202,14 +2675,13 @@ bool WifiInterface::isAPRunning()
 {
 #ifndef _WIN32
     // 检查hostapd服务是否正在运行
-    std::string command = "pidof hostapd";
-    std::string result = executeCommand(command);
+    if (!probe_.isProcessRunning("hostapd"))
+    {
+        return false;
+    }
 
     // 同时检查AP接口状态
-    std::string interfaceCommand = "ip link show " + apInterface_ + " | grep -q 'state UP'";
-    bool interfaceUp = executeCommandWithResult(interfaceCommand);
-
-    return !result.empty() && interfaceUp;
+    return SysProbe::getOperState(apInterface_) == "up";
 #else
     return true;
 #endif // _WIN32
@@ -4,89 +4,49 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <atomic>
 #include <algorithm>
 #include <ctime>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
 #include <regex>
+#include "WifiTypes.h"
+#include "ProcessRunner.h"
+#include "WpaCtrl.h"
+#include "SupplicantProfile.h"
+#include "HostapdClient.h"
+#include "RtNetlink.h"
+#include "AddressWatcher.h"
+#include "DhcpClient.h"
+#include "SysProbe.h"
+#include "IwScanParser.h"
+#include "IwStationParser.h"
+#include "ScanTable.h"
+#include "ScanService.h"
+#include "ScanBroker.h"
+#include "SightingStore.h"
+#include "WpaPsk.h"
+#include "PhaseTracer.h"
+#include "ConnectionHistory.h"
+#include "RoamManager.h"
+#include "LinkMonitor.h"
+#include "MetricStore.h"
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <unistd.h>
 #include <sys/wait.h>
+#include <sys/stat.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <net/if.h>
+#include <netdb.h>
 #endif // _WIN32
 
-enum class WifiMode
-{
-    WIFI_MODE_STA = 0,    // 仅STA模式
-    WIFI_MODE_AP = 1,     // 仅AP模式
-    WIFI_MODE_AP_STA = 2, // AP+STA双模式
-    WIFI_MODE_ALL_OFF = 3 // 所有模式关闭
-};
-
-// WiFi加密模式
-enum class SecurityMode
-{
-    OPEN = 0,        // 开放网络
-    WEP = 1,         // WEP加密
-    WPA_PSK = 2,     // WPA-PSK
-    WPA2_PSK = 3,    // WPA2-PSK
-    WPA_WPA2_PSK = 4 // WPA/WPA2混合
-};
-
-struct NetworkInfo
-{
-    std::string ssid;
-    int signalStrength; // 信号强度(dBm)
-    SecurityMode security;
-    int channel;
-    bool isHidden;
-    std::string bssid;    // MAC地址
-    int frequency;        // 频率(MHz)
-    bool autoConnect;     // 是否自动连接
-    std::string password; // 保存的密码
-};
-
-struct ClientInfo
-{
-    std::string macAddress;
-    std::string ipAddress;
-    int signalStrength;
-    std::string hostname;
-    long connectedTime; // 连接时间(秒)
-};
-
-struct StaticIPConfig
-{
-    std::string ipAddress;  // IP地址 (如: "192.168.1.100")
-    std::string subnetMask; // 子网掩码 (如: "255.255.255.0")
-    std::string gateway;    // 网关地址 (如: "192.168.1.1")
-
-    StaticIPConfig() : subnetMask("255.255.255.0") {}
-};
-
-struct APConfig
-{
-    std::string ssid;
-    std::string password;
-    int channel;
-    SecurityMode security;
-    int maxClients; // 最大客户端数量(1-5)
-};
-
-enum class ConnectionStatus
-{
-    DISCONNECTED = 0,
-    CONNECTING = 1,
-    CONNECTED = 2,
-    DISCONNECTING = 3,
-    CONNECTION_FAILED = 4
-};
-
 class WifiInterface
 {
 public:
@@ -119,11 +79,90 @@ public:
     bool scanNetworks();
 
     /**
-     * 获取扫描结果列表
+     * 获取扫描结果列表(每个未保存的SSID取信号最强的BSS, 兼容接口, 每次调用都会复制)
      * @return 网络信息列表
      */
     std::vector<NetworkInfo> getScanResults();
 
+    /**
+     * 获取最近一次扫描的完整BSS表(只读, 不复制; 下次扫描前有效)
+     * @return 扫描表
+     */
+    const ScanTable &getScanTable() const { return scanTable_; }
+
+    /**
+     * 启动后台扫描: 按配置的间隔扫描STA接口, 维护老化BSS表并发布BSS变化事件
+     * @param config 扫描间隔/老化时间/信号变化阈值
+     * @return 成功返回true
+     */
+    bool startBackgroundScan(const ScanServiceConfig &config = ScanServiceConfig());
+
+    /**
+     * 停止后台扫描(等待正在进行的扫描结束)
+     */
+    void stopBackgroundScan();
+
+    /**
+     * 后台扫描服务, 用于订阅BSS事件和读取老化BSS表
+     * @return 扫描服务
+     */
+    ScanService &getScanService() { return scanService_; }
+
+    /**
+     * 扫描请求统计(缓存命中/内核缓存命中/主动扫描/合并次数)
+     * @return 统计信息
+     */
+    ScanBrokerStats getScanStats() const { return scanBroker_.getStats(); }
+
+    /**
+     * 启动漫游: 信号持续低于阈值时扫描同一SSID的其他AP, 找到明显更强的AP后经wpa_supplicant漫游
+     * @param config 阈值/迟滞/采样间隔
+     * @return 成功返回true
+     */
+    bool startRoaming(const RoamConfig &config = RoamConfig());
+
+    /**
+     * 停止漫游(等待正在进行的扫描/漫游结束)
+     */
+    void stopRoaming();
+
+    /**
+     * 漫游管理, 用于读取候选AP和漫游统计(次数/耗时)
+     * @return 漫游管理
+     */
+    RoamManager &getRoamManager() { return roamManager_; }
+
+    /**
+     * 启动链路质量监测: 按采样间隔读取关联AP的信号/速率/重传/信标丢失并维护平滑统计
+     * @param config 采样间隔/EWMA权重/百分位数窗口
+     * @return 成功返回true
+     */
+    bool startLinkMonitor(const LinkMonitorConfig &config = LinkMonitorConfig());
+
+    /**
+     * 停止链路质量监测(最后的快照保留)
+     */
+    void stopLinkMonitor();
+
+    /**
+     * 链路质量监测, snapshot()无锁读取最近的统计
+     * @return 链路监测
+     */
+    LinkMonitor &getLinkMonitor() { return linkMonitor_; }
+
+    /**
+     * 设置指标历史存储: 链路监测的每次采样记录到"bss/<bssid>/signal|txrate|retries|beaconloss",
+     * getConnectedClients()读取到的客户端记录到"client/<mac>/signal|txrate"
+     * @param store 存储, 为nullptr时不再记录; 生命周期须长于WifiInterface. 可在链路监测运行时调用
+     */
+    void setMetricStore(MetricStore *store);
+
+    /**
+     * 最近一次连接中DHCP获得地址的耗时(从启动udhcpc到地址写入接口)
+     * @return 毫秒, 尚未通过DHCP获得地址时返回-1
+     */
+    int getDhcpLatencyMs() const { return dhcpLatencyMs_; }
+
     /**
      * 连接指定的WiFi网络
      * @param ssid 网络名称
@@ -221,7 +260,7 @@ public:
     std::string getMACAddress();
 
     /**
-     * 获取信号强度
+     * 获取信号强度, 链路监测运行时直接读取最近的快照
      * @return 信号强度(dBm)
      */
     int getSignalStrength();
@@ -277,7 +316,7 @@ public:
      * @param macAddress 客户端MAC地址
      * @return 成功返回true，失败返回false
      */
-    bool disconnectClient(const std::string &macAddress);
+    bool disconnectClient(const MacAddress &macAddress);
 
     /**
      * 获取AP的IP地址
@@ -305,25 +344,74 @@ private:
     APConfig apConfig_;
     NetworkInfo currentNetwork_;
     std::vector<NetworkInfo> savedNetworks_;
-    std::vector<NetworkInfo> scanResults_;
+    ScanTable scanTable_; // 最近一次扫描的全部BSS
     std::vector<ClientInfo> connectedClients_;
     bool isAPRunning_;
     pid_t wpaSupplicantPid_;
     pid_t hostapdPid_;
     std::map<std::string, std::string> savedPasswords_; // 保存wifi密码
     std::map<std::string, bool> autoConnectNetworks_;   // 自动连接设置
+    SightingStore sightings_;                           // 已保存网络最近出现的频率/BSSID
+    std::map<std::string, std::string> savedPsks_;      // 由保存的口令预先计算的PSK(64位十六进制)
+    std::map<std::string, DhcpLease> leases_;           // 各网络最近的DHCP租约, 用于INIT-REBOOT
+    std::string leaseSsid_;                             // dhcpRenewer_维护的租约所属网络
+    std::string udhcpcScript_;                          // 记录租约的udhcpc事件脚本, 为空时使用默认脚本
+    ConnectionHistory history_;                         // 各SSID/BSSID的连接结果, 自动连接时排序候选
 
     StaticIPConfig staticIPConfig_;
     bool useStaticIP_;
+    int dhcpLatencyMs_;    // 最近一次DHCP获得地址的耗时
+    ProcessRunner runner_; // 命令执行器(不经过shell)
+    WpaCtrl wpaCtrl_;      // wpa_supplicant控制接口
+    SupplicantProfile supplicant_; // 常驻wpa_supplicant中的已保存网络
+    HostapdClient hostapd_; // hostapd控制接口, 增量维护AP客户端表
+    RtNetlink rtnl_;        // 地址/路由/邻居表查询
+    SysProbe probe_;        // sysfs/procfs状态探测
+    InterfaceScanSource staScanSource_; // STA接口扫描(前台和后台扫描共用)
+    SteadyScanClock scanClock_;
+    ScanBroker scanBroker_;             // 扫描结果缓存, 合并并发的扫描请求
+    ScanEventWatcher scanWatcher_;      // 把wpa_supplicant等发起的全信道扫描告诉scanBroker_
+    ScanService scanService_;           // 后台扫描服务(经由scanBroker_扫描)
+    DhcpRenewer dhcpRenewer_;           // INIT-REBOOT重连后代替udhcpc续约
+    SupplicantRoamLink roamLink_;       // 漫游线程专用的wpa_supplicant控制连接
+    RoamManager roamManager_;           // 同一SSID多个AP之间的漫游(经由scanBroker_扫描)
+    StationLinkSource linkSource_;      // 链路监测线程专用的nl80211套接字/控制连接
+    LinkMonitor linkMonitor_;           // 高频链路质量采样
+    std::atomic<MetricStore *> metricStore_; // 指标历史, 未设置时为nullptr; 链路监测线程也会读取
+    uint32_t recordedSamples_[LINK_METRIC_COUNT]; // 各链路指标已记录的样本数, 只在链路监测线程访问
 
-    std::string executeCommand(const std::string &command);
-    bool executeCommandWithResult(const std::string &command);
     /*
-     * 解码十六进制字符串,解决中文编码问题
-     * @param hexString 十六进制字符串
-     * @return 解码后的字符串
+     * 链路监测采样回调, 把本次更新了的指标写入metricStore_
+     */
+    static void recordLinkSample(const LinkSnapshot &snapshot, void *context);
+    /*
+     * 把客户端的信号和发送速率写入metricStore_
      */
-    std::string decodeHexString(const std::string &hexString);
+    void recordClientMetrics(const std::vector<ClientInfo> &clients);
+
+    std::string executeCommand(const std::vector<std::string> &argv, int timeoutMs = -1);
+    bool executeCommandWithResult(const std::vector<std::string> &argv, int timeoutMs = -1);
+    /*
+     * 检查是否存在指定名称的进程(读取/proc, 不启动ps)
+     * @param name 进程名称
+     * @return 存在返回true
+     */
+    bool isProcessRunning(const std::string &name);
+    /*
+     * 查找第一行包含pattern的文本行, 返回其中按空白分隔的第fieldIndex个字段(从0开始)
+     * @param text 命令输出
+     * @param pattern 匹配字符串
+     * @param fieldIndex 字段序号
+     * @return 字段内容, 未找到返回空字符串
+     */
+    static std::string findLineField(const std::string &text, const std::string &pattern, size_t fieldIndex);
+    /*
+     * 读取文件最后若干行
+     * @param path 文件路径
+     * @param lineCount 行数
+     * @return 文件末尾内容
+     */
+    static std::string readFileTail(const std::string &path, size_t lineCount);
 
     bool enableInterface(const std::string &iface);
     bool disableInterface(const std::string &iface);
@@ -332,24 +420,101 @@ private:
     bool disableSTAInterface();
     bool disableAPInterface();
     /*
-     * 解析扫描结果并过滤已保存网络
-     * @param scanOutput 扫描输出
-     * @return 过滤后的网络列表（不包括已保存的）
+     * 获取STA接口的扫描结果并填充扫描表, 已保存的SSID标记为kScanSaved.
+     * 结果不超过maxAgeMs时复用缓存, 否则扫描(优先nl80211, 不可用时解析iw输出)
+     * @param table 扫描表(先清空)
+     * @param maxAgeMs 能接受的最大结果年龄(毫秒), 0表示必须扫描
+     * @return 成功返回true
      */
-    bool parseScanResults(const std::string &scanOutput);
-    /**
-     * 解析扫描结果但不进行已保存网络过滤
-     * @param scanOutput 扫描输出
-     * @return 所有网络列表（包括已保存的）
+    bool scanInto(ScanTable &table, int maxAgeMs);
+    /*
+     * 标记扫描表中的已保存网络(kScanSaved)并更新其出现位置, 位置变化时写回配置文件
+     * @param table 扫描表
+     */
+    void markSavedNetworks(ScanTable &table);
+    /*
+     * 从扫描表中取出在范围内的已保存网络(带自动连接设置和信号强度)
+     * @param table 扫描表
+     * @param networks 结果
+     */
+    void collectSavedNetworks(const ScanTable &table, std::vector<NetworkInfo> &networks) const;
+    /*
+     * 只在自动连接网络最近出现过的频率上定向扫描, 并探测这些SSID(可以发现隐藏网络)
+     * @param networks 在范围内的已保存网络
+     * @return 没有频率记录、扫描失败或未找到任何网络时返回false
+     */
+    bool scanSavedNetworkChannels(std::vector<NetworkInfo> &networks);
+    /*
+     * 连接STA接口的wpa_supplicant控制接口(已连接时直接返回), 不订阅事件, 需要事件时由调用者attach()
+     * @param waitMs 等待控制接口套接字出现的时间(毫秒)
+     * @return 成功返回true，失败返回false
+     */
+    bool openWpaControl(int waitMs = 0);
+    /*
+     * 等待wpa_supplicant报告连接结果(未订阅事件时先订阅, 调用者应在SELECT_NETWORK之前订阅, 返回前取消订阅)
+     * @param ssid 目标网络, 已关联到该网络时直接返回CONNECTED
+     * @param timeoutMs 超时时间(毫秒)
+     * @return CONNECTED/CONNECTION_FAILED, 超时返回CONNECTING
+     */
+    ConnectionStatus waitForWpaConnection(const std::string &ssid, int timeoutMs);
+    /*
+     * 写入包含全部已保存网络的配置文件并启动wpa_supplicant
      */
-    std::vector<NetworkInfo> parseScanResultsWithoutFiltering(const std::string &scanOutput);
     bool startWpaSupplicant();
     bool stopWpaSupplicant();
+    /*
+     * 确保wpa_supplicant在运行且网络表已同步: 已在运行时直接复用, 否则启动
+     * @return 成功返回true，失败返回false
+     */
+    bool ensureWpaSupplicant();
+    /*
+     * 由已保存的设置生成wpa_supplicant网络配置(自动连接的网络启用并优先)
+     * @param ssid 网络名称
+     * @param password 密码
+     * @return 网络配置
+     */
+    SupplicantNetwork buildSupplicantNetwork(const std::string &ssid, const std::string &password) const;
+    /*
+     * 写入wpa_supplicant的密钥: 口令换成PSK(已保存的直接复用, 否则现场计算), 其他原样返回
+     * @param ssid 网络名称
+     * @param password 密码
+     * @return 64位十六进制PSK或原密码
+     */
+    std::string resolvePsk(const std::string &ssid, const std::string &password) const;
+    /*
+     * 连接AP接口的hostapd控制接口(已连接时直接返回)
+     * @return 成功返回true，失败返回false
+     */
+    bool openHostapdControl();
+    /*
+     * 查询接口的第一个IPv4地址
+     * @param iface 接口名称
+     * @param address 地址信息
+     * @return 找到返回true
+     */
+    bool getInterfaceAddress(const std::string &iface, InterfaceAddress &address);
+    /*
+     * 在邻居表中按MAC地址查找IP地址
+     * @param neighbors 邻居表
+     * @param macAddress MAC地址
+     * @return IP地址, 未找到返回空字符串
+     */
+    static std::string findNeighborIP(const std::vector<NeighborEntry> &neighbors, const MacAddress &macAddress);
+    /*
+     * 反向解析IP地址对应的主机名
+     * @param ipAddress IP地址
+     * @return 主机名, 解析失败返回空字符串
+     */
+    static std::string lookupHostname(const std::string &ipAddress);
+    /*
+     * 为尚未解析的客户端查询IP地址和主机名(邻居表只导出一次)
+     */
+    void resolveClientAddresses();
     bool startHostapd();
     bool startHostapdSafe();
     bool stopHostapd();
     bool startDHCPServer();
-    bool configureWpaSupplicant(const std::string &ssid, const std::string &password);
+    bool configureWpaSupplicant();
     bool configureHostapd(const APConfig &config);
     bool getInterfaceStatus();
 
@@ -357,6 +522,63 @@ private:
     bool validateMaxClients(int maxClients);
     void saveNetworkConfig();
     void loadNetworkConfig();
+    /*
+     * 已保存租约的持久化(/etc/wifi_leases.conf)
+     */
+    void saveLeaseCache();
+    void loadLeaseCache();
+    /*
+     * 连接历史的持久化(/etc/wifi_history.conf)
+     */
+    void saveConnectionHistory();
+    void loadConnectionHistory();
+    /*
+     * 记录一次连接尝试的结果并写回连接历史
+     * @param ssid 网络名称
+     * @param bssid 尝试的AP
+     * @param failure 失败阶段, 成功为NONE
+     * @param rssi 扫描到的信号强度(dBm), 0表示未知
+     * @param start 本次连接开始的时间
+     */
+    void recordConnectAttempt(const std::string &ssid, const MacAddress &bssid, ConnectFailure failure, int rssi,
+                              std::chrono::steady_clock::time_point start);
+    /*
+     * 连接网络, 连接历史记在调用方选定的候选AP上(关联后换成实际的AP)
+     * @param bssid 候选AP, 零地址表示未知(历史只按SSID参考)
+     * @param rssi 候选AP扫描到的信号强度(dBm), 0表示未知
+     */
+    bool connectToCandidate(const std::string &ssid, const std::string &password, const MacAddress &bssid, int rssi);
+    /*
+     * 以保存的租约INIT-REBOOT: 发送请求后先应用原地址, ACK后启动续约;
+     * NAK时删除该租约, NAK或超时时撤销地址
+     * @param ssid 网络名称
+     * @param ifindex STA接口索引
+     * @param bssid 当前关联的AP
+     * @param lease 确认后的租约
+     * @return 成功返回true, 失败时调用方走完整DHCP
+     */
+    bool rejoinWithCachedLease(const std::string &ssid, int ifindex, const MacAddress &bssid, DhcpLease &lease);
+    /*
+     * 通过rtnetlink应用租约的地址/网关, 并写入DNS服务器
+     */
+    bool applyLease(int ifindex, const DhcpLease &lease);
+    /*
+     * 从udhcpc事件脚本写入的租约文件记录租期和服务器标识(不再向服务器查询)
+     */
+    void learnLease(const std::string &ssid, const MacAddress &bssid, const std::string &address);
+    /*
+     * 安装记录租约的udhcpc事件脚本, 找不到默认脚本时不安装(udhcpc使用默认脚本, 不记录租约)
+     */
+    void installUdhcpcScript();
+    /*
+     * 完整DHCP的udhcpc命令(后台运行, 带事件脚本)
+     */
+    std::vector<std::string> udhcpcCommand() const;
+    /*
+     * 停止续约线程并保存续约后的租约
+     */
+    void stopLeaseRenewal();
+    static void onLeaseLost(const DhcpLease &lease, void *context);
     bool saveAPConfig();
     bool loadAPConfig();
 };
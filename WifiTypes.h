@@ -0,0 +1,112 @@
+#ifndef WIFI_TYPES_H
+#define WIFI_TYPES_H
+
+#include <string>
+#include <vector>
+#include "MacAddress.h"
+
+enum class WifiMode
+{
+    WIFI_MODE_STA = 0,    // 仅STA模式
+    WIFI_MODE_AP = 1,     // 仅AP模式
+    WIFI_MODE_AP_STA = 2, // AP+STA双模式
+    WIFI_MODE_ALL_OFF = 3 // 所有模式关闭
+};
+
+// WiFi加密模式
+enum class SecurityMode
+{
+    OPEN = 0,        // 开放网络
+    WEP = 1,         // WEP加密
+    WPA_PSK = 2,     // WPA-PSK
+    WPA2_PSK = 3,    // WPA2-PSK
+    WPA_WPA2_PSK = 4 // WPA/WPA2混合
+};
+
+struct NetworkInfo
+{
+    std::string ssid;
+    int signalStrength; // 信号强度(dBm)
+    SecurityMode security;
+    int channel;
+    bool isHidden;
+    MacAddress bssid;     // MAC地址
+    int frequency;        // 频率(MHz)
+    bool autoConnect;     // 是否自动连接
+    std::string password; // 保存的密码
+    int ageMs;            // 距内核最近一次收到该BSS的时间(毫秒)
+
+    NetworkInfo()
+        : signalStrength(0), security(SecurityMode::OPEN), channel(0), isHidden(false),
+          frequency(0), autoConnect(false), ageMs(0) {}
+};
+
+// 定向扫描参数, 两项都为空时等同于全信道扫描
+struct ScanParams
+{
+    std::vector<int> frequencies;   // 只扫描这些频率(MHz)
+    std::vector<std::string> ssids; // 发送携带这些SSID的探测请求(可以发现隐藏网络)
+
+    bool empty() const { return frequencies.empty() && ssids.empty(); }
+};
+
+// 已保存网络最近一次被扫描到的位置, 重连时只在这些频率上定向扫描
+struct NetworkSighting
+{
+    std::vector<int> frequencies;   // 频率(MHz), 信号强的在前
+    std::vector<MacAddress> bssids; // BSSID, 信号强的在前
+};
+
+struct ClientInfo
+{
+    MacAddress macAddress;
+    std::string ipAddress;
+    int signalStrength;
+    std::string hostname;
+    long connectedTime; // 连接时间(秒)
+    long inactiveMs;    // 空闲时间(毫秒)
+    unsigned long long rxBytes;
+    unsigned long long txBytes;
+    unsigned long rxPackets;
+    unsigned long txPackets;
+    unsigned long txRetries;        // 重传次数
+    unsigned long txFailed;         // 发送失败次数
+    unsigned long beaconLoss;       // 检测到信标丢失的次数(STA模式)
+    long txBitrateKbps;             // 最近一次发送速率(kbit/s)
+    long rxBitrateKbps;             // 最近一次接收速率(kbit/s)
+    long expectedThroughputKbps;    // 驱动估计的可用吞吐量(kbit/s), 不支持时为0
+
+    ClientInfo()
+        : signalStrength(0), connectedTime(0), inactiveMs(0), rxBytes(0), txBytes(0),
+          rxPackets(0), txPackets(0), txRetries(0), txFailed(0), beaconLoss(0),
+          txBitrateKbps(0), rxBitrateKbps(0), expectedThroughputKbps(0) {}
+};
+
+struct StaticIPConfig
+{
+    std::string ipAddress;  // IP地址 (如: "192.168.1.100")
+    std::string subnetMask; // 子网掩码 (如: "255.255.255.0")
+    std::string gateway;    // 网关地址 (如: "192.168.1.1")
+
+    StaticIPConfig() : subnetMask("255.255.255.0") {}
+};
+
+struct APConfig
+{
+    std::string ssid;
+    std::string password;
+    int channel;
+    SecurityMode security;
+    int maxClients; // 最大客户端数量(1-5)
+};
+
+enum class ConnectionStatus
+{
+    DISCONNECTED = 0,
+    CONNECTING = 1,
+    CONNECTED = 2,
+    DISCONNECTING = 3,
+    CONNECTION_FAILED = 4
+};
+
+#endif // WIFI_TYPES_H
@@ -0,0 +1,284 @@
+#include "WpaCtrl.h"
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif // _WIN32
+
+#ifndef _WIN32
+namespace
+{
+const size_t kMaxMessageSize = 4096 * 4; // SCAN_RESULTS等大响应的上限
+
+std::atomic<int> gClientCounter(0);
+
+long long monotonicMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool fillAddress(const std::string &path, struct sockaddr_un &addr)
+{
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+} // namespace
+#endif // _WIN32
+
+WpaCtrl::WpaCtrl(const std::string &clientDir)
+    : clientDir_(clientDir), fd_(-1), attached_(false)
+{
+}
+
+WpaCtrl::~WpaCtrl()
+{
+    close();
+}
+
+bool WpaCtrl::open(const std::string &socketPath)
+{
+#ifndef _WIN32
+    close();
+
+    struct sockaddr_un local;
+    struct sockaddr_un dest;
+    localPath_ = clientDir_ + "/wpa_ctrl_" + std::to_string(getpid()) + "-" + std::to_string(++gClientCounter);
+    if (!fillAddress(localPath_, local) || !fillAddress(socketPath, dest))
+    {
+        std::cout << "Control socket path too long: " << socketPath << std::endl;
+        localPath_.clear();
+        return false;
+    }
+
+    fd_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+    {
+        localPath_.clear();
+        return false;
+    }
+
+    // 服务端通过本地地址回复, 必须先bind
+    unlink(localPath_.c_str());
+    if (bind(fd_, reinterpret_cast<struct sockaddr *>(&local), sizeof(local)) < 0 ||
+        connect(fd_, reinterpret_cast<struct sockaddr *>(&dest), sizeof(dest)) < 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+        unlink(localPath_.c_str());
+        localPath_.clear();
+        return false;
+    }
+
+    socketPath_ = socketPath;
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+void WpaCtrl::close()
+{
+#ifndef _WIN32
+    if (fd_ < 0)
+    {
+        return;
+    }
+    if (attached_)
+    {
+        detach();
+    }
+    ::close(fd_);
+    fd_ = -1;
+    unlink(localPath_.c_str());
+    localPath_.clear();
+    socketPath_.clear();
+    events_.clear();
+    attached_ = false;
+#endif // _WIN32
+}
+
+bool WpaCtrl::request(const std::string &command, std::string &reply, int timeoutMs)
+{
+#ifndef _WIN32
+    reply.clear();
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    if (send(fd_, command.data(), command.size(), 0) < 0)
+    {
+        return false;
+    }
+
+    long long deadline = monotonicMs() + timeoutMs;
+    while (true)
+    {
+        long long remaining = deadline - monotonicMs();
+        std::string message;
+        if (remaining < 0 || !receive(message, static_cast<int>(remaining)))
+        {
+            return false;
+        }
+        // 已ATTACH时, 响应前可能先收到异步事件
+        if (attached_ && isEventMessage(message))
+        {
+            events_.push_back(stripEventLevel(message));
+            continue;
+        }
+        reply = message;
+        return true;
+    }
+#else
+    reply.clear();
+    return false;
+#endif // _WIN32
+}
+
+bool WpaCtrl::attach()
+{
+#ifndef _WIN32
+    std::string reply;
+    if (!request("ATTACH", reply) || reply.compare(0, 2, "OK") != 0)
+    {
+        return false;
+    }
+    attached_ = true;
+    return true;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool WpaCtrl::detach()
+{
+#ifndef _WIN32
+    std::string reply;
+    bool ok = request("DETACH", reply, 500) && reply.compare(0, 2, "OK") == 0;
+    attached_ = false;
+    return ok;
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool WpaCtrl::waitEvent(std::string &event, int timeoutMs)
+{
+#ifndef _WIN32
+    event.clear();
+    if (!events_.empty())
+    {
+        event = events_.front();
+        events_.pop_front();
+        return true;
+    }
+    if (fd_ < 0)
+    {
+        return false;
+    }
+
+    long long deadline = monotonicMs() + timeoutMs;
+    while (true)
+    {
+        long long remaining = deadline - monotonicMs();
+        std::string message;
+        if (!receive(message, remaining < 0 ? 0 : static_cast<int>(remaining)))
+        {
+            return false;
+        }
+        // 忽略迟到的命令响应
+        if (isEventMessage(message))
+        {
+            event = stripEventLevel(message);
+            return true;
+        }
+    }
+#else
+    event.clear();
+    return false;
+#endif // _WIN32
+}
+
+bool WpaCtrl::receive(std::string &message, int timeoutMs)
+{
+#ifndef _WIN32
+    struct pollfd pfd;
+    pfd.fd = fd_;
+    pfd.events = POLLIN;
+    long long deadline = monotonicMs() + timeoutMs;
+    while (true)
+    {
+        long long remaining = deadline - monotonicMs();
+        int ready = poll(&pfd, 1, remaining < 0 ? 0 : static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (ready <= 0)
+        {
+            return false;
+        }
+
+        char buffer[kMaxMessageSize];
+        ssize_t n = recv(fd_, buffer, sizeof(buffer), 0);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            return false;
+        }
+        message.assign(buffer, static_cast<size_t>(n));
+        return true;
+    }
+#else
+    return false;
+#endif // _WIN32
+}
+
+bool WpaCtrl::isEventMessage(const std::string &message)
+{
+    // 事件格式: "<级别>内容", 如 "<3>CTRL-EVENT-CONNECTED - Connection to ..."
+    return message.size() > 2 && message[0] == '<' && message.find('>') != std::string::npos;
+}
+
+std::string WpaCtrl::stripEventLevel(const std::string &message)
+{
+    size_t end = message.find('>');
+    return end == std::string::npos ? message : message.substr(end + 1);
+}
+
+std::string WpaCtrl::getValue(const std::string &reply, const std::string &key)
+{
+    size_t pos = 0;
+    while (pos < reply.size())
+    {
+        size_t end = reply.find('\n', pos);
+        if (end == std::string::npos)
+        {
+            end = reply.size();
+        }
+        if (end - pos > key.size() && reply.compare(pos, key.size(), key) == 0 && reply[pos + key.size()] == '=')
+        {
+            size_t valueStart = pos + key.size() + 1;
+            return reply.substr(valueStart, end - valueStart);
+        }
+        pos = end + 1;
+    }
+    return "";
+}
@@ -0,0 +1,122 @@
+#ifndef WPA_CTRL_H
+#define WPA_CTRL_H
+
+#include <string>
+#include <deque>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif // _WIN32
+
+/*
+ * wpa_supplicant/hostapd 控制接口客户端
+ * 通过UNIX数据报套接字与控制接口通信(协议与wpa_ctrl.c一致),
+ * 支持请求/响应命令以及ATTACH后的异步事件接收
+ */
+class WpaCtrl
+{
+public:
+    /**
+     * @param clientDir 本地套接字所在目录, 测试时可指向临时目录
+     */
+    explicit WpaCtrl(const std::string &clientDir = "/tmp");
+    ~WpaCtrl();
+
+    /**
+     * 连接控制接口
+     * @param socketPath 控制接口套接字路径(如 /var/run/wpa_supplicant/wlan0)
+     * @return 成功返回true，失败返回false
+     */
+    bool open(const std::string &socketPath);
+
+    /**
+     * 关闭连接(已ATTACH时先发送DETACH)
+     */
+    void close();
+
+    /**
+     * 判断是否已连接
+     * @return 已连接返回true
+     */
+    bool isOpen() const { return fd_ >= 0; }
+
+    /**
+     * 获取当前连接的控制接口路径
+     * @return 套接字路径, 未连接时为空
+     */
+    std::string getSocketPath() const { return socketPath_; }
+
+    /**
+     * 发送命令并等待响应, 等待期间收到的异步事件放入事件队列
+     * @param command 命令(如 STATUS、SIGNAL_POLL、SCAN_RESULTS)
+     * @param reply 响应内容
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 收到响应返回true, 超时或连接失败返回false
+     */
+    bool request(const std::string &command, std::string &reply, int timeoutMs = 2000);
+
+    /**
+     * 订阅异步事件(ATTACH)
+     * @return 成功返回true，失败返回false
+     */
+    bool attach();
+
+    /**
+     * 取消订阅异步事件(DETACH)
+     * @return 成功返回true，失败返回false
+     */
+    bool detach();
+
+    /**
+     * 等待下一条异步事件
+     * @param event 事件内容(已去除 "<N>" 级别前缀)
+     * @param timeoutMs 超时时间(毫秒), 0表示只取已到达的事件
+     * @return 收到事件返回true, 超时返回false
+     */
+    bool waitEvent(std::string &event, int timeoutMs);
+
+    /**
+     * 判断是否已订阅异步事件
+     * @return 已订阅返回true
+     */
+    bool isAttached() const { return attached_; }
+
+    /**
+     * 从 "key=value" 多行响应(STATUS、SIGNAL_POLL等)中取出指定字段
+     * @param reply 命令响应
+     * @param key 字段名
+     * @return 字段值, 不存在时返回空字符串
+     */
+    static std::string getValue(const std::string &reply, const std::string &key);
+
+    /**
+     * 获取套接字描述符, 用于外部poll
+     * @return 套接字描述符, 未连接时为-1
+     */
+    int getFd() const { return fd_; }
+
+private:
+    std::string clientDir_;
+    std::string socketPath_;
+    std::string localPath_;
+    int fd_;
+    bool attached_;
+    std::deque<std::string> events_; // 请求过程中收到的待处理事件
+
+    /*
+     * 接收一条消息
+     * @param message 消息内容
+     * @param timeoutMs 超时时间(毫秒)
+     * @return 收到消息返回true
+     */
+    bool receive(std::string &message, int timeoutMs);
+    static bool isEventMessage(const std::string &message);
+    static std::string stripEventLevel(const std::string &message);
+
+    WpaCtrl(const WpaCtrl &);
+    WpaCtrl &operator=(const WpaCtrl &);
+};
+
+#endif // WPA_CTRL_H
@@ -0,0 +1,551 @@
+#include "WpaPsk.h"
+
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+const size_t kLanes = 4;
+const size_t kDigestLength = 20;
+const size_t kBlockLength = 64;
+// 迭代中被压缩的消息为 64字节密钥块 + 20字节摘要, 填充后的长度字段(位)
+const uint32_t kIterationBits = (kBlockLength + kDigestLength) * 8;
+
+const uint32_t kSha1Init[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+const uint32_t kSha1K[4] = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+
+inline uint32_t rotl(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+inline uint32_t loadBigEndian(const uint8_t *p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+inline void storeBigEndian(uint8_t *p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+void sha1Compress(uint32_t state[5], const uint32_t block[16])
+{
+    uint32_t w[16];
+    memcpy(w, block, sizeof(w));
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for (int i = 0; i < 80; i++)
+    {
+        if (i >= 16)
+        {
+            w[i & 15] = rotl(w[(i - 3) & 15] ^ w[(i - 8) & 15] ^ w[(i - 14) & 15] ^ w[i & 15], 1);
+        }
+        uint32_t f;
+        if (i < 20)
+        {
+            f = d ^ (b & (c ^ d));
+        }
+        else if (i < 40 || i >= 60)
+        {
+            f = b ^ c ^ d;
+        }
+        else
+        {
+            f = (b & c) | (d & (b | c));
+        }
+        uint32_t temp = rotl(a, 5) + f + e + kSha1K[i / 20] + w[i & 15];
+        e = d;
+        d = c;
+        c = rotl(b, 30);
+        b = a;
+        a = temp;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+/*
+ * 流式SHA1, 可以从HMAC预先计算的中间状态继续
+ */
+class Sha1Stream
+{
+public:
+    explicit Sha1Stream(const uint32_t state[5] = kSha1Init, uint64_t processed = 0)
+        : used_(0), total_(processed)
+    {
+        memcpy(state_, state, sizeof(state_));
+    }
+
+    void update(const uint8_t *data, size_t length)
+    {
+        total_ += length;
+        while (length > 0)
+        {
+            size_t chunk = std::min(length, kBlockLength - used_);
+            memcpy(buffer_ + used_, data, chunk);
+            used_ += chunk;
+            data += chunk;
+            length -= chunk;
+            if (used_ == kBlockLength)
+            {
+                compressBuffer();
+            }
+        }
+    }
+
+    void final(uint8_t digest[kDigestLength])
+    {
+        uint64_t bits = total_ * 8;
+        buffer_[used_++] = 0x80;
+        if (used_ > kBlockLength - 8)
+        {
+            memset(buffer_ + used_, 0, kBlockLength - used_);
+            compressBuffer();
+        }
+        memset(buffer_ + used_, 0, kBlockLength - 8 - used_);
+        storeBigEndian(buffer_ + kBlockLength - 8, static_cast<uint32_t>(bits >> 32));
+        storeBigEndian(buffer_ + kBlockLength - 4, static_cast<uint32_t>(bits));
+        compressBuffer();
+        for (int i = 0; i < 5; i++)
+        {
+            storeBigEndian(digest + i * 4, state_[i]);
+        }
+    }
+
+private:
+    uint32_t state_[5];
+    uint8_t buffer_[kBlockLength];
+    size_t used_;
+    uint64_t total_;
+
+    void compressBuffer()
+    {
+        uint32_t block[16];
+        for (int i = 0; i < 16; i++)
+        {
+            block[i] = loadBigEndian(buffer_ + i * 4);
+        }
+        sha1Compress(state_, block);
+        used_ = 0;
+    }
+};
+
+// HMAC-SHA1的密钥状态: 压缩过 key^ipad / key^opad 一个块后的中间状态
+struct HmacKey
+{
+    uint32_t inner[5];
+    uint32_t outer[5];
+};
+
+void prepareKey(const uint8_t *key, size_t length, HmacKey &hmacKey)
+{
+    uint8_t padded[kBlockLength] = {0};
+    if (length > kBlockLength)
+    {
+        Sha1Stream stream;
+        stream.update(key, length);
+        stream.final(padded);
+    }
+    else if (length > 0)
+    {
+        memcpy(padded, key, length);
+    }
+
+    uint32_t inner[16];
+    uint32_t outer[16];
+    for (int i = 0; i < 16; i++)
+    {
+        uint32_t word = loadBigEndian(padded + i * 4);
+        inner[i] = word ^ 0x36363636u;
+        outer[i] = word ^ 0x5c5c5c5cu;
+    }
+    memcpy(hmacKey.inner, kSha1Init, sizeof(hmacKey.inner));
+    memcpy(hmacKey.outer, kSha1Init, sizeof(hmacKey.outer));
+    sha1Compress(hmacKey.inner, inner);
+    sha1Compress(hmacKey.outer, outer);
+}
+
+// 一个PBKDF2输出块 T_i 的计算状态
+struct Job
+{
+    HmacKey key;
+    uint32_t u[5]; // U_j
+    uint32_t t[5]; // U_1 ^ ... ^ U_j
+};
+
+/*
+ * U_1 = HMAC(P, S || INT(blockIndex))
+ */
+void startJob(const HmacKey &key, const uint8_t *salt, size_t saltLength, uint32_t blockIndex, Job &job)
+{
+    job.key = key;
+    uint8_t index[4];
+    storeBigEndian(index, blockIndex);
+    uint8_t digest[kDigestLength];
+    Sha1Stream inner(key.inner, kBlockLength);
+    inner.update(salt, saltLength);
+    inner.update(index, sizeof(index));
+    inner.final(digest);
+    Sha1Stream outer(key.outer, kBlockLength);
+    outer.update(digest, sizeof(digest));
+    outer.final(digest);
+    for (int i = 0; i < 5; i++)
+    {
+        job.u[i] = loadBigEndian(digest + i * 4);
+        job.t[i] = job.u[i];
+    }
+}
+
+void iterateScalar(Job &job, uint32_t rounds)
+{
+    // 20字节摘要的单块填充: 摘要 | 0x80 | 0... | 长度
+    uint32_t block[16] = {0};
+    block[5] = 0x80000000u;
+    block[15] = kIterationBits;
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        uint32_t state[5];
+        memcpy(block, job.u, sizeof(job.u));
+        memcpy(state, job.key.inner, sizeof(state));
+        sha1Compress(state, block);
+        memcpy(block, state, sizeof(state));
+        memcpy(job.u, job.key.outer, sizeof(job.u));
+        sha1Compress(job.u, block);
+        for (int i = 0; i < 5; i++)
+        {
+            job.t[i] ^= job.u[i];
+        }
+    }
+}
+
+//////////////////// 4路SHA1 ////////////////////
+
+#if defined(__SSE2__)
+typedef __m128i Lane;
+const char *const kBackend = "SSE2";
+
+inline Lane laneSet(uint32_t x) { return _mm_set1_epi32(static_cast<int>(x)); }
+inline Lane laneAdd(Lane a, Lane b) { return _mm_add_epi32(a, b); }
+inline Lane laneXor(Lane a, Lane b) { return _mm_xor_si128(a, b); }
+inline Lane laneAnd(Lane a, Lane b) { return _mm_and_si128(a, b); }
+inline Lane laneOr(Lane a, Lane b) { return _mm_or_si128(a, b); }
+template <int N>
+inline Lane laneRotl(Lane x) { return _mm_or_si128(_mm_slli_epi32(x, N), _mm_srli_epi32(x, 32 - N)); }
+inline Lane laneLoad(const uint32_t *p) { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p)); }
+inline void laneStore(uint32_t *p, Lane x) { _mm_storeu_si128(reinterpret_cast<__m128i *>(p), x); }
+#elif defined(__ARM_NEON)
+typedef uint32x4_t Lane;
+const char *const kBackend = "NEON";
+
+inline Lane laneSet(uint32_t x) { return vdupq_n_u32(x); }
+inline Lane laneAdd(Lane a, Lane b) { return vaddq_u32(a, b); }
+inline Lane laneXor(Lane a, Lane b) { return veorq_u32(a, b); }
+inline Lane laneAnd(Lane a, Lane b) { return vandq_u32(a, b); }
+inline Lane laneOr(Lane a, Lane b) { return vorrq_u32(a, b); }
+template <int N>
+inline Lane laneRotl(Lane x) { return vsriq_n_u32(vshlq_n_u32(x, N), x, 32 - N); }
+inline Lane laneLoad(const uint32_t *p) { return vld1q_u32(p); }
+inline void laneStore(uint32_t *p, Lane x) { vst1q_u32(p, x); }
+#else
+struct Lane
+{
+    uint32_t v[kLanes];
+};
+const char *const kBackend = "portable";
+
+inline Lane laneSet(uint32_t x)
+{
+    Lane r;
+    for (size_t i = 0; i < kLanes; i++)
+    {
+        r.v[i] = x;
+    }
+    return r;
+}
+#define LANE_BINARY(name, expr)                \
+    inline Lane name(Lane a, Lane b)           \
+    {                                          \
+        Lane r;                                \
+        for (size_t i = 0; i < kLanes; i++)    \
+        {                                      \
+            r.v[i] = expr;                     \
+        }                                      \
+        return r;                              \
+    }
+LANE_BINARY(laneAdd, a.v[i] + b.v[i])
+LANE_BINARY(laneXor, a.v[i] ^ b.v[i])
+LANE_BINARY(laneAnd, a.v[i] & b.v[i])
+LANE_BINARY(laneOr, a.v[i] | b.v[i])
+#undef LANE_BINARY
+template <int N>
+inline Lane laneRotl(Lane x)
+{
+    Lane r;
+    for (size_t i = 0; i < kLanes; i++)
+    {
+        r.v[i] = rotl(x.v[i], N);
+    }
+    return r;
+}
+inline Lane laneLoad(const uint32_t *p)
+{
+    Lane r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
+}
+inline void laneStore(uint32_t *p, Lane x)
+{
+    memcpy(p, x.v, sizeof(x.v));
+}
+#endif
+
+// 一轮SHA1(20步共用同一个f和K)
+#define SHA1_LANE_STEP(F, K)                                                                          \
+    {                                                                                                 \
+        if (i >= 16)                                                                                  \
+        {                                                                                             \
+            w[i & 15] = laneRotl<1>(laneXor(laneXor(w[(i - 3) & 15], w[(i - 8) & 15]),                \
+                                            laneXor(w[(i - 14) & 15], w[i & 15])));                   \
+        }                                                                                             \
+        Lane temp = laneAdd(laneAdd(laneRotl<5>(a), F), laneAdd(laneAdd(e, K), w[i & 15]));          \
+        e = d;                                                                                        \
+        d = c;                                                                                        \
+        c = laneRotl<30>(b);                                                                          \
+        b = a;                                                                                        \
+        a = temp;                                                                                     \
+    }
+
+void sha1CompressLanes(Lane state[5], const Lane block[16])
+{
+    Lane w[16];
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = block[i];
+    }
+    Lane a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    const Lane k0 = laneSet(kSha1K[0]);
+    const Lane k1 = laneSet(kSha1K[1]);
+    const Lane k2 = laneSet(kSha1K[2]);
+    const Lane k3 = laneSet(kSha1K[3]);
+    int i = 0;
+    for (; i < 20; i++)
+        SHA1_LANE_STEP(laneXor(d, laneAnd(b, laneXor(c, d))), k0)
+    for (; i < 40; i++)
+        SHA1_LANE_STEP(laneXor(laneXor(b, c), d), k1)
+    for (; i < 60; i++)
+        SHA1_LANE_STEP(laneOr(laneAnd(b, c), laneAnd(d, laneOr(b, c))), k2)
+    for (; i < 80; i++)
+        SHA1_LANE_STEP(laneXor(laneXor(b, c), d), k3)
+    state[0] = laneAdd(state[0], a);
+    state[1] = laneAdd(state[1], b);
+    state[2] = laneAdd(state[2], c);
+    state[3] = laneAdd(state[3], d);
+    state[4] = laneAdd(state[4], e);
+}
+#undef SHA1_LANE_STEP
+
+/*
+ * 最多kLanes个输出块同时迭代, 不足时重复最后一个块填满(结果丢弃)
+ */
+void iterateLanes(Job *jobs, size_t count, uint32_t rounds)
+{
+    uint32_t column[kLanes];
+    Lane inner[5], outer[5], u[5], t[5];
+    for (int word = 0; word < 5; word++)
+    {
+        for (size_t lane = 0; lane < kLanes; lane++)
+        {
+            column[lane] = jobs[lane < count ? lane : count - 1].key.inner[word];
+        }
+        inner[word] = laneLoad(column);
+        for (size_t lane = 0; lane < kLanes; lane++)
+        {
+            column[lane] = jobs[lane < count ? lane : count - 1].key.outer[word];
+        }
+        outer[word] = laneLoad(column);
+        for (size_t lane = 0; lane < kLanes; lane++)
+        {
+            column[lane] = jobs[lane < count ? lane : count - 1].u[word];
+        }
+        u[word] = laneLoad(column);
+        t[word] = u[word];
+    }
+
+    Lane block[16];
+    const Lane zero = laneSet(0);
+    block[5] = laneSet(0x80000000u);
+    for (int word = 6; word < 15; word++)
+    {
+        block[word] = zero;
+    }
+    block[15] = laneSet(kIterationBits);
+
+    for (uint32_t round = 0; round < rounds; round++)
+    {
+        Lane state[5];
+        for (int word = 0; word < 5; word++)
+        {
+            block[word] = u[word];
+            state[word] = inner[word];
+        }
+        sha1CompressLanes(state, block);
+        for (int word = 0; word < 5; word++)
+        {
+            block[word] = state[word];
+            u[word] = outer[word];
+        }
+        sha1CompressLanes(u, block);
+        for (int word = 0; word < 5; word++)
+        {
+            t[word] = laneXor(t[word], u[word]);
+        }
+    }
+
+    for (int word = 0; word < 5; word++)
+    {
+        laneStore(column, t[word]);
+        for (size_t lane = 0; lane < count; lane++)
+        {
+            jobs[lane].t[word] = column[lane];
+        }
+    }
+}
+
+void runJobs(Job *jobs, size_t count, uint32_t iterations, bool vectorized)
+{
+    uint32_t rounds = iterations > 0 ? iterations - 1 : 0;
+    if (!vectorized)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            iterateScalar(jobs[i], rounds);
+        }
+        return;
+    }
+    for (size_t first = 0; first < count; first += kLanes)
+    {
+        iterateLanes(jobs + first, std::min(kLanes, count - first), rounds);
+    }
+}
+
+void writeBlock(const Job &job, uint8_t *output, size_t length)
+{
+    uint8_t digest[kDigestLength];
+    for (int i = 0; i < 5; i++)
+    {
+        storeBigEndian(digest + i * 4, job.t[i]);
+    }
+    memcpy(output, digest, std::min(length, kDigestLength));
+}
+} // namespace
+
+const size_t WpaPsk::kPskLength;
+const uint32_t WpaPsk::kIterations;
+
+bool WpaPsk::isPassphrase(const std::string &password)
+{
+    if (password.size() < 8 || password.size() > 63)
+    {
+        return false;
+    }
+    for (char c : password)
+    {
+        if (c < 32 || c > 126)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WpaPsk::derive(const std::string &passphrase, const std::string &ssid, uint8_t psk[kPskLength])
+{
+    pbkdf2Sha1(reinterpret_cast<const uint8_t *>(passphrase.data()), passphrase.size(),
+               reinterpret_cast<const uint8_t *>(ssid.data()), ssid.size(), kIterations, psk, kPskLength);
+}
+
+std::string WpaPsk::deriveHex(const std::string &passphrase, const std::string &ssid)
+{
+    uint8_t psk[kPskLength];
+    derive(passphrase, ssid, psk);
+    return toHex(psk, sizeof(psk));
+}
+
+void WpaPsk::deriveBatch(std::vector<Request> &requests)
+{
+    // 每个PSK两个输出块(T1和T2的前12字节)
+    std::vector<Job> jobs(requests.size() * 2);
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        const Request &request = requests[i];
+        HmacKey key;
+        prepareKey(reinterpret_cast<const uint8_t *>(request.passphrase.data()), request.passphrase.size(), key);
+        const uint8_t *salt = reinterpret_cast<const uint8_t *>(request.ssid.data());
+        startJob(key, salt, request.ssid.size(), 1, jobs[i * 2]);
+        startJob(key, salt, request.ssid.size(), 2, jobs[i * 2 + 1]);
+    }
+    runJobs(jobs.data(), jobs.size(), kIterations, true);
+    for (size_t i = 0; i < requests.size(); i++)
+    {
+        writeBlock(jobs[i * 2], requests[i].psk, kDigestLength);
+        writeBlock(jobs[i * 2 + 1], requests[i].psk + kDigestLength, kPskLength - kDigestLength);
+    }
+}
+
+void WpaPsk::pbkdf2Sha1(const uint8_t *password, size_t passwordLength, const uint8_t *salt, size_t saltLength,
+                        uint32_t iterations, uint8_t *output, size_t outputLength, bool vectorized)
+{
+    size_t blockCount = (outputLength + kDigestLength - 1) / kDigestLength;
+    if (blockCount == 0)
+    {
+        return;
+    }
+    HmacKey key;
+    prepareKey(password, passwordLength, key);
+    std::vector<Job> jobs(blockCount);
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        startJob(key, salt, saltLength, static_cast<uint32_t>(i + 1), jobs[i]);
+    }
+    runJobs(jobs.data(), jobs.size(), iterations, vectorized);
+    for (size_t i = 0; i < blockCount; i++)
+    {
+        size_t offset = i * kDigestLength;
+        writeBlock(jobs[i], output + offset, std::min(kDigestLength, outputLength - offset));
+    }
+}
+
+std::string WpaPsk::toHex(const uint8_t *data, size_t length)
+{
+    static const char kHexDigits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(length * 2);
+    for (size_t i = 0; i < length; i++)
+    {
+        hex.push_back(kHexDigits[data[i] >> 4]);
+        hex.push_back(kHexDigits[data[i] & 0x0f]);
+    }
+    return hex;
+}
+
+const char *WpaPsk::backend()
+{
+    return kBackend;
+}
+
+size_t WpaPsk::laneCount()
+{
+    return kLanes;
+}
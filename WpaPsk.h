@@ -0,0 +1,86 @@
+#ifndef WPA_PSK_H
+#define WPA_PSK_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * WPA/WPA2预共享密钥计算
+ * PSK = PBKDF2-HMAC-SHA1(口令, SSID, 4096次, 32字节), 与wpa_passphrase的结果一致.
+ * 预先计算后以64位十六进制写入wpa_supplicant配置, wpa_supplicant启动时不再重复计算.
+ * HMAC的内外层密钥状态只计算一次, 每次迭代固定为两次SHA1压缩;
+ * SHA1压缩按4路并行(x86为SSE2, ARM为NEON, 其他平台为可移植实现), 多个输出块/多个网络同时计算
+ */
+class WpaPsk
+{
+public:
+    static const size_t kPskLength = 32;
+    static const uint32_t kIterations = 4096;
+
+    // 批量计算的一项
+    struct Request
+    {
+        std::string passphrase;
+        std::string ssid;
+        uint8_t psk[kPskLength]; // 计算结果
+    };
+
+    /**
+     * 判断是否为口令(8~63个可打印ASCII字符), 否则不能用于PSK计算
+     * @param password 密码
+     * @return 是口令返回true
+     */
+    static bool isPassphrase(const std::string &password);
+
+    /**
+     * 计算一个网络的PSK(两个输出块并行计算)
+     * @param passphrase 口令
+     * @param ssid 网络名称(作为盐)
+     * @param psk 32字节结果
+     */
+    static void derive(const std::string &passphrase, const std::string &ssid, uint8_t psk[kPskLength]);
+
+    /**
+     * 计算PSK并转换为64位十六进制(小写)
+     */
+    static std::string deriveHex(const std::string &passphrase, const std::string &ssid);
+
+    /**
+     * 批量计算PSK, 每次并行计算两个网络(共4个输出块)
+     * @param requests 输入及结果
+     */
+    static void deriveBatch(std::vector<Request> &requests);
+
+    /**
+     * 通用PBKDF2-HMAC-SHA1(RFC 2898), 输出块并行计算
+     * @param password 密码
+     * @param passwordLength 密码长度
+     * @param salt 盐
+     * @param saltLength 盐长度
+     * @param iterations 迭代次数(不小于1)
+     * @param output 结果
+     * @param outputLength 结果长度
+     * @param vectorized false时逐块使用标量SHA1(用于对比和校验)
+     */
+    static void pbkdf2Sha1(const uint8_t *password, size_t passwordLength, const uint8_t *salt, size_t saltLength,
+                           uint32_t iterations, uint8_t *output, size_t outputLength, bool vectorized = true);
+
+    /**
+     * 转换为十六进制(小写)
+     */
+    static std::string toHex(const uint8_t *data, size_t length);
+
+    /**
+     * 并行SHA1的实现("SSE2"/"NEON"/"portable")
+     */
+    static const char *backend();
+
+    /**
+     * 并行SHA1的路数
+     */
+    static size_t laneCount();
+};
+
+#endif // WPA_PSK_H
@@ -3,6 +3,8 @@
 #include <chrono>
 #include <string>
 #include <iomanip>
+#include <cstdlib>
+#include <ctime>
 
 #define WIFI_TEST
 // #define BLUE_TEST
@@ -13,6 +15,127 @@
 #ifdef BLUE_TEST
 #include "BlueInterface.h"
 #endif // BLUE_TEST
+#include "PhaseTracer.h"
+#include "MetricStore.h"
+
+// 阶段耗时跟踪: 开关, 汇总, 导出Chrome trace-event JSON
+void phaseTraceMenu()
+{
+    std::string input;
+    while (true)
+    {
+        std::cout << "\n=== 阶段耗时跟踪 (" << (PhaseTracer::isEnabled() ? "已开启" : "已关闭") << ") ===" << std::endl;
+        std::cout << "1. " << (PhaseTracer::isEnabled() ? "关闭" : "开启") << "跟踪" << std::endl;
+        std::cout << "2. 显示阶段汇总" << std::endl;
+        std::cout << "3. 导出Chrome trace(/tmp/peripheral_trace.json)" << std::endl;
+        std::cout << "4. 清空记录" << std::endl;
+        std::cout << "0. 返回上级菜单" << std::endl;
+        std::cout << "请选择: ";
+
+        std::getline(std::cin, input);
+        if (input == "1")
+        {
+            PhaseTracer::setEnabled(!PhaseTracer::isEnabled());
+        }
+        else if (input == "2")
+        {
+            std::cout << PhaseTracer::summary();
+        }
+        else if (input == "3")
+        {
+            std::cout << (PhaseTracer::writeChromeJson("/tmp/peripheral_trace.json") ? "已导出, 可在chrome://tracing或Perfetto中打开" : "导出失败") << std::endl;
+        }
+        else if (input == "4")
+        {
+            PhaseTracer::clear();
+        }
+        else if (input == "0")
+        {
+            return;
+        }
+        else
+        {
+            std::cout << "无效选择，请重新输入" << std::endl;
+        }
+    }
+}
+
+// 指标历史: 转存文件位置及容量上限(约16MiB, 10Hz采样的链路指标可保留数天)
+const char *const kMetricSpillPath = "/etc/peripheral_metrics.dat";
+
+void openMetricStore(MetricStore &store)
+{
+    MetricStoreConfig config;
+    config.spillPath = kMetricSpillPath;
+    if (!store.open(config))
+    {
+        std::cout << "指标历史文件不可用, 只保留内存中的数据" << std::endl;
+    }
+}
+
+// 指标历史: 序列列表, 按分钟降采样最近一小时
+void metricHistoryMenu(MetricStore &store)
+{
+    std::string input;
+    while (true)
+    {
+        MetricStoreStats stats = store.getStats();
+        std::vector<std::string> names;
+        store.seriesNames(names);
+        std::cout << "\n=== 指标历史 (" << stats.series << " 个序列, " << stats.samples << " 个样本, 压缩后 "
+                  << stats.encodedBytes / 1024 << " KiB, 内存块 " << stats.memoryBlocks << ", 文件块 "
+                  << stats.spilledBlocks << ") ===" << std::endl;
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            std::cout << i + 1 << ". " << names[i] << std::endl;
+        }
+        std::cout << "f. 写入文件" << std::endl;
+        std::cout << "0. 返回上级菜单" << std::endl;
+        std::cout << "选择序列查看最近一小时: ";
+
+        std::getline(std::cin, input);
+        if (input == "0")
+        {
+            return;
+        }
+        if (input == "f")
+        {
+            store.flush();
+            continue;
+        }
+        size_t choice = 0;
+        try
+        {
+            choice = static_cast<size_t>(std::stoul(input));
+        }
+        catch (...)
+        {
+        }
+        if (choice == 0 || choice > names.size())
+        {
+            std::cout << "无效选择，请重新输入" << std::endl;
+            continue;
+        }
+
+        int64_t nowMs = MetricStore::nowMs();
+        std::vector<MetricBucket> buckets;
+        store.downsample(names[choice - 1], nowMs - 3600 * 1000, nowMs, 60 * 1000, buckets);
+        std::cout << names[choice - 1] << " 最近一小时(每分钟):" << std::endl;
+        if (buckets.empty())
+        {
+            std::cout << "没有样本" << std::endl;
+        }
+        for (const auto &bucket : buckets)
+        {
+            time_t seconds = static_cast<time_t>(bucket.startMs / 1000);
+            char label[16];
+            strftime(label, sizeof(label), "%H:%M", localtime(&seconds));
+            std::cout << "  " << label << "  " << std::setw(5) << bucket.count << " 个  平均 " << std::fixed
+                      << std::setprecision(1) << bucket.mean() << "  范围 " << bucket.min << " ~ " << bucket.max
+                      << std::defaultfloat << std::endl;
+        }
+    }
+}
 
 #ifdef BLUE_TEST
 void displayBluetoothDevices(const std::vector<BluetoothDevice> &devices)
@@ -37,7 +160,7 @@ void displayBluetoothDevices(const std::vector<BluetoothDevice> &devices)
         const auto &device = devices[i];
         std::cout << std::setw(3) << i + 1
                   << std::setw(25) << (device.name.empty() ? "[未知设备]" : device.name.substr(0, 24))
-                  << std::setw(20) << device.address
+                  << std::setw(20) << device.address.toString(true)
                   << std::setw(8) << (device.isPaired ? "是" : "否")
                   << std::setw(8) << (device.isConnected ? "是" : "否")
                   << std::setw(10) << (device.autoConnect ? "是" : "否") << std::endl;
@@ -66,7 +189,7 @@ void displaySavedDevices(BlueInterface &blue)
             bool isConnected = blue.isDeviceConnected(device.address);
             bool autoConnect = blue.getAutoConnectStatus(device.address);
 
-            std::cout << i + 1 << ". " << device.name << " (" << device.address << ")" << std::endl;
+            std::cout << i + 1 << ". " << device.name << " (" << device.address.toString(true) << ")" << std::endl;
             std::cout << "   状态: " << (isConnected ? "已连接" : "未连接")
                       << " | 自动连接: " << (autoConnect ? "启用" : "禁用") << std::endl;
         }
@@ -78,7 +201,7 @@ void displaySavedDevices(BlueInterface &blue)
         for (size_t i = 0; i < savedDevices.size(); ++i)
         {
             const auto &device = savedDevices[i];
-            std::cout << pairedDevices.size() + i + 1 << ". " << device.name << " (" << device.address << ")" << std::endl;
+            std::cout << pairedDevices.size() + i + 1 << ". " << device.name << " (" << device.address.toString(true) << ")" << std::endl;
             std::cout << "   自动连接: " << (device.autoConnect ? "启用" : "禁用") << std::endl;
         }
     }
@@ -103,7 +226,13 @@ void displayBluetoothStatus(BlueInterface &blue)
             std::cout << "当前连接的设备:" << std::endl;
             for (const auto &device : connectedDevices)
             {
-                std::cout << "  - " << device.name << " (" << device.address << ")" << std::endl;
+                std::cout << "  - " << device.name << " (" << device.address.toString(true) << ")";
+                int rssi = blue.getDeviceSignalStrength(device.address);
+                if (rssi != 0)
+                {
+                    std::cout << " " << rssi << " dBm";
+                }
+                std::cout << std::endl;
             }
         }
     }
@@ -303,7 +432,7 @@ void managePairedDevices(BlueInterface &blue)
                 {
                     const auto &selectedDevice = pairedDevices[deviceChoice - 1];
                     bool currentAutoConnect = blue.getAutoConnectStatus(selectedDevice.address);
-                    std::cout << "当前设备: " << selectedDevice.name << " (" << selectedDevice.address << ")" << std::endl;
+                    std::cout << "当前设备: " << selectedDevice.name << " (" << selectedDevice.address.toString(true) << ")" << std::endl;
                     std::cout << "当前自动连接状态: " << (currentAutoConnect ? "启用" : "禁用") << std::endl;
                     std::cout << "是否启用自动连接? (y/n): ";
                     std::getline(std::cin, input);
@@ -676,7 +805,7 @@ void bluetoothDeviceManagement(BlueInterface &blue)
                 if (deviceChoice > 0 && deviceChoice <= static_cast<int>(devices.size()))
                 {
                     const auto &selectedDevice = devices[deviceChoice - 1];
-                    std::cout << "当前设备: " << selectedDevice.name << " (" << selectedDevice.address << ")" << std::endl;
+                    std::cout << "当前设备: " << selectedDevice.name << " (" << selectedDevice.address.toString(true) << ")" << std::endl;
                     std::cout << "当前自动连接状态: " << (selectedDevice.autoConnect ? "启用" : "禁用") << std::endl;
                     std::cout << "是否启用自动连接? (y/n): ";
                     std::getline(std::cin, input);
@@ -829,7 +958,12 @@ void bluetoothAdapterSettings(BlueInterface &blue)
 
 int main()
 {
+    // 设置PERIPHERAL_TRACE时从启动开始记录
+    PhaseTracer::setEnabled(getenv("PERIPHERAL_TRACE") != nullptr);
+    MetricStore metrics;
+    openMetricStore(metrics);
     BlueInterface blue;
+    blue.setMetricStore(&metrics);
     std::string input;
     int choice;
 
@@ -843,6 +977,8 @@ int main()
         std::cout << "1. 蓝牙设备管理" << std::endl;
         std::cout << "2. 蓝牙适配器设置" << std::endl;
         std::cout << "3. 查看蓝牙状态" << std::endl;
+        std::cout << "4. 阶段耗时跟踪" << std::endl;
+        std::cout << "5. 指标历史" << std::endl;
         std::cout << "0. 退出程序" << std::endl;
         std::cout << "请选择操作: ";
 
@@ -869,6 +1005,12 @@ int main()
         case 3:
             displayBluetoothStatus(blue);
             break;
+        case 4:
+            phaseTraceMenu();
+            break;
+        case 5:
+            metricHistoryMenu(metrics);
+            break;
         case 0:
             std::cout << "退出程序" << std::endl;
             return 0;
@@ -899,8 +1041,30 @@ void displayNetworks(const std::vector<NetworkInfo> &networks)
                   << std::setw(10) << network.signalStrength << " dBm"
                   << std::setw(8) << network.channel
                   << std::setw(10) << network.frequency << "MHz"
-                  << std::setw(20) << network.bssid.substr(0, 17) << std::endl;
+                  << std::setw(20) << network.bssid << std::endl;
+    }
+}
+
+// 后台扫描事件回调(在扫描线程中调用)
+void printBssEvent(const BssEvent &event, void *context)
+{
+    static const char *const kEventNames[] = {"新增", "消失", "变化"};
+    std::cout << "[后台扫描] " << kEventNames[static_cast<int>(event.type)] << " "
+              << (event.ssid.empty() ? "[隐藏网络]" : event.ssid) << " (" << event.bssid << ") "
+              << event.signalStrength << " dBm, 信道 " << event.channel;
+    if (event.changes & kBssSignalChanged)
+    {
+        std::cout << ", 信号 " << event.previousSignal << " -> " << event.signalStrength;
+    }
+    if (event.changes & kBssChannelChanged)
+    {
+        std::cout << ", 信道 " << event.previousChannel << " -> " << event.channel;
     }
+    if (event.changes & kBssSecurityChanged)
+    {
+        std::cout << ", 加密方式变化";
+    }
+    std::cout << std::endl;
 }
 
 void displaySavedNetworks(WifiInterface &wifi)
@@ -976,6 +1140,37 @@ void displayConnectionStatus(WifiInterface &wifi)
     std::cout << "子网掩码: " << (subnetMask.empty() ? "未分配" : subnetMask) << std::endl;
     std::cout << "网关地址: " << (gateway.empty() ? "未分配" : gateway) << std::endl;
     std::cout << "MAC地址: " << (macAddress.empty() ? "未知" : macAddress) << std::endl;
+    int dhcpLatencyMs = wifi.getDhcpLatencyMs();
+    if (dhcpLatencyMs >= 0)
+    {
+        std::cout << "DHCP耗时: " << dhcpLatencyMs << " ms" << std::endl;
+    }
+    RoamStats roamStats = wifi.getRoamManager().getStats();
+    if (roamStats.roams > 0)
+    {
+        std::cout << "漫游: " << roamStats.roams << " 次, 最近一次 " << roamStats.lastRoamMs << " ms(含扫描 "
+                  << roamStats.lastTotalMs << " ms)" << std::endl;
+    }
+
+    LinkSnapshot link;
+    if (wifi.getLinkMonitor().snapshot(link) && link.associated)
+    {
+        const LinkMetricStats &signal = link.metrics[LINK_SIGNAL];
+        const LinkMetricStats &bitrate = link.metrics[LINK_TX_BITRATE];
+        const LinkMetricStats &retries = link.metrics[LINK_TX_RETRIES];
+        const LinkMetricStats &beaconLoss = link.metrics[LINK_BEACON_LOSS];
+        std::cout << "链路质量(" << signal.samples << " 个样本): 信号 平均 " << signal.ewma << " dBm, 范围 "
+                  << signal.min << "~" << signal.max << ", P10/P50/P90 " << signal.p10 << "/" << signal.p50 << "/"
+                  << signal.p90 << std::endl;
+        std::cout << "  发送速率 平均 " << bitrate.ewma << " Mbit/s, P10 " << bitrate.p10 << "; 重传 "
+                  << retries.ewma << " 次/秒, P90 " << retries.p90 << "; 信标丢失 " << beaconLoss.ewma
+                  << " 次/秒" << std::endl;
+    }
+
+    ScanBrokerStats scanStats = wifi.getScanStats();
+    std::cout << "扫描请求: 缓存命中 " << scanStats.hits << ", 内核缓存命中 " << scanStats.kernelHits
+              << ", 主动扫描 " << scanStats.misses << ", 合并 " << scanStats.coalesced
+              << ", 定向扫描 " << scanStats.targeted << ", 失败 " << scanStats.failures << std::endl;
 }
 
 void displayStaticIPConfig(WifiInterface &wifi)
@@ -1202,6 +1397,9 @@ void staModeMenu(WifiInterface &wifi)
         std::cout << "5. 自动连接已保存网络" << std::endl;
         std::cout << "6. 管理已保存网络" << std::endl;
         std::cout << "7. 静态IP配置管理" << std::endl;
+        std::cout << "8. " << (wifi.getScanService().isRunning() ? "停止" : "开启") << "后台扫描" << std::endl;
+        std::cout << "9. " << (wifi.getRoamManager().isRunning() ? "停止" : "开启") << "自动漫游" << std::endl;
+        std::cout << "10. " << (wifi.getLinkMonitor().isRunning() ? "停止" : "开启") << "链路质量监测" << std::endl;
         std::cout << "0. 返回主菜单" << std::endl;
         std::cout << "请选择操作: ";
 
@@ -1453,6 +1651,65 @@ void staModeMenu(WifiInterface &wifi)
             break;
         }
 
+        case 8:
+        {
+            static int subscription = 0;
+            if (wifi.getScanService().isRunning())
+            {
+                wifi.stopBackgroundScan();
+                wifi.getScanService().unsubscribe(subscription);
+                std::cout << "后台扫描已停止" << std::endl;
+                break;
+            }
+            subscription = wifi.getScanService().subscribe(printBssEvent, nullptr);
+            if (wifi.startBackgroundScan())
+            {
+                std::cout << "后台扫描已开启, 网络变化将实时显示" << std::endl;
+            }
+            else
+            {
+                wifi.getScanService().unsubscribe(subscription);
+                std::cout << "后台扫描开启失败" << std::endl;
+            }
+            break;
+        }
+
+        case 9:
+        {
+            RoamManager &roaming = wifi.getRoamManager();
+            if (roaming.isRunning())
+            {
+                wifi.stopRoaming();
+                RoamStats stats = roaming.getStats();
+                std::cout << "自动漫游已停止: 触发" << stats.triggers << "次, 漫游" << stats.roams << "次, 失败"
+                          << stats.failures << "次";
+                if (stats.roams > 0)
+                {
+                    std::cout << ", 最近一次漫游耗时" << stats.lastRoamMs << "ms(含扫描" << stats.lastTotalMs
+                              << "ms), 平均" << stats.totalRoamMs / stats.roams << "ms";
+                }
+                std::cout << std::endl;
+                break;
+            }
+            std::cout << (wifi.startRoaming() ? "自动漫游已开启, 信号低于-75dBm时切换到更强的AP" : "自动漫游开启失败")
+                      << std::endl;
+            break;
+        }
+
+        case 10:
+        {
+            if (wifi.getLinkMonitor().isRunning())
+            {
+                wifi.stopLinkMonitor();
+                std::cout << "链路质量监测已停止" << std::endl;
+                break;
+            }
+            std::cout << (wifi.startLinkMonitor() ? "链路质量监测已开启, 每100ms采样一次, 在连接状态中查看"
+                                                  : "链路质量监测开启失败")
+                      << std::endl;
+            break;
+        }
+
         case 0:
             return;
 
@@ -1609,6 +1866,11 @@ void apModeMenu(WifiInterface &wifi)
                 {
                     std::cout << i + 1 << ". MAC: " << clients[i].macAddress
                               << ", IP: " << clients[i].ipAddress << std::endl;
+                    std::cout << "   信号: " << clients[i].signalStrength << " dBm"
+                              << ", 发送速率: " << clients[i].txBitrateKbps / 1000 << " Mbit/s"
+                              << ", 接收速率: " << clients[i].rxBitrateKbps / 1000 << " Mbit/s"
+                              << ", 收/发: " << clients[i].rxBytes << "/" << clients[i].txBytes << " 字节"
+                              << ", 重传: " << clients[i].txRetries << std::endl;
                 }
             }
             break;
@@ -1745,11 +2007,17 @@ void apStaModeMenu(WifiInterface &wifi)
 // ==================== 主菜单 ====================
 int main()
 {
+    // 设置PERIPHERAL_TRACE时从启动开始记录
+    PhaseTracer::setEnabled(getenv("PERIPHERAL_TRACE") != nullptr);
+    // 先于wifi构造, 链路监测线程在wifi析构时停止后才关闭
+    MetricStore metrics;
+    openMetricStore(metrics);
 #ifdef _WIN32
     WifiInterface wifi("Wi-Fi", "Microsoft Wi-Fi Direct Virtual Adapter");
 #else
     WifiInterface wifi("wlan0", "wlan1");
 #endif // _WIN32
+    wifi.setMetricStore(&metrics);
 
     std::string input;
     int choice;
@@ -1794,6 +2062,8 @@ int main()
         std::cout << "3. AP+STA共存模式" << std::endl;
         std::cout << "4. 全关闭模式" << std::endl;
         std::cout << "5. 切换工作模式" << std::endl;
+        std::cout << "6. 阶段耗时跟踪" << std::endl;
+        std::cout << "7. 指标历史" << std::endl;
         std::cout << "0. 退出程序" << std::endl;
         std::cout << "请选择操作模式: ";
 
@@ -1927,6 +2197,14 @@ int main()
             break;
         }
 
+        case 6:
+            phaseTraceMenu();
+            break;
+
+        case 7:
+            metricHistoryMenu(metrics);
+            break;
+
         case 0:
             std::cout << "退出测试程序" << std::endl;
             return 0;